@@ -0,0 +1,307 @@
+#include <benchmark/benchmark.h>
+
+#include "cli/settings_file.hpp"
+#include "game/game_types.hpp"
+#include "game/game_utils.hpp"
+#include "game/holdem/hand_evaluation.hpp"
+#include "game/holdem/holdem_parser.hpp"
+#include "game/holdem/holdem.hpp"
+#include "solver/cfr.hpp"
+#include "solver/tree.hpp"
+#include "util/fixed_vector.hpp"
+#include "util/scoped_silent_output.hpp"
+#include "util/stack_allocator.hpp"
+#include "util/thread_count.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Run with --benchmark_format=json or --benchmark_out=<file> --benchmark_out_format=json for machine readable results
+
+namespace {
+static constexpr int NumRandomHands = 4096;
+
+// Flop, turn, and river boards used by the synthetic benchmarks
+static const StreetArray<std::string> SyntheticBoards = { "Kd, 7c, 2h", "Kd, 7c, 2h, 9s", "Kd, 7c, 2h, 9s, 4d" };
+
+// Powers of two up to the number of available threads, and the number of available threads itself, to measure thread scaling
+std::vector<std::int64_t> getThreadCounts() {
+    int maxNumThreads = getMaxNumThreads();
+    std::vector<std::int64_t> threadCounts;
+    for (int numThreads = 1; numThreads < maxNumThreads; numThreads *= 2) {
+        threadCounts.push_back(numThreads);
+    }
+    threadCounts.push_back(maxNumThreads);
+    return threadCounts;
+}
+
+void applyThreadCounts(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgsProduct({ getThreadCounts() })->ArgNames({ "threads" });
+}
+
+// Runs the function on one thread of a parallel region, so that the solver can spawn tasks for the other threads
+template <typename Function>
+void runInParallel(int numThreads, const Function& function) {
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(numThreads)
+    #pragma omp single
+    #endif
+    function();
+}
+
+// Every combo that does not overlap the board, with equal weights
+Holdem::Range buildFullRange(CardSet board) {
+    Holdem::Range range;
+    for (CardID card0 = 0; card0 < holdem::DeckSize; ++card0) {
+        for (CardID card1 = card0 + 1; card1 < holdem::DeckSize; ++card1) {
+            CardSet hand = cardIDToSet(card0) | cardIDToSet(card1);
+            if (!doSetsOverlap(hand, board)) {
+                range.hands.push_back(hand);
+                range.weights.push_back(1.0f);
+            }
+        }
+    }
+    return range;
+}
+
+Holdem::Settings getSyntheticSettings(Street street, bool allowBets, int numThreads) {
+    CardSet board = buildCommunityCardsFromString(SyntheticBoards[street]).getValue();
+    Holdem::Range fullRange = buildFullRange(board);
+
+    FixedVector<int, holdem::MaxNumBetSizes> betSizes;
+    if (allowBets) {
+        betSizes.pushBack(75);
+    }
+
+    return {
+        .ranges = { fullRange, fullRange },
+        .startingCommunityCards = board,
+        .betSizes = { { betSizes, betSizes, betSizes }, { betSizes, betSizes, betSizes } },
+        .raiseSizes = {},
+        .startingPlayerWagers = 50,
+        .effectiveStackRemaining = 200,
+        .deadMoney = 0,
+        .useChanceCardIsomorphism = true,
+        .expandAllInRunouts = false,
+        .numThreads = numThreads,
+        .handTableCacheDirectory = {},
+    };
+}
+
+// A loaded example spot with its tree built and its training data initialized
+struct ExampleSpot {
+    std::filesystem::path path;
+    std::unique_ptr<Holdem> rules;
+    std::unique_ptr<Tree> tree;
+    int numCompletedIterations;
+};
+
+// Only the most recently used spot is kept, since the trees of the examples can be large
+ExampleSpot* getExampleSpot(const std::filesystem::path& path) {
+    static std::unique_ptr<ExampleSpot> cachedSpot;
+    if (cachedSpot && cachedSpot->path == path) {
+        return cachedSpot.get();
+    }
+    cachedSpot.reset();
+
+    ScopedSilentOutput silentOutput;
+    std::optional<HoldemSettingsFile> settingsFile = loadHoldemSettingsFile(path.string());
+    if (!settingsFile) {
+        return nullptr;
+    }
+    settingsFile->gameSettings.numThreads = getMaxNumThreads();
+
+    auto spot = std::make_unique<ExampleSpot>();
+    spot->path = path;
+    spot->rules = std::make_unique<Holdem>(settingsFile->gameSettings);
+    spot->tree = std::make_unique<Tree>(settingsFile->solverSettings.useTrainingDataCompression);
+    spot->tree->buildTreeSkeleton(*spot->rules, getMaxNumThreads());
+    spot->tree->initCfrVectors(getMaxNumThreads());
+    spot->numCompletedIterations = 0;
+
+    cachedSpot = std::move(spot);
+    return cachedSpot.get();
+}
+
+void BM_GetFiveCardHandRank(benchmark::State& state) {
+    std::mt19937 generator{ 0 };
+    std::vector<CardSet> hands;
+    hands.reserve(NumRandomHands);
+    while (hands.size() < NumRandomHands) {
+        CardSet hand = 0;
+        while (getSetSize(hand) < 5) {
+            hand |= cardIDToSet(static_cast<CardID>(generator() % holdem::DeckSize));
+        }
+        hands.push_back(hand);
+    }
+
+    for (auto _ : state) {
+        for (CardSet hand : hands) {
+            benchmark::DoNotOptimize(getFiveCardHandRank(hand));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * NumRandomHands);
+}
+BENCHMARK(BM_GetFiveCardHandRank);
+
+// Building the hand tables dominates setup, and its cost depends on how many runouts are still to come
+void BM_BuildHandTables(benchmark::State& state) {
+    Street street = static_cast<Street>(state.range(0));
+    Holdem::Settings settings = getSyntheticSettings(street, false, static_cast<int>(state.range(1)));
+
+    for (auto _ : state) {
+        Holdem rules{ settings };
+        benchmark::DoNotOptimize(rules.getRangeHands(Player::P0).data());
+    }
+}
+BENCHMARK(BM_BuildHandTables)
+    ->ArgsProduct({ { 0, 1, 2 }, getThreadCounts() })
+    ->ArgNames({ "street", "threads" })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// The leaf evaluators are internal to the traversal, so they are measured through expected value traversals of river trees with full ranges
+// Without bets the only actions are check and all in, so almost all of the work is in the fold and showdown nodes
+void BM_RiverTraversal(benchmark::State& state) {
+    bool allowBets = state.range(0) != 0;
+    int numThreads = static_cast<int>(state.range(1));
+    Holdem rules{ getSyntheticSettings(Street::River, allowBets, numThreads) };
+    Tree tree;
+    tree.buildTreeSkeleton(rules, numThreads);
+    tree.initCfrVectors(numThreads);
+    StackAllocator allocator(numThreads, tree.estimateStackAllocatorSize());
+
+    auto countNodes = [&tree](NodeType nodeType) -> std::int64_t {
+        return std::count_if(tree.allNodes.begin(), tree.allNodes.end(), [nodeType](const Node& node) { return node.nodeType == nodeType; });
+    };
+    std::int64_t numShowdowns = countNodes(NodeType::Showdown);
+    std::int64_t numFolds = countNodes(NodeType::Fold);
+
+    for (auto _ : state) {
+        runInParallel(numThreads, [&]() {
+            benchmark::DoNotOptimize(expectedValue(Player::P0, rules, tree, allocator));
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * (numShowdowns + numFolds));
+    state.counters["showdowns"] = static_cast<double>(numShowdowns);
+    state.counters["folds"] = static_cast<double>(numFolds);
+}
+BENCHMARK(BM_RiverTraversal)
+    ->ArgsProduct({ { 0, 1 }, getThreadCounts() })
+    ->ArgNames({ "bets", "threads" })
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+// Full range river trees have few nodes, so the subtree tasks are the only parallelism their iterations get
+void BM_RiverDiscountedCfrIteration(benchmark::State& state) {
+    int numThreads = static_cast<int>(state.range(0));
+    Holdem rules{ getSyntheticSettings(Street::River, true, numThreads) };
+    Tree tree;
+    tree.buildTreeSkeleton(rules, numThreads);
+    tree.initCfrVectors(numThreads);
+    StackAllocator allocator(numThreads, tree.estimateStackAllocatorSize());
+
+    int iteration = 0;
+    for (auto _ : state) {
+        DiscountParams params = getDiscountParams(1.5f, 0.0f, 2.0f, ++iteration);
+        runInParallel(numThreads, [&]() {
+            for (Player hero : { Player::P0, Player::P1 }) {
+                discountedCfr(hero, rules, params, tree, allocator);
+            }
+        });
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["nodes"] = static_cast<double>(tree.allNodes.size());
+}
+BENCHMARK(BM_RiverDiscountedCfrIteration)
+    ->Apply(applyThreadCounts)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+// One iteration updates both players, the same as one iteration of the solve command
+void BM_DiscountedCfrIteration(benchmark::State& state, const std::filesystem::path& path) {
+    ExampleSpot* spot = getExampleSpot(path);
+    if (!spot) {
+        state.SkipWithError("Could not load example spot");
+        return;
+    }
+
+    int numThreads = static_cast<int>(state.range(0));
+    StackAllocator allocator(numThreads, spot->tree->estimateStackAllocatorSize());
+
+    for (auto _ : state) {
+        DiscountParams params = getDiscountParams(1.5f, 0.0f, 2.0f, spot->numCompletedIterations + 1);
+        runInParallel(numThreads, [&]() {
+            for (Player hero : { Player::P0, Player::P1 }) {
+                discountedCfr(hero, *spot->rules, params, *spot->tree, allocator);
+            }
+        });
+        ++spot->numCompletedIterations;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["nodes"] = static_cast<double>(spot->tree->allNodes.size());
+}
+
+void BM_CalculateExploitabilityFast(benchmark::State& state, const std::filesystem::path& path) {
+    ExampleSpot* spot = getExampleSpot(path);
+    if (!spot) {
+        state.SkipWithError("Could not load example spot");
+        return;
+    }
+
+    int numThreads = static_cast<int>(state.range(0));
+    StackAllocator allocator(numThreads, spot->tree->estimateStackAllocatorSize());
+
+    for (auto _ : state) {
+        runInParallel(numThreads, [&]() {
+            benchmark::DoNotOptimize(calculateExploitabilityFast(*spot->rules, *spot->tree, allocator));
+        });
+    }
+}
+
+void registerExampleBenchmarks() {
+    std::vector<std::filesystem::path> examplePaths;
+    for (const auto& entry : std::filesystem::directory_iterator{ POSTFLOP_EXAMPLES_DIRECTORY }) {
+        if (entry.path().extension() == ".yml") {
+            examplePaths.push_back(entry.path());
+        }
+    }
+    std::sort(examplePaths.begin(), examplePaths.end());
+
+    for (const std::filesystem::path& path : examplePaths) {
+        std::string spotName = path.stem().string();
+
+        benchmark::RegisterBenchmark(("BM_DiscountedCfrIteration/" + spotName).c_str(), BM_DiscountedCfrIteration, path)
+            ->Apply(applyThreadCounts)
+            ->Unit(benchmark::kMillisecond)
+            ->UseRealTime();
+
+        benchmark::RegisterBenchmark(("BM_CalculateExploitabilityFast/" + spotName).c_str(), BM_CalculateExploitabilityFast, path)
+            ->Apply(applyThreadCounts)
+            ->Unit(benchmark::kMillisecond)
+            ->UseRealTime();
+    }
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    registerExampleBenchmarks();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
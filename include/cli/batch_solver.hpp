@@ -0,0 +1,16 @@
+#ifndef BATCH_SOLVER_HPP
+#define BATCH_SOLVER_HPP
+
+#include <string>
+
+// Solves every Hold'em settings file listed in a YAML manifest without the interactive prompt
+// Each solved tree is written with the same binary format as the "save" command
+// Returns true if every spot was solved and saved
+bool runBatch(const std::string& manifestPath);
+
+// Solves one Hold'em settings file on many flops and writes a CSV report of each flop's expected values and root action frequencies
+// Flops that a suit permutation of both ranges maps onto each other are only solved once, and their report row counts all of them
+// Returns true if every flop was solved and the report was written
+bool runAggregate(const std::string& manifestPath);
+
+#endif // BATCH_SOLVER_HPP
@@ -0,0 +1,12 @@
+#ifndef DISTRIBUTED_WORKER_HPP
+#define DISTRIBUTED_WORKER_HPP
+
+#include <cstdint>
+#include <string>
+
+// Builds the tree of a Hold'em settings file and serves coordinators on the port until one of them shuts the worker down
+// The coordinator must be set up with the same settings file, see solver/distributed.hpp
+// Returns false if the settings file could not be loaded or the port could not be opened
+bool runDistributedWorker(const std::string& settingsPath, std::uint16_t port);
+
+#endif // DISTRIBUTED_WORKER_HPP
@@ -0,0 +1,12 @@
+#ifndef QUERY_SERVER_HPP
+#define QUERY_SERVER_HPP
+
+#include <string>
+
+// Serves strategy lookups over HTTP/JSON for the saved solutions listed in a YAML manifest
+// Each request names a solution and the actions and cards that lead to a node, so any number of clients can browse at once
+// Solutions are memory mapped when first requested, and the least recently used ones are unloaded to stay under the memory budget
+// Returns false if the manifest could not be loaded or the port could not be opened, otherwise serves until the process is stopped
+bool runQueryServer(const std::string& manifestPath);
+
+#endif // QUERY_SERVER_HPP
@@ -0,0 +1,63 @@
+#ifndef SETTINGS_FILE_HPP
+#define SETTINGS_FILE_HPP
+
+#include "game/holdem/holdem.hpp"
+#include "solver/solver_session.hpp"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+// Options from the solver section of a settings file
+struct SolverSettings {
+    float targetPercentExploitability;
+    int maxIterations;
+    int exploitabilityCheckFrequency;
+    int numThreads;
+    bool useTrainingDataCompression;
+
+    // When pruning is enabled, every iteration except each pruningRevisitFrequency-th one uses regret based pruning
+    bool usePruning;
+    int pruningRevisitFrequency;
+
+    // Update both players in one traversal per iteration instead of one traversal per player
+    bool useSimultaneousUpdates;
+
+    // The first chanceSamplingIterations iterations only visit chanceSamplingCards cards at each chance node, the rest visit every card
+    int chanceSamplingIterations;
+    int chanceSamplingCards;
+
+    // Checkpoints are disabled when checkpointFile is empty
+    std::string checkpointFile;
+    int checkpointFrequency;
+    int checkpointIntervalMinutes;
+
+    // Solved tree with the same board and ranges to seed the regrets from, empty to start from zero
+    std::string warmStartFile;
+
+    // Directory for scratch files holding the training data, empty to keep it in RAM
+    std::string trainingDataDirectory;
+
+    // Back the training data with transparent huge pages, ignored when it is stored in scratch files
+    bool useHugePages;
+
+    // Addresses (host:port) of the workers that train the subtrees after the first chance card, empty to solve on this machine
+    std::vector<std::string> distributedWorkers;
+};
+
+struct HoldemSettingsFile {
+    Holdem::Settings gameSettings;
+    SolverSettings solverSettings;
+
+    // Ranges before the hands that overlap the board are removed, used to solve the same ranges on other boards
+    PlayerArray<Holdem::Range> fullRanges;
+};
+
+// Loads a Hold'em YAML settings file, printing each field as it is loaded
+// Errors are printed to std::cerr, and std::nullopt is returned if any required field is missing or invalid
+std::optional<HoldemSettingsFile> loadHoldemSettingsFile(const std::string& filePath);
+
+// The options used by the training loop, see trainDiscountedCfr
+SolveSettings getSolveSettings(const SolverSettings& solverSettings);
+
+#endif // SETTINGS_FILE_HPP
@@ -4,18 +4,15 @@
 #include "cli/cli_dispatcher.hpp"
 #include "game/game_rules.hpp"
 #include "game/game_types.hpp"
+#include "solver/node_path.hpp"
 #include "solver/tree.hpp"
 
 #include <cstddef>
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
-struct NodeInfo {
-    std::size_t index;
-    std::optional<SuitMapping> swapList;
-};
-
 struct SolverContext {
     std::unique_ptr<IGameRules> rules;
     std::unique_ptr<Tree> tree;
@@ -24,6 +21,35 @@ struct SolverContext {
     int exploitabilityCheckFrequency;
     int numThreads;
     std::vector<NodeInfo> nodePath;
+
+    // Checkpoints are disabled when checkpointFile is empty
+    // A frequency or interval of 0 disables that trigger, the final state is always saved
+    std::string checkpointFile;
+    int checkpointFrequency;
+    int checkpointIntervalMinutes;
+
+    // Solved tree to seed the regrets from, empty to start from zero
+    std::string warmStartFile;
+
+    // Directory for scratch files holding the training data, empty to keep it in RAM
+    std::string trainingDataDirectory;
+
+    // Back the training data with transparent huge pages, ignored when it is stored in scratch files
+    bool useHugePages;
+
+    // Addresses (host:port) of the workers that train the subtrees after the first chance card, empty to solve on this machine
+    std::vector<std::string> distributedWorkers;
+
+    // When pruning is enabled, every iteration except each pruningRevisitFrequency-th one uses regret based pruning
+    bool usePruning;
+    int pruningRevisitFrequency;
+
+    // Update both players in one traversal per iteration instead of one traversal per player
+    bool useSimultaneousUpdates;
+
+    // The first chanceSamplingIterations iterations only visit chanceSamplingCards cards at each chance node, the rest visit every card
+    int chanceSamplingIterations;
+    int chanceSamplingCards;
 };
 
 bool registerAllCommands(CliDispatcher& dispatcher, SolverContext& context);
@@ -2,11 +2,73 @@
 #define GAME_RULES_HPP
 
 #include "game/game_types.hpp"
+#include "game/game_utils.hpp"
 #include "util/fixed_vector.hpp"
 
+#include <cassert>
+#include <cstddef>
 #include <span>
 #include <string>
 
+// Valid hands and sorted hand ranks for every runout of up to two chance cards after the starting board of a 52 card deck
+// The lookups are defined here, so that traversals given these tables inline them instead of making a virtual call per node
+struct RunoutHandTables {
+    CardSet startingBoard;
+    PlayerArray<std::size_t> rangeSize;
+
+    // rangeSize entries per runout, with the valid hands first
+    // Runouts are the starting board, then each single card, then each pair of cards
+    PlayerArray<std::span<const HandInfo>> validHands;
+    PlayerArray<std::span<const int>> numValidHands;
+
+    // rangeSize entries per full board with the blocked hands first, so only full boards have runouts
+    PlayerArray<std::span<const RankedHand>> handRanks;
+    PlayerArray<std::span<const int>> numValidHandRanks;
+
+    std::span<const HandInfo> getValidHands(Player player, CardSet board) const {
+        CardSet chanceCardsDealt = board & ~startingBoard;
+        std::size_t runoutIndex = 0;
+        switch (getSetSize(chanceCardsDealt)) {
+            case 0:
+                break;
+            case 1:
+                runoutIndex = 1 + getLowestCardInSet(chanceCardsDealt);
+                break;
+            case 2:
+                runoutIndex = 1 + 52 + mapTwoCardSetToIndex(chanceCardsDealt);
+                break;
+            default:
+                assert(false);
+                break;
+        }
+
+        return validHands[player].subspan(runoutIndex * rangeSize[player], numValidHands[player][runoutIndex]);
+    }
+
+    std::span<const RankedHand> getValidSortedHandRanks(Player player, CardSet board) const {
+        assert(getSetSize(board) == 5);
+
+        CardSet chanceCardsDealt = board & ~startingBoard;
+        std::size_t runoutIndex = 0;
+        switch (getSetSize(chanceCardsDealt)) {
+            case 0:
+                break;
+            case 1:
+                runoutIndex = getLowestCardInSet(chanceCardsDealt);
+                break;
+            case 2:
+                runoutIndex = mapTwoCardSetToIndex(chanceCardsDealt);
+                break;
+            default:
+                assert(false);
+                break;
+        }
+
+        std::size_t numValid = numValidHandRanks[player][runoutIndex];
+        return handRanks[player].subspan((runoutIndex + 1) * rangeSize[player] - numValid, numValid);
+    }
+};
+
 class IGameRules {
 public:
     virtual ~IGameRules() = default;
@@ -22,11 +84,18 @@ public:
     virtual std::span<const CardSet> getRangeHands(Player player) const = 0;
     virtual int getHandIndexAfterSuitSwap(Player player, int handIndex, Suit x, Suit y) const = 0;
 
+    // Index of the hand in getRangeHands(player) in constant time, or -1 if the hand is not in the range
+    virtual int getRangeIndex(Player player, CardSet hand) const = 0;
+
     // Functions for the CFR algorithm
     virtual std::span<const float> getInitialRangeWeights(Player player) const = 0;
     virtual std::span<const HandInfo> getValidHands(Player player, CardSet board) const = 0;
     virtual std::span<const RankedHand> getValidSortedHandRanks(Player player, CardSet board) const = 0;
 
+    // Games whose hand tables are laid out as RunoutHandTables return them, so that traversals can look hands up without virtual calls
+    // getValidHands and getValidSortedHandRanks must then return the same as the tables
+    virtual const RunoutHandTables* getRunoutHandTables() const { return nullptr; }
+
     // Functions for output
     virtual std::string getActionName(ActionID actionID, int betRaiseSize) const = 0;
 };
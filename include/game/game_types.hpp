@@ -8,6 +8,7 @@
 #include <cstdint>
 
 constexpr int StandardDeckSize = holdem::DeckSize;
+constexpr int StandardBoardSize = holdem::BoardSize;
 constexpr int MaxNumDealCards = holdem::MaxNumDealCards;
 constexpr int MaxNumActions = holdem::MaxNumActions;
 
@@ -33,7 +34,11 @@ enum class NodeType : std::uint8_t {
     Chance,
     Decision,
     Fold,
-    Showdown
+    Showdown,
+
+    // Both players are all in before the river, so the rest of the board is dealt without any decisions
+    // The expected value is calculated directly from every runout instead of expanding chance nodes
+    AllInRunout
 };
 
 enum class Value : std::uint8_t {
@@ -116,6 +116,19 @@ constexpr int mapTwoSuitsToIndex(Suit x, Suit y) {
     return finalIndex;
 }
 
+// Index of a set of two cards among the 52 choose 2 such sets
+constexpr int mapTwoCardSetToIndex(CardSet cardSet) {
+    assert(getSetSize(cardSet) == 2);
+
+    CardID x = popLowestCardFromSet(cardSet);
+    CardID y = popLowestCardFromSet(cardSet);
+    assert(cardSet == 0);
+
+    int finalIndex = x + ((y * (y - 1)) >> 1);
+    assert(finalIndex < (52 * 51) / 2);
+    return finalIndex;
+}
+
 constexpr Street getNextStreet(Street street) {
     return static_cast<Street>(static_cast<int>(street) + 1);
 }
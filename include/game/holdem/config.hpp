@@ -5,6 +5,7 @@
 
 namespace holdem {
 constexpr int DeckSize = 52;
+constexpr int BoardSize = 5;
 constexpr int MaxNumDealCards = DeckSize - 3; // Three flop cards are already dealt
 
 constexpr int MaxNumBetSizes = 3;
@@ -0,0 +1,38 @@
+#ifndef FLOP_ISOMORPHISM_HPP
+#define FLOP_ISOMORPHISM_HPP
+
+#include "game/game_types.hpp"
+#include "game/holdem/holdem.hpp"
+
+#include <array>
+#include <span>
+#include <vector>
+
+// Relabeling of the four suits, where suit s becomes permutation[s]
+using SuitPermutation = std::array<Suit, 4>;
+
+CardSet permuteSetSuits(CardSet cardSet, const SuitPermutation& permutation);
+
+// Suit permutations that map every hand of both ranges to a hand of the same range with the same weight, starting with the identity
+// Flops that one of these permutations maps onto each other have the same solution up to the relabeling of the suits
+std::vector<SuitPermutation> getRangeSuitSymmetries(const PlayerArray<Holdem::Range>& ranges);
+
+// A flop that stands for every flop that the range symmetries map onto it
+struct CanonicalFlop {
+    // Lowest flop (as a CardSet) of its class
+    CardSet flop;
+
+    // Number of input flops in the class
+    int numFlops;
+};
+
+// Groups the flops into classes of flops that the symmetries map onto each other, in order of the first flop of each class
+std::vector<CanonicalFlop> getCanonicalFlops(std::span<const CardSet> flops, std::span<const SuitPermutation> symmetries);
+
+// All 22100 flops, in increasing order
+std::vector<CardSet> getAllFlops();
+
+// Removes the hands that overlap the board, which gives the same range as building it for that board
+Holdem::Range removeBlockedHands(const Holdem::Range& range, CardSet board);
+
+#endif // FLOP_ISOMORPHISM_HPP
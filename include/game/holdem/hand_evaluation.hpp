@@ -5,6 +5,23 @@
 
 #include <cstdint>
 
+enum class HandType : std::uint8_t {
+    HighCard,
+    Pair,
+    TwoPair,
+    ThreeOfAKind,
+    Straight,
+    Flush,
+    FullHouse,
+    FourOfAKind,
+    StraightFlush,
+    RoyalFlush
+};
+
 HandRank getFiveCardHandRank(CardSet hand);
+HandRank getSevenCardHandRank(CardSet hand);
+
+// Hand type stored in the highest bits of a hand rank
+HandType getHandType(HandRank handRank);
 
 #endif // HAND_EVALUATION_HPP
\ No newline at end of file
@@ -7,7 +7,9 @@
 #include "util/fixed_vector.hpp"
 #include "util/result.hpp"
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <span>
 #include <string>
 #include <vector>
@@ -33,8 +35,14 @@ public:
         int effectiveStackRemaining;
         int deadMoney;
         bool useChanceCardIsomorphism;
+
+        // Build chance nodes down to the river after both players are all in, instead of evaluating the runouts at a single all in runout node
+        bool expandAllInRunouts;
         int numThreads;
 
+        // Directory used to cache hand tables between runs, empty to disable caching
+        std::string handTableCacheDirectory;
+
         // TODO:
         // Add all-in threshold
         // Force all-in threshold
@@ -43,8 +51,32 @@ public:
         // Rake?
     };
 
+    // Hand tables depend only on the starting board and the hands in each range, so spots that agree on both can share them
+    struct HandTables {
+        PlayerArray<std::vector<HandInfo>> validHands;
+        PlayerArray<std::vector<RankedHand>> handRanks;
+
+        // Number of hands that do not overlap the board for every runout in validHands and handRanks
+        PlayerArray<std::vector<int>> numValidHands;
+        PlayerArray<std::vector<int>> numValidHandRanks;
+    };
+
+    // Wall time of each setup stage in seconds, stages that were skipped are zero
+    // The isomorphism tables are built while the hand tables are built or loaded from the cache, so the stages overlap
+    struct SetupTimings {
+        double handTableCacheSeconds = 0.0;
+        double handRanksSeconds = 0.0;
+        double validHandsSeconds = 0.0;
+        double isomorphismTablesSeconds = 0.0;
+    };
+
     Holdem(const Settings& settings);
 
+    // Shares the hand tables of handTableSource instead of building them, the settings must satisfy canShareHandTables()
+    Holdem(const Settings& settings, const Holdem& handTableSource);
+
+    static bool canShareHandTables(const Settings& settings0, const Settings& settings1);
+
     GameState getInitialGameState() const override;
     CardSet getDeck() const override;
     int getDeadMoney() const override;
@@ -54,24 +86,43 @@ public:
     FixedVector<SuitEquivalenceClass, 4> getChanceNodeIsomorphisms(CardSet board) const override;
     std::span<const CardSet> getRangeHands(Player player) const override;
     int getHandIndexAfterSuitSwap(Player player, int handIndex, Suit x, Suit y) const override;
+    int getRangeIndex(Player player, CardSet hand) const override;
     std::span<const float> getInitialRangeWeights(Player player) const override;
     std::span<const HandInfo> getValidHands(Player player, CardSet board) const override;
     std::span<const RankedHand> getValidSortedHandRanks(Player player, CardSet board) const override;
+    const RunoutHandTables* getRunoutHandTables() const override;
     std::string getActionName(ActionID actionID, int betRaiseSize) const override;
 
+    bool wereHandTablesLoadedFromCache() const;
+
+    // Heap memory used by the hand tables, which is shared with every Holdem built from this one
+    std::size_t getHandTablesSize() const;
+
+    // Equal to getHandTablesSize() of a Holdem built from the settings, without building it
+    static std::size_t estimateHandTablesSize(const Settings& settings);
+    const SetupTimings& getSetupTimings() const;
+
 private:
-    void buildHandTables();
+    void buildHandRanks(HandTables& handTables) const;
+    void buildValidHands(HandTables& handTables) const;
+    void buildIsomorphismTables();
+    bool loadHandTablesFromCache(HandTables& handTables) const;
+    void saveHandTablesToCache(const HandTables& handTables) const;
+    void buildValidRangeSizes(HandTables& handTables) const;
+    void setRunoutHandTables();
     HandInfo getHandInfo(Player player, int handIndex) const;
     int getTotalEffectiveStack() const;
     bool areBothPlayersAllIn(const GameState& state) const;
     Street getStartingStreet() const;
 
     Settings m_settings;
-    PlayerArray<std::vector<HandInfo>> m_validHands;
-    PlayerArray<std::vector<RankedHand>> m_handRanks;
+    std::shared_ptr<const HandTables> m_handTables;
+    RunoutHandTables m_runoutHandTables;
     PlayerArray<std::array<std::int16_t, holdem::NumPossibleTwoCardHands>> m_handToRangeIndex;
     FixedVector<SuitEquivalenceClass, 4> m_startingIsomorphisms;
     std::array<FixedVector<SuitEquivalenceClass, 4>, 4> m_isomorphismsAfterSuitDealt;
+    bool m_handTablesLoadedFromCache;
+    SetupTimings m_setupTimings;
 };
 
 #endif // HOLDEM_HPP
\ No newline at end of file
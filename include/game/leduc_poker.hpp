@@ -21,6 +21,7 @@ public:
     FixedVector<SuitEquivalenceClass, 4> getChanceNodeIsomorphisms(CardSet board) const override;
     std::span<const CardSet> getRangeHands(Player player) const override;
     int getHandIndexAfterSuitSwap(Player player, int handIndex, Suit x, Suit y) const override;
+    int getRangeIndex(Player player, CardSet hand) const override;
     std::span<const float> getInitialRangeWeights(Player player) const override;
     std::span<const HandInfo> getValidHands(Player player, CardSet board) const override;
     std::span<const RankedHand> getValidSortedHandRanks(Player player, CardSet board) const override;
@@ -7,56 +7,209 @@
 #include "util/fixed_vector.hpp"
 #include "util/stack_allocator.hpp"
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <span>
 
 struct DiscountParams {
     float alphaT;
     float betaT;
     float gammaT;
+
+    // Iteration and exponents the factors were computed for
+    // Decision nodes are only discounted when they are updated, so nodes that were skipped by pruning or chance sampling
+    // use them to catch up on the discounts of the iterations they missed
+    int iteration;
+    float alpha;
+    float beta;
+    float gamma;
 };
 
 DiscountParams getDiscountParams(float alpha, float beta, float gamma, int iteration);
 
+// Public chance sampling: each chance node only visits numSampledCards of its cards, chosen at random from the seed and the node,
+// and the reach probabilities of the visited cards are scaled up so that the expected values and the regret and strategy increments are unbiased
+// The discount is not sampled: the nodes after the cards that were not visited catch up on it when they are next updated
+// A numSampledCards of 0 visits every card
+struct ChanceSampling {
+    int numSampledCards;
+    std::uint64_t seed;
+};
+
+enum class TraversalMode : std::uint8_t {
+    VanillaCfr,
+    CfrPlus,
+    DiscountedCfr,
+    ExpectedValue,
+    BestResponse
+};
+
+// Traversal of some of the children of a chance node, which is how the subtrees after the first chance card
+// are handed to the machines that own them in a distributed solve (see solver/distributed.hpp)
+struct ChanceNodeTraversal {
+    TraversalMode mode;
+
+    Player hero;
+    DiscountParams params;
+    bool usePruning;
+
+    // Used by the chance nodes below the children
+    ChanceSampling sampling;
+
+    // Factor for the reach probabilities of each child, which is above 1 when only a sample of the children is traversed
+    float childWeight;
+
+    // Index of the chance node in Tree::allNodes
+    std::uint32_t nodeIndex;
+
+    // Bit i is set if the child at childrenOffset + i is traversed
+    std::uint64_t childMask;
+
+    // Reach probabilities of both players entering the chance node
+    // The hero's are only needed by training traversals and may be empty otherwise
+    PlayerArray<std::span<const float>> reachProbs = {};
+
+    // Expected values of each child, numChildren * rangeSize per player, before they are summed over the chance cards
+    // Only the hero's are written, unless this is a best response or Discounted CFR traversal and the villain's are given as well,
+    // in which case both players are traversed at once (see simultaneousDiscountedCfr) and the hero is ignored
+    // Children outside the mask are left unchanged
+    PlayerArray<std::span<float>> childExpectedValues = {};
+};
+
+bool isBothPlayersTraversal(const ChanceNodeTraversal& traversal);
+
+void traverseChanceNodeChildren(const ChanceNodeTraversal& traversal, const IGameRules& rules, Tree& tree, StackAllocator& allocator);
+
 void vanillaCfr(
     Player hero,
     const IGameRules& rules,
     Tree& tree,
-    StackAllocator<float>& allocator
+    StackAllocator& allocator
 );
 
 void cfrPlus(
     Player hero,
     const IGameRules& rules,
     Tree& tree,
-    StackAllocator<float>& allocator
+    StackAllocator& allocator
 );
 
+// With pruning, subtrees that cannot change the hero's expected values this iteration are skipped:
+// actions the hero never plays whose regrets are far below zero, and subtrees the villain never reaches
+// Subtrees the villain never reaches still get their strategy sums updated, but the regrets below pruned actions miss their updates,
+// so pruned iterations should be mixed with regular ones
 void discountedCfr(
     Player hero,
     const IGameRules& rules,
     const DiscountParams& params,
     Tree& tree,
-    StackAllocator<float>& allocator
+    StackAllocator& allocator,
+    bool usePruning = false
+);
+
+// Discounted CFR with public chance sampling, which makes each iteration much cheaper but noisier
+// Useful for the first iterations of a solve, which can then be refined with regular Discounted CFR iterations
+void sampledDiscountedCfr(
+    Player hero,
+    const IGameRules& rules,
+    const DiscountParams& params,
+    const ChanceSampling& sampling,
+    Tree& tree,
+    StackAllocator& allocator,
+    bool usePruning = false
+);
+
+// Discounted CFR iteration that updates both players in a single pass over the tree, instead of one pass per player
+// Both players' reach probabilities are carried down and both players' expected values are returned up,
+// and each decision node updates the regrets of the player to act using the other player's current strategy
+// Each iteration is one traversal instead of two, but alternating updates usually converge faster for the same number of traversals
+// A sampling with numSampledCards = 0 visits every chance card
+void simultaneousDiscountedCfr(
+    const IGameRules& rules,
+    const DiscountParams& params,
+    const ChanceSampling& sampling,
+    Tree& tree,
+    StackAllocator& allocator,
+    bool usePruning = false
+);
+
+// Discounted CFR on the subtree below a node, with the reach probabilities of both players entering it held fixed
+// The rest of the tree is not visited, so its regrets and average strategy are left as they are
+// Iterations are counted from 1 again, so the first iteration restarts the discounting of the hero's nodes in the subtree
+void discountedCfrSubtree(
+    Player hero,
+    const IGameRules& rules,
+    const DiscountParams& params,
+    std::size_t subtreeRootIndex,
+    const PlayerArray<std::span<const float>>& reachProbs,
+    Tree& tree,
+    StackAllocator& allocator,
+    bool usePruning = false
 );
 
 float expectedValue(
     Player hero,
     const IGameRules& rules,
     Tree& tree,
-    StackAllocator<float>& allocator
+    StackAllocator& allocator
 );
 
 float bestResponseEV(
     Player hero,
     const IGameRules& rules,
     Tree& tree,
-    StackAllocator<float>& allocator
+    StackAllocator& allocator
 );
 
-float calculateExploitability(const IGameRules& rules, Tree& tree, StackAllocator<float>& allocator);
+// Best response expected values of both players, computed in a single traversal of the tree
+PlayerArray<float> bestResponseEVs(const IGameRules& rules, Tree& tree, StackAllocator& allocator);
+
+float calculateExploitability(const IGameRules& rules, Tree& tree, StackAllocator& allocator);
+
+float calculateExploitabilityFast(const IGameRules& rules, Tree& tree, StackAllocator& allocator);
+
+// Exploitability of the subtree below a node against opponents that enter it with the given reach probabilities
+// Uses the same approximation as calculateExploitabilityFast, and is averaged over the pairs of hands that reach the node
+float calculateSubtreeExploitability(
+    const IGameRules& rules,
+    std::size_t subtreeRootIndex,
+    const PlayerArray<std::span<const float>>& reachProbs,
+    Tree& tree,
+    StackAllocator& allocator
+);
+
+// Conversions between the 16 bit training data of a decision node and floats, for trees that use training data compression
+void decodeRegretSums(std::span<float> outputRegretSums, const Node& decisionNode, const Tree& tree);
+void encodeRegretSums(std::span<const float> inputRegretSums, const Node& decisionNode, Tree& tree);
+void decodeStrategySums(std::span<float> outputStrategySums, const Node& decisionNode, const Tree& tree);
+void encodeStrategySums(std::span<const float> inputStrategySums, const Node& decisionNode, Tree& tree);
+
+// Average strategy and expected values of the player to act at a decision node, see visitDecisionNodeSolutions
+struct DecisionNodeSolution {
+    // Index in Tree::allNodes
+    std::size_t nodeIndex;
+    Player player;
+    int numActions;
+
+    // Hands of the player to act that are not blocked by the board
+    std::span<const HandInfo> hands;
+
+    // strategy[action * hands.size() + i] is the probability that hands[i] takes the action
+    std::span<const float> strategy;
+
+    // Expected value of hands[i] against the villain hands that reach the node and don't share a card with it,
+    // or NaN if there are no such hands
+    std::span<const float> expectedValues;
+};
+
+using DecisionNodeVisitor = std::function<void(const DecisionNodeSolution& solution)>;
 
-float calculateExploitabilityFast(const IGameRules& rules, Tree& tree, StackAllocator<float>& allocator);
+// Runs an expected value traversal for each player that hands every decision node where that player acts to the visitor
+// Nodes after suit isomorphic chance cards are only visited for the card that the tree stores, and nodes are visited in traversal order
+// The visitor is called from every traversal thread, so it must be thread safe
+void visitDecisionNodeSolutions(const IGameRules& rules, Tree& tree, StackAllocator& allocator, const DecisionNodeVisitor& visitor);
 
-FixedVector<float, MaxNumActions> getFinalStrategy(int hand, const Node& decisionNode, const Tree& tree);
+FixedVector<float, MaxNumActions> getFinalStrategy(const IGameRules& rules, int hand, const Node& decisionNode, const Tree& tree);
 
 #endif // CFR_HPP
\ No newline at end of file
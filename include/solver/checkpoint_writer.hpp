@@ -0,0 +1,39 @@
+#ifndef CHECKPOINT_WRITER_HPP
+#define CHECKPOINT_WRITER_HPP
+
+#include "game/game_rules.hpp"
+#include "solver/tree.hpp"
+
+#include <filesystem>
+
+// Writes training checkpoints while training continues
+// Each checkpoint is written by a forked child process, which sees a copy-on-write snapshot of the tree as it was when the checkpoint started
+// Training only pauses while the process is forked, and only the pages that training modifies during the write are duplicated
+// Training data in scratch files is shared with the child instead of copied, so those checkpoints are written before training continues
+class CheckpointWriter {
+public:
+    CheckpointWriter(const IGameRules& rules, const std::filesystem::path& path);
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    // Waits for the previous checkpoint to finish, then starts writing the current state of the tree
+    // Returns false if the previous checkpoint could not be written
+    bool writeAsync(const Tree& tree);
+
+    // Waits for the current checkpoint to finish, returns false if it could not be written
+    bool wait();
+
+    bool isWriting() const;
+
+private:
+    const IGameRules& m_rules;
+    std::filesystem::path m_path;
+
+    // Process writing the current checkpoint, or -1 if no checkpoint is being written
+    int m_writerProcess;
+    bool m_lastWriteSucceeded;
+};
+
+#endif // CHECKPOINT_WRITER_HPP
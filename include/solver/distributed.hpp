@@ -0,0 +1,92 @@
+#ifndef DISTRIBUTED_HPP
+#define DISTRIBUTED_HPP
+
+#include "game/game_rules.hpp"
+#include "solver/cfr.hpp"
+#include "solver/tree.hpp"
+#include "util/result.hpp"
+#include "util/tcp_socket.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+// A distributed solve splits the subtrees after the first chance card between worker processes, usually on other machines
+// Every worker builds the same tree from the same settings, but only allocates the training data of the subtrees it owns
+// The coordinator trains the nodes before the first chance card, and whenever a traversal reaches a chance node whose children
+// are subtrees, it sends the reach probabilities entering the chance node to the workers and receives the expected values of
+// the children each of them owns, so only per hand vectors are sent over the network
+// Workers must run on machines with the same byte order and float format as the coordinator
+
+// Subtrees are dealt out in turn, so the children of each chance node are spread evenly over the workers
+bool isSubtreeOwnedByWorker(std::size_t subtreeIndex, int workerIndex, int numWorkers);
+
+class DistributedCoordinator {
+public:
+    // Connects to the workers at the given host:port addresses and checks that each of them built the same tree
+    // Once every worker has allocated its subtrees, the coordinator allocates the training data before the first chance card
+    static Result<std::unique_ptr<DistributedCoordinator>> connect(
+        const std::vector<std::string>& addresses,
+        const IGameRules& rules,
+        Tree& tree,
+        int numThreads
+    );
+
+    // Ends the session of every worker, which then waits for the next coordinator
+    ~DistributedCoordinator();
+
+    DistributedCoordinator(const DistributedCoordinator&) = delete;
+    DistributedCoordinator& operator=(const DistributedCoordinator&) = delete;
+
+    // While the coordinator is active, every traversal of its tree hands the subtrees after the first chance card to the workers
+    // This includes expected value and best response traversals, so the exploitability is calculated the same way as for a local solve
+    // Each tree can only have one active coordinator
+    void start();
+    void stop();
+
+    // Fills in the expected values of the children in the mask, which are computed by the workers that own them
+    // Requests are sent one at a time, and every worker uses all of its threads on each one
+    // If a worker cannot be reached, the coordinator fails and every later traversal gets expected values of zero
+    void traverseChanceNode(const ChanceNodeTraversal& traversal);
+
+    // The error that made the coordinator fail, if any
+    std::optional<std::string> getError() const;
+
+    // Makes every worker process exit instead of waiting for the next coordinator
+    void shutdownWorkers();
+
+    int getNumWorkers() const;
+
+private:
+    struct Worker {
+        std::string address;
+        TcpConnection connection;
+    };
+
+    DistributedCoordinator(std::vector<Worker> workers, Tree& tree);
+
+    bool sendTraversal(Worker& worker, const ChanceNodeTraversal& traversal, bool hasHeroReachProbs);
+    bool receiveChildExpectedValues(Worker& worker, int workerIndex, const ChanceNodeTraversal& traversal);
+    void fail(const Worker& worker, const ChanceNodeTraversal& traversal);
+    void endSessions(bool shutdown);
+
+    std::vector<Worker> m_workers;
+    Tree& m_tree;
+    mutable std::mutex m_mutex;
+    std::optional<std::string> m_error;
+};
+
+enum class WorkerSessionEnd {
+    Finished,
+    Shutdown
+};
+
+// Serves one coordinator on an accepted connection until it finishes its solve or asks the worker to shut down
+// The tree must have the same skeleton as the coordinator's tree, and its training data is reinitialized for the subtrees the worker owns
+// Returns an error if the coordinator built a different tree or the connection was lost
+Result<WorkerSessionEnd> serveCoordinator(const IGameRules& rules, Tree& tree, int numThreads, TcpConnection& connection);
+
+#endif // DISTRIBUTED_HPP
@@ -0,0 +1,69 @@
+#ifndef NODE_PATH_HPP
+#define NODE_PATH_HPP
+
+#include "game/game_rules.hpp"
+#include "game/game_types.hpp"
+#include "solver/tree.hpp"
+#include "util/result.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// Node on the path from the root to the node being browsed
+// Suit isomorphic chance cards share the subtree of one card, and swapList holds the suits that were swapped to reach it, if any
+struct NodeInfo {
+    std::size_t index;
+    std::optional<SuitMapping> swapList;
+};
+
+// All functions below only read the tree, so any number of threads can browse the same tree at once
+
+std::vector<NodeInfo> getRootNodePath(const Tree& tree);
+
+// Child of the decision node at the end of the path for an action index
+Result<NodeInfo> getActionChild(const Tree& tree, const std::vector<NodeInfo>& nodePath, int action);
+
+// Child of the chance node at the end of the path for a card named in the suits of the starting board,
+// which is mapped through the suit swaps of earlier chance cards to the card the tree stores
+Result<NodeInfo> getDealtChild(const Tree& tree, const std::vector<NodeInfo>& nodePath, CardID card);
+
+// Follows a history of steps from the root, each of which is an action index at a decision node or a card name at a chance node
+Result<std::vector<NodeInfo>> resolveNodePath(const Tree& tree, std::span<const std::string> steps);
+
+// Starting board followed by the cards dealt along the path, in the suits of the starting board
+std::vector<CardID> getNodePathBoard(const IGameRules& rules, const Tree& tree, const std::vector<NodeInfo>& nodePath);
+
+std::string getActionName(const IGameRules& rules, const Tree& tree, std::size_t decisionNodeIndex, int action);
+
+// Index that each hand of the player's range has at the end of the path, where the suit swaps of isomorphic chance cards
+// have been applied to it, or -1 if the hand is blocked by the starting board or a dealt card
+std::vector<int> getNodePathHandIndices(const IGameRules& rules, const Tree& tree, const std::vector<NodeInfo>& nodePath, Player player);
+
+// Every hand of one player's range at the end of a path, indexed like IGameRules::getRangeHands
+struct NodePathRange {
+    // Same as getNodePathHandIndices
+    std::vector<int> handIndices;
+
+    // Initial weight of each hand times the probability that the player's average strategy takes the actions on the path, 0 if blocked
+    std::vector<float> reachWeights;
+};
+
+// Computes the whole range in one pass over the path, rather than following the path once per hand
+NodePathRange getNodePathRange(const IGameRules& rules, const Tree& tree, const std::vector<NodeInfo>& nodePath, Player player);
+
+// Average strategy of the whole range of the player to act at the decision node at the end of a path
+struct NodePathRangeStrategy {
+    Player player;
+    int numActions;
+    NodePathRange range;
+
+    // Laid out as strategy[action * rangeSize + hand], where hand indexes IGameRules::getRangeHands and blocked hands are 0
+    std::vector<float> strategy;
+};
+
+NodePathRangeStrategy getNodePathRangeStrategy(const IGameRules& rules, const Tree& tree, const std::vector<NodeInfo>& nodePath);
+
+#endif // NODE_PATH_HPP
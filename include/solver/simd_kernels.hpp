@@ -0,0 +1,60 @@
+#ifndef SIMD_KERNELS_HPP
+#define SIMD_KERNELS_HPP
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+// Elementwise kernels for the hottest loops in CFR traversal
+// All per hand spans passed to a kernel must have the same size
+// The best instruction set supported by the CPU is chosen at runtime, and every implementation produces bitwise identical results
+
+// Kernels over the actions of a decision node read and write numActions rows of values, where row a starts at a * actionStride
+// They are instantiated for every action count from 1 to MaxNumActions, so the loop over the actions is unrolled
+// and the sums over the actions of each hand stay in registers
+
+// Regret matching over numActions rows of regretSums.size() / numActions hands
+// strategy[a][i] = max(regretSums[a][i], 0) / total[i], or 1 / numActions if no action has positive regret
+// strategy may be the same buffer as regretSums
+void normalizeRegretSums(std::span<float> strategy, std::span<const float> regretSums, int numActions);
+
+// Average strategy over numActions rows of strategySums.size() / numActions hands
+// strategy[a][i] = strategySums[a][i] / total[i], or 1 / numActions if the total is zero
+// strategy may be the same buffer as strategySums
+void normalizeStrategySums(std::span<float> strategy, std::span<const float> strategySums, int numActions);
+
+// output[i] += values[i] * weights[i]
+void accumulateWeightedValues(std::span<float> output, std::span<const float> values, std::span<const float> weights);
+
+// output[i] += values[0][i] * weights[0][i] + ... + values[numActions - 1][i] * weights[numActions - 1][i], added in action order
+void accumulateActionWeightedValues(
+    std::span<float> output,
+    std::span<const float> values,
+    std::span<const float> weights,
+    int numActions,
+    std::size_t actionStride
+);
+
+// output[i] += values[0][i] + ... + values[numActions - 1][i], added in action order
+void accumulateActionValues(std::span<float> output, std::span<const float> values, int numActions, std::size_t actionStride);
+
+// For every action a, with one strategy expected value and reach probability per hand:
+// regretSums[a][i] = regretSums[a][i] * ((regretSums[a][i] > 0) ? alphaT : betaT) + (actionExpectedValues[a][i] - strategyExpectedValues[i])
+// strategySums[a][i] = strategySums[a][i] * gammaT + reachProbs[i] * currentStrategy[a][i]
+void updateDiscountedTrainingData(
+    std::span<float> regretSums,
+    std::span<float> strategySums,
+    std::span<const float> actionExpectedValues,
+    std::span<const float> strategyExpectedValues,
+    std::span<const float> reachProbs,
+    std::span<const float> currentStrategy,
+    float alphaT,
+    float betaT,
+    float gammaT,
+    int numActions,
+    std::size_t actionStride
+);
+
+std::string_view getSimdInstructionSetName();
+
+#endif // SIMD_KERNELS_HPP
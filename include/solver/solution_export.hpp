@@ -0,0 +1,72 @@
+#ifndef SOLUTION_EXPORT_HPP
+#define SOLUTION_EXPORT_HPP
+
+#include "game/game_rules.hpp"
+#include "solver/tree.hpp"
+#include "util/result.hpp"
+#include "util/stack_allocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// Columnar export of a whole solution, so that it can be analyzed outside the solver
+//
+// The file starts with a header:
+//     u32 magic "PSEX", u32 version, u32 MaxNumActions
+// followed by any number of chunks, each holding a batch of rows of one table:
+//     u32 table, u64 number of rows, u32 number of columns, then each column:
+//         u64 name length, name characters, u8 column type, then the column data
+// and ends with a u32 table id of SolutionExportTable::End
+//
+// Fixed size columns are a u64 count followed by the values, padded so that they start on a 64 byte boundary
+// String columns are an offsets array of count + 1 u32 values followed by a character array, both laid out the same way,
+// where string i is the characters from offsets[i] to offsets[i + 1]
+// All values are in native byte order
+//
+// The nodes table has one row per decision node, in tree order, which is breadth first from the root:
+//     node_index (u32), parent_index (u32, the previous decision node, or UINT32_MAX at the root),
+//     player (u8), street (u8), num_actions (u8), pot (i32), board (string), history (string), actions (string)
+// The history is the actions and dealt cards from the root separated by commas, and actions lists the node's action names the same way
+// Nodes after suit isomorphic chance cards only exist for the card that the tree stores
+//
+// The hands table has one row per decision node and hand of the player to act that is not blocked by the board:
+//     node_index (u32), hand (string), ev (f32), strategy_0 to strategy_{MaxNumActions - 1} (f32)
+// Rows are grouped by node but written in the order that the traversal threads finish them, so they are joined to nodes by node_index
+// The expected value is in chips won or lost over the whole hand, against the villain range that reaches the node,
+// and is NaN if no villain hand reaches it. Strategy columns past the node's number of actions are NaN
+
+enum class SolutionExportTable : std::uint32_t {
+    Nodes = 0,
+    Hands = 1,
+    End = 0xFFFFFFFF
+};
+
+enum class SolutionExportColumnType : std::uint8_t {
+    UInt8,
+    UInt32,
+    Int32,
+    Float32,
+    String
+};
+
+struct SolutionExportSummary {
+    std::size_t numDecisionNodes;
+    std::size_t numHandRows;
+    std::size_t numChunks;
+};
+
+static constexpr std::size_t DefaultExportRowsPerChunk = 65536;
+
+// Streams the solution to the file while an expected value traversal computes it, so the whole export is never held in memory at once
+// Each traversal thread buffers up to about rowsPerChunk hand rows before writing them as a chunk
+// Must be called from a single thread inside an OpenMP parallel region to use all threads of the allocator
+Result<SolutionExportSummary> exportSolution(
+    const IGameRules& rules,
+    Tree& tree,
+    const std::filesystem::path& path,
+    StackAllocator& allocator,
+    std::size_t rowsPerChunk = DefaultExportRowsPerChunk
+);
+
+#endif // SOLUTION_EXPORT_HPP
@@ -0,0 +1,149 @@
+#ifndef SOLVER_SESSION_HPP
+#define SOLVER_SESSION_HPP
+
+#include "game/game_rules.hpp"
+#include "game/holdem/holdem.hpp"
+#include "solver/tree.hpp"
+#include "util/result.hpp"
+#include "util/stack_allocator.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Solver options for programs that embed the solver, with the same defaults as the solver section of a settings file
+// Every count must be at least 1, except chanceSamplingIterations which can be 0
+struct SolveSettings {
+    float targetPercentExploitability = 0.3f;
+    int maxIterations = 1000;
+    int exploitabilityCheckFrequency = 10;
+    int numThreads = 1;
+    bool useTrainingDataCompression = false;
+
+    // When pruning is enabled, every iteration except each pruningRevisitFrequency-th one uses regret based pruning
+    bool usePruning = false;
+    int pruningRevisitFrequency = 10;
+
+    // Update both players in one traversal per iteration instead of one traversal per player
+    bool useSimultaneousUpdates = false;
+
+    // The first chanceSamplingIterations iterations only visit chanceSamplingCards cards at each chance node, the rest visit every card
+    int chanceSamplingIterations = 0;
+    int chanceSamplingCards = 8;
+};
+
+struct SolveProgress {
+    int iteration;
+
+    // Only calculated every exploitabilityCheckFrequency iterations
+    std::optional<float> exploitability;
+    std::optional<float> exploitabilityPercent;
+};
+
+enum class SolveStatus {
+    TargetReached,
+    MaxIterationsReached,
+    Cancelled,
+
+    // A distributed worker was lost during the last iteration, which is not counted (see DistributedCoordinator)
+    WorkerLost
+};
+
+struct SolveResult {
+    SolveStatus status;
+    int numIterations;
+
+    // Only calculated when the target or maxIterations is reached
+    std::optional<float> exploitability;
+    std::optional<float> exploitabilityPercent;
+};
+
+// Called on the solving thread after every iteration, so it should return quickly
+using SolveProgressCallback = std::function<void(const SolveProgress&)>;
+
+// Called after every iteration like SolveProgressCallback, returning false stops the solve with SolveStatus::Cancelled
+using SolveIterationCallback = std::function<bool(const SolveProgress&)>;
+
+// Returns an error if a setting is out of range
+std::optional<std::string> getSolveSettingsError(const SolveSettings& settings);
+
+// Trains an initialized tree with Discounted CFR from its last completed iteration until the target exploitability or maxIterations is reached
+// This is the training loop of SolverSession, the solve command and the batch solver, and settings.numThreads is not used by it
+// Must be called by one thread of a parallel region with the allocator's threads, so that the traversals can spawn tasks for the others
+SolveResult trainDiscountedCfr(
+    const IGameRules& rules,
+    const SolveSettings& settings,
+    Tree& tree,
+    StackAllocator& allocator,
+    const SolveIterationCallback& onIteration = {}
+);
+
+// Owns the rules, tree and allocator of one spot, so that a program can solve it and read its strategies without going through the CLI
+// Solving runs on a thread owned by the session, and the tree must not be read until the solve has finished
+class SolverSession {
+public:
+    // Returns an error if a setting is out of range, see getSolveSettingsError
+    static Result<std::unique_ptr<SolverSession>> create(std::unique_ptr<IGameRules> rules, const SolveSettings& settings);
+
+    // Builds the Hold'em hand tables, which takes a while for large ranges unless they are found in the hand table cache
+    static Result<std::unique_ptr<SolverSession>> createHoldem(const Holdem::Settings& gameSettings, const SolveSettings& settings);
+
+    // Cancels a running solve and waits for it to stop
+    ~SolverSession();
+
+    SolverSession(const SolverSession&) = delete;
+    SolverSession& operator=(const SolverSession&) = delete;
+
+    // Builds the tree on the first call, then trains it from its last completed iteration until the target exploitability or
+    // maxIterations is reached, so calling it again after raising maxIterations continues the solve
+    // Must not be called while another solve of the session is running
+    // Exceptions thrown by the solve, such as std::bad_alloc when the training data does not fit in memory, are rethrown by the future
+    std::future<SolveResult> solveAsync(SolveProgressCallback onProgress = {});
+    SolveResult solve(const SolveProgressCallback& onProgress = {});
+
+    // Asks a running solve to stop after its current iteration, the solve then finishes with SolveStatus::Cancelled
+    void cancel();
+    bool isSolving() const;
+
+    const IGameRules& getRules() const;
+    const SolveSettings& getSettings() const;
+
+    // Only valid while no solve is running. Nodes are indexed the same way as Tree::allNodes
+    const Tree& getTree() const;
+
+    // Average strategy of a decision node, with the probability of action a for hand h of the player to act at index a * rangeSize + h,
+    // where h indexes IGameRules::getRangeHands and hands blocked by the board play a uniform strategy
+    // Suit isomorphic chance cards share one subtree, so hands below a swapped card must be mapped with Tree::isomorphicHandIndices
+    // The strategy is normalized on the first request and kept until the next solve starts, so the span stays valid until then
+    // Returns an empty span while a solve is running or if the node is not a decision node
+    std::span<const float> getStrategy(std::size_t nodeIndex);
+
+private:
+    SolverSession(std::unique_ptr<IGameRules> rules, const SolveSettings& settings);
+
+    SolveResult runSolve(const SolveProgressCallback& onProgress);
+    void waitForSolveThread();
+
+    std::unique_ptr<IGameRules> m_rules;
+    SolveSettings m_settings;
+    Tree m_tree;
+    std::unique_ptr<StackAllocator> m_allocator;
+
+    std::thread m_solveThread;
+    std::atomic<bool> m_isSolving;
+    std::atomic<bool> m_isCancelRequested;
+
+    std::mutex m_strategyMutex;
+    std::unordered_map<std::size_t, std::vector<float>> m_strategies;
+};
+
+#endif // SOLVER_SESSION_HPP
@@ -0,0 +1,188 @@
+#ifndef TRAVERSAL_PROFILER_HPP
+#define TRAVERSAL_PROFILER_HPP
+
+#include "game/game_types.hpp"
+#include "util/stack_allocator.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#ifdef POSTFLOP_PROFILING
+#include <algorithm>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+// Traversal counters are only collected when the solver is built with POSTFLOP_PROFILING
+// Otherwise the profiling scopes below are empty and compile to nothing
+#ifdef POSTFLOP_PROFILING
+constexpr bool IsProfilingEnabled = true;
+#else
+constexpr bool IsProfilingEnabled = false;
+#endif
+
+constexpr int NumNodeTypes = static_cast<int>(NodeType::AllInRunout) + 1;
+
+// Counters for the traversals run by one thread while a profiler is active
+// Padded to a cache line so that threads do not write to the same line
+struct alignas(StackAllocator::Alignment) ThreadProfile {
+    // Cycles are counted for each node alone, not including its children, the taskwaits in it, or the tasks run during them
+    std::array<std::uint64_t, NumNodeTypes> numNodes;
+    std::array<std::uint64_t, NumNodeTypes> nodeCycles;
+
+    // Cycles at a taskwait that were not spent running other tasks
+    std::uint64_t numTaskwaits;
+    std::uint64_t taskwaitIdleCycles;
+
+    std::uint64_t numTasksSpawned;
+    std::uint64_t numTasksRun;
+
+    // Cycles of the scopes nested in the current scope, so that the current scope can leave them out
+    std::uint64_t nestedCycles;
+};
+
+// Collects per thread counters from every traversal run between start() and stop()
+// Only one profiler can be active at a time
+class TraversalProfiler {
+public:
+    explicit TraversalProfiler(int numThreads);
+    ~TraversalProfiler();
+
+    TraversalProfiler(const TraversalProfiler&) = delete;
+    TraversalProfiler& operator=(const TraversalProfiler&) = delete;
+
+    void start();
+    void stop();
+
+    const std::vector<ThreadProfile>& getThreadProfiles() const;
+
+    // Writes the counters of each thread, along with the stack allocator usage of each thread, as a JSON object
+    bool writeJsonReport(const std::filesystem::path& path, const StackAllocator& allocator) const;
+
+private:
+    #ifdef POSTFLOP_PROFILING
+    friend ThreadProfile* getActiveThreadProfile();
+    #endif
+
+    std::vector<ThreadProfile> m_threadProfiles;
+    std::chrono::steady_clock::time_point m_startTime;
+    std::chrono::steady_clock::duration m_wallTime;
+    std::uint64_t m_startCycles;
+    std::uint64_t m_wallCycles;
+};
+
+#ifdef POSTFLOP_PROFILING
+// Profile of the calling thread in the active profiler, or nullptr if no profiler is active
+ThreadProfile* getActiveThreadProfile();
+
+inline std::uint64_t readCycleCounter() {
+    #if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+    #else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    #endif
+}
+
+// Base for the scopes below, which measure their own cycles and hide them from the enclosing scope
+class CycleScope {
+protected:
+    CycleScope() : m_profile{ getActiveThreadProfile() } {
+        if (m_profile) {
+            m_savedNestedCycles = m_profile->nestedCycles;
+            m_profile->nestedCycles = 0;
+            m_startCycles = readCycleCounter();
+        }
+    }
+
+    // Returns the cycles spent in this scope but not in the scopes nested in it
+    std::uint64_t finish() {
+        std::uint64_t elapsedCycles = readCycleCounter() - m_startCycles;
+        std::uint64_t ownCycles = elapsedCycles - std::min(m_profile->nestedCycles, elapsedCycles);
+        m_profile->nestedCycles = m_savedNestedCycles + elapsedCycles;
+        return ownCycles;
+    }
+
+    ThreadProfile* m_profile;
+
+private:
+    std::uint64_t m_savedNestedCycles = 0;
+    std::uint64_t m_startCycles = 0;
+};
+
+// Counts a node and the cycles spent in it
+class NodeProfileScope : private CycleScope {
+public:
+    explicit NodeProfileScope(NodeType nodeType) : m_nodeType{ nodeType } {}
+
+    ~NodeProfileScope() {
+        if (m_profile) {
+            int nodeTypeIndex = static_cast<int>(m_nodeType);
+            ++m_profile->numNodes[nodeTypeIndex];
+            m_profile->nodeCycles[nodeTypeIndex] += finish();
+        }
+    }
+
+private:
+    NodeType m_nodeType;
+};
+
+// Counts a task run by this thread, the cycles spent in it outside of nodes belong to the node that spawned it
+class TaskProfileScope : private CycleScope {
+public:
+    explicit TaskProfileScope(NodeType spawningNodeType) : m_spawningNodeType{ spawningNodeType } {}
+
+    ~TaskProfileScope() {
+        if (m_profile) {
+            ++m_profile->numTasksRun;
+            m_profile->nodeCycles[static_cast<int>(m_spawningNodeType)] += finish();
+        }
+    }
+
+private:
+    NodeType m_spawningNodeType;
+};
+
+// Counts a taskwait and the cycles it spent waiting instead of running other tasks
+class TaskwaitProfileScope : private CycleScope {
+public:
+    TaskwaitProfileScope() {}
+
+    ~TaskwaitProfileScope() {
+        if (m_profile) {
+            ++m_profile->numTaskwaits;
+            m_profile->taskwaitIdleCycles += finish();
+        }
+    }
+};
+
+inline void profileTaskSpawned() {
+    if (ThreadProfile* profile = getActiveThreadProfile()) {
+        ++profile->numTasksSpawned;
+    }
+}
+#else
+class NodeProfileScope {
+public:
+    explicit NodeProfileScope(NodeType) {}
+};
+
+class TaskProfileScope {
+public:
+    explicit TaskProfileScope(NodeType) {}
+};
+
+class TaskwaitProfileScope {
+public:
+    TaskwaitProfileScope() {}
+};
+
+inline void profileTaskSpawned() {}
+#endif
+
+#endif // TRAVERSAL_PROFILER_HPP
@@ -4,45 +4,193 @@
 #include "game/game_types.hpp"
 #include "game/game_rules.hpp"
 #include "util/fixed_vector.hpp"
+#include "util/mapped_file.hpp"
+#include "util/result.hpp"
+#include "util/large_array_allocator.hpp"
 
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <span>
 #include <vector>
 
+class DistributedCoordinator;
+
+// Compact node used by the training and best response traversals
+// Everything the traversal does not read is kept in the NodeDetails and ChanceNodeDetails side tables
 struct Node {
     // Used by all nodes
-    GameState state;
+    CardSet board;
+
+    // Used by decision nodes only
+    std::size_t trainingDataOffset;
 
     // Used by chance nodes and decision nodes
     std::uint32_t childrenOffset;
+
+    // Used by decision nodes only
+    std::uint32_t decisionNodeIndex;
+
+    // Used by chance nodes only
+    std::uint32_t chanceNodeIndex;
+
+    // Used by all nodes
+    // Estimated cost of traversing the subtree rooted at this node, used to decide which subtrees get their own parallel task
+    float subtreeWork;
+
+    // Used by fold and showdown nodes only
+    // Amount wagered by the losing player (the folding player, or either player at a showdown)
+    std::int32_t losingPlayerWager;
+
+    // Used by chance nodes and decision nodes
     std::uint8_t numChildren;
 
     // Used by all nodes
     NodeType nodeType;
+    Player playerToAct;
+    CardID lastDealtCard;
+};
 
-    // Used by decision nodes only
-    std::size_t trainingDataOffset;
+// Rest of the game state of a node, only needed to display the tree
+// Indexed the same way as Tree::allNodes
+struct NodeDetails {
+    PlayerArray<int> totalWagers;
+    int previousStreetsWager;
+    ActionID lastAction;
+    Street currentStreet;
+};
 
-    // Used by chance nodes only
+// Indexed by Node::chanceNodeIndex
+struct ChanceNodeDetails {
     CardSet availableCards;
     FixedVector<SuitMapping, 3> suitMappings;
 };
 
+// Sizes of a tree counted from the game rules without building it
+// Each count is split by the street of the node
+struct TreeSizeCounts {
+    StreetArray<std::size_t> numNodes;
+    StreetArray<std::size_t> numDecisionNodes;
+    StreetArray<std::size_t> numChanceNodes;
+    StreetArray<std::size_t> trainingDataSize;
+
+    // Boards with an all in runout node, sorted and without duplicates, each of which gets an AllInRunoutTable
+    std::vector<CardSet> allInRunoutBoards;
+};
+
+// Showdown outcomes of every pair of hands over the runouts of a board with an all in runout node
+// outcomes[hand0 * rangeSize[P1] + hand1] is twice the number of runouts player 0 wins plus the number of runouts that tie,
+// or 0 if the hands overlap each other or the board
+// The outcomes don't depend on the strategy, so they are built the first time a traversal reaches the board and reused after that
+struct AllInRunoutTable {
+    CardSet board;
+    std::vector<std::uint16_t> outcomes;
+    std::once_flag buildFlag;
+};
+
+// Wall time of each stage of Tree::buildTreeSkeleton in seconds
+// The hand index tables and the range weight are built while the nodes are built, so the stages overlap
+struct TreeSetupTimings {
+    double nodesSeconds = 0.0;
+    double handIndexTablesSeconds = 0.0;
+    double rangeWeightSeconds = 0.0;
+    double totalSeconds = 0.0;
+};
+
+// Total weight of the pairs of hands that don't overlap each other or the board, with weights[player][hand] as the weight of each hand
+// Tree::totalRangeWeight uses the initial range weights on the starting board, and subtree solves use the reach probabilities of their root
+double getNonOverlappingPairWeight(const IGameRules& rules, CardSet board, const PlayerArray<std::span<const float>>& weights);
+
+// Training data can be stored in scratch files or huge pages, see Tree::setTrainingDataDirectory and Tree::setTrainingDataHugePages
+// Growing these vectors without a value leaves the new elements uninitialized, see LargeArrayAllocator
+template <typename T>
+using TrainingDataVector = std::vector<T, LargeArrayAllocator<T>>;
+
 class Tree {
 public:
-    Tree();
+    explicit Tree(bool useTrainingDataCompression = false);
 
     bool isTreeSkeletonBuilt() const;
     bool areCfrVectorsInitialized() const;
-    void buildTreeSkeleton(const IGameRules& rules);
+    bool isTrainingDataCompressed() const;
+
+    // The subtrees after the first chance card are built in parallel and then stitched together
+    // The layout of the tree is the same for any number of threads
+    void buildTreeSkeleton(const IGameRules& rules, int numThreads = 1);
+    const TreeSetupTimings& getSetupTimings() const;
     std::size_t getNumberOfDecisionNodes() const;
     std::size_t getTreeSkeletonSize() const;
-    std::size_t estimateFullTreeSize() const;
-    void initCfrVectors();
+
+    // Counts the nodes and training data of the tree for the given rules without allocating any nodes
+    static TreeSizeCounts countTreeSize(const IGameRules& rules, int numThreads = 1);
+
+    // Memory estimates from counted sizes, equal to the sizes of the tree once it is built
+    std::size_t estimateTreeSkeletonSize(const IGameRules& rules, const TreeSizeCounts& counts) const;
+    std::size_t estimateFullTreeSize(const IGameRules& rules, const TreeSizeCounts& counts) const;
+
+    // Estimated stack allocator size needed by each thread during a traversal, used as the initial size of each thread's stack
+    std::size_t estimateStackAllocatorSize() const;
+    // The training data is zeroed in parallel, one subtree after the first chance card at a time, so that on NUMA systems
+    // its pages are spread over the memory of every socket instead of all being placed next to one thread
+    void initCfrVectors(int numThreads = 1);
     std::size_t getRootNodeIndex() const;
 
+    // The subtrees after the first chance card are numbered in order of their root node index
+    std::size_t getNumberOfSubtrees() const;
+    std::optional<std::size_t> getSubtreeIndex(std::size_t nodeIndex) const;
+
+    // Only zeroes the training data before the first chance card and of the subtrees for which isSubtreeOwned(subtreeIndex) is true,
+    // for distributed solves where the other subtrees are trained on other machines (see solver/distributed.hpp)
+    // The training data of the other subtrees is allocated but never touched, so its pages are not backed by memory, and it must not be read
+    void initCfrVectors(int numThreads, const std::function<bool(std::size_t)>& isSubtreeOwned);
+    bool isTrainingDataPartial() const;
+
+    // While a coordinator is attached, every traversal of this tree hands the subtrees after the first chance card to its workers
+    // Set by DistributedCoordinator::start and cleared by DistributedCoordinator::stop
+    void setDistributedCoordinator(DistributedCoordinator* coordinator);
+    DistributedCoordinator* getDistributedCoordinator() const;
+
+    // Stores the regret and strategy sums in memory mapped scratch files in the directory, so that trees larger than RAM can be trained
+    // Discards the current training data, so it must be called before initCfrVectors. Returns false if scratch files cannot be created in the directory
+    bool setTrainingDataDirectory(const std::filesystem::path& directory);
+    bool isTrainingDataFileBacked() const;
+
+    // Backs the regret and strategy sums with transparent huge pages to reduce TLB misses, unless they are stored in scratch files
+    // Discards the current training data, so it must be called before initCfrVectors
+    void setTrainingDataHugePages(bool useHugePages);
+
+    // Only the subtrees after the first chance card have contiguous training data, so other nodes are ignored
+    // Prefetching starts reading the training data of a subtree from its scratch files ahead of the traversal that needs it
+    // Releasing lets it be written back and evicted once a traversal is done with it, but only when physical memory is low, since evicted pages have to be read back from disk
+    // Both do nothing unless the training data is file backed
+    void prefetchSubtreeTrainingData(std::size_t nodeIndex) const;
+    void releaseSubtreeTrainingData(std::size_t nodeIndex) const;
+
+    // Outcome table of the board of an all in runout node, built on first use
+    // Safe to call from several threads at once
+    const AllInRunoutTable& getAllInRunoutTable(const IGameRules& rules, CardSet board);
+
+    // Reassembles the full game state of a node from the node and its side table entry
+    GameState getNodeState(std::size_t nodeIndex) const;
+
+    // Read-only views of the average strategy data, which may come from the owned vectors or a memory mapped file
+    bool isTrainingDataMemoryMapped() const;
+    std::span<const float> getStrategySums() const;
+    std::span<const std::uint16_t> getCompressedStrategySums() const;
+    std::span<const float> getStrategySumScales() const;
+
+    // Writes the tree skeleton, the hand index tables, and the training data to a versioned binary file
+    bool saveToFile(const IGameRules& rules, const std::filesystem::path& path) const;
+
+    // Loads a tree written by saveToFile, checking that it was solved with the same ranges and board as the given rules
+    // When memory mapping is used, the average strategy is read lazily from the file and the tree can only be browsed, not trained
+    static Result<std::unique_ptr<Tree>> loadFromFile(const IGameRules& rules, const std::filesystem::path& path, bool useMemoryMapping);
+
     // Game data
     int gameHandSize;
     PlayerArray<int> rangeSize;
@@ -54,14 +202,60 @@ public:
 
     // Node data
     std::vector<Node> allNodes;
-    std::vector<float> allStrategySums;
-    std::vector<float> allRegretSums;
+    std::vector<NodeDetails> allNodeDetails;
+    std::vector<ChanceNodeDetails> allChanceNodeDetails;
+    TrainingDataVector<float> allStrategySums;
+    TrainingDataVector<float> allRegretSums;
+
+    // Compressed node data, used instead of allStrategySums and allRegretSums when training data compression is enabled
+    // Values are stored as 16 bit integers, with one scale factor per decision node (indexed by decisionNodeIndex)
+    TrainingDataVector<std::uint16_t> allCompressedStrategySums;
+    TrainingDataVector<std::int16_t> allCompressedRegretSums;
+    std::vector<float> allStrategySumScales;
+    std::vector<float> allRegretSumScales;
+
+    // Last Discounted CFR iteration whose discount has been applied to each decision node's training data (indexed by decisionNodeIndex)
+    // Nodes skipped by an iteration are discounted lazily when they are next updated, see DiscountParams
+    std::vector<std::int32_t> allLastDiscountedIterations;
+
+    // Number of training iterations that have been run on the training data, used to resume training
+    int numCompletedIterations;
 
 private:
-    void buildAllNodes(const IGameRules& rules);
+    // Training data of a subtree after the first chance card, which is laid out after the training data of the previous subtree
+    struct SubtreeTrainingDataBlock {
+        std::size_t nodeIndex;
+        std::size_t trainingDataOffset;
+        std::size_t trainingDataSize;
+    };
+
+    void buildAllNodes(const IGameRules& rules, int numThreads);
+    void initAllInRunoutTables();
+    void hintSubtreeTrainingData(std::size_t subtreeIndex, void (*hint)(const void*, std::size_t)) const;
+    void resetTrainingDataAllocators();
+    void resizeTrainingData();
+    void zeroTrainingData(int numThreads, const std::function<bool(std::size_t)>& isSubtreeOwned);
+    std::size_t getTrainingDataHeapSize(std::size_t trainingDataSize, std::size_t numDecisionNodes) const;
 
     std::size_t m_trainingDataSize;
     std::size_t m_numDecisionNodes;
+    bool m_useTrainingDataCompression;
+    bool m_isTrainingDataPartial;
+    DistributedCoordinator* m_distributedCoordinator;
+    TreeSetupTimings m_setupTimings;
+
+    // Sorted by nodeIndex
+    std::vector<SubtreeTrainingDataBlock> m_subtreeTrainingDataBlocks;
+
+    // Sorted by board, one for each board with an all in runout node
+    std::vector<std::unique_ptr<AllInRunoutTable>> m_allInRunoutTables;
+    LargeArrayOptions m_trainingDataOptions;
+
+    // Used instead of the training data vectors when the tree is loaded from a memory mapped file
+    std::shared_ptr<const MappedFile> m_mappedFile;
+    std::span<const float> m_mappedStrategySums;
+    std::span<const std::uint16_t> m_mappedCompressedStrategySums;
+    std::span<const float> m_mappedStrategySumScales;
 };
 
 #endif // TREE_HPP
\ No newline at end of file
@@ -0,0 +1,17 @@
+#ifndef WARM_START_HPP
+#define WARM_START_HPP
+
+#include "game/game_rules.hpp"
+#include "solver/tree.hpp"
+
+#include <cstddef>
+
+// Seeds the regrets and strategy sums of a tree from a solved tree of the same board and ranges, such as a solve with different bet or raise sizes
+// Decision nodes are matched by their action history. An action without an exact match takes the training data of the source action
+// of the same kind (fold, check or call, bet or raise) with the closest resulting wager, and the subtrees below them are matched the same way
+// Target actions that take the same source action split its training data evenly
+// The target tree continues the iteration count of the source tree, so that Discounted CFR weighs the seeded training data as that many iterations of history
+// Returns the number of decision nodes of the target tree that were seeded
+std::size_t warmStartTree(const IGameRules& rules, const Tree& sourceTree, Tree& targetTree);
+
+#endif // WARM_START_HPP
@@ -0,0 +1,141 @@
+#ifndef BINARY_IO_HPP
+#define BINARY_IO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Writes trivially copyable values to a temporary file in native byte order
+// The temporary file only replaces the destination when commit() succeeds, so readers never see a partially written file
+class BinaryWriter {
+public:
+    explicit BinaryWriter(const std::filesystem::path& path);
+    ~BinaryWriter();
+
+    BinaryWriter(const BinaryWriter&) = delete;
+    BinaryWriter& operator=(const BinaryWriter&) = delete;
+
+    bool isGood() const;
+    bool commit();
+
+    void writeBytes(std::span<const std::byte> bytes);
+
+    // Writes zeros until the file position is a multiple of alignment
+    void writePadding(std::size_t alignment);
+
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        writeBytes(std::as_bytes(std::span<const T, 1>{ &value, 1 }));
+    }
+
+    // Writes the number of elements followed by the elements themselves
+    template <typename T>
+    void writeArray(std::span<const T> values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write<std::uint64_t>(values.size());
+        writeBytes(std::as_bytes(values));
+    }
+
+    // Same as writeArray, but the elements start at an aligned file position so that they can be used directly from a mapped file
+    template <typename T>
+    void writeAlignedArray(std::span<const T> values, std::size_t alignment) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write<std::uint64_t>(values.size());
+        writePadding(alignment);
+        writeBytes(std::as_bytes(values));
+    }
+
+private:
+    std::filesystem::path m_path;
+    std::filesystem::path m_temporaryPath;
+    std::ofstream m_file;
+    std::uint64_t m_position;
+    bool m_committed;
+};
+
+// Reads values written by BinaryWriter from an in-memory buffer, usually a MappedFile
+// All reads fail instead of reading past the end of the buffer
+class BinaryReader {
+public:
+    explicit BinaryReader(std::span<const std::byte> bytes);
+
+    bool readBytes(std::span<std::byte> bytes);
+    bool skipPadding(std::size_t alignment);
+    bool isAtEnd() const;
+
+    template <typename T>
+    bool read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return readBytes(std::as_writable_bytes(std::span<T, 1>{ &value, 1 }));
+    }
+
+    // Reads an array written by BinaryWriter::writeArray, failing if it has more than maxSize elements
+    template <typename T>
+    bool readArray(std::vector<T>& values, std::size_t maxSize) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        std::uint64_t size;
+        if (!read(size) || size > maxSize) return false;
+        values.resize(size);
+        return readBytes(std::as_writable_bytes(std::span<T>{ values }));
+    }
+
+    // Reads an array written by BinaryWriter::writeAlignedArray without copying it
+    // The returned span points into the underlying buffer
+    template <typename T>
+    bool readAlignedArrayView(std::span<const T>& values, std::size_t alignment, std::size_t maxSize) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        std::uint64_t size;
+        if (!read(size) || size > maxSize || !skipPadding(alignment)) return false;
+
+        std::span<const std::byte> bytes = takeBytes(size * sizeof(T));
+        if (bytes.size() != size * sizeof(T)) return false;
+        if (reinterpret_cast<std::uintptr_t>(bytes.data()) % alignof(T) != 0) return false;
+
+        values = { reinterpret_cast<const T*>(bytes.data()), static_cast<std::size_t>(size) };
+        return true;
+    }
+
+    // Reads a value and checks that it matches the expected value
+    template <typename T>
+    bool expect(const T& expectedValue) {
+        T value;
+        return read(value) && (value == expectedValue);
+    }
+
+private:
+    std::span<const std::byte> takeBytes(std::size_t numBytes);
+
+    std::span<const std::byte> m_bytes;
+    std::size_t m_position;
+};
+
+// 64 bit FNV-1a hash, used to build cache keys
+class Fnv1aHasher {
+public:
+    void addBytes(std::span<const std::byte> bytes);
+
+    template <typename T>
+    void add(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        addBytes(std::as_bytes(std::span<const T, 1>{ &value, 1 }));
+    }
+
+    template <typename T>
+    void addArray(std::span<const T> values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        add<std::uint64_t>(values.size());
+        addBytes(std::as_bytes(values));
+    }
+
+    std::uint64_t getHash() const;
+
+private:
+    std::uint64_t m_hash = 0xcbf29ce484222325ULL;
+};
+
+#endif // BINARY_IO_HPP
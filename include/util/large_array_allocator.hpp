@@ -0,0 +1,133 @@
+#ifndef LARGE_ARRAY_ALLOCATOR_HPP
+#define LARGE_ARRAY_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Maps a new zero filled file of the given size in the directory for reading and writing, or returns nullptr on failure
+// The file is deleted right away, so it disappears when the mapping is closed even if the process does not exit cleanly
+// On POSIX systems the pages are written back to the file by the operating system, so the mapping can be larger than RAM
+// On other platforms the memory is allocated on the heap instead
+void* mapScratchFile(const std::filesystem::path& directory, std::size_t size);
+void unmapScratchFile(void* data, std::size_t size);
+
+// Checks that scratch files can be created in the directory
+bool canMapScratchFiles(const std::filesystem::path& directory);
+
+// Hints for part of a scratch file mapping, rounded out to whole pages, neither of them waits for the disk
+// Prefetching starts reading the pages, and releasing starts writing back their changes so that their memory can be reused
+void prefetchScratchPages(const void* data, std::size_t size);
+void releaseScratchPages(const void* data, std::size_t size);
+
+// True when less than a sixteenth of the physical memory is free, always false on platforms where it cannot be checked
+// Pages of scratch files count as used memory until they are released or evicted
+bool isPhysicalMemoryLow();
+
+// Heap memory aligned to huge pages, which Linux is asked to back with transparent huge pages
+// The pages are only assigned when they are first touched, so the memory should be written first by the threads that will use it
+// Returns nullptr on failure
+void* allocateHugePageMemory(std::size_t size);
+void freeHugePageMemory(void* data, std::size_t size);
+
+struct LargeArrayOptions {
+    // Every allocation gets its own memory mapped scratch file in this directory, empty to allocate on the heap
+    std::filesystem::path scratchDirectory;
+
+    // Heap allocations use huge pages to reduce TLB misses, scratch files always use regular pages
+    bool useHugePages = false;
+};
+
+// Allocator for arrays that are too large to place well with the default heap, such as the training data of a tree
+// Elements are not zeroed when a container grows without a value, so that the owner can first touch the memory from the threads that use it
+template <typename T>
+class LargeArrayAllocator {
+public:
+    using value_type = T;
+
+    // Containers take the allocator of the container they are assigned from, so that assigning a new container moves its storage
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    LargeArrayAllocator() noexcept = default;
+
+    explicit LargeArrayAllocator(const LargeArrayOptions& options) :
+        m_options{ std::make_shared<const LargeArrayOptions>(options) } {
+    }
+
+    template <typename U>
+    LargeArrayAllocator(const LargeArrayAllocator<U>& other) noexcept :
+        m_options{ other.getOptions() } {
+    }
+
+    T* allocate(std::size_t size) {
+        static_assert(alignof(T) <= alignof(std::max_align_t));
+
+        if (isFileBacked() && (size > 0)) {
+            return checkAllocation(mapScratchFile(m_options->scratchDirectory, size * sizeof(T)));
+        }
+        else if (usesHugePages() && (size > 0)) {
+            return checkAllocation(allocateHugePageMemory(size * sizeof(T)));
+        }
+        else {
+            return std::allocator<T>{}.allocate(size);
+        }
+    }
+
+    void deallocate(T* data, std::size_t size) noexcept {
+        if (isFileBacked() && (size > 0)) {
+            unmapScratchFile(data, size * sizeof(T));
+        }
+        else if (usesHugePages() && (size > 0)) {
+            freeHugePageMemory(data, size * sizeof(T));
+        }
+        else {
+            std::allocator<T>{}.deallocate(data, size);
+        }
+    }
+
+    // Default initialization instead of value initialization, so trivial elements are left unwritten
+    template <typename U>
+    void construct(U* element) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new (static_cast<void*>(element)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* element, Args&&... args) {
+        ::new (static_cast<void*>(element)) U(std::forward<Args>(args)...);
+    }
+
+    bool isFileBacked() const {
+        return m_options && !m_options->scratchDirectory.empty();
+    }
+
+    bool usesHugePages() const {
+        return m_options && m_options->scratchDirectory.empty() && m_options->useHugePages;
+    }
+
+    const std::shared_ptr<const LargeArrayOptions>& getOptions() const {
+        return m_options;
+    }
+
+    template <typename U>
+    bool operator==(const LargeArrayAllocator<U>& other) const {
+        return m_options == other.getOptions();
+    }
+
+private:
+    static T* checkAllocation(void* data) {
+        if (!data) {
+            throw std::bad_alloc{};
+        }
+        return static_cast<T*>(data);
+    }
+
+    // Shared between the copies of an allocator, so that allocators that can free each other's memory compare equal
+    std::shared_ptr<const LargeArrayOptions> m_options;
+};
+
+#endif // LARGE_ARRAY_ALLOCATOR_HPP
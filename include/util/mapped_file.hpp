@@ -0,0 +1,32 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+// Read-only view of a whole file
+// On POSIX systems the file is memory mapped so that pages are only read from disk when they are accessed
+// On other platforms the file is read into memory instead
+class MappedFile {
+public:
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isGood() const;
+    bool isMemoryMapped() const;
+    std::span<const std::byte> getBytes() const;
+
+private:
+    const std::byte* m_data;
+    std::size_t m_size;
+    bool m_good;
+    bool m_memoryMapped;
+    std::vector<std::byte> m_fallbackBuffer;
+};
+
+#endif // MAPPED_FILE_HPP
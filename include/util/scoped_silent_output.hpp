@@ -0,0 +1,20 @@
+#ifndef SCOPED_SILENT_OUTPUT_HPP
+#define SCOPED_SILENT_OUTPUT_HPP
+
+#include <iostream>
+#include <streambuf>
+
+// Redirects std::cout while alive, so that the field by field output of the settings loader does not drown out other progress
+class ScopedSilentOutput {
+public:
+    ScopedSilentOutput() : m_previousBuffer{ std::cout.rdbuf(nullptr) } {}
+    ~ScopedSilentOutput() { std::cout.rdbuf(m_previousBuffer); }
+
+    ScopedSilentOutput(const ScopedSilentOutput&) = delete;
+    ScopedSilentOutput& operator=(const ScopedSilentOutput&) = delete;
+
+private:
+    std::streambuf* m_previousBuffer;
+};
+
+#endif // SCOPED_SILENT_OUTPUT_HPP
@@ -1,69 +1,78 @@
 #ifndef STACK_ALLOCATOR_HPP
 #define STACK_ALLOCATOR_HPP
 
-#include "util/fixed_vector.hpp"
-
 #include <cassert>
 #include <cstddef>
-#include <cstdint>
 #include <memory>
 #include <span>
 #include <type_traits>
 #include <vector>
 
-// TODO: Remove template and allow all trivally copyable types at once
-template<typename T>
+// Per thread stack of temporary arrays, blocks must be deallocated in the reverse order they were allocated
+// Each thread's stack starts as a single chunk and grows by adding chunks when it runs out of space, so it never overflows
 class StackAllocator {
-    static_assert(std::is_trivially_copyable_v<T>);
 public:
-    static constexpr int MaxNumThreads = 64;
+    // Blocks start on a cache line so that SIMD kernels can use aligned loads
+    static constexpr std::size_t Alignment = 64;
 
-    StackAllocator(int numThreads) : m_stackPointers(numThreads, 0), m_stacks(numThreads, std::vector<T>(StackBytesPerThread / sizeof(T))), m_maximumStackUsage(numThreads, 0) {
-        assert(numThreads <= MaxNumThreads);
-    }
+    static constexpr std::size_t DefaultBytesPerThread = 512 * 1024;
 
-    bool isEmpty() const {
-        for (std::size_t stackPointer : m_stackPointers) {
-            if (stackPointer > 0) return false;
-        }
-        return true;
-    }
-
-    std::span<T> allocate(int thread, std::size_t size) {
-        assert(thread < MaxNumThreads);
-        assert(m_stackPointers[thread] + size <= m_stacks[thread].size());
+    explicit StackAllocator(int numThreads, std::size_t initialBytesPerThread = DefaultBytesPerThread);
 
-        auto start = m_stacks[thread].begin() + m_stackPointers[thread];
-        auto end = start + size;
-        m_stackPointers[thread] += size;
+    StackAllocator(const StackAllocator&) = delete;
+    StackAllocator& operator=(const StackAllocator&) = delete;
 
-        std::size_t currentStackUsage = m_stackPointers[thread] * sizeof(T);
-        m_maximumStackUsage[thread] = std::max(m_maximumStackUsage[thread], currentStackUsage);
+    int getNumThreads() const;
+    bool isEmpty() const;
 
-        return { start, end };
+    template <typename T>
+    std::span<T> allocate(int thread, std::size_t size) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        static_assert(Alignment % alignof(T) == 0);
+        return { reinterpret_cast<T*>(allocateBytes(thread, size * sizeof(T))), size };
     }
 
+    template <typename T>
     void deallocate(int thread, std::span<T> data) {
-        assert(thread < MaxNumThreads);
-        assert(m_stackPointers[thread] - data.size() >= 0);
-
-        T* expectedTopOfStack = std::to_address(data.end());
-        T* currentTopOfStack = std::to_address(m_stacks[thread].begin() + m_stackPointers[thread]);
-        assert(expectedTopOfStack == currentTopOfStack);
-
-        m_stackPointers[thread] -= data.size();
+        deallocateBytes(thread, reinterpret_cast<std::byte*>(data.data()), data.size() * sizeof(T));
     }
 
-    FixedVector<std::size_t, MaxNumThreads> getMaximumStackUsage() const {
-        return m_maximumStackUsage;
-    }
+    // High water marks of each thread since the allocator was created
+    // Usage in bytes includes the padding used to align blocks
+    std::vector<std::size_t> getMaximumStackUsage() const;
+    std::vector<std::size_t> getMaximumNumBlocks() const;
+
+    // Total size of the chunks owned by each thread
+    std::vector<std::size_t> getReservedBytes() const;
 
 private:
-    static constexpr int KB = (1 << 10);
-    static constexpr int StackBytesPerThread = 512 * KB; // TODO: Maybe dynamically choose this based on tree size
-    FixedVector<std::size_t, MaxNumThreads> m_stackPointers;
-    FixedVector<std::vector<T>, MaxNumThreads> m_stacks;
-    FixedVector<std::size_t, MaxNumThreads> m_maximumStackUsage;
+    struct AlignedDeleter {
+        void operator()(std::byte* data) const;
+    };
+
+    struct Chunk {
+        std::unique_ptr<std::byte[], AlignedDeleter> data;
+        std::size_t capacity;
+        std::size_t used;
+    };
+
+    // Padded to a cache line so that threads do not write to the same line
+    struct alignas(Alignment) ThreadStack {
+        std::vector<Chunk> chunks;
+        std::size_t currentChunk;
+        std::size_t bytesInUse;
+        std::size_t numBlocks;
+        std::size_t maximumBytesInUse;
+        std::size_t maximumNumBlocks;
+    };
+
+    static Chunk allocateChunk(std::size_t capacity);
+
+    std::byte* allocateBytes(int thread, std::size_t numBytes);
+    void deallocateBytes(int thread, std::byte* data, std::size_t numBytes);
+
+    std::size_t m_chunkBytes;
+    std::vector<ThreadStack> m_threadStacks;
 };
 
 template <typename T>
@@ -78,7 +87,7 @@ public:
     using const_pointer = const T*;
     using iterator = typename std::span<T>::iterator;
 
-    ScopedVector(StackAllocator<T>& allocator, int allocatingThread, std::size_t size) : m_allocator{ allocator }, m_allocatingThread{ allocatingThread }, m_data{ allocator.allocate(allocatingThread, size) } {}
+    ScopedVector(StackAllocator& allocator, int allocatingThread, std::size_t size) : m_allocator{ allocator }, m_allocatingThread{ allocatingThread }, m_data{ allocator.allocate<T>(allocatingThread, size) } {}
 
     ~ScopedVector() {
         m_allocator.deallocate(m_allocatingThread, m_data);
@@ -125,9 +134,9 @@ public:
     }
 
 private:
-    StackAllocator<T>& m_allocator;
+    StackAllocator& m_allocator;
     int m_allocatingThread;
     std::span<T> m_data;
 };
 
-#endif // STACK_ALLOCATOR_HPP
\ No newline at end of file
+#endif // STACK_ALLOCATOR_HPP
@@ -0,0 +1,87 @@
+#ifndef TCP_SOCKET_HPP
+#define TCP_SOCKET_HPP
+
+#include "util/result.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <type_traits>
+
+// Blocking TCP connection that sends and receives whole buffers
+// Only available on POSIX systems, elsewhere connecting and listening always fail
+class TcpConnection {
+public:
+    TcpConnection();
+    ~TcpConnection();
+
+    TcpConnection(TcpConnection&& other) noexcept;
+    TcpConnection& operator=(TcpConnection&& other) noexcept;
+
+    TcpConnection(const TcpConnection&) = delete;
+    TcpConnection& operator=(const TcpConnection&) = delete;
+
+    // Address in the form host:port
+    static Result<TcpConnection> connect(const std::string& address);
+
+    bool isOpen() const;
+    void close();
+
+    // Receiving fails once no bytes have arrived for this long, 0 waits forever
+    bool setReceiveTimeout(std::chrono::milliseconds timeout);
+
+    // Both return false if the connection was closed or failed before every byte was transferred
+    bool sendBytes(std::span<const std::byte> bytes);
+    bool receiveBytes(std::span<std::byte> bytes);
+
+    // Waits until some bytes arrive and returns how many were written to the start of the buffer, or 0 if the connection was closed or failed
+    std::size_t receiveAvailableBytes(std::span<std::byte> buffer);
+
+    template <typename T>
+    bool send(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return sendBytes(std::as_bytes(std::span<const T, 1>{ &value, 1 }));
+    }
+
+    template <typename T>
+    bool receive(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return receiveBytes(std::as_writable_bytes(std::span<T, 1>{ &value, 1 }));
+    }
+
+private:
+    friend class TcpListener;
+    explicit TcpConnection(int socket);
+
+    int m_socket;
+};
+
+class TcpListener {
+public:
+    TcpListener();
+    ~TcpListener();
+
+    TcpListener(TcpListener&& other) noexcept;
+    TcpListener& operator=(TcpListener&& other) noexcept;
+
+    TcpListener(const TcpListener&) = delete;
+    TcpListener& operator=(const TcpListener&) = delete;
+
+    // Listens on every interface, port 0 picks a free port
+    // The backlog is the number of connections that can wait to be accepted
+    static Result<TcpListener> listen(std::uint16_t port, int backlog = 1);
+
+    std::uint16_t getPort() const;
+
+    // Waits for the next connection, several threads can wait on the same listener
+    Result<TcpConnection> accept();
+
+private:
+    explicit TcpListener(int socket);
+
+    int m_socket;
+};
+
+#endif // TCP_SOCKET_HPP
@@ -0,0 +1,17 @@
+#ifndef THREAD_COUNT_HPP
+#define THREAD_COUNT_HPP
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Number of threads OpenMP uses by default, 1 in builds without OpenMP
+inline int getMaxNumThreads() {
+    #ifdef _OPENMP
+    return omp_get_max_threads();
+    #else
+    return 1;
+    #endif
+}
+
+#endif // THREAD_COUNT_HPP
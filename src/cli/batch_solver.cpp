@@ -0,0 +1,722 @@
+#include "cli/batch_solver.hpp"
+
+#include "cli/settings_file.hpp"
+#include "game/game_types.hpp"
+#include "game/game_utils.hpp"
+#include "game/holdem/flop_isomorphism.hpp"
+#include "game/holdem/holdem_parser.hpp"
+#include "game/holdem/holdem.hpp"
+#include "solver/cfr.hpp"
+#include "solver/node_path.hpp"
+#include "solver/solver_session.hpp"
+#include "solver/tree.hpp"
+#include "solver/warm_start.hpp"
+#include "util/result.hpp"
+#include "util/scoped_silent_output.hpp"
+#include "util/stack_allocator.hpp"
+#include "util/string_utils.hpp"
+#include "util/thread_count.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+struct BatchManifest {
+    int numThreads;
+    int numConcurrentSpots;
+    std::filesystem::path outputDirectory;
+    std::vector<std::filesystem::path> spotPaths;
+};
+
+struct BatchSpot {
+    std::filesystem::path settingsPath;
+    std::filesystem::path outputPath;
+    HoldemSettingsFile settingsFile;
+
+    // Index of the first spot in the manifest with the same hand tables as this one
+    int handTableSpot;
+};
+
+struct SpotResult {
+    // Empty if the spot was solved and saved
+    std::string error;
+    int numIterations = 0;
+    float exploitabilityPercent = 0.0f;
+    double secondsElapsed = 0.0;
+};
+
+// Relative paths in the manifest are relative to the directory of the manifest
+std::filesystem::path resolvePath(const std::filesystem::path& manifestDirectory, const std::string& path) {
+    std::filesystem::path resolvedPath{ path };
+    return resolvedPath.is_absolute() ? resolvedPath : manifestDirectory / resolvedPath;
+}
+
+std::optional<BatchManifest> loadManifest(const std::string& manifestPath) {
+    YAML::Node input;
+    try {
+        input = YAML::LoadFile(manifestPath);
+    }
+    catch (const YAML::Exception&) {
+        std::cerr << "Error: Could not load batch manifest. Invalid file name: " << manifestPath << "\n";
+        return std::nullopt;
+    }
+
+    std::filesystem::path manifestDirectory = std::filesystem::path{ manifestPath }.parent_path();
+    BatchManifest manifest;
+    try {
+        manifest.numThreads = input["threads"] ? input["threads"].as<int>() : getMaxNumThreads();
+        manifest.numConcurrentSpots = input["concurrent-spots"] ? input["concurrent-spots"].as<int>() : 1;
+        manifest.outputDirectory = resolvePath(manifestDirectory, input["output-directory"] ? input["output-directory"].as<std::string>() : ".");
+
+        for (const YAML::Node& spot : input["spots"]) {
+            manifest.spotPaths.push_back(resolvePath(manifestDirectory, spot.as<std::string>()));
+        }
+    }
+    catch (const YAML::Exception&) {
+        std::cerr << "Error: Invalid batch manifest " << manifestPath << ".\n";
+        return std::nullopt;
+    }
+
+    if (manifest.spotPaths.empty()) {
+        std::cerr << "Error: The batch manifest does not list any spots.\n";
+        return std::nullopt;
+    }
+
+    if (manifest.numThreads < 1 || manifest.numConcurrentSpots < 1) {
+        std::cerr << "Error: threads and concurrent-spots must be at least 1.\n";
+        return std::nullopt;
+    }
+
+    #ifndef _OPENMP
+    manifest.numThreads = 1;
+    #endif
+    manifest.numConcurrentSpots = std::min(manifest.numConcurrentSpots, manifest.numThreads);
+
+    return manifest;
+}
+
+// Loads the settings of every spot before solving starts, so that a typo in the last spot does not surface hours into the batch
+std::optional<std::vector<BatchSpot>> loadSpots(const BatchManifest& manifest) {
+    std::vector<BatchSpot> spots;
+    std::set<std::filesystem::path> outputPaths;
+
+    for (const std::filesystem::path& settingsPath : manifest.spotPaths) {
+        std::optional<HoldemSettingsFile> settingsFile;
+        {
+            ScopedSilentOutput silentOutput;
+            settingsFile = loadHoldemSettingsFile(settingsPath.string());
+        }
+        if (!settingsFile) {
+            std::cerr << "Error: Could not load spot " << settingsPath.string() << ".\n";
+            return std::nullopt;
+        }
+
+        std::filesystem::path outputPath = manifest.outputDirectory / (settingsPath.stem().string() + ".bin");
+        if (!outputPaths.insert(outputPath).second) {
+            std::cerr << "Error: More than one spot would be saved to " << outputPath.string() << ". Spot file names must be unique.\n";
+            return std::nullopt;
+        }
+
+        int spotIndex = static_cast<int>(spots.size());
+        int handTableSpot = spotIndex;
+        for (int otherSpot = 0; otherSpot < spotIndex; ++otherSpot) {
+            if (Holdem::canShareHandTables(spots[otherSpot].settingsFile.gameSettings, settingsFile->gameSettings)) {
+                handTableSpot = spots[otherSpot].handTableSpot;
+                break;
+            }
+        }
+
+        spots.push_back({
+            .settingsPath = settingsPath,
+            .outputPath = outputPath,
+            .settingsFile = std::move(*settingsFile),
+            .handTableSpot = handTableSpot,
+        });
+    }
+
+    return spots;
+}
+
+// Hand tables are built by the first spot that needs them and kept until the last spot that uses them has been set up
+class HandTableCache {
+public:
+    explicit HandTableCache(const std::vector<BatchSpot>& spots) : m_entries(spots.size()) {
+        for (const BatchSpot& spot : spots) {
+            ++m_entries[spot.handTableSpot].numRemainingSpots;
+        }
+    }
+
+    std::shared_ptr<const Holdem> createRules(const BatchSpot& spot) {
+        const Holdem::Settings& settings = spot.settingsFile.gameSettings;
+        Entry& entry = m_entries[spot.handTableSpot];
+
+        // Concurrent spots that need the same tables wait here for the first one to build them
+        std::lock_guard<std::mutex> lock{ entry.mutex };
+        std::shared_ptr<const Holdem> rules = entry.source ? std::make_shared<Holdem>(settings, *entry.source) : std::make_shared<Holdem>(settings);
+
+        assert(entry.numRemainingSpots > 0);
+        --entry.numRemainingSpots;
+        entry.source = (entry.numRemainingSpots > 0) ? rules : nullptr;
+        return rules;
+    }
+
+private:
+    struct Entry {
+        std::mutex mutex;
+        std::shared_ptr<const Holdem> source;
+        int numRemainingSpots = 0;
+    };
+
+    std::vector<Entry> m_entries;
+};
+
+// Trains the tree until it reaches the target exploitability or the iteration limit of the solver settings
+// The result always has the exploitability, since batch solves are never cancelled
+SolveResult trainTree(const Holdem& rules, const SolverSettings& solverSettings, int numThreads, Tree& tree, StackAllocator& allocator) {
+    SolveResult result;
+
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(numThreads)
+    #pragma omp single
+    #endif
+    result = trainDiscountedCfr(rules, getSolveSettings(solverSettings), tree, allocator);
+
+    assert(result.exploitabilityPercent);
+    return result;
+}
+
+SpotResult solveSpot(const BatchSpot& spot, const Holdem& rules, int numThreads, std::unique_ptr<StackAllocator>& allocator) {
+    const SolverSettings& solverSettings = spot.settingsFile.solverSettings;
+    auto startTime = std::chrono::steady_clock::now();
+
+    Tree tree{ solverSettings.useTrainingDataCompression };
+    tree.buildTreeSkeleton(rules, numThreads);
+    tree.setTrainingDataHugePages(solverSettings.useHugePages);
+    if (!solverSettings.trainingDataDirectory.empty() && !tree.setTrainingDataDirectory(solverSettings.trainingDataDirectory)) {
+        return { .error = "Error: Could not create training data files in " + solverSettings.trainingDataDirectory + "." };
+    }
+    tree.initCfrVectors(numThreads);
+
+    if (!solverSettings.warmStartFile.empty()) {
+        static constexpr bool UseMemoryMapping = false;
+        Result<std::unique_ptr<Tree>> warmStartResult = Tree::loadFromFile(rules, solverSettings.warmStartFile, UseMemoryMapping);
+        if (warmStartResult.isError()) {
+            return { .error = warmStartResult.getError() };
+        }
+        warmStartTree(rules, *warmStartResult.getValue(), tree);
+    }
+
+    // The allocator of each group of threads is kept between spots, its stacks grow when a larger tree needs more space
+    if (!allocator) {
+        allocator = std::make_unique<StackAllocator>(numThreads, tree.estimateStackAllocatorSize());
+    }
+
+    SolveResult trainingResult = trainTree(rules, solverSettings, numThreads, tree, *allocator);
+
+    if (!tree.saveToFile(rules, spot.outputPath)) {
+        return { .error = "Error: Could not write tree to " + spot.outputPath.string() + "." };
+    }
+
+    double secondsElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return {
+        .error = {},
+        .numIterations = tree.numCompletedIterations,
+        .exploitabilityPercent = *trainingResult.exploitabilityPercent,
+        .secondsElapsed = secondsElapsed,
+    };
+}
+
+struct AggregateManifest {
+    int numThreads;
+    int numConcurrentFlops;
+
+    // Estimated memory of the trees solved at the same time, 0 for no limit
+    std::size_t memoryBudget;
+
+    std::filesystem::path settingsPath;
+    std::filesystem::path outputPath;
+    std::vector<CardSet> flops;
+
+    // Machines that share a report each solve every shardCount-th canonical flop, starting at shardIndex
+    int shardIndex;
+    int shardCount;
+};
+
+struct FlopResult {
+    // Empty if the flop was solved
+    std::string error;
+    int numIterations = 0;
+    float exploitabilityPercent = 0.0f;
+    PlayerArray<float> expectedValues = { 0.0f, 0.0f };
+
+    // Range weighted frequency of each action at the root
+    std::vector<std::string> rootActionNames = {};
+    std::vector<double> rootActionFrequencies = {};
+};
+
+std::string getFlopName(CardSet flop) {
+    std::string name;
+    for (const std::string& cardName : getCardSetNames(flop)) {
+        name += cardName;
+    }
+    return name;
+}
+
+std::optional<AggregateManifest> loadAggregateManifest(const std::string& manifestPath) {
+    YAML::Node input;
+    try {
+        input = YAML::LoadFile(manifestPath);
+    }
+    catch (const YAML::Exception&) {
+        std::cerr << "Error: Could not load aggregate manifest. Invalid file name: " << manifestPath << "\n";
+        return std::nullopt;
+    }
+
+    std::filesystem::path manifestDirectory = std::filesystem::path{ manifestPath }.parent_path();
+    AggregateManifest manifest;
+    try {
+        manifest.numThreads = input["threads"] ? input["threads"].as<int>() : getMaxNumThreads();
+        manifest.numConcurrentFlops = input["concurrent-flops"] ? input["concurrent-flops"].as<int>() : 1;
+        manifest.memoryBudget = static_cast<std::size_t>(input["memory-budget-mb"] ? input["memory-budget-mb"].as<std::uint64_t>() : 0) * 1024 * 1024;
+        manifest.settingsPath = resolvePath(manifestDirectory, input["settings"].as<std::string>());
+        manifest.outputPath = resolvePath(manifestDirectory, input["output"] ? input["output"].as<std::string>() : "aggregate-report.csv");
+        manifest.shardIndex = input["shard-index"] ? input["shard-index"].as<int>() : 0;
+        manifest.shardCount = input["shard-count"] ? input["shard-count"].as<int>() : 1;
+
+        const YAML::Node& flops = input["flops"];
+        if (flops.IsScalar() && (flops.as<std::string>() == "all")) {
+            manifest.flops = getAllFlops();
+        }
+        else {
+            for (const YAML::Node& flop : flops) {
+                Result<CardSet> flopResult = buildCommunityCardsFromString(flop.as<std::string>());
+                if (flopResult.isError() || (getSetSize(flopResult.getValue()) != 3)) {
+                    std::cerr << "Error: Invalid flop \"" << flop.as<std::string>() << "\" in the aggregate manifest.\n";
+                    return std::nullopt;
+                }
+                manifest.flops.push_back(flopResult.getValue());
+            }
+        }
+    }
+    catch (const YAML::Exception&) {
+        std::cerr << "Error: Invalid aggregate manifest " << manifestPath << ".\n";
+        return std::nullopt;
+    }
+
+    if (manifest.flops.empty()) {
+        std::cerr << "Error: The aggregate manifest does not list any flops.\n";
+        return std::nullopt;
+    }
+
+    if (manifest.numThreads < 1 || manifest.numConcurrentFlops < 1) {
+        std::cerr << "Error: threads and concurrent-flops must be at least 1.\n";
+        return std::nullopt;
+    }
+
+    if (manifest.shardCount < 1 || manifest.shardIndex < 0 || manifest.shardIndex >= manifest.shardCount) {
+        std::cerr << "Error: shard-index must be at least 0 and less than shard-count.\n";
+        return std::nullopt;
+    }
+
+    #ifndef _OPENMP
+    manifest.numThreads = 1;
+    #endif
+    manifest.numConcurrentFlops = std::min(manifest.numConcurrentFlops, manifest.numThreads);
+
+    return manifest;
+}
+
+// Holds back flops until the estimated memory of the flops being solved leaves room for them
+// A flop that is larger than the whole budget is solved once nothing else is running, so every flop is solved eventually
+class MemoryBudget {
+public:
+    explicit MemoryBudget(std::size_t budget) : m_budget{ budget }, m_used{ 0 } {}
+
+    // Adds bytes to a reservation that already holds ownedBytes, waiting until they fit or the reservation is the only one
+    void acquire(std::size_t bytes, std::size_t ownedBytes) {
+        if (m_budget == 0) return;
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        m_released.wait(lock, [this, bytes, ownedBytes]() { return (m_used == ownedBytes) || (m_used + bytes <= m_budget); });
+        m_used += bytes;
+    }
+
+    void release(std::size_t bytes) {
+        if (m_budget == 0) return;
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_used -= bytes;
+        }
+        m_released.notify_all();
+    }
+
+    // A flop grows its reservation while it builds its rules and counts its tree, so only one flop at a time may do that
+    // Otherwise two flops could each hold part of the budget while waiting for the other's part
+    // Returns a lock that owns nothing when there is no budget
+    std::unique_lock<std::mutex> lockSetup() {
+        if (m_budget == 0) return {};
+        return std::unique_lock<std::mutex>{ m_setupMutex };
+    }
+
+private:
+    std::size_t m_budget;
+    std::size_t m_used;
+    std::mutex m_mutex;
+    std::condition_variable m_released;
+    std::mutex m_setupMutex;
+};
+
+// Memory reserved from a MemoryBudget, which is released when the reservation is destroyed
+class MemoryReservation {
+public:
+    explicit MemoryReservation(MemoryBudget& budget) : m_budget{ budget }, m_bytes{ 0 } {}
+
+    MemoryReservation(const MemoryReservation&) = delete;
+    MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+    ~MemoryReservation() {
+        m_budget.release(m_bytes);
+    }
+
+    void grow(std::size_t bytes) {
+        m_budget.acquire(bytes, m_bytes);
+        m_bytes += bytes;
+    }
+
+private:
+    MemoryBudget& m_budget;
+    std::size_t m_bytes;
+};
+
+FlopResult solveFlop(
+    const HoldemSettingsFile& settingsFile,
+    CardSet flop,
+    int numThreads,
+    MemoryBudget& memoryBudget,
+    std::unique_ptr<StackAllocator>& allocator
+) {
+    const SolverSettings& solverSettings = settingsFile.solverSettings;
+
+    Holdem::Settings settings = settingsFile.gameSettings;
+    settings.startingCommunityCards = flop;
+    settings.numThreads = numThreads;
+    for (Player player : { Player::P0, Player::P1 }) {
+        settings.ranges[player] = removeBlockedHands(settingsFile.fullRanges[player], flop);
+        if (settings.ranges[player].hands.empty()) {
+            return { .error = "Error: No hands are possible given the flop." };
+        }
+    }
+
+    // The tree can only be counted once the rules are built, so the hand tables are reserved first
+    MemoryReservation reservation{ memoryBudget };
+    std::unique_lock<std::mutex> setupLock = memoryBudget.lockSetup();
+    reservation.grow(sizeof(Holdem) + Holdem::estimateHandTablesSize(settings));
+    Holdem rules{ settings };
+
+    Tree tree{ solverSettings.useTrainingDataCompression };
+    reservation.grow(tree.estimateFullTreeSize(rules, Tree::countTreeSize(rules, numThreads)));
+    if (setupLock.owns_lock()) {
+        setupLock.unlock();
+    }
+
+    tree.buildTreeSkeleton(rules, numThreads);
+    tree.setTrainingDataHugePages(solverSettings.useHugePages);
+    if (!solverSettings.trainingDataDirectory.empty() && !tree.setTrainingDataDirectory(solverSettings.trainingDataDirectory)) {
+        return { .error = "Error: Could not create training data files in " + solverSettings.trainingDataDirectory + "." };
+    }
+    tree.initCfrVectors(numThreads);
+
+    if (!allocator) {
+        allocator = std::make_unique<StackAllocator>(numThreads, tree.estimateStackAllocatorSize());
+    }
+
+    FlopResult result;
+    SolveResult trainingResult = trainTree(rules, solverSettings, numThreads, tree, *allocator);
+    result.numIterations = trainingResult.numIterations;
+    result.exploitabilityPercent = *trainingResult.exploitabilityPercent;
+
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(numThreads)
+    #pragma omp single
+    #endif
+    {
+        for (Player player : { Player::P0, Player::P1 }) {
+            result.expectedValues[player] = expectedValue(player, rules, tree, *allocator);
+        }
+    }
+
+    std::vector<NodeInfo> rootPath = getRootNodePath(tree);
+    NodePathRangeStrategy rootStrategy = getNodePathRangeStrategy(rules, tree, rootPath);
+    std::size_t rangeSize = rootStrategy.range.reachWeights.size();
+    double totalWeight = 0.0;
+    for (float weight : rootStrategy.range.reachWeights) {
+        totalWeight += weight;
+    }
+
+    for (int action = 0; action < rootStrategy.numActions; ++action) {
+        double frequency = 0.0;
+        for (std::size_t hand = 0; hand < rangeSize; ++hand) {
+            frequency += static_cast<double>(rootStrategy.range.reachWeights[hand]) * rootStrategy.strategy[action * rangeSize + hand];
+        }
+        result.rootActionNames.push_back(getActionName(rules, tree, tree.getRootNodeIndex(), action));
+        result.rootActionFrequencies.push_back((totalWeight > 0.0) ? frequency / totalWeight : 0.0);
+    }
+
+    return result;
+}
+
+// One row per canonical flop, with the number of flops it stands for so that the rows can be weighted
+bool writeAggregateReport(
+    const std::filesystem::path& outputPath,
+    const std::vector<CanonicalFlop>& flops,
+    const std::vector<FlopResult>& results,
+    const std::vector<std::string>& rootActionNames
+) {
+    std::ofstream output{ outputPath };
+    if (!output) return false;
+
+    output << "flop,num_flops,iterations,exploitability_percent,oop_ev,ip_ev";
+    for (const std::string& actionName : rootActionNames) {
+        output << "," << actionName;
+    }
+    output << "\n";
+
+    for (std::size_t flopIndex = 0; flopIndex < flops.size(); ++flopIndex) {
+        const FlopResult& result = results[flopIndex];
+        if (!result.error.empty()) continue;
+
+        output << getFlopName(flops[flopIndex].flop) << "," << flops[flopIndex].numFlops << "," << result.numIterations << ","
+            << formatFixedPoint(result.exploitabilityPercent, 5) << ","
+            << formatFixedPoint(result.expectedValues[Player::P0], 5) << "," << formatFixedPoint(result.expectedValues[Player::P1], 5);
+        for (double frequency : result.rootActionFrequencies) {
+            output << "," << formatFixedPoint(frequency, 5);
+        }
+        output << "\n";
+    }
+
+    output.flush();
+    return static_cast<bool>(output);
+}
+} // namespace
+
+bool runBatch(const std::string& manifestPath) {
+    std::optional<BatchManifest> manifestOption = loadManifest(manifestPath);
+    if (!manifestOption) return false;
+    const BatchManifest& manifest = *manifestOption;
+
+    std::optional<std::vector<BatchSpot>> spotsOption = loadSpots(manifest);
+    if (!spotsOption) return false;
+    std::vector<BatchSpot>& spots = *spotsOption;
+
+    std::error_code error;
+    std::filesystem::create_directories(manifest.outputDirectory, error);
+    if (error) {
+        std::cerr << "Error: Could not create output directory " << manifest.outputDirectory.string() << ".\n";
+        return false;
+    }
+
+    // Each group of threads solves one spot at a time, leftover threads are left idle
+    int numGroups = manifest.numConcurrentSpots;
+    int numThreadsPerGroup = manifest.numThreads / numGroups;
+    int numSpots = static_cast<int>(spots.size());
+
+    std::cout << "Solving " << numSpots << " spots, " << numGroups << " at a time with " << numThreadsPerGroup << " threads each.\n" << std::flush;
+
+    for (BatchSpot& spot : spots) {
+        spot.settingsFile.gameSettings.numThreads = numThreadsPerGroup;
+    }
+
+    HandTableCache handTableCache{ spots };
+    std::vector<std::unique_ptr<StackAllocator>> allocators(numGroups);
+    std::mutex outputMutex;
+    int numFinishedSpots = 0;
+    int numFailedSpots = 0;
+    auto batchStartTime = std::chrono::steady_clock::now();
+
+    #ifdef _OPENMP
+    // Spots run in their own parallel region inside the region of their group
+    omp_set_max_active_levels(2);
+    #pragma omp parallel for num_threads(numGroups) schedule(dynamic, 1)
+    #endif
+    for (int spotIndex = 0; spotIndex < numSpots; ++spotIndex) {
+        #ifdef _OPENMP
+        int group = omp_get_thread_num();
+        #else
+        int group = 0;
+        #endif
+
+        const BatchSpot& spot = spots[spotIndex];
+        std::shared_ptr<const Holdem> rules = handTableCache.createRules(spot);
+        SpotResult result = solveSpot(spot, *rules, numThreadsPerGroup, allocators[group]);
+
+        std::lock_guard<std::mutex> lock{ outputMutex };
+        ++numFinishedSpots;
+        std::cout << "[" << numFinishedSpots << "/" << numSpots << "] " << spot.settingsPath.string() << ": ";
+        if (result.error.empty()) {
+            std::cout << result.numIterations << " iterations, exploitability " << formatFixedPoint(result.exploitabilityPercent, 5)
+                << "%, " << formatFixedPoint(result.secondsElapsed, 3) << "s. Saved to " << spot.outputPath.string() << ".\n" << std::flush;
+        }
+        else {
+            ++numFailedSpots;
+            std::cout << "\n" << std::flush;
+            std::cerr << result.error << "\n";
+        }
+    }
+
+    double secondsElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - batchStartTime).count();
+    double solvesPerHour = (secondsElapsed > 0.0) ? (numSpots - numFailedSpots) * 3600.0 / secondsElapsed : 0.0;
+    std::cout << "Solved " << (numSpots - numFailedSpots) << " of " << numSpots << " spots in " << formatFixedPoint(secondsElapsed, 3)
+        << "s (" << formatFixedPoint(solvesPerHour, 1) << " solves per hour).\n";
+
+    return numFailedSpots == 0;
+}
+
+bool runAggregate(const std::string& manifestPath) {
+    std::optional<AggregateManifest> manifestOption = loadAggregateManifest(manifestPath);
+    if (!manifestOption) return false;
+    const AggregateManifest& manifest = *manifestOption;
+
+    std::optional<HoldemSettingsFile> settingsFile;
+    {
+        ScopedSilentOutput silentOutput;
+        settingsFile = loadHoldemSettingsFile(manifest.settingsPath.string());
+    }
+    if (!settingsFile) {
+        std::cerr << "Error: Could not load settings " << manifest.settingsPath.string() << ".\n";
+        return false;
+    }
+
+    if (getSetSize(settingsFile->gameSettings.startingCommunityCards) != 3) {
+        std::cerr << "Error: The aggregate settings must start on the flop. Their board is replaced by each flop of the report.\n";
+        return false;
+    }
+
+    if (!settingsFile->solverSettings.warmStartFile.empty()) {
+        std::cerr << "Error: warm-start-file cannot be used in an aggregate report, since each flop needs a tree of its own board.\n";
+        return false;
+    }
+
+    // Flops that a suit permutation of both ranges maps onto each other have the same solution, so only one of them is solved
+    std::vector<SuitPermutation> symmetries = getRangeSuitSymmetries(settingsFile->fullRanges);
+    std::vector<CanonicalFlop> canonicalFlops = getCanonicalFlops(manifest.flops, symmetries);
+
+    std::vector<CanonicalFlop> flops;
+    for (std::size_t flopIndex = manifest.shardIndex; flopIndex < canonicalFlops.size(); flopIndex += manifest.shardCount) {
+        flops.push_back(canonicalFlops[flopIndex]);
+    }
+
+    int numGroups = manifest.numConcurrentFlops;
+    int numThreadsPerGroup = manifest.numThreads / numGroups;
+    int numFlops = static_cast<int>(flops.size());
+
+    std::cout << manifest.flops.size() << " flops reduce to " << canonicalFlops.size() << " canonical flops with "
+        << symmetries.size() << " suit symmetries of the ranges.\n";
+    if (manifest.shardCount > 1) {
+        std::cout << "Shard " << manifest.shardIndex << " of " << manifest.shardCount << " solves " << numFlops << " of them.\n";
+    }
+    std::cout << "Solving " << numFlops << " flops, " << numGroups << " at a time with " << numThreadsPerGroup << " threads each";
+    if (manifest.memoryBudget > 0) {
+        std::cout << " and a memory budget of " << formatBytes(manifest.memoryBudget);
+    }
+    std::cout << ".\n" << std::flush;
+
+    MemoryBudget memoryBudget{ manifest.memoryBudget };
+    std::vector<std::unique_ptr<StackAllocator>> allocators(numGroups);
+    std::vector<FlopResult> results(numFlops);
+    std::mutex outputMutex;
+    int numFinishedFlops = 0;
+    auto startTime = std::chrono::steady_clock::now();
+
+    #ifdef _OPENMP
+    // Flops run in their own parallel region inside the region of their group
+    omp_set_max_active_levels(2);
+    #pragma omp parallel for num_threads(numGroups) schedule(dynamic, 1)
+    #endif
+    for (int flopIndex = 0; flopIndex < numFlops; ++flopIndex) {
+        #ifdef _OPENMP
+        int group = omp_get_thread_num();
+        #else
+        int group = 0;
+        #endif
+
+        FlopResult result = solveFlop(*settingsFile, flops[flopIndex].flop, numThreadsPerGroup, memoryBudget, allocators[group]);
+
+        std::lock_guard<std::mutex> lock{ outputMutex };
+        ++numFinishedFlops;
+        std::cout << "[" << numFinishedFlops << "/" << numFlops << "] " << getFlopName(flops[flopIndex].flop) << ": ";
+        if (result.error.empty()) {
+            std::cout << result.numIterations << " iterations, exploitability " << formatFixedPoint(result.exploitabilityPercent, 5) << "%.\n" << std::flush;
+        }
+        else {
+            std::cout << "\n" << std::flush;
+            std::cerr << result.error << "\n";
+        }
+        results[flopIndex] = std::move(result);
+    }
+
+    // Averages over the flops that were solved, each weighted by the number of flops it stands for
+    int numSolvedFlops = 0;
+    double totalWeight = 0.0;
+    PlayerArray<double> averageExpectedValues = { 0.0, 0.0 };
+    std::vector<std::string> rootActionNames;
+    std::vector<double> averageRootActionFrequencies;
+    for (int flopIndex = 0; flopIndex < numFlops; ++flopIndex) {
+        const FlopResult& result = results[flopIndex];
+        if (!result.error.empty()) continue;
+
+        if (numSolvedFlops == 0) {
+            rootActionNames = result.rootActionNames;
+            averageRootActionFrequencies.assign(rootActionNames.size(), 0.0);
+        }
+        assert(result.rootActionNames == rootActionNames);
+        ++numSolvedFlops;
+
+        double weight = flops[flopIndex].numFlops;
+        totalWeight += weight;
+        for (Player player : { Player::P0, Player::P1 }) {
+            averageExpectedValues[player] += weight * result.expectedValues[player];
+        }
+        for (std::size_t action = 0; action < rootActionNames.size(); ++action) {
+            averageRootActionFrequencies[action] += weight * result.rootActionFrequencies[action];
+        }
+    }
+
+    double secondsElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "Solved " << numSolvedFlops << " of " << numFlops << " flops in " << formatFixedPoint(secondsElapsed, 3) << "s.\n";
+
+    if (numSolvedFlops > 0) {
+        std::cout << "Weighted average: OOP EV " << formatFixedPoint(averageExpectedValues[Player::P0] / totalWeight, 5)
+            << ", IP EV " << formatFixedPoint(averageExpectedValues[Player::P1] / totalWeight, 5);
+        for (std::size_t action = 0; action < rootActionNames.size(); ++action) {
+            std::cout << ", " << rootActionNames[action] << " " << formatFixedPoint((averageRootActionFrequencies[action] / totalWeight) * 100.0, 3) << "%";
+        }
+        std::cout << "\n";
+    }
+
+    if (!writeAggregateReport(manifest.outputPath, flops, results, rootActionNames)) {
+        std::cerr << "Error: Could not write aggregate report to " << manifest.outputPath.string() << ".\n";
+        return false;
+    }
+    std::cout << "Wrote report to " << manifest.outputPath.string() << ".\n";
+
+    return numSolvedFlops == numFlops;
+}
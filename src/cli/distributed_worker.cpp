@@ -0,0 +1,69 @@
+#include "cli/distributed_worker.hpp"
+
+#include "cli/settings_file.hpp"
+#include "game/holdem/holdem.hpp"
+#include "solver/distributed.hpp"
+#include "solver/tree.hpp"
+#include "util/result.hpp"
+#include "util/scoped_timer.hpp"
+#include "util/tcp_socket.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+
+bool runDistributedWorker(const std::string& settingsPath, std::uint16_t port) {
+    std::optional<HoldemSettingsFile> settingsFile = loadHoldemSettingsFile(settingsPath);
+    if (!settingsFile) {
+        return false;
+    }
+    const SolverSettings& solverSettings = settingsFile->solverSettings;
+
+    std::optional<Holdem> rules;
+    {
+        ScopedTimer timer{ "Building Holdem lookup tables...", "Finished building lookup tables" };
+        rules.emplace(settingsFile->gameSettings);
+    }
+
+    Tree tree{ solverSettings.useTrainingDataCompression };
+    {
+        ScopedTimer timer{ "Building tree skeleton...", "Finished building tree skeleton" };
+        tree.buildTreeSkeleton(*rules, solverSettings.numThreads);
+    }
+
+    tree.setTrainingDataHugePages(solverSettings.useHugePages);
+    if (!solverSettings.trainingDataDirectory.empty() && !tree.setTrainingDataDirectory(solverSettings.trainingDataDirectory)) {
+        std::cerr << "Error: Could not create training data files in " << solverSettings.trainingDataDirectory << ".\n";
+        return false;
+    }
+
+    Result<TcpListener> listenerResult = TcpListener::listen(port);
+    if (listenerResult.isError()) {
+        std::cerr << listenerResult.getError() << "\n";
+        return false;
+    }
+    TcpListener& listener = listenerResult.getValue();
+
+    while (true) {
+        std::cout << "\nWaiting for a coordinator on port " << port << "...\n" << std::flush;
+        Result<TcpConnection> connectionResult = listener.accept();
+        if (connectionResult.isError()) {
+            std::cerr << connectionResult.getError() << "\n";
+            continue;
+        }
+
+        std::cout << "Coordinator connected, serving subtrees with " << solverSettings.numThreads << " threads.\n" << std::flush;
+        Result<WorkerSessionEnd> sessionResult = serveCoordinator(*rules, tree, solverSettings.numThreads, connectionResult.getValue());
+        if (sessionResult.isError()) {
+            std::cerr << sessionResult.getError() << "\n";
+            continue;
+        }
+
+        if (sessionResult.getValue() == WorkerSessionEnd::Shutdown) {
+            std::cout << "Shut down by the coordinator.\n";
+            return true;
+        }
+        std::cout << "Coordinator finished its solve.\n";
+    }
+}
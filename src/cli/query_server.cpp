@@ -0,0 +1,664 @@
+#include "cli/query_server.hpp"
+
+#include "cli/settings_file.hpp"
+#include "game/game_types.hpp"
+#include "game/game_utils.hpp"
+#include "game/holdem/holdem.hpp"
+#include "solver/node_path.hpp"
+#include "solver/tree.hpp"
+#include "util/result.hpp"
+#include "util/scoped_silent_output.hpp"
+#include "util/string_utils.hpp"
+#include "util/tcp_socket.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+namespace {
+// Requests are a request line and a few headers, anything longer is not a strategy query
+static constexpr std::size_t MaxRequestHeadSize = 16 * 1024;
+
+// Idle keep-alive connections are closed after this long so they cannot hold on to every serving thread
+static constexpr std::chrono::seconds IdleConnectionTimeout{ 30 };
+
+struct SolutionFiles {
+    std::string name;
+    std::filesystem::path settingsPath;
+    std::filesystem::path treePath;
+};
+
+struct ServerManifest {
+    std::uint16_t port;
+    int numThreads;
+    std::size_t memoryBudget;
+    std::vector<SolutionFiles> solutions;
+};
+
+// Rules and tree of a saved solution, which are never modified once loaded, so requests can read them without locks
+struct LoadedSolution {
+    std::unique_ptr<Holdem> rules;
+    std::unique_ptr<Tree> tree;
+    std::size_t memorySize;
+};
+
+// Relative paths in the manifest are relative to the directory of the manifest
+std::filesystem::path resolvePath(const std::filesystem::path& manifestDirectory, const std::string& path) {
+    std::filesystem::path resolvedPath{ path };
+    return resolvedPath.is_absolute() ? resolvedPath : manifestDirectory / resolvedPath;
+}
+
+std::optional<ServerManifest> loadManifest(const std::string& manifestPath) {
+    YAML::Node input;
+    try {
+        input = YAML::LoadFile(manifestPath);
+    }
+    catch (const YAML::Exception&) {
+        std::cerr << "Error: Could not load server manifest. Invalid file name: " << manifestPath << "\n";
+        return std::nullopt;
+    }
+
+    std::filesystem::path manifestDirectory = std::filesystem::path{ manifestPath }.parent_path();
+    ServerManifest manifest;
+    int port;
+    int memoryBudgetMegabytes;
+    try {
+        port = input["port"] ? input["port"].as<int>() : 8080;
+        manifest.numThreads = input["threads"] ? input["threads"].as<int>() : static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+        memoryBudgetMegabytes = input["memory-budget-mb"] ? input["memory-budget-mb"].as<int>() : 4096;
+
+        for (const YAML::Node& solution : input["solutions"]) {
+            manifest.solutions.push_back({
+                .name = solution["name"].as<std::string>(),
+                .settingsPath = resolvePath(manifestDirectory, solution["settings"].as<std::string>()),
+                .treePath = resolvePath(manifestDirectory, solution["tree"].as<std::string>()),
+            });
+        }
+    }
+    catch (const YAML::Exception&) {
+        std::cerr << "Error: Invalid server manifest " << manifestPath << ".\n";
+        return std::nullopt;
+    }
+
+    if (manifest.solutions.empty()) {
+        std::cerr << "Error: The server manifest does not list any solutions.\n";
+        return std::nullopt;
+    }
+
+    if (port < 0 || port > std::numeric_limits<std::uint16_t>::max()) {
+        std::cerr << "Error: Invalid port " << port << ".\n";
+        return std::nullopt;
+    }
+
+    if (manifest.numThreads < 1 || memoryBudgetMegabytes < 1) {
+        std::cerr << "Error: threads and memory-budget-mb must be at least 1.\n";
+        return std::nullopt;
+    }
+
+    manifest.port = static_cast<std::uint16_t>(port);
+    manifest.memoryBudget = static_cast<std::size_t>(memoryBudgetMegabytes) * 1024 * 1024;
+    return manifest;
+}
+
+// Holds the solutions that were requested most recently, as long as their total size fits in the memory budget
+// A solution that is unloaded stays alive until the requests that are reading it finish
+class SolutionCache {
+public:
+    SolutionCache(std::size_t memoryBudget) : m_memoryBudget{ memoryBudget }, m_numUses{ 0 }, m_usedMemory{ 0 } {}
+
+    // Loads every settings file before serving starts, so that a typo does not surface on the first request for that solution
+    bool addSolution(const SolutionFiles& files) {
+        std::optional<HoldemSettingsFile> settingsFile;
+        {
+            ScopedSilentOutput silentOutput;
+            settingsFile = loadHoldemSettingsFile(files.settingsPath.string());
+        }
+        if (!settingsFile) {
+            std::cerr << "Error: Could not load settings " << files.settingsPath.string() << " of solution " << files.name << ".\n";
+            return false;
+        }
+
+        auto [entryIt, isNewEntry] = m_entries.try_emplace(files.name);
+        if (!isNewEntry) {
+            std::cerr << "Error: More than one solution is named " << files.name << ".\n";
+            return false;
+        }
+
+        Entry& entry = entryIt->second;
+        entry.gameSettings = settingsFile->gameSettings;
+        entry.treePath = files.treePath;
+        return true;
+    }
+
+    Result<std::shared_ptr<const LoadedSolution>> getSolution(const std::string& name) {
+        auto entryIt = m_entries.find(name);
+        if (entryIt == m_entries.end()) {
+            return "Error: Unknown solution " + name + ".";
+        }
+        Entry& entry = entryIt->second;
+
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            if (entry.solution) {
+                entry.lastUse = ++m_numUses;
+                return std::shared_ptr<const LoadedSolution>{ entry.solution };
+            }
+        }
+
+        // Requests for the same solution wait here for the first one to load it, requests for other solutions are not blocked
+        std::lock_guard<std::mutex> loadLock{ entry.loadMutex };
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            if (entry.solution) {
+                entry.lastUse = ++m_numUses;
+                return std::shared_ptr<const LoadedSolution>{ entry.solution };
+            }
+        }
+
+        Result<std::shared_ptr<const LoadedSolution>> loadResult = loadSolution(entry);
+        if (loadResult.isError()) {
+            return loadResult;
+        }
+
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        entry.solution = loadResult.getValue();
+        entry.lastUse = ++m_numUses;
+        m_usedMemory += entry.solution->memorySize;
+        evictLeastRecentlyUsed(entry);
+        std::cout << "Loaded solution " << name << " (" << formatBytes(entry.solution->memorySize) << ", "
+            << formatBytes(m_usedMemory) << " of " << formatBytes(m_memoryBudget) << " in use).\n" << std::flush;
+        return std::shared_ptr<const LoadedSolution>{ entry.solution };
+    }
+
+    std::vector<std::pair<std::string, bool>> getSolutionNames() const {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        std::vector<std::pair<std::string, bool>> names;
+        for (const auto& [name, entry] : m_entries) {
+            names.emplace_back(name, entry.solution != nullptr);
+        }
+        return names;
+    }
+
+private:
+    struct Entry {
+        Holdem::Settings gameSettings;
+        std::filesystem::path treePath;
+
+        std::mutex loadMutex;
+        std::shared_ptr<const LoadedSolution> solution;
+        std::uint64_t lastUse = 0;
+    };
+
+    static Result<std::shared_ptr<const LoadedSolution>> loadSolution(const Entry& entry) {
+        static constexpr bool UseMemoryMapping = true;
+
+        auto rules = std::make_unique<Holdem>(entry.gameSettings);
+        Result<std::unique_ptr<Tree>> treeResult = Tree::loadFromFile(*rules, entry.treePath, UseMemoryMapping);
+        if (treeResult.isError()) {
+            return treeResult.getError();
+        }
+
+        std::unique_ptr<Tree>& tree = treeResult.getValue();
+        std::size_t memorySize = rules->getHandTablesSize()
+            + tree->getTreeSkeletonSize()
+            + tree->getStrategySums().size_bytes()
+            + tree->getCompressedStrategySums().size_bytes()
+            + tree->getStrategySumScales().size_bytes();
+
+        return std::shared_ptr<const LoadedSolution>{ new LoadedSolution{ std::move(rules), std::move(tree), memorySize } };
+    }
+
+    // The solution that was just loaded is kept even if it alone is over the budget
+    void evictLeastRecentlyUsed(const Entry& newestEntry) {
+        while (m_usedMemory > m_memoryBudget) {
+            Entry* oldestEntry = nullptr;
+            for (auto& [name, entry] : m_entries) {
+                if (!entry.solution || (&entry == &newestEntry)) continue;
+                if (!oldestEntry || (entry.lastUse < oldestEntry->lastUse)) {
+                    oldestEntry = &entry;
+                }
+            }
+            if (!oldestEntry) return;
+
+            m_usedMemory -= oldestEntry->solution->memorySize;
+            oldestEntry->solution = nullptr;
+        }
+    }
+
+    // Entries are only added before serving starts, so the map itself is never modified while requests read it
+    std::map<std::string, Entry> m_entries;
+    std::size_t m_memoryBudget;
+
+    // Guards the loaded solutions and their use counters
+    mutable std::mutex m_mutex;
+    std::uint64_t m_numUses;
+    std::size_t m_usedMemory;
+};
+
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::map<std::string, std::string> queryParameters;
+    bool keepAlive;
+};
+
+struct HttpResponse {
+    int status;
+    std::string body;
+};
+
+std::string getStatusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 431: return "Request Header Fields Too Large";
+        default: return "Internal Server Error";
+    }
+}
+
+std::string decodeUrlComponent(std::string_view component) {
+    auto getHexDigit = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+
+    std::string decoded;
+    for (std::size_t i = 0; i < component.size(); ++i) {
+        if (component[i] == '+') {
+            decoded += ' ';
+        }
+        else if ((component[i] == '%') && (i + 2 < component.size()) && (getHexDigit(component[i + 1]) >= 0) && (getHexDigit(component[i + 2]) >= 0)) {
+            decoded += static_cast<char>((getHexDigit(component[i + 1]) << 4) | getHexDigit(component[i + 2]));
+            i += 2;
+        }
+        else {
+            decoded += component[i];
+        }
+    }
+    return decoded;
+}
+
+std::map<std::string, std::string> parseQueryParameters(std::string_view query) {
+    std::map<std::string, std::string> parameters;
+    for (const std::string& parameter : parseTokens(std::string{ query }, '&')) {
+        std::size_t separator = parameter.find('=');
+        std::string_view parameterView{ parameter };
+        if (separator == std::string::npos) {
+            parameters[decodeUrlComponent(parameterView)] = "";
+        }
+        else {
+            parameters[decodeUrlComponent(parameterView.substr(0, separator))] = decodeUrlComponent(parameterView.substr(separator + 1));
+        }
+    }
+    return parameters;
+}
+
+// Reads the next request head from the connection, keeping any bytes of a pipelined request after it in the buffer
+// Returns std::nullopt if the connection was closed, and a request with an empty method if the head is malformed or too long
+std::optional<HttpRequest> readRequest(TcpConnection& connection, std::string& buffer) {
+    std::size_t headEnd;
+    while ((headEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (buffer.size() > MaxRequestHeadSize) {
+            return HttpRequest{ .method = {}, .path = {}, .queryParameters = {}, .keepAlive = false };
+        }
+
+        std::byte received[4096];
+        std::size_t numReceived = connection.receiveAvailableBytes(received);
+        if (numReceived == 0) return std::nullopt;
+        buffer.append(reinterpret_cast<const char*>(received), numReceived);
+    }
+
+    std::string head = buffer.substr(0, headEnd);
+    buffer.erase(0, headEnd + 4);
+
+    std::vector<std::string> lines = parseTokens(head, '\n');
+    std::vector<std::string> requestLine = lines.empty() ? std::vector<std::string>{} : parseTokens(trim(lines[0]), ' ');
+    if (requestLine.size() != 3) {
+        return HttpRequest{ .method = {}, .path = {}, .queryParameters = {}, .keepAlive = false };
+    }
+
+    HttpRequest request;
+    request.method = requestLine[0];
+    request.keepAlive = (requestLine[2] == "HTTP/1.1");
+
+    std::string_view target{ requestLine[1] };
+    std::size_t queryStart = target.find('?');
+    request.path = decodeUrlComponent(target.substr(0, queryStart));
+    if (queryStart != std::string_view::npos) {
+        request.queryParameters = parseQueryParameters(target.substr(queryStart + 1));
+    }
+
+    for (std::size_t i = 1; i < lines.size(); ++i) {
+        std::string line = trim(lines[i]);
+        std::size_t separator = line.find(':');
+        if (separator == std::string::npos) continue;
+
+        std::string name = trim(line.substr(0, separator));
+        std::string value = trim(line.substr(separator + 1));
+        for (char& c : name) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        for (char& c : value) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (name == "connection") {
+            request.keepAlive = (value == "keep-alive") || (request.keepAlive && (value != "close"));
+        }
+    }
+
+    return request;
+}
+
+bool sendResponse(TcpConnection& connection, const HttpResponse& response, bool keepAlive) {
+    std::string head = "HTTP/1.1 " + std::to_string(response.status) + " " + getStatusText(response.status) + "\r\n"
+        + "Content-Type: application/json\r\n"
+        + "Content-Length: " + std::to_string(response.body.size()) + "\r\n"
+        + "Connection: " + (keepAlive ? "keep-alive" : "close") + "\r\n\r\n";
+
+    return connection.sendBytes(std::as_bytes(std::span<const char>{ head }))
+        && connection.sendBytes(std::as_bytes(std::span<const char>{ response.body }));
+}
+
+void appendJsonString(std::string& output, std::string_view value) {
+    output += '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': output += "\\\""; break;
+            case '\\': output += "\\\\"; break;
+            case '\n': output += "\\n"; break;
+            case '\r': output += "\\r"; break;
+            case '\t': output += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+                    output += escaped;
+                }
+                else {
+                    output += c;
+                }
+        }
+    }
+    output += '"';
+}
+
+void appendJsonFloat(std::string& output, float value) {
+    char formatted[32];
+    std::snprintf(formatted, sizeof(formatted), "%.6g", static_cast<double>(value));
+    output += formatted;
+}
+
+template <typename T, typename AppendFunction>
+void appendJsonArray(std::string& output, const std::vector<T>& values, AppendFunction appendValue) {
+    output += '[';
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) output += ',';
+        appendValue(output, values[i]);
+    }
+    output += ']';
+}
+
+HttpResponse makeErrorResponse(int status, std::string_view error) {
+    std::string body = "{\"error\":";
+    appendJsonString(body, error);
+    body += '}';
+    return { status, body };
+}
+
+std::string getNodeTypeName(NodeType nodeType) {
+    switch (nodeType) {
+        case NodeType::Chance:
+            return "chance";
+        case NodeType::Decision:
+            return "decision";
+        case NodeType::Fold:
+            return "fold";
+        case NodeType::Showdown:
+            return "showdown";
+        case NodeType::AllInRunout:
+            return "all-in-runout";
+        default:
+            assert(false);
+            return "???";
+    }
+}
+
+std::string getHandName(CardSet hand) {
+    return join(getCardSetNames(hand), "");
+}
+
+// GET /node?solution=<name>&path=<steps>, where the steps are action ids and dealt cards separated by commas, e.g. path=1,0,Kh,2
+HttpResponse handleNodeQuery(SolutionCache& cache, const HttpRequest& request) {
+    auto solutionIt = request.queryParameters.find("solution");
+    if (solutionIt == request.queryParameters.end()) {
+        return makeErrorResponse(400, "Error: Missing solution parameter.");
+    }
+
+    Result<std::shared_ptr<const LoadedSolution>> solutionResult = cache.getSolution(solutionIt->second);
+    if (solutionResult.isError()) {
+        return makeErrorResponse(404, solutionResult.getError());
+    }
+    const Holdem& rules = *solutionResult.getValue()->rules;
+    const Tree& tree = *solutionResult.getValue()->tree;
+
+    auto pathIt = request.queryParameters.find("path");
+    std::vector<std::string> steps;
+    if (pathIt != request.queryParameters.end()) {
+        for (const std::string& step : parseTokens(pathIt->second, ',')) {
+            std::string trimmedStep = trim(step);
+            if (!trimmedStep.empty()) {
+                steps.push_back(trimmedStep);
+            }
+        }
+    }
+
+    Result<std::vector<NodeInfo>> nodePathResult = resolveNodePath(tree, steps);
+    if (nodePathResult.isError()) {
+        return makeErrorResponse(400, nodePathResult.getError());
+    }
+    const std::vector<NodeInfo>& nodePath = nodePathResult.getValue();
+
+    std::size_t nodeIndex = nodePath.back().index;
+    const Node& node = tree.allNodes[nodeIndex];
+    GameState state = tree.getNodeState(nodeIndex);
+
+    std::string body = "{\"node\":" + std::to_string(nodeIndex) + ",\"type\":";
+    appendJsonString(body, getNodeTypeName(node.nodeType));
+    body += ",\"board\":";
+    appendJsonArray(body, getNodePathBoard(rules, tree, nodePath), [](std::string& output, CardID card) {
+        appendJsonString(output, getNameFromCardID(card));
+    });
+    body += ",\"wagers\":[" + std::to_string(state.totalWagers[Player::P0]) + "," + std::to_string(state.totalWagers[Player::P1]) + "]";
+    body += ",\"pot\":" + std::to_string(state.totalWagers[Player::P0] + state.totalWagers[Player::P1] + tree.deadMoney);
+
+    switch (node.nodeType) {
+        case NodeType::Chance: {
+            // Available cards are stored in the suits of the tree, so an earlier suit swap is undone to name them in the suits of the board
+            std::optional<SuitMapping> earlierSwapList;
+            for (const auto& [index, swapList] : nodePath) {
+                if (swapList) earlierSwapList = swapList;
+            }
+
+            std::vector<CardID> cards;
+            CardSet availableCards = tree.allChanceNodeDetails[node.chanceNodeIndex].availableCards;
+            while (availableCards != 0) {
+                CardID card = popLowestCardFromSet(availableCards);
+                cards.push_back(earlierSwapList ? swapCardSuits(card, earlierSwapList->child, earlierSwapList->parent) : card);
+            }
+
+            body += ",\"cards\":";
+            appendJsonArray(body, cards, [](std::string& output, CardID card) {
+                appendJsonString(output, getNameFromCardID(card));
+            });
+            break;
+        }
+
+        case NodeType::Decision: {
+            static constexpr PlayerArray<std::string_view> PlayerNames = { "OOP", "IP" };
+
+            std::vector<std::string> actionNames;
+            for (int action = 0; action < node.numChildren; ++action) {
+                actionNames.push_back(getActionName(rules, tree, nodeIndex, action));
+            }
+
+            body += ",\"player\":";
+            appendJsonString(body, PlayerNames[node.playerToAct]);
+            body += ",\"actions\":";
+            appendJsonArray(body, actionNames, [](std::string& output, const std::string& actionName) {
+                appendJsonString(output, actionName);
+            });
+
+            // Hands blocked by the board are left out
+            NodePathRangeStrategy rangeStrategy = getNodePathRangeStrategy(rules, tree, nodePath);
+            const auto rangeHands = rules.getRangeHands(rangeStrategy.player);
+            std::size_t rangeSize = rangeHands.size();
+
+            body += ",\"strategy\":{";
+            bool isFirstHand = true;
+            for (std::size_t hand = 0; hand < rangeSize; ++hand) {
+                if (rangeStrategy.range.handIndices[hand] == -1) continue;
+
+                if (!isFirstHand) body += ',';
+                isFirstHand = false;
+
+                appendJsonString(body, getHandName(rangeHands[hand]));
+                body += ":[";
+                for (int action = 0; action < rangeStrategy.numActions; ++action) {
+                    if (action > 0) body += ',';
+                    appendJsonFloat(body, rangeStrategy.strategy[action * rangeSize + hand]);
+                }
+                body += ']';
+            }
+            body += '}';
+
+            body += ",\"weights\":{";
+            isFirstHand = true;
+            for (std::size_t hand = 0; hand < rangeSize; ++hand) {
+                if (rangeStrategy.range.handIndices[hand] == -1) continue;
+
+                if (!isFirstHand) body += ',';
+                isFirstHand = false;
+
+                appendJsonString(body, getHandName(rangeHands[hand]));
+                body += ':';
+                appendJsonFloat(body, rangeStrategy.range.reachWeights[hand]);
+            }
+            body += '}';
+            break;
+        }
+
+        case NodeType::Fold:
+        case NodeType::Showdown:
+        case NodeType::AllInRunout:
+            break;
+
+        default:
+            assert(false);
+            break;
+    }
+
+    body += '}';
+    return { 200, body };
+}
+
+HttpResponse handleSolutionsQuery(const SolutionCache& cache) {
+    std::string body = "{\"solutions\":";
+    appendJsonArray(body, cache.getSolutionNames(), [](std::string& output, const std::pair<std::string, bool>& solution) {
+        output += "{\"name\":";
+        appendJsonString(output, solution.first);
+        output += solution.second ? ",\"loaded\":true}" : ",\"loaded\":false}";
+    });
+    body += '}';
+    return { 200, body };
+}
+
+HttpResponse handleRequest(SolutionCache& cache, const HttpRequest& request) {
+    if (request.method != "GET") {
+        return makeErrorResponse(405, "Error: Only GET requests are supported.");
+    }
+
+    if (request.path == "/node") {
+        return handleNodeQuery(cache, request);
+    }
+    if (request.path == "/solutions") {
+        return handleSolutionsQuery(cache);
+    }
+    return makeErrorResponse(404, "Error: Unknown endpoint " + request.path + ".");
+}
+
+void serveConnection(SolutionCache& cache, TcpConnection& connection) {
+    if (!connection.setReceiveTimeout(IdleConnectionTimeout)) return;
+
+    std::string buffer;
+    while (true) {
+        std::optional<HttpRequest> request = readRequest(connection, buffer);
+        if (!request) return;
+
+        if (request->method.empty()) {
+            int status = (buffer.size() > MaxRequestHeadSize) ? 431 : 400;
+            sendResponse(connection, makeErrorResponse(status, "Error: Malformed request."), false);
+            return;
+        }
+
+        HttpResponse response = handleRequest(cache, *request);
+        if (!sendResponse(connection, response, request->keepAlive) || !request->keepAlive) return;
+    }
+}
+} // namespace
+
+bool runQueryServer(const std::string& manifestPath) {
+    std::optional<ServerManifest> manifestOption = loadManifest(manifestPath);
+    if (!manifestOption) return false;
+    const ServerManifest& manifest = *manifestOption;
+
+    SolutionCache cache{ manifest.memoryBudget };
+    for (const SolutionFiles& solution : manifest.solutions) {
+        if (!cache.addSolution(solution)) return false;
+    }
+
+    Result<TcpListener> listenerResult = TcpListener::listen(manifest.port, manifest.numThreads);
+    if (listenerResult.isError()) {
+        std::cerr << listenerResult.getError() << "\n";
+        return false;
+    }
+    TcpListener& listener = listenerResult.getValue();
+
+    std::cout << "Serving " << manifest.solutions.size() << " solutions on port " << listener.getPort() << " with "
+        << manifest.numThreads << " threads and a memory budget of " << formatBytes(manifest.memoryBudget) << ".\n" << std::flush;
+
+    // Each thread serves one connection at a time
+    std::vector<std::thread> threads;
+    for (int i = 0; i < manifest.numThreads; ++i) {
+        threads.emplace_back([&cache, &listener]() {
+            while (true) {
+                Result<TcpConnection> connectionResult = listener.accept();
+                if (connectionResult.isError()) continue;
+                serveConnection(cache, connectionResult.getValue());
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    return true;
+}
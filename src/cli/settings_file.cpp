@@ -0,0 +1,272 @@
+#include "cli/settings_file.hpp"
+
+#include "game/game_types.hpp"
+#include "game/holdem/holdem_parser.hpp"
+#include "game/holdem/holdem.hpp"
+#include "solver/solver_session.hpp"
+#include "util/fixed_vector.hpp"
+#include "util/result.hpp"
+#include "util/string_utils.hpp"
+#include "util/thread_count.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+namespace {
+template <typename T>
+bool loadField(T& field, const YAML::Node& node, const std::vector<std::string>& indices, int depth) {
+    if (!node.IsDefined() || node.IsNull()) {
+        return false;
+    }
+
+    if (depth == indices.size()) {
+        try {
+            field = node.as<T>();
+            std::cout << "Successfully loaded field " << join(indices, "::") << ".\n";
+            return true;
+        }
+        catch (const YAML::Exception&) {
+            return false;
+        }
+    }
+
+    return loadField(field, node[indices[depth]], indices, depth + 1);
+}
+
+template <typename T>
+bool loadRequiredField(T& field, const YAML::Node& root, const std::vector<std::string>& indices) {
+    bool success = loadField(field, root, indices, 0);
+    if (!success) {
+        std::cerr << "Error: Could not load field " << join(indices, "::") << ".\n";
+        return false;
+    }
+
+    return true;
+}
+
+template <typename T>
+void loadOptionalField(T& field, const YAML::Node& root, const std::vector<std::string>& indices, const T& defaultValue) {
+    bool success = loadField(field, root, indices, 0);
+    if (!success) {
+        std::cout << "Could not load field " << join(indices, "::") << ", using default.\n";
+        field = defaultValue;
+    }
+}
+
+void loadOptionalIntWithBounds(int& field, const YAML::Node& root, const std::vector<std::string>& indices, int defaultValue, std::optional<int> lowerBound, std::optional<int> upperBound) {
+    if (lowerBound) {
+        assert(defaultValue >= *lowerBound);
+    }
+    if (upperBound) {
+        assert(defaultValue <= *upperBound);
+    }
+
+    loadOptionalField<int>(field, root, indices, defaultValue);
+
+    bool belowLowerBound = lowerBound && (field < *lowerBound);
+    bool aboveUpperBound = upperBound && (field > *upperBound);
+
+    if (belowLowerBound || aboveUpperBound) {
+        field = defaultValue;
+
+        std::cout << "Value provided for field " << join(indices, "::") << " was ";
+        if (belowLowerBound) {
+            std::cout << "below the minimum value of " << *lowerBound << ",";
+        }
+        else {
+            std::cout << "above the maximum value of " << *upperBound << ",";
+        }
+        std::cout << " using default.\n";
+    }
+}
+
+template <typename T, std::size_t Capacity>
+bool fillFixedVector(FixedVector<T, Capacity>& fixedVec, const std::vector<T>& vec) {
+    if (vec.size() > Capacity) {
+        return false;
+    }
+
+    for (const T& elem : vec) {
+        fixedVec.pushBack(elem);
+    }
+    return true;
+}
+} // namespace
+
+std::optional<HoldemSettingsFile> loadHoldemSettingsFile(const std::string& filePath) {
+    YAML::Node input;
+    try {
+        input = YAML::LoadFile(filePath);
+    }
+    catch (const YAML::Exception&) {
+        std::cerr << "Error: Could not load settings file. Invalid file name: " << filePath << "\n";
+        return std::nullopt;
+    }
+
+    std::cout << "Loading Holdem settings from " << filePath << ":\n";
+
+    static constexpr PlayerArray<std::string> playerNames = { "oop", "ip" };
+    static constexpr StreetArray<std::string> streetNames = { "flop", "turn", "river" };
+
+    HoldemSettingsFile settingsFile;
+    Holdem::Settings& settings = settingsFile.gameSettings;
+    SolverSettings& solverSettings = settingsFile.solverSettings;
+
+    // Load board
+    std::string boardString;
+    if (!loadRequiredField(boardString, input, { "board" })) {
+        return std::nullopt;
+    }
+    Result<CardSet> boardResult = buildCommunityCardsFromString(boardString);
+    if (boardResult.isError()) {
+        std::cerr << boardResult.getError() << "\n";
+        return std::nullopt;
+    }
+    settings.startingCommunityCards = boardResult.getValue();
+
+    // Load ranges
+    for (Player player : { Player::P0, Player::P1 }) {
+        std::string rangeString;
+        if (!loadRequiredField(rangeString, input, { "ranges", playerNames[player] })) {
+            return std::nullopt;
+        }
+        Result<Holdem::Range> rangeResult = buildRangeFromString(rangeString, settings.startingCommunityCards);
+        if (rangeResult.isError()) {
+            std::cerr << rangeResult.getError() << "\n";
+            return std::nullopt;
+        }
+        settings.ranges[player] = rangeResult.getValue();
+
+        Result<Holdem::Range> fullRangeResult = buildRangeFromString(rangeString);
+        if (fullRangeResult.isError()) {
+            std::cerr << fullRangeResult.getError() << "\n";
+            return std::nullopt;
+        }
+        settingsFile.fullRanges[player] = fullRangeResult.getValue();
+    }
+
+    // Tree settings
+    // Load bet and raise sizes
+    for (Player player : { Player::P0, Player::P1 }) {
+        for (Street street : { Street::Flop, Street::Turn, Street::River }) {
+            {
+                std::vector<int> betSizesVector;
+                loadOptionalField(betSizesVector, input, { "tree", "actions", playerNames[player], streetNames[street], "bet-sizes" }, {});
+                if (!fillFixedVector(settings.betSizes[player][street], betSizesVector)) {
+                    std::cerr << "Error: Too many bet sizes provided for " << playerNames[player] << " " << streetNames[street] << ", maximum is " << holdem::MaxNumBetSizes << "\n.";
+                    return std::nullopt;
+                }
+            }
+
+            {
+                std::vector<int> raiseSizesVector;
+                loadOptionalField(raiseSizesVector, input, { "tree", "actions", playerNames[player], streetNames[street], "raise-sizes" }, {});
+                if (!fillFixedVector(settings.raiseSizes[player][street], raiseSizesVector)) {
+                    std::cerr << "Error: Too many raise sizes provided for " << playerNames[player] << " " << streetNames[street] << ", maximum is " << holdem::MaxNumRaiseSizes << "\n.";
+                    return std::nullopt;
+                }
+            }
+        }
+    }
+
+    // Load starting wager
+    if (!loadRequiredField(settings.startingPlayerWagers, input, { "tree", "starting-wager-per-player" })) {
+        return std::nullopt;
+    }
+    if (settings.startingPlayerWagers <= 0) {
+        std::cerr << "Error: Starting wager per player must be positive.\n";
+        return std::nullopt;
+    }
+
+    // Load effective stack
+    if (!loadRequiredField(settings.effectiveStackRemaining, input, { "tree", "effective-stack-remaining" })) {
+        return std::nullopt;
+    }
+    if (settings.effectiveStackRemaining <= 0) {
+        std::cerr << "Error: Effective stack must be positive.\n";
+        return std::nullopt;
+    }
+
+    // Load dead money
+    loadOptionalIntWithBounds(settings.deadMoney, input, { "tree", "dead-money-in-pot" }, 0, 0, std::nullopt);
+
+    // Load use isomorphism
+    loadOptionalField(settings.useChanceCardIsomorphism, input, { "tree", "use-isomorphism" }, true);
+
+    // Load all in runout expansion
+    loadOptionalField(settings.expandAllInRunouts, input, { "tree", "expand-all-in-runouts" }, false);
+
+    // Solver settings
+    // Load num threads
+    #ifdef _OPENMP
+    loadOptionalIntWithBounds(solverSettings.numThreads, input, { "solver", "threads" }, getMaxNumThreads(), 1, std::nullopt);
+    #else
+    solverSettings.numThreads = 1;
+    std::cout << "OpenMP was not found, using one thread.\n";
+    #endif
+    settings.numThreads = solverSettings.numThreads;
+
+    // Load target exploitability
+    loadOptionalField(solverSettings.targetPercentExploitability, input, { "solver", "target-exploitability" }, 0.3f);
+
+    // Load max iterations
+    loadOptionalIntWithBounds(solverSettings.maxIterations, input, { "solver", "max-iterations" }, 1000, 1, std::nullopt);
+
+    // Load exploitability check frequency
+    loadOptionalIntWithBounds(solverSettings.exploitabilityCheckFrequency, input, { "solver", "exploitability-check-frequency" }, 10, 1, std::nullopt);
+
+    // Load training data compression
+    loadOptionalField(solverSettings.useTrainingDataCompression, input, { "solver", "compress-training-data" }, false);
+
+    // Load pruning settings
+    loadOptionalField(solverSettings.usePruning, input, { "solver", "pruning" }, false);
+    loadOptionalIntWithBounds(solverSettings.pruningRevisitFrequency, input, { "solver", "pruning-revisit-frequency" }, 10, 1, std::nullopt);
+
+    // Load update schedule
+    loadOptionalField(solverSettings.useSimultaneousUpdates, input, { "solver", "simultaneous-updates" }, false);
+
+    // Load chance sampling settings
+    loadOptionalIntWithBounds(solverSettings.chanceSamplingIterations, input, { "solver", "chance-sampling-iterations" }, 0, 0, std::nullopt);
+    loadOptionalIntWithBounds(solverSettings.chanceSamplingCards, input, { "solver", "chance-sampling-cards" }, 8, 1, std::nullopt);
+
+    // Load checkpoint settings
+    loadOptionalField(solverSettings.checkpointFile, input, { "solver", "checkpoint-file" }, std::string{});
+    loadOptionalIntWithBounds(solverSettings.checkpointFrequency, input, { "solver", "checkpoint-frequency" }, 0, 0, std::nullopt);
+    loadOptionalIntWithBounds(solverSettings.checkpointIntervalMinutes, input, { "solver", "checkpoint-interval-minutes" }, 0, 0, std::nullopt);
+
+    // Load warm start file
+    loadOptionalField(solverSettings.warmStartFile, input, { "solver", "warm-start-file" }, std::string{});
+
+    // Load training data directory
+    loadOptionalField(solverSettings.trainingDataDirectory, input, { "solver", "training-data-directory" }, std::string{});
+    loadOptionalField(solverSettings.useHugePages, input, { "solver", "huge-pages" }, false);
+    loadOptionalField(solverSettings.distributedWorkers, input, { "solver", "distributed-workers" }, std::vector<std::string>{});
+
+    // Load hand table cache directory
+    loadOptionalField(settings.handTableCacheDirectory, input, { "solver", "hand-table-cache-directory" }, std::string{});
+
+    std::cout << "Successfully loaded Holdem settings.\n\n";
+
+    return settingsFile;
+}
+
+SolveSettings getSolveSettings(const SolverSettings& solverSettings) {
+    return {
+        .targetPercentExploitability = solverSettings.targetPercentExploitability,
+        .maxIterations = solverSettings.maxIterations,
+        .exploitabilityCheckFrequency = solverSettings.exploitabilityCheckFrequency,
+        .numThreads = solverSettings.numThreads,
+        .useTrainingDataCompression = solverSettings.useTrainingDataCompression,
+        .usePruning = solverSettings.usePruning,
+        .pruningRevisitFrequency = solverSettings.pruningRevisitFrequency,
+        .useSimultaneousUpdates = solverSettings.useSimultaneousUpdates,
+        .chanceSamplingIterations = solverSettings.chanceSamplingIterations,
+        .chanceSamplingCards = solverSettings.chanceSamplingCards
+    };
+}
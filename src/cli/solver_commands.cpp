@@ -1,6 +1,7 @@
 #include "cli/solver_commands.hpp"
 
 #include "cli/cli_dispatcher.hpp"
+#include "cli/settings_file.hpp"
 #include "game/game_rules.hpp"
 #include "game/game_types.hpp"
 #include "game/game_utils.hpp"
@@ -9,7 +10,14 @@
 #include "game/kuhn_poker.hpp"
 #include "game/leduc_poker.hpp"
 #include "solver/cfr.hpp"
+#include "solver/checkpoint_writer.hpp"
+#include "solver/distributed.hpp"
+#include "solver/node_path.hpp"
+#include "solver/solution_export.hpp"
+#include "solver/solver_session.hpp"
+#include "solver/traversal_profiler.hpp"
 #include "solver/tree.hpp"
+#include "solver/warm_start.hpp"
 #include "util/fixed_vector.hpp"
 #include "util/result.hpp"
 #include "util/scoped_timer.hpp"
@@ -18,14 +26,17 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
-#include <optional>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
-
-#include <yaml-cpp/yaml.h>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -40,14 +51,24 @@ void printInvalidContextError() {
     std::cerr << "Error: Game settings not loaded. Please run \"kuhn\", \"leduc\", or \"holdem <file>\" first.\n";
 }
 
+void printSetupStageTime(std::string_view stageName, double secondsElapsed) {
+    std::cout << "  " << stageName << ": " << formatFixedPoint(secondsElapsed, 3) << "s\n";
+}
+
 void buildTreeSkeletonIfNeeded(SolverContext& context) {
     assert(isContextValid(context));
 
     if (!context.tree->isTreeSkeletonBuilt()) {
         {
             ScopedTimer timer{ "Tree skeleton not yet built, building...", "Finished building tree skeleton" };
-            context.tree->buildTreeSkeleton(*context.rules);
+            context.tree->buildTreeSkeleton(*context.rules, context.numThreads);
         }
+
+        // The hand index tables and range weight are built alongside the nodes
+        const TreeSetupTimings& timings = context.tree->getSetupTimings();
+        printSetupStageTime("Nodes", timings.nodesSeconds);
+        printSetupStageTime("Hand index tables", timings.handIndexTablesSeconds);
+        printSetupStageTime("Range weight", timings.rangeWeightSeconds);
         std::cout << "\n";
     }
 
@@ -61,85 +82,6 @@ void printUnsolvedTreeError() {
     std::cerr << "Error: Tree must be solved first.\n";
 }
 
-template <typename T>
-bool loadField(T& field, const YAML::Node& node, const std::vector<std::string>& indices, int depth) {
-    if (!node.IsDefined() || node.IsNull()) {
-        return false;
-    }
-
-    if (depth == indices.size()) {
-        try {
-            field = node.as<T>();
-            std::cout << "Successfully loaded field " << join(indices, "::") << ".\n";
-            return true;
-        }
-        catch (const YAML::Exception&) {
-            return false;
-        }
-    }
-
-    return loadField(field, node[indices[depth]], indices, depth + 1);
-}
-
-template <typename T>
-bool loadRequiredField(T& field, const YAML::Node& root, const std::vector<std::string>& indices) {
-    bool success = loadField(field, root, indices, 0);
-    if (!success) {
-        std::cerr << "Error: Could not load field " << join(indices, "::") << ".\n";
-        return false;
-    }
-
-    return true;
-}
-
-template <typename T>
-void loadOptionalField(T& field, const YAML::Node& root, const std::vector<std::string>& indices, const T& defaultValue) {
-    bool success = loadField(field, root, indices, 0);
-    if (!success) {
-        std::cout << "Could not load field " << join(indices, "::") << ", using default.\n";
-        field = defaultValue;
-    }
-}
-
-void loadOptionalIntWithBounds(int& field, const YAML::Node& root, const std::vector<std::string>& indices, int defaultValue, std::optional<int> lowerBound, std::optional<int> upperBound) {
-    if (lowerBound) {
-        assert(defaultValue >= *lowerBound);
-    }
-    if (upperBound) {
-        assert(defaultValue <= *upperBound);
-    }
-
-    loadOptionalField<int>(field, root, indices, defaultValue);
-
-    bool belowLowerBound = lowerBound && (field < *lowerBound);
-    bool aboveUpperBound = upperBound && (field > *upperBound);
-
-    if (belowLowerBound || aboveUpperBound) {
-        field = defaultValue;
-
-        std::cout << "Value provided for field " << join(indices, "::") << " was ";
-        if (belowLowerBound) {
-            std::cout << "below the minimum value of " << *lowerBound << ",";
-        }
-        else {
-            std::cout << "above the maximum value of " << *upperBound << ",";
-        }
-        std::cout << " using default.\n";
-    }
-}
-
-template <typename T, std::size_t Capacity>
-bool fillFixedVector(FixedVector<T, Capacity>& fixedVec, const std::vector<T>& vec) {
-    if (vec.size() > Capacity) {
-        return false;
-    }
-
-    for (const T& elem : vec) {
-        fixedVec.pushBack(elem);
-    }
-    return true;
-}
-
 std::string removeOuterQuotes(const std::string& input) {
     int inputSize = input.size();
     if (inputSize < 2) {
@@ -155,127 +97,48 @@ std::string removeOuterQuotes(const std::string& input) {
 }
 
 bool handleSetupHoldem(SolverContext& context, const std::string& argument) {
-    std::string filePath = removeOuterQuotes(argument);
-
-    YAML::Node input;
-    try {
-        input = YAML::LoadFile(filePath);
-    }
-    catch (const YAML::Exception&) {
-        std::cerr << "Error: Could not load settings file. Invalid file name: " << filePath << "\n";
+    std::optional<HoldemSettingsFile> settingsFile = loadHoldemSettingsFile(removeOuterQuotes(argument));
+    if (!settingsFile) {
         return false;
     }
 
-    std::cout << "Loading Holdem settings from " << filePath << ":\n";
-
-    static constexpr PlayerArray<std::string> playerNames = { "oop", "ip" };
-    static constexpr StreetArray<std::string> streetNames = { "flop", "turn", "river" };
+    const SolverSettings& solverSettings = settingsFile->solverSettings;
+    context.numThreads = solverSettings.numThreads;
+    context.targetPercentExploitability = solverSettings.targetPercentExploitability;
+    context.maxIterations = solverSettings.maxIterations;
+    context.exploitabilityCheckFrequency = solverSettings.exploitabilityCheckFrequency;
+    context.usePruning = solverSettings.usePruning;
+    context.pruningRevisitFrequency = solverSettings.pruningRevisitFrequency;
+    context.useSimultaneousUpdates = solverSettings.useSimultaneousUpdates;
+    context.chanceSamplingIterations = solverSettings.chanceSamplingIterations;
+    context.chanceSamplingCards = solverSettings.chanceSamplingCards;
+    context.checkpointFile = solverSettings.checkpointFile;
+    context.checkpointFrequency = solverSettings.checkpointFrequency;
+    context.checkpointIntervalMinutes = solverSettings.checkpointIntervalMinutes;
+    context.warmStartFile = solverSettings.warmStartFile;
+    context.trainingDataDirectory = solverSettings.trainingDataDirectory;
+    context.useHugePages = solverSettings.useHugePages;
+    context.distributedWorkers = solverSettings.distributedWorkers;
 
-    Holdem::Settings settings;
-
-    // Load board
-    std::string boardString;
-    if (!loadRequiredField(boardString, input, { "board" })) {
-        return false;
-    }
-    Result<CardSet> boardResult = buildCommunityCardsFromString(boardString);
-    if (boardResult.isError()) {
-        std::cerr << boardResult.getError() << "\n";
-        return false;
-    }
-    settings.startingCommunityCards = boardResult.getValue();
-
-    // Load ranges
-    for (Player player : { Player::P0, Player::P1 }) {
-        std::string rangeString;
-        if (!loadRequiredField(rangeString, input, { "ranges", playerNames[player] })) {
-            return false;
-        }
-        Result<Holdem::Range> rangeResult = buildRangeFromString(rangeString, settings.startingCommunityCards);
-        if (rangeResult.isError()) {
-            std::cerr << rangeResult.getError() << "\n";
-            return false;
+    {
+        ScopedTimer timer{ "Building Holdem lookup tables...", "Finished building lookup tables" };
+        auto holdemRules = std::make_unique<Holdem>(settingsFile->gameSettings);
+        if (holdemRules->wereHandTablesLoadedFromCache()) {
+            std::cout << "Loaded hand tables from cache.\n";
         }
-        settings.ranges[player] = rangeResult.getValue();
-    }
-
-    // Tree settings
-    // Load bet and raise sizes
-    for (Player player : { Player::P0, Player::P1 }) {
-        for (Street street : { Street::Flop, Street::Turn, Street::River }) {
-            {
-                std::vector<int> betSizesVector;
-                loadOptionalField(betSizesVector, input, { "tree", "actions", playerNames[player], streetNames[street], "bet-sizes" }, {});
-                if (!fillFixedVector(settings.betSizes[player][street], betSizesVector)) {
-                    std::cerr << "Error: Too many bet sizes provided for " << playerNames[player] << " " << streetNames[street] << ", maximum is " << holdem::MaxNumBetSizes << "\n.";
-                    return false;
-                }
-            }
 
-            {
-                std::vector<int> raiseSizesVector;
-                loadOptionalField(raiseSizesVector, input, { "tree", "actions", playerNames[player], streetNames[street], "raise-sizes" }, {});
-                if (!fillFixedVector(settings.raiseSizes[player][street], raiseSizesVector)) {
-                    std::cerr << "Error: Too many raise sizes provided for " << playerNames[player] << " " << streetNames[street] << ", maximum is " << holdem::MaxNumRaiseSizes << "\n.";
-                    return false;
-                }
-            }
+        // The isomorphism tables are built alongside the hand tables
+        const Holdem::SetupTimings& timings = holdemRules->getSetupTimings();
+        if (!holdemRules->wereHandTablesLoadedFromCache()) {
+            printSetupStageTime("Hand ranks", timings.handRanksSeconds);
         }
+        printSetupStageTime("Valid hands", timings.validHandsSeconds);
+        printSetupStageTime("Hand table cache", timings.handTableCacheSeconds);
+        printSetupStageTime("Isomorphism tables", timings.isomorphismTablesSeconds);
+        context.rules = std::move(holdemRules);
     }
 
-    // Load starting wager
-    if (!loadRequiredField(settings.startingPlayerWagers, input, { "tree", "starting-wager-per-player" })) {
-        return false;
-    }
-    if (settings.startingPlayerWagers <= 0) {
-        std::cerr << "Error: Starting wager per player must be positive.\n";
-        return false;
-    }
-
-    // Load effective stack
-    if (!loadRequiredField(settings.effectiveStackRemaining, input, { "tree", "effective-stack-remaining" })) {
-        return false;
-    }
-    if (settings.effectiveStackRemaining <= 0) {
-        std::cerr << "Error: Effective stack must be positive.\n";
-        return false;
-    }
-
-    // Load dead money
-    loadOptionalIntWithBounds(settings.deadMoney, input, { "tree", "dead-money-in-pot" }, 0, 0, std::nullopt);
-
-    // Load use isomorphism
-    loadOptionalField(settings.useChanceCardIsomorphism, input, { "tree", "use-isomorphism" }, true);
-
-    // Solver settings
-    // Load num threads
-    #ifdef _OPENMP
-    constexpr static int MaxNumThreads = 64;
-    int defaultNumThreads = std::min(omp_get_max_threads(), MaxNumThreads);
-    loadOptionalIntWithBounds(context.numThreads, input, { "solver", "threads" }, defaultNumThreads, 1, MaxNumThreads);
-    #else
-    context.numThreads = 1;
-    std::cout << "OpenMP was not found, using one thread.\n";
-    #endif
-    settings.numThreads = context.numThreads;
-
-    // Load target exploitability
-    loadOptionalField(context.targetPercentExploitability, input, { "solver", "target-exploitability" }, 0.3f);
-
-    // Load max iterations
-    loadOptionalIntWithBounds(context.maxIterations, input, { "solver", "max-iterations" }, 1000, 1, std::nullopt);
-
-    // Load exploitability check frequency
-    loadOptionalIntWithBounds(context.exploitabilityCheckFrequency, input, { "solver", "exploitability-check-frequency" }, 10, 1, std::nullopt);
-
-    std::cout << "Successfully loaded Holdem settings.\n\n";
-
-    {
-        ScopedTimer timer{ "Building Holdem lookup tables...", "Finished building lookup tables" };
-        context.rules = std::make_unique<Holdem>(settings);
-    }
-
-    context.tree = std::make_unique<Tree>();
+    context.tree = std::make_unique<Tree>(solverSettings.useTrainingDataCompression);
 
     return true;
 }
@@ -287,7 +150,9 @@ bool handleSetupKuhn(SolverContext& context) {
         .targetPercentExploitability = 0.3f,
         .maxIterations = 100000,
         .exploitabilityCheckFrequency = 10000,
-        .numThreads = 1
+        .numThreads = 1,
+        .pruningRevisitFrequency = 10,
+        .chanceSamplingCards = 8
     };
 
     std::cout << "Successfully loaded Kuhn poker.\n";
@@ -303,7 +168,9 @@ bool handleSetupLeduc(SolverContext& context) {
         .targetPercentExploitability = 0.3f,
         .maxIterations = 10000,
         .exploitabilityCheckFrequency = 1000,
-        .numThreads = 1
+        .numThreads = 1,
+        .pruningRevisitFrequency = 10,
+        .chanceSamplingCards = 8
     };
 
     std::cout << "Successfully loaded Leduc poker.\n";
@@ -316,12 +183,29 @@ bool handleEstimateTreeSize(SolverContext& context) {
         return false;
     }
 
-    buildTreeSkeletonIfNeeded(context);
+    // The sizes are counted from the game rules, so the tree skeleton does not have to be built
+    TreeSizeCounts counts = Tree::countTreeSize(*context.rules, context.numThreads);
+
+    static constexpr StreetArray<std::string> streetNames = { "Flop", "Turn", "River" };
+    std::size_t totalNumNodes = 0;
+    std::size_t totalNumDecisionNodes = 0;
+    for (Street street : { Street::Flop, Street::Turn, Street::River }) {
+        totalNumNodes += counts.numNodes[street];
+        totalNumDecisionNodes += counts.numDecisionNodes[street];
+        if (counts.numNodes[street] > 0) {
+            std::cout << streetNames[street] << " nodes: " << counts.numNodes[street]
+                << " (" << counts.numDecisionNodes[street] << " decision, " << counts.numChanceNodes[street] << " chance), "
+                << counts.trainingDataSize[street] << " training data values\n";
+        }
+    }
 
-    std::cout << "Total number of nodes: " << context.tree->allNodes.size() << "\n";
-    std::cout << "Number of decision nodes: " << context.tree->getNumberOfDecisionNodes() << "\n";
-    std::cout << "Tree skeleton size: " << formatBytes(context.tree->getTreeSkeletonSize()) << "\n";
-    std::cout << "Expected full tree size: " << formatBytes(context.tree->estimateFullTreeSize()) << "\n";
+    std::cout << "Total number of nodes: " << totalNumNodes << "\n";
+    std::cout << "Number of decision nodes: " << totalNumDecisionNodes << "\n";
+    std::cout << "Tree skeleton size: " << formatBytes(context.tree->estimateTreeSkeletonSize(*context.rules, counts)) << "\n";
+    std::cout << "Expected full tree size: " << formatBytes(context.tree->estimateFullTreeSize(*context.rules, counts)) << "\n";
+    if (!context.trainingDataDirectory.empty()) {
+        std::cout << "Training data is stored in scratch files in " << context.trainingDataDirectory << ", so only the tree skeleton has to fit in RAM.\n";
+    }
     return true;
 }
 
@@ -336,6 +220,8 @@ bool handleNodeInfo(SolverContext& context) {
                 return "Fold";
             case NodeType::Showdown:
                 return "Showdown";
+            case NodeType::AllInRunout:
+                return "All in runout";
             default:
                 assert(false);
                 return "???";
@@ -343,50 +229,21 @@ bool handleNodeInfo(SolverContext& context) {
     };
 
     auto getBoardString = [&context]() -> std::string {
-        // First get the cards from the starting board
-        std::vector<std::string> boardCards = getCardSetNames(context.rules->getInitialGameState().currentBoard);
-
-        // Then get turn/river cards, applying suit swap lists if needed
-        CardID lastChanceCard = InvalidCard;
-        std::optional<SuitMapping> lastSwapList;
-        for (const auto& [index, swapList] : context.nodePath) {
-            const Node& currentNode = context.tree->allNodes[index];
-            CardID lastDealtCard = currentNode.state.lastDealtCard;
-            if (lastDealtCard != lastChanceCard) {
-                // We've reached a new chance card, add it to the board after applying swap lists
-                // To go from tree suits to user suits, we need to apply the swaps in reverse order
-                // There can be at most 2 swap lists, one for turn and one for river
-                CardID cardToAdd = lastDealtCard;
-                if (swapList) {
-                    cardToAdd = swapCardSuits(cardToAdd, swapList->child, swapList->parent);
-                }
-                if (lastSwapList) {
-                    cardToAdd = swapCardSuits(cardToAdd, lastSwapList->child, lastSwapList->parent);
-                }
-                boardCards.push_back(getNameFromCardID(cardToAdd));
-
-                lastChanceCard = lastDealtCard;
-                lastSwapList = swapList;
-            }
-        }
-
-        if (boardCards.empty()) {
+        std::vector<CardID> board = getNodePathBoard(*context.rules, *context.tree, context.nodePath);
+        if (board.empty()) {
             return "Empty";
         }
-        else {
-            return join(boardCards, " ");
+
+        std::vector<std::string> boardCards;
+        for (CardID card : board) {
+            boardCards.push_back(getNameFromCardID(card));
         }
+        return join(boardCards, " ");
     };
 
     auto getActionString = [&context](int action) -> std::string {
         assert(!context.nodePath.empty());
-        const Node& node = context.tree->allNodes[context.nodePath.back().index];
-        const Node& nextNode = context.tree->allNodes[node.childrenOffset + action];
-
-        int lastBetTotal = std::max(nextNode.state.totalWagers[Player::P0], nextNode.state.totalWagers[Player::P1]);
-        int betOrRaiseSize = lastBetTotal - node.state.previousStreetsWager;
-
-        return context.rules->getActionName(nextNode.state.lastAction, betOrRaiseSize);
+        return getActionName(*context.rules, *context.tree, context.nodePath.back().index, action);
     };
 
     if (!isContextValid(context)) {
@@ -403,9 +260,10 @@ bool handleNodeInfo(SolverContext& context) {
 
     assert(!context.nodePath.empty());
     const Node& node = context.tree->allNodes[context.nodePath.back().index];
+    GameState state = context.tree->getNodeState(context.nodePath.back().index);
 
-    int oopWager = node.state.totalWagers[Player::P0];
-    int ipWager = node.state.totalWagers[Player::P1];
+    int oopWager = state.totalWagers[Player::P0];
+    int ipWager = state.totalWagers[Player::P1];
     int deadMoney = context.tree->deadMoney;
 
     // TODO: Print series of events that led to this node
@@ -421,8 +279,9 @@ bool handleNodeInfo(SolverContext& context) {
     switch (node.nodeType) {
         case NodeType::Chance: {
             std::cout << "Possible cards: ";
-            int numTotalChanceCards = getSetSize(node.availableCards);
-            CardSet temp = node.availableCards;
+            CardSet availableCards = context.tree->allChanceNodeDetails[node.chanceNodeIndex].availableCards;
+            int numTotalChanceCards = getSetSize(availableCards);
+            CardSet temp = availableCards;
             for (int i = 0; i < numTotalChanceCards; ++i) {
                 std::cout << getNameFromCardID(popLowestCardFromSet(temp)) << " ";
             }
@@ -433,7 +292,7 @@ bool handleNodeInfo(SolverContext& context) {
         }
 
         case NodeType::Decision:
-            std::cout << "Player to act: " << playerNames[node.state.playerToAct] << "\n";
+            std::cout << "Player to act: " << playerNames[node.playerToAct] << "\n";
             for (int action = 0; action < node.numChildren; ++action) {
                 std::cout << "    [" << action << "] " << getActionString(action) << "\n";
             }
@@ -441,12 +300,16 @@ bool handleNodeInfo(SolverContext& context) {
             return true;
 
         case NodeType::Fold:
-            std::cout << playerNames[node.state.playerToAct] << " wins\n";
+            std::cout << playerNames[node.playerToAct] << " wins\n";
             return true;
 
         case NodeType::Showdown:
             return true;
 
+        case NodeType::AllInRunout:
+            std::cout << "Both players are all in, the rest of the board is dealt out\n";
+            return true;
+
         default:
             assert(false);
             return false;
@@ -465,73 +328,119 @@ bool handleRoot(SolverContext& context) {
         return false;
     }
 
-    context.nodePath = { { context.tree->getRootNodeIndex(), std::nullopt } };
+    context.nodePath = getRootNodePath(*context.tree);
 
     // Print node info for root node
     return handleNodeInfo(context);
 }
 
-bool handleSolve(SolverContext& context) {
-    struct CfrResult {
-        float exploitability;
-        int iteration;
+SolveSettings getSolveSettings(const SolverContext& context) {
+    return {
+        .targetPercentExploitability = context.targetPercentExploitability,
+        .maxIterations = context.maxIterations,
+        .exploitabilityCheckFrequency = context.exploitabilityCheckFrequency,
+        .numThreads = context.numThreads,
+        .useTrainingDataCompression = context.tree->isTrainingDataCompressed(),
+        .usePruning = context.usePruning,
+        .pruningRevisitFrequency = context.pruningRevisitFrequency,
+        .useSimultaneousUpdates = context.useSimultaneousUpdates,
+        .chanceSamplingIterations = context.chanceSamplingIterations,
+        .chanceSamplingCards = context.chanceSamplingCards
     };
+}
 
+// Trains the tree starting after its last completed iteration, then prints information about the final strategy
+// If profileFile is not empty, the traversals during training are profiled and the report is written to it
+bool trainTree(SolverContext& context, const std::string& profileFile) {
     auto getStartingPot = [&context]() -> int {
         GameState initialState = context.rules->getInitialGameState();
         return initialState.totalWagers[Player::P0] + initialState.totalWagers[Player::P1] + context.tree->deadMoney;
     };
 
-    auto runCfr = [&context, &getStartingPot](StackAllocator<float>& allocator) -> std::optional<CfrResult> {
-        std::optional<CfrResult> resultOption;
-        float startingPot = static_cast<float>(getStartingPot());
+    std::optional<TraversalProfiler> profiler;
+
+    auto runCfr = [&context, &profiler](StackAllocator& allocator) -> SolveResult {
+        if (profiler) {
+            profiler->start();
+        }
 
-        for (int i = 0; i < context.maxIterations; ++i) {
-            int iteration = i + 1;
+        std::optional<CheckpointWriter> checkpointWriter;
+        if (!context.checkpointFile.empty()) {
+            checkpointWriter.emplace(*context.rules, context.checkpointFile);
+        }
+        int lastCheckpointIteration = context.tree->numCompletedIterations;
+        auto lastCheckpointTime = std::chrono::steady_clock::now();
+
+        auto reportCheckpointError = [&context]() -> void {
+            std::cerr << "Error: Could not write checkpoint to " << context.checkpointFile << ".\n";
+        };
+
+        auto writeCheckpoint = [&](int iteration) -> void {
+            // Training continues while the checkpoint is written, a failure is only known once the next checkpoint starts
+            std::cout << "Writing checkpoint after iteration " << iteration << ".\n" << std::flush;
+            if (!checkpointWriter->writeAsync(*context.tree)) {
+                reportCheckpointError();
+            }
+            lastCheckpointIteration = iteration;
+            lastCheckpointTime = std::chrono::steady_clock::now();
+        };
 
-            for (Player hero : { Player::P0, Player::P1 }) {
-                // Using Discounted CFR with alpha = 1.5, beta = 0, gamma = 2
-                // These values work very well in practice, as shown in below paper
+        auto isCheckpointDue = [&](int iteration) -> bool {
+            if ((context.checkpointFrequency > 0) && (iteration - lastCheckpointIteration >= context.checkpointFrequency)) {
+                return true;
+            }
 
-                // Brown, N., & Sandholm, T. (2019). 
-                // Solving Imperfect-Information Games via Discounted Regret Minimization. 
-                // Proceedings of the AAAI Conference on Artificial Intelligence, 33(01), 1829-1836. 
-                // https://doi.org/10.1609/aaai.v33i01.33011829
+            auto timeSinceLastCheckpoint = std::chrono::steady_clock::now() - lastCheckpointTime;
+            return (context.checkpointIntervalMinutes > 0) && (timeSinceLastCheckpoint >= std::chrono::minutes(context.checkpointIntervalMinutes));
+        };
 
-                discountedCfr(hero, *context.rules, getDiscountParams(1.5f, 0.0f, 2.0f, iteration), *context.tree, allocator);
+        SolveResult result = trainDiscountedCfr(*context.rules, getSolveSettings(context), *context.tree, allocator, [&](const SolveProgress& progress) {
+            if (checkpointWriter && isCheckpointDue(progress.iteration)) {
+                writeCheckpoint(progress.iteration);
             }
 
-            if ((context.exploitabilityCheckFrequency > 0) && (iteration % context.exploitabilityCheckFrequency == 0)) {
-                float exploitability = calculateExploitabilityFast(*context.rules, *context.tree, allocator);
-                float exploitabilityPercent = (exploitability / startingPot) * 100.0f;
-                std::cout << "Finished iteration " << iteration << ". Exploitability: " << formatFixedPoint(exploitability, 5) << " (" << formatFixedPoint(exploitabilityPercent, 5) << "%)\n";
-                if (exploitabilityPercent <= context.targetPercentExploitability) {
-                    resultOption = CfrResult{ exploitability, iteration };
-                    break;
-                }
+            if (progress.exploitability) {
+                std::cout << "Finished iteration " << progress.iteration << ". Exploitability: " << formatFixedPoint(*progress.exploitability, 5)
+                    << " (" << formatFixedPoint(*progress.exploitabilityPercent, 5) << "%)\n";
+            }
+            return true;
+        });
+
+        if (checkpointWriter) {
+            // Always save the final state, so that training can be resumed with a higher iteration limit
+            if (lastCheckpointIteration != context.tree->numCompletedIterations) {
+                writeCheckpoint(context.tree->numCompletedIterations);
+            }
+
+            if (!checkpointWriter->wait()) {
+                reportCheckpointError();
             }
         }
 
-        return resultOption;
+        if (profiler) {
+            profiler->stop();
+        }
+
+        return result;
     };
 
-    if (!isContextValid(context)) {
-        printInvalidContextError();
-        return false;
+    assert(isTreeSolved(context) && !context.tree->isTrainingDataMemoryMapped());
+
+    if (context.tree->numCompletedIterations > 0) {
+        std::cout << "Resuming training after iteration " << context.tree->numCompletedIterations << ".\n";
     }
 
-    buildTreeSkeletonIfNeeded(context);
+    SolveResult result;
 
-    {
-        ScopedTimer timer{ "Allocating memory...", "Finished allocating memory" };
-        context.tree->initCfrVectors();
+    if (!profileFile.empty()) {
+        if (!IsProfilingEnabled) {
+            std::cout << "Warning: The solver was built without POSTFLOP_PROFILING, so the profile will only contain the wall time and stack usage.\n";
+        }
+        profiler.emplace(context.numThreads);
     }
-    std::cout << "\n";
-
-    std::optional<CfrResult> resultOption;
 
     #ifdef _OPENMP
-    StackAllocator<float> allocator(context.numThreads);
+    StackAllocator allocator(context.numThreads, context.tree->estimateStackAllocatorSize());
     #pragma omp parallel num_threads(context.numThreads)
     {
         #pragma omp single
@@ -542,25 +451,33 @@ bool handleSolve(SolverContext& context) {
 
             {
                 ScopedTimer timer{ {}, "Finished training" };
-                resultOption = runCfr(allocator);
+                result = runCfr(allocator);
             }
         }
     }
     #else
     context.numThreads = 1;
-    StackAllocator<float> allocator(context.numThreads);
+    if (profiler) {
+        profiler.emplace(context.numThreads);
+    }
+    StackAllocator allocator(context.numThreads, context.tree->estimateStackAllocatorSize());
     std::cout << "Starting training in single-threaded mode. Target exploitability: "
         << formatFixedPoint(context.targetPercentExploitability, 5)
         << "% Maximum iterations: " << context.maxIterations << "\n" << std::flush;
 
     {
         ScopedTimer timer{ {}, "Finished training" };
-        resultOption = runCfr(allocator);
+        result = runCfr(allocator);
     }
     #endif
 
-    if (resultOption) {
-        std::cout << "Target exploitability percentage reached after iteration " << resultOption->iteration << ".\n\n";
+    // The caller reports the error of the lost worker, the final strategy cannot be evaluated without it
+    if (result.status == SolveStatus::WorkerLost) {
+        return false;
+    }
+
+    if (result.status == SolveStatus::TargetReached) {
+        std::cout << "Target exploitability percentage reached after iteration " << result.numIterations << ".\n\n";
     }
     else {
         std::cout << "Target exploitability percentage not reached.\n\n";
@@ -573,98 +490,270 @@ bool handleSolve(SolverContext& context) {
     std::cout << "Player 1 expected value: " << formatFixedPoint(player1ExpectedValue, 5) << "\n\n";
 
     std::cout << "Calculating exploitability of final strategy...\n" << std::flush;
-    float exploitability = resultOption ? resultOption->exploitability : calculateExploitabilityFast(*context.rules, *context.tree, allocator);
+    float exploitability = result.exploitability ? *result.exploitability : calculateExploitabilityFast(*context.rules, *context.tree, allocator);
     float exploitabilityPercent = (exploitability / static_cast<float>(getStartingPot())) * 100.0f;
     std::cout << "Exploitability: " << formatFixedPoint(exploitability, 5) << " (" << formatFixedPoint(exploitabilityPercent, 5) << "%)\n\n";
 
     std::cout << "Maximum stack allocator memory usage per thread: ";
-    auto stackUsages = allocator.getMaximumStackUsage();
+    std::vector<std::size_t> stackUsages = allocator.getMaximumStackUsage();
+    std::vector<std::size_t> stackBlocks = allocator.getMaximumNumBlocks();
     for (int i = 0; i < context.numThreads; ++i) {
-        std::cout << formatBytes(stackUsages[i]);
+        std::cout << formatBytes(stackUsages[i]) << " (" << stackBlocks[i] << " arrays)";
         if (i < context.numThreads - 1) std::cout << ", ";
     }
     std::cout << "\n\n";
 
+    if (profiler) {
+        if (profiler->writeJsonReport(profileFile, allocator)) {
+            std::cout << "Wrote traversal profile to " << profileFile << ".\n\n";
+        }
+        else {
+            std::cerr << "Error: Could not write traversal profile to " << profileFile << ".\n\n";
+        }
+    }
+
     // Start traversal at the root
     return handleRoot(context);
 }
 
-bool handleStrategy(SolverContext& context, const std::string& argument) {
-    struct Strategy {
-        CardSet hand;
-        double weight;
-        FixedVector<float, MaxNumActions> finalStrategy;
-    };
+// Seeds the regrets and strategy sums of the current tree from the solved tree in the warm start file
+bool warmStartFromFile(SolverContext& context) {
+    static constexpr bool UseMemoryMapping = false;
+
+    std::cout << "Loading warm start tree from " << context.warmStartFile << "...\n" << std::flush;
+    Result<std::unique_ptr<Tree>> treeResult = Tree::loadFromFile(*context.rules, context.warmStartFile, UseMemoryMapping);
+    if (treeResult.isError()) {
+        std::cerr << treeResult.getError() << "\n";
+        return false;
+    }
 
-    auto getStrategyForHand = [&context](CardSet hand) -> std::optional<Strategy> {
-        const Node& node = context.tree->allNodes[context.nodePath.back().index];
-        Player playerToAct = node.state.playerToAct;
-        const auto rangeHands = context.rules->getRangeHands(playerToAct);
+    std::size_t numSeededDecisionNodes;
+    {
+        ScopedTimer timer{ "Seeding training data...", "Finished seeding training data" };
+        numSeededDecisionNodes = warmStartTree(*context.rules, *treeResult.getValue(), *context.tree);
+    }
+    std::cout << "Seeded " << numSeededDecisionNodes << " of " << context.tree->getNumberOfDecisionNodes() << " decision nodes.\n";
 
-        // Find out which index in the current player's range this hand corresponds to
-        int handIndex = -1;
-        for (int i = 0; i < rangeHands.size(); ++i) {
-            if (hand == rangeHands[i]) {
-                handIndex = i;
-                break;
-            }
-        }
-        if (handIndex == -1) {
-            // Hand was not in our range
-            return std::nullopt;
+    if (context.tree->numCompletedIterations >= context.maxIterations) {
+        std::cout << "Warning: The warm start tree was trained for " << context.tree->numCompletedIterations
+            << " iterations, so no iterations are left before the maximum of " << context.maxIterations << ". The seeded strategy is kept as it is.\n";
+    }
+    std::cout << "\n";
+
+    return true;
+}
+
+// Trains the nodes before the first chance card on this machine and the subtrees after it on the distributed workers
+bool trainTreeDistributed(SolverContext& context, const std::string& profileFile) {
+    if (!context.warmStartFile.empty() || !context.checkpointFile.empty()) {
+        std::cerr << "Error: Warm starts and checkpoints need the whole tree, so they cannot be used with distributed workers.\n";
+        return false;
+    }
+
+    std::cout << "Connecting to " << context.distributedWorkers.size() << " distributed workers and allocating memory...\n" << std::flush;
+    Result<std::unique_ptr<DistributedCoordinator>> coordinatorResult = DistributedCoordinator::connect(
+        context.distributedWorkers,
+        *context.rules,
+        *context.tree,
+        context.numThreads
+    );
+    if (coordinatorResult.isError()) {
+        std::cerr << coordinatorResult.getError() << "\n";
+        return false;
+    }
+    DistributedCoordinator& coordinator = *coordinatorResult.getValue();
+    std::cout << "Subtrees after the first chance card are split between " << coordinator.getNumWorkers() << " workers.\n\n";
+
+    coordinator.start();
+    bool success = trainTree(context, profileFile);
+    coordinator.stop();
+
+    if (std::optional<std::string> error = coordinator.getError()) {
+        std::cerr << *error << " Training stopped after iteration " << context.tree->numCompletedIterations << ".\n";
+        return false;
+    }
+
+    std::cout << "The subtrees after the first chance card are stored on the workers, so only the nodes before it can be browsed.\n";
+    return success;
+}
+
+bool handleSolve(SolverContext& context, const std::string& profileFile) {
+    if (!isContextValid(context)) {
+        printInvalidContextError();
+        return false;
+    }
+
+    buildTreeSkeletonIfNeeded(context);
+
+    context.tree->setTrainingDataHugePages(context.useHugePages);
+    if (!context.trainingDataDirectory.empty()) {
+        if (!context.tree->setTrainingDataDirectory(context.trainingDataDirectory)) {
+            std::cerr << "Error: Could not create training data files in " << context.trainingDataDirectory << ".\n";
+            return false;
         }
+        std::cout << "Storing training data in scratch files in " << context.trainingDataDirectory << ".\n";
+    }
 
-        if (doSetsOverlap(hand, context.rules->getInitialGameState().currentBoard)) {
-            // Hand is in our range, but is blocked by the starting board
-            return std::nullopt;
+    if (!context.distributedWorkers.empty()) {
+        return trainTreeDistributed(context, profileFile);
+    }
+
+    {
+        ScopedTimer timer{ "Allocating memory...", "Finished allocating memory" };
+        context.tree->initCfrVectors(context.numThreads);
+    }
+    std::cout << "\n";
+
+    if (!context.warmStartFile.empty() && !warmStartFromFile(context)) {
+        return false;
+    }
+
+    return trainTree(context, profileFile);
+}
+
+bool handleResume(SolverContext& context) {
+    static constexpr bool UseMemoryMapping = false;
+
+    if (!isContextValid(context)) {
+        printInvalidContextError();
+        return false;
+    }
+
+    if (context.checkpointFile.empty()) {
+        std::cerr << "Error: No checkpoint file set. Please set solver::checkpoint-file in the configuration file.\n";
+        return false;
+    }
+
+    std::cout << "Loading checkpoint from " << context.checkpointFile << "...\n" << std::flush;
+    Result<std::unique_ptr<Tree>> treeResult = Tree::loadFromFile(*context.rules, context.checkpointFile, UseMemoryMapping);
+    if (treeResult.isError()) {
+        std::cerr << treeResult.getError() << "\n";
+        return false;
+    }
+
+    context.tree = std::move(treeResult.getValue());
+    std::cout << "\n";
+
+    return trainTree(context, {});
+}
+
+// Reach probabilities of both players entering the current node when both play the average strategy
+// The hands are indexed the way the tree stores the current node, so the suit swaps of isomorphic deals are applied to them
+PlayerArray<std::vector<float>> getCurrentNodeReachProbs(const SolverContext& context) {
+    assert(!context.nodePath.empty());
+
+    PlayerArray<std::vector<float>> reachProbs;
+    for (Player player : { Player::P0, Player::P1 }) {
+        NodePathRange range = getNodePathRange(*context.rules, *context.tree, context.nodePath, player);
+        reachProbs[player].assign(context.tree->rangeSize[player], 0.0f);
+
+        // Suit swaps map hands one to one, so blocked hands can simply be left at zero
+        for (std::size_t hand = 0; hand < range.handIndices.size(); ++hand) {
+            if (range.handIndices[hand] != -1) {
+                reachProbs[player][range.handIndices[hand]] = range.reachWeights[hand];
+            }
         }
+    }
 
-        double handWeight = static_cast<double>(context.rules->getInitialRangeWeights(playerToAct)[handIndex]);
+    return reachProbs;
+}
 
-        assert(!context.nodePath.empty());
-        for (int i = 0; i < static_cast<int>(context.nodePath.size()) - 1; ++i) {
-            const Node& currentNode = context.tree->allNodes[context.nodePath[i].index];
-            const Node& nextNode = context.tree->allNodes[context.nodePath[i + 1].index];
-            std::optional<SuitMapping> swapList = context.nodePath[i + 1].swapList;
-
-            switch (currentNode.nodeType) {
-                case NodeType::Chance: {
-                    if (swapList) {
-                        // We need to swap our hand index to reflect the swapped suits
-                        const auto& isomorphicHandIndices = context.tree->isomorphicHandIndices[playerToAct][mapTwoSuitsToIndex(swapList->parent, swapList->child)];
-                        assert(isomorphicHandIndices.size() == context.tree->rangeSize[playerToAct]);
-                        handIndex = isomorphicHandIndices[handIndex];
-                    }
+// Runs more iterations on the subtree below the current node only
+// The reach probabilities entering the node come from the current solution and stay fixed, so the rest of the tree is unchanged
+bool handleResolve(SolverContext& context) {
+    if (!isContextValid(context)) {
+        printInvalidContextError();
+        return false;
+    }
 
-                    // Exit if the most recently added chance card overlaps with our hand
-                    CardID lastDealtCard = nextNode.state.lastDealtCard;
-                    if (setContainsCard(rangeHands[handIndex], lastDealtCard)) {
-                        return std::nullopt;
-                    }
+    if (!isTreeSolved(context)) {
+        printUnsolvedTreeError();
+        return false;
+    }
 
-                    break;
-                }
+    if (context.tree->isTrainingDataMemoryMapped()) {
+        std::cerr << "Error: Trees loaded from a file cannot be trained. Use \"resume\" with a checkpoint instead.\n";
+        return false;
+    }
 
-                case NodeType::Decision:
-                    assert(!swapList);
-                    if (currentNode.state.playerToAct == playerToAct) {
-                        // This is a strategy node for the current player, multiply the hand weight by the strategy for the action we took
-                        int actionIndexTaken = context.nodePath[i + 1].index - currentNode.childrenOffset;
-                        assert((actionIndexTaken >= 0) && (actionIndexTaken < currentNode.numChildren));
-                        FixedVector<float, MaxNumActions> finalStrategy = getFinalStrategy(handIndex, currentNode, *context.tree);
-                        handWeight *= static_cast<double>(finalStrategy[actionIndexTaken]);
-                    }
-                    break;
+    if (context.tree->isTrainingDataPartial()) {
+        std::cerr << "Error: Trees trained with distributed workers cannot be re-solved, since the workers keep the subtrees after the first chance card.\n";
+        return false;
+    }
+
+    assert(!context.nodePath.empty());
+    std::size_t nodeIndex = context.nodePath.back().index;
+    const Node& node = context.tree->allNodes[nodeIndex];
+    if ((node.nodeType != NodeType::Decision) && (node.nodeType != NodeType::Chance)) {
+        std::cerr << "Error: Current node is a terminal node, so there is nothing to re-solve.\n";
+        return false;
+    }
+
+    PlayerArray<std::vector<float>> reachProbVectors = getCurrentNodeReachProbs(context);
+    PlayerArray<std::span<const float>> reachProbs = { reachProbVectors[Player::P0], reachProbVectors[Player::P1] };
+
+    GameState state = context.tree->getNodeState(nodeIndex);
+    float pot = static_cast<float>(state.totalWagers[Player::P0] + state.totalWagers[Player::P1] + context.tree->deadMoney);
+
+    auto printExploitability = [&pot](const std::string& prefix, float exploitability) -> void {
+        std::cout << prefix << formatFixedPoint(exploitability, 5) << " (" << formatFixedPoint((exploitability / pot) * 100.0f, 5) << "% of the pot)\n";
+    };
+
+    auto runSubtreeCfr = [&](StackAllocator& allocator) -> void {
+        printExploitability("Subtree exploitability before re-solving: ", calculateSubtreeExploitability(*context.rules, nodeIndex, reachProbs, *context.tree, allocator));
+
+        ScopedTimer timer{ {}, "Finished re-solving" };
 
-                case NodeType::Fold:
-                case NodeType::Showdown:
-                default:
-                    assert(false);
+        // The stored regrets are kept as a warm start, but the iteration count restarts
+        // so that Discounted CFR weighs the new solution of the subtree above its old history
+        for (int iteration = 1; iteration <= context.maxIterations; ++iteration) {
+            bool usePruning = context.usePruning && (iteration % context.pruningRevisitFrequency != 0);
+
+            for (Player hero : { Player::P0, Player::P1 }) {
+                discountedCfrSubtree(hero, *context.rules, getDiscountParams(1.5f, 0.0f, 2.0f, iteration), nodeIndex, reachProbs, *context.tree, allocator, usePruning);
+            }
 
+            if ((context.exploitabilityCheckFrequency > 0) && (iteration % context.exploitabilityCheckFrequency == 0)) {
+                float exploitability = calculateSubtreeExploitability(*context.rules, nodeIndex, reachProbs, *context.tree, allocator);
+                printExploitability("Finished iteration " + std::to_string(iteration) + ". Subtree exploitability: ", exploitability);
+                if ((exploitability / pot) * 100.0f <= context.targetPercentExploitability) {
+                    break;
+                }
             }
         }
 
-        return Strategy{ hand, handWeight, getFinalStrategy(handIndex, node, *context.tree) };
+        printExploitability("Subtree exploitability after re-solving: ", calculateSubtreeExploitability(*context.rules, nodeIndex, reachProbs, *context.tree, allocator));
+    };
+
+    #ifdef _OPENMP
+    StackAllocator allocator(context.numThreads, context.tree->estimateStackAllocatorSize());
+    #pragma omp parallel num_threads(context.numThreads)
+    {
+        #pragma omp single
+        {
+            std::cout << "Re-solving the subtree below the current node in parallel with " << omp_get_num_threads() << " threads. Maximum iterations: "
+                << context.maxIterations << "\n" << std::flush;
+            runSubtreeCfr(allocator);
+        }
+    }
+    #else
+    context.numThreads = 1;
+    StackAllocator allocator(context.numThreads, context.tree->estimateStackAllocatorSize());
+    std::cout << "Re-solving the subtree below the current node in single-threaded mode. Maximum iterations: "
+        << context.maxIterations << "\n" << std::flush;
+    runSubtreeCfr(allocator);
+    #endif
+    std::cout << "\n";
+
+    // Print the new strategy of the current node
+    return handleNodeInfo(context);
+}
+
+bool handleStrategy(SolverContext& context, const std::string& argument) {
+    struct Strategy {
+        CardSet hand;
+        double weight;
+        FixedVector<float, MaxNumActions> finalStrategy;
     };
 
     if (!isContextValid(context)) {
@@ -684,9 +773,27 @@ bool handleStrategy(SolverContext& context, const std::string& argument) {
         return false;
     }
 
+    // The whole range is computed in one pass over the path, then each requested hand is looked up by its range index
+    NodePathRangeStrategy rangeStrategy = getNodePathRangeStrategy(*context.rules, *context.tree, context.nodePath);
+    std::size_t rangeSize = rangeStrategy.range.handIndices.size();
+
+    auto getStrategyForHand = [&context, &rangeStrategy, rangeSize](CardSet hand) -> std::optional<Strategy> {
+        // Hands that are not in the range or are blocked by the board are skipped
+        int rangeIndex = context.rules->getRangeIndex(rangeStrategy.player, hand);
+        if ((rangeIndex == -1) || (rangeStrategy.range.handIndices[rangeIndex] == -1)) {
+            return std::nullopt;
+        }
+
+        Strategy strategy = { hand, static_cast<double>(rangeStrategy.range.reachWeights[rangeIndex]), {} };
+        for (int action = 0; action < rangeStrategy.numActions; ++action) {
+            strategy.finalStrategy.pushBack(rangeStrategy.strategy[action * rangeSize + rangeIndex]);
+        }
+        return strategy;
+    };
+
     std::vector<Strategy> strategies;
     if (argument == "all") {
-        for (CardSet hand : context.rules->getRangeHands(node.state.playerToAct)) {
+        for (CardSet hand : context.rules->getRangeHands(node.playerToAct)) {
             std::optional<Strategy> strategyOption = getStrategyForHand(hand);
             if (strategyOption) {
                 strategies.push_back(*strategyOption);
@@ -823,26 +930,19 @@ bool handleAction(SolverContext& context, const std::string& argument) {
         return false;
     }
 
-    assert(!context.nodePath.empty());
-    const Node& node = context.tree->allNodes[context.nodePath.back().index];
-    if (node.nodeType != NodeType::Decision) {
-        std::cerr << "Error: Current node is not a decision node.\n";
-        return false;
-    }
-
     std::optional<int> actionOption = parseInt(argument);
     if (!actionOption) {
         std::cerr << "Error: Action is not a valid integer.\n";
         return false;
     }
 
-    int action = *actionOption;
-    if (action < 0 || action >= node.numChildren) {
-        std::cerr << "Error: Action id is out of range.\n";
+    Result<NodeInfo> childResult = getActionChild(*context.tree, context.nodePath, *actionOption);
+    if (childResult.isError()) {
+        std::cerr << childResult.getError() << "\n";
         return false;
     }
 
-    context.nodePath.push_back({ node.childrenOffset + action, std::nullopt });
+    context.nodePath.push_back(childResult.getValue());
 
     // Print node info for new node
     return handleNodeInfo(context);
@@ -866,58 +966,125 @@ bool handleDeal(SolverContext& context, const std::string& argument) {
         return false;
     }
 
+    if (context.tree->isTrainingDataPartial()) {
+        std::cerr << "Error: The subtrees after this chance node were trained on distributed workers and are not stored here.\n";
+        return false;
+    }
+
     Result<CardID> cardResult = getCardIDFromName(argument);
     if (cardResult.isError()) {
         std::cerr << cardResult.getError() << "\n";
         return false;
     }
 
-    CardID dealCard = cardResult.getValue();
-    if (!setContainsCard(node.availableCards, dealCard)) {
-        std::cerr << "Error: Card is not available to be dealt.\n";
+    Result<NodeInfo> childResult = getDealtChild(*context.tree, context.nodePath, cardResult.getValue());
+    if (childResult.isError()) {
+        std::cerr << childResult.getError() << "\n";
         return false;
     }
 
-    // Apply swap list from previous nodes
-    // There can only be one, since at most the turn could have happened before this
-    for (const auto& [index, swapList] : context.nodePath) {
-        if (swapList) {
-            dealCard = swapCardSuits(dealCard, swapList->child, swapList->parent);
-            break;
-        }
+    context.nodePath.push_back(childResult.getValue());
+
+    // Print node info for new node
+    return handleNodeInfo(context);
+}
+
+bool handleSave(SolverContext& context, const std::string& argument) {
+    if (!isContextValid(context)) {
+        printInvalidContextError();
+        return false;
     }
 
-    // Because of isomorphism, the card might not actually exist in the tree
-    std::optional<SuitMapping> swapList;
-    for (SuitMapping mapping : node.suitMappings) {
-        if (getCardSuit(dealCard) == mapping.child) {
-            swapList = mapping;
-            break;
-        }
+    if (!isTreeSolved(context)) {
+        printUnsolvedTreeError();
+        return false;
     }
 
-    CardID isomorphicDealCard;
-    if (swapList) {
-        isomorphicDealCard = getCardIDFromValueAndSuit(getCardValue(dealCard), swapList->parent);
+    if (context.tree->isTrainingDataMemoryMapped()) {
+        std::cerr << "Error: Trees loaded from a file cannot be saved again.\n";
+        return false;
     }
-    else {
-        isomorphicDealCard = dealCard;
+
+    if (context.tree->isTrainingDataPartial()) {
+        std::cerr << "Error: Trees trained with distributed workers cannot be saved, since the workers keep the subtrees after the first chance card.\n";
+        return false;
     }
 
-    for (int cardIndex = 0; cardIndex < node.numChildren; ++cardIndex) {
-        CardID card = context.tree->allNodes[node.childrenOffset + cardIndex].state.lastDealtCard;
-        assert(card != InvalidCard);
+    bool success;
+    {
+        ScopedTimer timer{ "Saving tree to " + argument + "...", "Finished saving tree" };
+        success = context.tree->saveToFile(*context.rules, argument);
+    }
 
-        if (card == isomorphicDealCard) {
-            context.nodePath.push_back({ node.childrenOffset + cardIndex, swapList });
+    if (!success) {
+        std::cerr << "Error: Could not write tree to " << argument << ".\n";
+        return false;
+    }
 
-            // Print node info for new node
-            return handleNodeInfo(context);
-        }
+    return true;
+}
+
+bool handleExport(SolverContext& context, const std::string& argument) {
+    if (!isContextValid(context)) {
+        printInvalidContextError();
+        return false;
+    }
+
+    if (!isTreeSolved(context)) {
+        printUnsolvedTreeError();
+        return false;
     }
 
-    assert(false);
-    return false;
+    std::optional<Result<SolutionExportSummary>> exportResult;
+    auto runExport = [&context, &argument, &exportResult](StackAllocator& allocator) -> void {
+        ScopedTimer timer{ "Exporting solution to " + argument + "...", "Finished exporting solution" };
+        exportResult = exportSolution(*context.rules, *context.tree, argument, allocator);
+    };
+
+    #ifdef _OPENMP
+    StackAllocator allocator(context.numThreads, context.tree->estimateStackAllocatorSize());
+    #pragma omp parallel num_threads(context.numThreads)
+    {
+        #pragma omp single
+        runExport(allocator);
+    }
+    #else
+    context.numThreads = 1;
+    StackAllocator allocator(context.numThreads, context.tree->estimateStackAllocatorSize());
+    runExport(allocator);
+    #endif
+
+    assert(exportResult);
+    if (exportResult->isError()) {
+        std::cerr << exportResult->getError() << "\n";
+        return false;
+    }
+
+    const SolutionExportSummary& summary = exportResult->getValue();
+    std::cout << "Exported " << summary.numDecisionNodes << " decision nodes and " << summary.numHandRows
+        << " hand rows in " << summary.numChunks << " chunks.\n";
+    return true;
+}
+
+bool handleLoad(SolverContext& context, const std::string& argument) {
+    static constexpr bool UseMemoryMapping = true;
+
+    if (!isContextValid(context)) {
+        printInvalidContextError();
+        return false;
+    }
+
+    Result<std::unique_ptr<Tree>> treeResult = Tree::loadFromFile(*context.rules, argument, UseMemoryMapping);
+    if (treeResult.isError()) {
+        std::cerr << treeResult.getError() << "\n";
+        return false;
+    }
+
+    context.tree = std::move(treeResult.getValue());
+    std::cout << "Successfully loaded tree from " << argument << ".\n\n";
+
+    // Start traversal at the root
+    return handleRoot(context);
 }
 
 bool handleBack(SolverContext& context) {
@@ -975,7 +1142,47 @@ bool registerAllCommands(CliDispatcher& dispatcher, SolverContext& context) {
     allSuccess &= dispatcher.registerCommand(
         "solve",
         "Solves the game tree using Discounted CFR. It is recommended to first run \"tree-size\" to ensure that the tree fits in RAM.",
-        [&context]() { return handleSolve(context); }
+        [&context]() { return handleSolve(context, {}); }
+    );
+
+    allSuccess &= dispatcher.registerCommand(
+        "solve-profile",
+        "file",
+        "Solves the game tree like \"solve\" and writes a JSON profile of the traversals to a file. Build with POSTFLOP_PROFILING for per node type timings.",
+        [&context](const std::string& argument) { return handleSolve(context, argument); }
+    );
+
+    allSuccess &= dispatcher.registerCommand(
+        "resume",
+        "Continues solving from the checkpoint file set in the configuration file.",
+        [&context]() { return handleResume(context); }
+    );
+
+    allSuccess &= dispatcher.registerCommand(
+        "resolve",
+        "Re-solves only the subtree below the current node, keeping the ranges that reach it from the current solution fixed.",
+        [&context]() { return handleResolve(context); }
+    );
+
+    allSuccess &= dispatcher.registerCommand(
+        "save",
+        "file",
+        "Saves the solved tree to a binary file.",
+        [&context](const std::string& argument) { return handleSave(context, argument); }
+    );
+
+    allSuccess &= dispatcher.registerCommand(
+        "export",
+        "file",
+        "Exports the average strategy and expected value of every hand at every decision node to a columnar file for analysis.",
+        [&context](const std::string& argument) { return handleExport(context, argument); }
+    );
+
+    allSuccess &= dispatcher.registerCommand(
+        "load",
+        "file",
+        "Loads a tree saved with \"save\". The game settings used to solve the tree must be loaded first.",
+        [&context](const std::string& argument) { return handleLoad(context, argument); }
     );
 
     allSuccess &= dispatcher.registerCommand(
@@ -0,0 +1,115 @@
+#include "game/holdem/flop_isomorphism.hpp"
+
+#include "game/game_types.hpp"
+#include "game/game_utils.hpp"
+#include "game/holdem/config.hpp"
+#include "game/holdem/holdem.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+CardSet permuteSetSuits(CardSet cardSet, const SuitPermutation& permutation) {
+    // The permutation is applied as a sequence of swaps, each of which moves the cards of one original suit to their final suit
+    // currentSuits[s] is the suit that holds the cards that started in suit s
+    SuitPermutation currentSuits = { Suit::Clubs, Suit::Diamonds, Suit::Hearts, Suit::Spades };
+    for (int suit = 0; suit < 4; ++suit) {
+        Suit currentSuit = currentSuits[suit];
+        Suit targetSuit = permutation[suit];
+        if (currentSuit == targetSuit) continue;
+
+        cardSet = swapSetSuits(cardSet, currentSuit, targetSuit);
+        for (Suit& otherSuit : currentSuits) {
+            if (otherSuit == targetSuit) {
+                otherSuit = currentSuit;
+            }
+        }
+        currentSuits[suit] = targetSuit;
+    }
+    return cardSet;
+}
+
+std::vector<SuitPermutation> getRangeSuitSymmetries(const PlayerArray<Holdem::Range>& ranges) {
+    PlayerArray<std::unordered_map<CardSet, float>> handWeights;
+    for (Player player : { Player::P0, Player::P1 }) {
+        const Holdem::Range& range = ranges[player];
+        for (std::size_t hand = 0; hand < range.hands.size(); ++hand) {
+            handWeights[player].emplace(range.hands[hand], range.weights[hand]);
+        }
+    }
+
+    auto isSymmetry = [&ranges, &handWeights](const SuitPermutation& permutation) -> bool {
+        for (Player player : { Player::P0, Player::P1 }) {
+            const Holdem::Range& range = ranges[player];
+            for (std::size_t hand = 0; hand < range.hands.size(); ++hand) {
+                auto permutedHand = handWeights[player].find(permuteSetSuits(range.hands[hand], permutation));
+                if ((permutedHand == handWeights[player].end()) || (permutedHand->second != range.weights[hand])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    // std::next_permutation visits all 24 permutations starting from the identity
+    std::vector<SuitPermutation> symmetries;
+    SuitPermutation permutation = { Suit::Clubs, Suit::Diamonds, Suit::Hearts, Suit::Spades };
+    do {
+        if (isSymmetry(permutation)) {
+            symmetries.push_back(permutation);
+        }
+    } while (std::next_permutation(permutation.begin(), permutation.end()));
+
+    assert(!symmetries.empty());
+    return symmetries;
+}
+
+std::vector<CanonicalFlop> getCanonicalFlops(std::span<const CardSet> flops, std::span<const SuitPermutation> symmetries) {
+    std::vector<CanonicalFlop> canonicalFlops;
+    std::unordered_map<CardSet, std::size_t> canonicalFlopIndices;
+
+    for (CardSet flop : flops) {
+        assert(getSetSize(flop) == 3);
+
+        CardSet canonicalFlop = flop;
+        for (const SuitPermutation& permutation : symmetries) {
+            canonicalFlop = std::min(canonicalFlop, permuteSetSuits(flop, permutation));
+        }
+
+        auto [index, inserted] = canonicalFlopIndices.emplace(canonicalFlop, canonicalFlops.size());
+        if (inserted) {
+            canonicalFlops.push_back({ .flop = canonicalFlop, .numFlops = 0 });
+        }
+        ++canonicalFlops[index->second].numFlops;
+    }
+
+    return canonicalFlops;
+}
+
+std::vector<CardSet> getAllFlops() {
+    std::vector<CardSet> flops;
+    for (int card0 = 0; card0 < holdem::DeckSize; ++card0) {
+        for (int card1 = card0 + 1; card1 < holdem::DeckSize; ++card1) {
+            for (int card2 = card1 + 1; card2 < holdem::DeckSize; ++card2) {
+                flops.push_back(cardIDToSet(static_cast<CardID>(card0)) | cardIDToSet(static_cast<CardID>(card1)) | cardIDToSet(static_cast<CardID>(card2)));
+            }
+        }
+    }
+
+    std::sort(flops.begin(), flops.end());
+    return flops;
+}
+
+Holdem::Range removeBlockedHands(const Holdem::Range& range, CardSet board) {
+    Holdem::Range filteredRange;
+    for (std::size_t hand = 0; hand < range.hands.size(); ++hand) {
+        if (!doSetsOverlap(range.hands[hand], board)) {
+            filteredRange.hands.push_back(range.hands[hand]);
+            filteredRange.weights.push_back(range.weights[hand]);
+        }
+    }
+    return filteredRange;
+}
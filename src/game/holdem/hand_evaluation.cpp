@@ -10,19 +10,6 @@
 #include <cstdint>
 
 namespace {
-enum class HandType : std::uint8_t {
-    HighCard,
-    Pair,
-    TwoPair,
-    ThreeOfAKind,
-    Straight,
-    Flush,
-    FullHouse,
-    FourOfAKind,
-    StraightFlush,
-    RoyalFlush
-};
-
 struct HandStrength {
     HandType handType;
     FixedVector<Value, 5> kickers;
@@ -58,6 +45,62 @@ HandRank convertHandStrengthToInt(const HandStrength& handStrength) {
 
     return handRank;
 }
+
+// Bit i of a value mask is set if the hand contains a card with value i
+using ValueMask = std::uint16_t;
+
+constexpr int NumValueMasks = 1 << 13;
+
+// Maps each value mask to the highest card of the best straight it contains, or -1 if it contains no straight
+constexpr std::array<std::int8_t, NumValueMasks> StraightHighValueTable = [] {
+    std::array<std::int8_t, NumValueMasks> table = {};
+    for (int mask = 0; mask < NumValueMasks; ++mask) {
+        table[mask] = -1;
+
+        // Bit i of runs is set if values [i, i + 4] are all present
+        int runs = mask & (mask >> 1) & (mask >> 2) & (mask >> 3) & (mask >> 4);
+        if (runs != 0) {
+            table[mask] = static_cast<std::int8_t>(std::bit_width(static_cast<unsigned>(runs)) - 1 + 4);
+            continue;
+        }
+
+        constexpr int WheelStraightMask = 0x100F;
+        if ((mask & WheelStraightMask) == WheelStraightMask) {
+            table[mask] = static_cast<std::int8_t>(Value::Five);
+        }
+    }
+    return table;
+}();
+
+constexpr HandRank getHandTypeBits(HandType handType) {
+    return static_cast<HandRank>(static_cast<std::uint8_t>(handType) + 1) << 20;
+}
+
+constexpr HandRank getKickerBits(int valueID, int kickerIndex) {
+    assert(valueID >= 0 && valueID < 13);
+    assert(kickerIndex >= 0 && kickerIndex < 5);
+    return static_cast<HandRank>(valueID + 2) << (16 - (4 * kickerIndex));
+}
+
+constexpr int getHighestValue(ValueMask mask) {
+    assert(mask != 0);
+    return std::bit_width(static_cast<unsigned>(mask)) - 1;
+}
+
+constexpr ValueMask removeValue(ValueMask mask, int valueID) {
+    return mask & ~static_cast<ValueMask>(1 << valueID);
+}
+
+// Adds the highest values in the mask as kickers, starting from the given kicker index
+constexpr HandRank getTopKickerBits(ValueMask mask, int numKickers, int firstKickerIndex) {
+    HandRank kickerBits = 0;
+    for (int i = 0; i < numKickers; ++i) {
+        int valueID = getHighestValue(mask);
+        kickerBits |= getKickerBits(valueID, firstKickerIndex + i);
+        mask = removeValue(mask, valueID);
+    }
+    return kickerBits;
+}
 } // namespace
 
 HandRank getFiveCardHandRank(CardSet hand) {
@@ -209,4 +252,113 @@ HandRank getFiveCardHandRank(CardSet hand) {
     }
 
     return convertHandStrengthToInt(handStrength);
+}
+
+HandRank getSevenCardHandRank(CardSet hand) {
+    assert(getSetSize(hand) == 7);
+
+    // Produces the same ranking as the best of the 21 five card hands, but without enumerating them
+    std::array<ValueMask, 4> suitMasks = {};
+    std::array<int, 13> valueCounts = {};
+    CardSet temp = hand;
+    while (temp != 0) {
+        CardID card = popLowestCardFromSet(temp);
+        int valueID = static_cast<int>(getCardValue(card));
+        suitMasks[static_cast<int>(getCardSuit(card))] |= static_cast<ValueMask>(1 << valueID);
+        ++valueCounts[valueID];
+    }
+
+    // With 7 cards, a hand containing a flush can't also contain four of a kind or a full house
+    for (ValueMask suitMask : suitMasks) {
+        if (std::popcount(suitMask) >= 5) {
+            int straightFlushHighValue = StraightHighValueTable[suitMask];
+            if (straightFlushHighValue == static_cast<int>(Value::Ace)) {
+                return getHandTypeBits(HandType::RoyalFlush);
+            }
+            else if (straightFlushHighValue != -1) {
+                return getHandTypeBits(HandType::StraightFlush) | getKickerBits(straightFlushHighValue, 0);
+            }
+            else {
+                return getHandTypeBits(HandType::Flush) | getTopKickerBits(suitMask, 5, 0);
+            }
+        }
+    }
+
+    ValueMask allValues = 0;
+    ValueMask pairValues = 0;
+    ValueMask tripsValues = 0;
+    ValueMask quadsValues = 0;
+    for (int valueID = 0; valueID < 13; ++valueID) {
+        ValueMask valueBit = static_cast<ValueMask>(1 << valueID);
+        switch (valueCounts[valueID]) {
+            case 4:
+                quadsValues |= valueBit;
+                break;
+            case 3:
+                tripsValues |= valueBit;
+                break;
+            case 2:
+                pairValues |= valueBit;
+                break;
+            default:
+                assert(valueCounts[valueID] <= 1);
+                break;
+        }
+        if (valueCounts[valueID] > 0) {
+            allValues |= valueBit;
+        }
+    }
+
+    if (quadsValues != 0) {
+        int quadsValue = getHighestValue(quadsValues);
+        return getHandTypeBits(HandType::FourOfAKind)
+            | getKickerBits(quadsValue, 0)
+            | getTopKickerBits(removeValue(allValues, quadsValue), 1, 1);
+    }
+
+    if (tripsValues != 0) {
+        // The pair of a full house can come from a second set of trips
+        int tripsValue = getHighestValue(tripsValues);
+        ValueMask fullHousePairValues = pairValues | removeValue(tripsValues, tripsValue);
+        if (fullHousePairValues != 0) {
+            return getHandTypeBits(HandType::FullHouse)
+                | getKickerBits(tripsValue, 0)
+                | getKickerBits(getHighestValue(fullHousePairValues), 1);
+        }
+    }
+
+    int straightHighValue = StraightHighValueTable[allValues];
+    if (straightHighValue != -1) {
+        return getHandTypeBits(HandType::Straight) | getKickerBits(straightHighValue, 0);
+    }
+
+    if (tripsValues != 0) {
+        int tripsValue = getHighestValue(tripsValues);
+        return getHandTypeBits(HandType::ThreeOfAKind)
+            | getKickerBits(tripsValue, 0)
+            | getTopKickerBits(removeValue(allValues, tripsValue), 2, 1);
+    }
+
+    if (std::popcount(pairValues) >= 2) {
+        int highPairValue = getHighestValue(pairValues);
+        int lowPairValue = getHighestValue(removeValue(pairValues, highPairValue));
+        return getHandTypeBits(HandType::TwoPair)
+            | getKickerBits(highPairValue, 0)
+            | getKickerBits(lowPairValue, 1)
+            | getTopKickerBits(removeValue(removeValue(allValues, highPairValue), lowPairValue), 1, 2);
+    }
+
+    if (pairValues != 0) {
+        int pairValue = getHighestValue(pairValues);
+        return getHandTypeBits(HandType::Pair)
+            | getKickerBits(pairValue, 0)
+            | getTopKickerBits(removeValue(allValues, pairValue), 3, 1);
+    }
+
+    return getHandTypeBits(HandType::HighCard) | getTopKickerBits(allValues, 5, 0);
+}
+
+HandType getHandType(HandRank handRank) {
+    assert(handRank != 0);
+    return static_cast<HandType>((handRank >> 20) - 1);
 }
\ No newline at end of file
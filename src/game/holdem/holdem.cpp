@@ -5,14 +5,25 @@
 #include "game/game_utils.hpp"
 #include "game/holdem/config.hpp"
 #include "game/holdem/hand_evaluation.hpp"
+#include "util/binary_io.hpp"
 #include "util/fixed_vector.hpp"
+#include "util/mapped_file.hpp"
 #include "util/result.hpp"
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <filesystem>
+#include <future>
+#include <iomanip>
+#include <memory>
 #include <optional>
+#include <span>
+#include <sstream>
 #include <string>
+#include <system_error>
 #include <vector>
 
 namespace {
@@ -30,18 +41,6 @@ enum class Action : std::uint8_t {
     AllIn
 };
 
-int mapTwoCardSetToIndex(CardSet cardSet) {
-    assert(getSetSize(cardSet) == 2);
-
-    CardID x = popLowestCardFromSet(cardSet);
-    CardID y = popLowestCardFromSet(cardSet);
-    assert(cardSet == 0);
-
-    int finalIndex = x + ((y * (y - 1)) >> 1);
-    assert(finalIndex < holdem::NumPossibleTwoCardHands);
-    return finalIndex;
-}
-
 std::optional<PlayerArray<int>> tryGetWagersAfterBet(
     PlayerArray<int> oldWagers,
     int deadMoney,
@@ -107,10 +106,96 @@ std::optional<PlayerArray<int>> tryGetWagersAfterRaise(
 
     return newPlayerWagers;
 }
+
+// Bump the version whenever the layout of the hand tables or the hand evaluator changes
+static constexpr std::uint32_t HandTableCacheMagic = 0x48544243; // "HTBC"
+static constexpr std::uint32_t HandTableCacheVersion = 1;
+
+// The largest possible table has one entry per (two card runout, range hand) pair
+static constexpr std::size_t MaxHandTableEntriesPerHand = 1 + holdem::DeckSize + holdem::NumPossibleTwoCardHands;
+
+std::filesystem::path getHandTableCachePath(const Holdem::Settings& settings) {
+    Fnv1aHasher hasher;
+    hasher.add(HandTableCacheVersion);
+    hasher.add(settings.startingCommunityCards);
+    for (Player player : { Player::P0, Player::P1 }) {
+        hasher.addArray(std::span<const CardSet>{ settings.ranges[player].hands });
+    }
+
+    std::ostringstream fileName;
+    fileName << "hand_tables_" << std::hex << std::setw(16) << std::setfill('0') << hasher.getHash() << ".bin";
+    return std::filesystem::path{ settings.handTableCacheDirectory } / fileName.str();
+}
+
+std::uint64_t getHandTableChecksum(const PlayerArray<std::vector<HandInfo>>& validHands, const PlayerArray<std::vector<RankedHand>>& handRanks) {
+    Fnv1aHasher hasher;
+    for (Player player : { Player::P0, Player::P1 }) {
+        hasher.addArray(std::span<const HandInfo>{ validHands[player] });
+        hasher.addArray(std::span<const RankedHand>{ handRanks[player] });
+    }
+    return hasher.getHash();
+}
+
+double getSecondsSince(std::chrono::steady_clock::time_point startTime) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
 } // namespace
 
-Holdem::Holdem(const Settings& settings) : m_settings{ settings } {
-    buildHandTables();
+Holdem::Holdem(const Settings& settings) : m_settings{ settings }, m_handTablesLoadedFromCache{ false } {
+    // The isomorphism tables only depend on the settings, so they are built on another thread while the hand tables are built or loaded
+    auto isomorphismTablesFuture = std::async(std::launch::async, [this]() -> void {
+        auto stageStartTime = std::chrono::steady_clock::now();
+        buildIsomorphismTables();
+        m_setupTimings.isomorphismTablesSeconds = getSecondsSince(stageStartTime);
+    });
+
+    auto handTables = std::make_shared<HandTables>();
+    auto stageStartTime = std::chrono::steady_clock::now();
+    m_handTablesLoadedFromCache = loadHandTablesFromCache(*handTables);
+    m_setupTimings.handTableCacheSeconds = getSecondsSince(stageStartTime);
+
+    if (!m_handTablesLoadedFromCache) {
+        stageStartTime = std::chrono::steady_clock::now();
+        buildHandRanks(*handTables);
+        m_setupTimings.handRanksSeconds = getSecondsSince(stageStartTime);
+
+        stageStartTime = std::chrono::steady_clock::now();
+        buildValidHands(*handTables);
+        m_setupTimings.validHandsSeconds = getSecondsSince(stageStartTime);
+
+        stageStartTime = std::chrono::steady_clock::now();
+        saveHandTablesToCache(*handTables);
+        m_setupTimings.handTableCacheSeconds += getSecondsSince(stageStartTime);
+    }
+
+    stageStartTime = std::chrono::steady_clock::now();
+    buildValidRangeSizes(*handTables);
+    m_setupTimings.validHandsSeconds += getSecondsSince(stageStartTime);
+
+    m_handTables = std::move(handTables);
+    setRunoutHandTables();
+    // get() rethrows an exception from the isomorphism table thread, such as std::bad_alloc
+    isomorphismTablesFuture.get();
+}
+
+Holdem::Holdem(const Settings& settings, const Holdem& handTableSource) :
+    m_settings{ settings },
+    m_handTables{ handTableSource.m_handTables },
+    m_handTablesLoadedFromCache{ false } {
+    assert(canShareHandTables(settings, handTableSource.m_settings));
+    setRunoutHandTables();
+
+    auto stageStartTime = std::chrono::steady_clock::now();
+    buildIsomorphismTables();
+    m_setupTimings.isomorphismTablesSeconds = getSecondsSince(stageStartTime);
+}
+
+bool Holdem::canShareHandTables(const Settings& settings0, const Settings& settings1) {
+    if (settings0.startingCommunityCards != settings1.startingCommunityCards) return false;
+    for (Player player : { Player::P0, Player::P1 }) {
+        if (settings0.ranges[player].hands != settings1.ranges[player].hands) return false;
+    }
+    return true;
 }
 
 GameState Holdem::getInitialGameState() const {
@@ -139,7 +224,7 @@ NodeType Holdem::getNodeType(const GameState& state) const {
     switch (static_cast<Action>(state.lastAction)) {
         case Action::StreetStart:
             if (areBothPlayersAllIn(state)) {
-                // Both players are all in, so we need to simulate a runout.
+                // Both players are all in and all in runouts are expanded, so we need to simulate a runout.
                 // We do this by adding chance nodes to the tree until we reach the river.
                 if (state.currentStreet == Street::River) {
                     return NodeType::Showdown;
@@ -172,7 +257,16 @@ NodeType Holdem::getNodeType(const GameState& state) const {
             assert(state.totalWagers[Player::P0] == state.totalWagers[Player::P1]);
 
             // If we are at the river we are at a showdown node, and if not we are at a chance node
-            return (state.currentStreet == Street::River) ? NodeType::Showdown : NodeType::Chance;
+            // Calling an all in before the river leaves no decisions, so all runouts can be evaluated at once
+            if (state.currentStreet == Street::River) {
+                return NodeType::Showdown;
+            }
+            else if (areBothPlayersAllIn(state) && !m_settings.expandAllInRunouts) {
+                return NodeType::AllInRunout;
+            }
+            else {
+                return NodeType::Chance;
+            }
         }
 
         case Action::BetSize0:
@@ -385,74 +479,15 @@ std::span<const float> Holdem::getInitialRangeWeights(Player player) const {
 }
 
 std::span<const HandInfo> Holdem::getValidHands(Player player, CardSet board) const {
-    CardSet chanceCardsDealt = board & ~m_settings.startingCommunityCards;
-    int runoutIndex;
-    switch (getSetSize(chanceCardsDealt)) {
-        case 0:
-            runoutIndex = 0;
-            break;
-        case 1:
-            runoutIndex = 1 + static_cast<int>(getLowestCardInSet(chanceCardsDealt));
-            break;
-        case 2:
-            runoutIndex = 1 + holdem::DeckSize + mapTwoCardSetToIndex(chanceCardsDealt);
-            break;
-        default:
-            assert(false);
-            runoutIndex = 0;
-            break;
-    }
-
-    std::size_t playerRangeSize = m_settings.ranges[player].hands.size();
-    std::size_t handIndexOffset = runoutIndex * playerRangeSize;
-
-    auto rangeBegin = m_validHands[player].begin() + handIndexOffset;
-    auto rangeEnd = rangeBegin + playerRangeSize;
-
-    // Ignore all invalid hands
-    while (rangeEnd > rangeBegin && *(rangeEnd - 1) == InvalidHand) {
-        --rangeEnd;
-    }
-
-    return { rangeBegin, rangeEnd };
+    return m_runoutHandTables.getValidHands(player, board);
 }
 
 std::span<const RankedHand> Holdem::getValidSortedHandRanks(Player player, CardSet board) const {
-    assert(getSetSize(board) == 5);
-
-    CardSet chanceCardsDealt = board & ~m_settings.startingCommunityCards;
-    int runoutIndex;
-    switch (getSetSize(chanceCardsDealt)) {
-        case 0:
-            assert(getStartingStreet() == Street::River);
-            runoutIndex = 0;
-            break;
-        case 1:
-            assert(getStartingStreet() == Street::Turn);
-            runoutIndex = static_cast<int>(getLowestCardInSet(chanceCardsDealt));
-            break;
-        case 2:
-            assert(getStartingStreet() == Street::Flop);
-            runoutIndex = mapTwoCardSetToIndex(chanceCardsDealt);
-            break;
-        default:
-            assert(false);
-            runoutIndex = 0;
-            break;
-    }
-
-    std::size_t playerRangeSize = m_settings.ranges[player].hands.size();
-    std::size_t handRankOffset = runoutIndex * playerRangeSize;
-
-    auto rangeBegin = m_handRanks[player].begin() + handRankOffset;
-    auto rangeEnd = rangeBegin + playerRangeSize;
-
-    // Ignore all hands that have rank 0 (overlap with the board)
-    while (rangeBegin < rangeEnd && rangeBegin->rank == 0) {
-        ++rangeBegin;
-    }
+    return m_runoutHandTables.getValidSortedHandRanks(player, board);
+}
 
-    return { rangeBegin, rangeEnd };
+const RunoutHandTables* Holdem::getRunoutHandTables() const {
+    return &m_runoutHandTables;
 }
 
 int Holdem::getHandIndexAfterSuitSwap(Player player, int handIndex, Suit x, Suit y) const {
@@ -466,6 +501,11 @@ int Holdem::getHandIndexAfterSuitSwap(Player player, int handIndex, Suit x, Suit
     return static_cast<int>(swappedHandIndex);
 }
 
+int Holdem::getRangeIndex(Player player, CardSet hand) const {
+    if (getSetSize(hand) != 2) return -1;
+    return static_cast<int>(m_handToRangeIndex[player][mapTwoCardSetToIndex(hand)]);
+}
+
 std::string Holdem::getActionName(ActionID actionID, int betRaiseSize) const {
     switch (static_cast<Action>(actionID)) {
         case Action::Fold:
@@ -490,31 +530,129 @@ std::string Holdem::getActionName(ActionID actionID, int betRaiseSize) const {
     }
 }
 
-void Holdem::buildHandTables() {
-    auto insertSevenCardHandRank = [this](Player player, CardSet board, int handRankOffset, int rangeIndex) -> void {
-        m_handRanks[player][handRankOffset + rangeIndex] = { .rank = 0, .info = getHandInfo(player, rangeIndex) };
+bool Holdem::wereHandTablesLoadedFromCache() const {
+    return m_handTablesLoadedFromCache;
+}
 
-        if (getSetSize(board) != 7) return;
+std::size_t Holdem::getHandTablesSize() const {
+    std::size_t size = sizeof(HandTables);
+    for (Player player : { Player::P0, Player::P1 }) {
+        size += m_handTables->validHands[player].capacity() * sizeof(HandInfo);
+        size += m_handTables->handRanks[player].capacity() * sizeof(RankedHand);
+        size += m_handTables->numValidHands[player].capacity() * sizeof(int);
+        size += m_handTables->numValidHandRanks[player].capacity() * sizeof(int);
+    }
+    return size;
+}
+
+std::size_t Holdem::estimateHandTablesSize(const Settings& settings) {
+    // Number of runouts in the hand rank and valid hand tables, see buildHandRanks and buildValidHands
+    std::size_t numHandRankRunouts;
+    std::size_t numValidHandRunouts;
+    switch (getSetSize(settings.startingCommunityCards)) {
+        case 5:
+            numHandRankRunouts = 1;
+            numValidHandRunouts = 1;
+            break;
+        case 4:
+            numHandRankRunouts = holdem::DeckSize;
+            numValidHandRunouts = 1 + holdem::DeckSize;
+            break;
+        case 3:
+            numHandRankRunouts = holdem::NumPossibleTwoCardHands;
+            numValidHandRunouts = 1 + holdem::DeckSize + holdem::NumPossibleTwoCardHands;
+            break;
+        default:
+            assert(false);
+            return 0;
+    }
+
+    std::size_t size = sizeof(HandTables);
+    for (Player player : { Player::P0, Player::P1 }) {
+        std::size_t playerRangeSize = settings.ranges[player].hands.size();
+        size += numValidHandRunouts * (playerRangeSize * sizeof(HandInfo) + sizeof(int));
+        size += numHandRankRunouts * (playerRangeSize * sizeof(RankedHand) + sizeof(int));
+    }
+    return size;
+}
+
+const Holdem::SetupTimings& Holdem::getSetupTimings() const {
+    return m_setupTimings;
+}
+
+bool Holdem::loadHandTablesFromCache(HandTables& handTables) const {
+    if (m_settings.handTableCacheDirectory.empty()) return false;
+
+    MappedFile file{ getHandTableCachePath(m_settings) };
+    if (!file.isGood()) return false;
+    BinaryReader reader{ file.getBytes() };
+
+    auto readTables = [&]() -> bool {
+        if (!reader.expect(HandTableCacheMagic) || !reader.expect(HandTableCacheVersion)) return false;
+
+        // The file name is only a hash, so check the full key to rule out collisions
+        if (!reader.expect(m_settings.startingCommunityCards)) return false;
+        for (Player player : { Player::P0, Player::P1 }) {
+            const std::vector<CardSet>& rangeHands = m_settings.ranges[player].hands;
+            std::vector<CardSet> cachedRangeHands;
+            if (!reader.readArray(cachedRangeHands, rangeHands.size()) || cachedRangeHands != rangeHands) return false;
+        }
 
-        std::array<CardID, 7> sevenCardArray;
-        CardSet temp = board;
-        for (int i = 0; i < 7; ++i) {
-            sevenCardArray[i] = popLowestCardFromSet(temp);
+        for (Player player : { Player::P0, Player::P1 }) {
+            std::size_t maxTableSize = MaxHandTableEntriesPerHand * m_settings.ranges[player].hands.size();
+            if (!reader.readArray(handTables.validHands[player], maxTableSize)) return false;
+            if (!reader.readArray(handTables.handRanks[player], maxTableSize)) return false;
         }
-        assert(temp == 0);
-
-        HandRank handRanking = 0;
-        for (int i = 0; i < 7; ++i) {
-            for (int j = i + 1; j < 7; ++j) {
-                CardSet cardsToIgnore = cardIDToSet(sevenCardArray[i]) | cardIDToSet(sevenCardArray[j]);
-                CardSet fiveCardHand = board & ~cardsToIgnore;
-                HandRank fiveCardHandRanking = getFiveCardHandRank(fiveCardHand);
-                handRanking = std::max(handRanking, fiveCardHandRanking);
-            }
+
+        return reader.expect(getHandTableChecksum(handTables.validHands, handTables.handRanks)) && reader.isAtEnd();
+    };
+
+    if (!readTables()) {
+        // Fall back to building the tables from scratch
+        for (Player player : { Player::P0, Player::P1 }) {
+            handTables.validHands[player].clear();
+            handTables.handRanks[player].clear();
         }
+        return false;
+    }
+
+    return true;
+}
+
+void Holdem::saveHandTablesToCache(const HandTables& handTables) const {
+    if (m_settings.handTableCacheDirectory.empty()) return;
 
+    // Caching is best effort, so failures are silently ignored
+    std::error_code error;
+    std::filesystem::create_directories(m_settings.handTableCacheDirectory, error);
+    if (error) return;
+
+    BinaryWriter writer{ getHandTableCachePath(m_settings) };
+    if (!writer.isGood()) return;
+
+    writer.write(HandTableCacheMagic);
+    writer.write(HandTableCacheVersion);
+    writer.write(m_settings.startingCommunityCards);
+    for (Player player : { Player::P0, Player::P1 }) {
+        writer.writeArray(std::span<const CardSet>{ m_settings.ranges[player].hands });
+    }
+    for (Player player : { Player::P0, Player::P1 }) {
+        writer.writeArray(std::span<const HandInfo>{ handTables.validHands[player] });
+        writer.writeArray(std::span<const RankedHand>{ handTables.handRanks[player] });
+    }
+    writer.write(getHandTableChecksum(handTables.validHands, handTables.handRanks));
+    writer.commit();
+}
+
+void Holdem::buildHandRanks(HandTables& handTables) const {
+    auto insertSevenCardHandRank = [this, &handTables](Player player, CardSet board, int handRankOffset, int rangeIndex) -> void {
+        handTables.handRanks[player][handRankOffset + rangeIndex] = { .rank = 0, .info = getHandInfo(player, rangeIndex) };
+
+        if (getSetSize(board) != 7) return;
+
+        HandRank handRanking = getSevenCardHandRank(board);
         assert(handRanking != 0);
-        m_handRanks[player][handRankOffset + rangeIndex].rank = handRanking;
+        handTables.handRanks[player][handRankOffset + rangeIndex].rank = handRanking;
     };
 
     const auto& startingCards = m_settings.startingCommunityCards;
@@ -529,20 +667,20 @@ void Holdem::buildHandTables() {
         switch (startingStreet) {
             case Street::River:
                 // We are starting at the river, so we can directly map player range indices into the hand ranking table
-                m_handRanks[player].resize(playerRangeSize);
+                handTables.handRanks[player].resize(playerRangeSize);
 
                 for (int rangeIndex = 0; rangeIndex < playerRangeSize; ++rangeIndex) {
                     CardSet board = ranges[player].hands[rangeIndex] | startingCards;
                     insertSevenCardHandRank(player, board, 0, rangeIndex);
                 }
 
-                std::sort(m_handRanks[player].begin(), m_handRanks[player].end());
+                std::sort(handTables.handRanks[player].begin(), handTables.handRanks[player].end());
                 break;
 
             case Street::Turn: {
                 // We are starting at the turn, so we have to consider each possible river runout
                 int handRankTableSize = holdem::DeckSize * playerRangeSize;
-                m_handRanks[player].resize(handRankTableSize);
+                handTables.handRanks[player].resize(handRankTableSize);
 
                 #ifdef _OPENMP
                 #pragma omp parallel for num_threads(m_settings.numThreads) schedule(dynamic)
@@ -556,8 +694,8 @@ void Holdem::buildHandTables() {
                     }
 
                     std::sort(
-                        m_handRanks[player].begin() + handRankOffset,
-                        m_handRanks[player].begin() + handRankOffset + playerRangeSize
+                        handTables.handRanks[player].begin() + handRankOffset,
+                        handTables.handRanks[player].begin() + handRankOffset + playerRangeSize
                     );
                 }
 
@@ -567,7 +705,7 @@ void Holdem::buildHandTables() {
             case Street::Flop: {
                 // We are starting at the flop, so we have to consider each possible turn and river runout
                 int handRankTableSize = holdem::NumPossibleTwoCardHands * playerRangeSize;
-                m_handRanks[player].resize(handRankTableSize);
+                handTables.handRanks[player].resize(handRankTableSize);
 
                 #ifdef _OPENMP
                 #pragma omp parallel for num_threads(m_settings.numThreads) schedule(dynamic)
@@ -583,8 +721,8 @@ void Holdem::buildHandTables() {
                         }
 
                         std::sort(
-                            m_handRanks[player].begin() + handRankOffset,
-                            m_handRanks[player].begin() + handRankOffset + playerRangeSize
+                            handTables.handRanks[player].begin() + handRankOffset,
+                            handTables.handRanks[player].begin() + handRankOffset + playerRangeSize
                         );
                     }
                 }
@@ -598,23 +736,34 @@ void Holdem::buildHandTables() {
         }
     }
 
+}
+
+void Holdem::buildValidHands(HandTables& handTables) const {
+    const auto& ranges = m_settings.ranges;
+
+    Street startingStreet = getStartingStreet();
+
     // Build valid indices table for fold nodes
-    auto insertValidIndicesEmptyBoard = [this](Player player) -> void {
+    // Every runout writes its own part of the table, so the runouts are split between threads
+    auto insertValidIndicesEmptyBoard = [this, &handTables](Player player) -> void {
         const auto& playerHands = m_settings.ranges[player].hands;
 
         int indexInTable = 0;
         for (int handIndex = 0; handIndex < playerHands.size(); ++handIndex) {
             if (!doSetsOverlap(playerHands[handIndex], m_settings.startingCommunityCards)) {
-                m_validHands[player][indexInTable] = getHandInfo(player, handIndex);
+                handTables.validHands[player][indexInTable] = getHandInfo(player, handIndex);
                 ++indexInTable;
             }
         }
     };
 
-    auto insertValidIndicesOneCardBoards = [this](Player player) -> void {
+    auto insertValidIndicesOneCardBoards = [this, &handTables](Player player) -> void {
         CardSet startingBoard = m_settings.startingCommunityCards;
         const auto& playerHands = m_settings.ranges[player].hands;
 
+        #ifdef _OPENMP
+        #pragma omp parallel for num_threads(m_settings.numThreads) schedule(dynamic)
+        #endif
         for (CardID card = 0; card < holdem::DeckSize; ++card) {
             if (setContainsCard(startingBoard, card)) continue;
 
@@ -622,17 +771,20 @@ void Holdem::buildHandTables() {
             int indexInTable = 0;
             for (int handIndex = 0; handIndex < playerHands.size(); ++handIndex) {
                 if (!doSetsOverlap(playerHands[handIndex], startingBoard | cardIDToSet(card))) {
-                    m_validHands[player][validIndexOffset + indexInTable] = getHandInfo(player, handIndex);
+                    handTables.validHands[player][validIndexOffset + indexInTable] = getHandInfo(player, handIndex);
                     ++indexInTable;
                 }
             }
         }
     };
 
-    auto insertValidIndicesTwoCardBoards = [this](Player player) -> void {
+    auto insertValidIndicesTwoCardBoards = [this, &handTables](Player player) -> void {
         CardSet startingBoard = m_settings.startingCommunityCards;
         const auto& playerHands = m_settings.ranges[player].hands;
 
+        #ifdef _OPENMP
+        #pragma omp parallel for num_threads(m_settings.numThreads) schedule(dynamic)
+        #endif
         for (CardID turnCard = 0; turnCard < holdem::DeckSize; ++turnCard) {
             for (CardID riverCard = turnCard + 1; riverCard < holdem::DeckSize; ++riverCard) {
                 CardSet runout = cardIDToSet(turnCard) | cardIDToSet(riverCard);
@@ -642,7 +794,7 @@ void Holdem::buildHandTables() {
                 int indexInTable = 0;
                 for (int handIndex = 0; handIndex < playerHands.size(); ++handIndex) {
                     if (!doSetsOverlap(startingBoard | runout, playerHands[handIndex])) {
-                        m_validHands[player][validIndexOffset + indexInTable] = getHandInfo(player, handIndex);
+                        handTables.validHands[player][validIndexOffset + indexInTable] = getHandInfo(player, handIndex);
                         ++indexInTable;
                     }
                 }
@@ -656,20 +808,20 @@ void Holdem::buildHandTables() {
         switch (startingStreet) {
             case Street::River: {
                 static constexpr int NumEntries = 1;
-                m_validHands[player].assign(NumEntries * playerRangeSize, InvalidHand);
+                handTables.validHands[player].assign(NumEntries * playerRangeSize, InvalidHand);
                 insertValidIndicesEmptyBoard(player);
                 break;
             }
             case Street::Turn: {
                 static constexpr int NumEntries = 1 + holdem::DeckSize;
-                m_validHands[player].assign(NumEntries * playerRangeSize, InvalidHand);
+                handTables.validHands[player].assign(NumEntries * playerRangeSize, InvalidHand);
                 insertValidIndicesEmptyBoard(player);
                 insertValidIndicesOneCardBoards(player);
                 break;
             }
             case Street::Flop: {
                 static constexpr int NumEntries = 1 + holdem::DeckSize + holdem::NumPossibleTwoCardHands;
-                m_validHands[player].assign(NumEntries * playerRangeSize, InvalidHand);
+                handTables.validHands[player].assign(NumEntries * playerRangeSize, InvalidHand);
                 insertValidIndicesEmptyBoard(player);
                 insertValidIndicesOneCardBoards(player);
                 insertValidIndicesTwoCardBoards(player);
@@ -680,17 +832,60 @@ void Holdem::buildHandTables() {
                 break;
         }
     }
+}
 
-    if (m_settings.useChanceCardIsomorphism) {
-        // Build hand index table for card isomorphisms
-        for (Player player : { Player::P0, Player::P1 }) {
-            m_handToRangeIndex[player].fill(-1);
-            for (int handIndex = 0; handIndex < m_settings.ranges[player].hands.size(); ++handIndex) {
-                int handIndexInTable = mapTwoCardSetToIndex(m_settings.ranges[player].hands[handIndex]);
-                m_handToRangeIndex[player][handIndexInTable] = static_cast<std::int16_t>(handIndex);
-            }
+void Holdem::buildValidRangeSizes(HandTables& handTables) const {
+    // The CFR traversal asks for the valid hands at every chance, fold and showdown node,
+    // so the size of each runout is counted once instead of scanning past the blocked hands on every lookup
+    for (Player player : { Player::P0, Player::P1 }) {
+        std::size_t playerRangeSize = m_settings.ranges[player].hands.size();
+        assert(playerRangeSize > 0);
+
+        std::span<const HandInfo> validHands = handTables.validHands[player];
+        std::size_t numValidHandRunouts = validHands.size() / playerRangeSize;
+        handTables.numValidHands[player].resize(numValidHandRunouts);
+        for (std::size_t runoutIndex = 0; runoutIndex < numValidHandRunouts; ++runoutIndex) {
+            auto runoutHands = validHands.subspan(runoutIndex * playerRangeSize, playerRangeSize);
+            auto validEnd = std::find(runoutHands.begin(), runoutHands.end(), InvalidHand);
+            handTables.numValidHands[player][runoutIndex] = static_cast<int>(validEnd - runoutHands.begin());
+        }
+
+        std::span<const RankedHand> handRanks = handTables.handRanks[player];
+        std::size_t numHandRankRunouts = handRanks.size() / playerRangeSize;
+        handTables.numValidHandRanks[player].resize(numHandRankRunouts);
+        for (std::size_t runoutIndex = 0; runoutIndex < numHandRankRunouts; ++runoutIndex) {
+            auto runoutHandRanks = handRanks.subspan(runoutIndex * playerRangeSize, playerRangeSize);
+            auto numBlockedHands = std::count_if(runoutHandRanks.begin(), runoutHandRanks.end(), [](const RankedHand& rankedHand) {
+                return rankedHand.rank == 0;
+            });
+            handTables.numValidHandRanks[player][runoutIndex] = static_cast<int>(playerRangeSize - numBlockedHands);
         }
+    }
+}
 
+// The tables point into the shared hand tables, which stay alive as long as this Holdem
+void Holdem::setRunoutHandTables() {
+    m_runoutHandTables.startingBoard = m_settings.startingCommunityCards;
+    for (Player player : { Player::P0, Player::P1 }) {
+        m_runoutHandTables.rangeSize[player] = m_settings.ranges[player].hands.size();
+        m_runoutHandTables.validHands[player] = m_handTables->validHands[player];
+        m_runoutHandTables.numValidHands[player] = m_handTables->numValidHands[player];
+        m_runoutHandTables.handRanks[player] = m_handTables->handRanks[player];
+        m_runoutHandTables.numValidHandRanks[player] = m_handTables->numValidHandRanks[player];
+    }
+}
+
+void Holdem::buildIsomorphismTables() {
+    // Build hand index table for card isomorphisms and range index lookups
+    for (Player player : { Player::P0, Player::P1 }) {
+        m_handToRangeIndex[player].fill(-1);
+        for (int handIndex = 0; handIndex < m_settings.ranges[player].hands.size(); ++handIndex) {
+            int handIndexInTable = mapTwoCardSetToIndex(m_settings.ranges[player].hands[handIndex]);
+            m_handToRangeIndex[player][handIndexInTable] = static_cast<std::int16_t>(handIndex);
+        }
+    }
+
+    if (m_settings.useChanceCardIsomorphism) {
         // Build chance card isomorphism tables
         auto mergeSuitClasses = [](FixedVector<SuitEquivalenceClass, 4>& isomorphisms, Suit x, Suit y) -> void {
             // Inefficient, but there are only 4 suits...
@@ -744,7 +939,7 @@ void Holdem::buildHandTables() {
 
         m_startingIsomorphisms = IdentityIsomorphism;
 
-        bool willTurnBeDealt = (startingStreet == Street::Flop);
+        bool willTurnBeDealt = (getStartingStreet() == Street::Flop);
 
         if (willTurnBeDealt) {
             for (int suit = 0; suit < 4; ++suit) {
@@ -171,6 +171,13 @@ int KuhnPoker::getHandIndexAfterSuitSwap(Player /*player*/, int /*handIndex*/, S
     return -1;
 }
 
+int KuhnPoker::getRangeIndex(Player /*player*/, CardSet hand) const {
+    for (int handIndex = 0; handIndex < static_cast<int>(PossibleHands.size()); ++handIndex) {
+        if (PossibleHands[handIndex] == hand) return handIndex;
+    }
+    return -1;
+}
+
 std::string KuhnPoker::getActionName(ActionID actionID, int /*betRaiseSize*/) const {
     switch (static_cast<Action>(actionID)) {
         case Action::Fold:
@@ -340,6 +340,14 @@ int LeducPoker::getHandIndexAfterSuitSwap(Player /*player*/, int handIndex, Suit
     return handIndex ^ 1;
 }
 
+int LeducPoker::getRangeIndex(Player /*player*/, CardSet hand) const {
+    // There are only 6 hands, so a scan is as fast as a table
+    for (int handIndex = 0; handIndex < static_cast<int>(PossibleHands.size()); ++handIndex) {
+        if (PossibleHands[handIndex] == hand) return handIndex;
+    }
+    return -1;
+}
+
 std::string LeducPoker::getActionName(ActionID actionID, int betRaiseSize) const {
     switch (static_cast<Action>(actionID)) {
         case Action::Fold:
@@ -1,9 +1,44 @@
+#include "cli/batch_solver.hpp"
 #include "cli/cli_dispatcher.hpp"
+#include "cli/distributed_worker.hpp"
+#include "cli/query_server.hpp"
 #include "cli/solver_commands.hpp"
+#include "util/string_utils.hpp"
 
 #include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string_view>
+
+int main(int argc, char** argv) {
+    if (argc == 3 && std::string_view{ argv[1] } == "--batch") {
+        return runBatch(argv[2]) ? 0 : 1;
+    }
+
+    if (argc == 3 && std::string_view{ argv[1] } == "--aggregate") {
+        return runAggregate(argv[2]) ? 0 : 1;
+    }
+
+    if (argc == 3 && std::string_view{ argv[1] } == "--serve") {
+        return runQueryServer(argv[2]) ? 0 : 1;
+    }
+
+    if (argc == 4 && std::string_view{ argv[1] } == "--worker") {
+        std::optional<int> port = parseInt(argv[3]);
+        if (!port || (*port <= 0) || (*port > std::numeric_limits<std::uint16_t>::max())) {
+            std::cerr << "Error: Invalid port " << argv[3] << ".\n";
+            return 1;
+        }
+        return runDistributedWorker(argv[2], static_cast<std::uint16_t>(*port)) ? 0 : 1;
+    }
+
+    if (argc != 1) {
+        std::cerr << "Usage: " << argv[0] << " [--batch manifest.yml | --aggregate manifest.yml | --worker settings.yml port | --serve manifest.yml]\n";
+        return 1;
+    }
 
-int main() {
     CliDispatcher dispatcher("PostflopSolver", Version{ .major = 1, .minor = 0, .patch = 0 });
     SolverContext context;
     bool success = registerAllCommands(dispatcher, context);
@@ -3,19 +3,24 @@
 #include "game/game_rules.hpp"
 #include "game/game_types.hpp"
 #include "game/game_utils.hpp"
+#include "solver/distributed.hpp"
+#include "solver/simd_kernels.hpp"
+#include "solver/traversal_profiler.hpp"
 #include "solver/tree.hpp"
 #include "util/fixed_vector.hpp"
 #include "util/stack_allocator.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <numeric>
 #include <optional>
-#include <ranges>
 #include <span>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -27,17 +32,15 @@
 // TODO: Add back intermediate calculation with doubles
 
 namespace {
-enum class TraversalMode : std::uint8_t {
-    VanillaCfr,
-    CfrPlus,
-    DiscountedCfr,
-    ExpectedValue,
-    BestResponse
-};
-
 struct TraversalConstants {
-    Player hero;
-    DiscountParams params;
+    Player hero = Player::P0;
+    DiscountParams params = {};
+    float taskWorkThreshold = 0.0f;
+    bool usePruning = false;
+    ChanceSampling sampling = {};
+
+    // Only set by expected value traversals that report the hero's decision nodes, see visitDecisionNodeSolutions
+    const DecisionNodeVisitor* visitor = nullptr;
 };
 
 constexpr bool isCfr(TraversalMode mode) {
@@ -54,81 +57,248 @@ int getThreadIndex() {
     #endif
 }
 
-bool shouldParallelize(Street currentStreet, Street startingStreet) {
-    return (currentStreet == startingStreet) && (startingStreet != Street::River);
+// Children with at least this much estimated work are traversed in their own OpenMP task
+// Aim for many tasks per thread so that idle threads can steal work when subtrees are unbalanced,
+// but never spawn tasks for subtrees so small that the task overhead would dominate
+float getTaskWorkThreshold(const Tree& tree) {
+    #ifdef _OPENMP
+    static constexpr float TasksPerThread = 16.0f;
+    static constexpr float MinTaskWork = 8192.0f;
+
+    int numThreads = omp_get_num_threads();
+    if (numThreads > 1) {
+        float rootWork = tree.allNodes[tree.getRootNodeIndex()].subtreeWork;
+        return std::max(rootWork / (static_cast<float>(numThreads) * TasksPerThread), MinTaskWork);
+    }
+    #endif
+
+    // Outside of a parallel region there are no other threads to run tasks
+    return std::numeric_limits<float>::infinity();
+}
+
+bool shouldSpawnTask(const Node& childNode, const TraversalConstants& constants) {
+    return childNode.subtreeWork >= constants.taskWorkThreshold;
 }
 
-void writeCurrentStrategyToBuffer(std::span<float> currentStrategyBuffer, const Node& decisionNode, const Tree& tree, StackAllocator<float>& allocator) {
+// Training data only has entries for the hands of the player to act that are not blocked by the board of the decision node
+// Entry i of an action belongs to the hand at trainingHands[i], which are sorted by hand index
+template <typename GameRules>
+std::span<const HandInfo> getTrainingHands(const Node& decisionNode, const GameRules& rules) {
     assert(decisionNode.nodeType == NodeType::Decision);
+    return rules.getValidHands(decisionNode.playerToAct, decisionNode.board);
+}
 
-    int numActions = decisionNode.numChildren;
-    int playerToActRangeSize = tree.rangeSize[decisionNode.state.playerToAct];
-    assert(numActions > 0);
-    assert(currentStrategyBuffer.size() == numActions * playerToActRangeSize);
+[[maybe_unused]] bool isTrainingDataSizeValid(std::size_t trainingDataSize, const Node& decisionNode, const Tree& tree) {
+    assert(decisionNode.nodeType == NodeType::Decision);
+    std::size_t maxTrainingDataSize = static_cast<std::size_t>(decisionNode.numChildren) * tree.rangeSize[decisionNode.playerToAct];
+    return (trainingDataSize % decisionNode.numChildren == 0) && (trainingDataSize <= maxTrainingDataSize);
+}
 
-    ScopedVector<float> totalPositiveRegrets(allocator, getThreadIndex(), playerToActRangeSize);
-    std::fill(totalPositiveRegrets.begin(), totalPositiveRegrets.end(), 0.0f);
+// Per hand arrays are indexed by the whole range during traversal, while strategies and training data only cover the training hands
+// Blocked hands have zero reach probability and zero expected value, so they are skipped when converting between the two
+bool isRangeCompacted(std::span<const HandInfo> trainingHands, int rangeSize) {
+    assert(trainingHands.size() <= static_cast<std::size_t>(rangeSize));
+    return trainingHands.size() < static_cast<std::size_t>(rangeSize);
+}
 
-    const auto regretSums = tree.allRegretSums.begin() + decisionNode.trainingDataOffset;
+// newReachProbs[hand] = reachProbs[hand] * actionStrategy[hand] over the whole range
+void writeActionReachProbs(
+    std::span<float> newReachProbs,
+    std::span<const float> reachProbs,
+    std::span<const float> actionStrategy,
+    std::span<const HandInfo> trainingHands
+) {
+    int rangeSize = static_cast<int>(reachProbs.size());
+    assert(newReachProbs.size() == reachProbs.size());
+    assert(actionStrategy.size() == trainingHands.size());
 
-    for (int action = 0; action < numActions; ++action) {
-        for (int hand = 0; hand < playerToActRangeSize; ++hand) {
-            float positiveRegret = std::max(regretSums[action * playerToActRangeSize + hand], 0.0f);
-            currentStrategyBuffer[action * playerToActRangeSize + hand] = positiveRegret;
-            totalPositiveRegrets[hand] += positiveRegret;
+    if (!isRangeCompacted(trainingHands, rangeSize)) {
+        for (int hand = 0; hand < rangeSize; ++hand) {
+            newReachProbs[hand] = reachProbs[hand] * actionStrategy[hand];
         }
+        return;
+    }
+
+    std::fill(newReachProbs.begin(), newReachProbs.end(), 0.0f);
+    for (std::size_t i = 0; i < trainingHands.size(); ++i) {
+        int hand = trainingHands[i].index;
+        newReachProbs[hand] = reachProbs[hand] * actionStrategy[i];
+    }
+}
+
+// outputExpectedValues[hand] += actionExpectedValues[hand] * actionStrategy[hand] over the whole range
+void accumulateStrategyExpectedValues(
+    std::span<float> outputExpectedValues,
+    std::span<const float> actionExpectedValues,
+    std::span<const float> actionStrategy,
+    std::span<const HandInfo> trainingHands
+) {
+    int rangeSize = static_cast<int>(outputExpectedValues.size());
+    assert(actionExpectedValues.size() == outputExpectedValues.size());
+    assert(actionStrategy.size() == trainingHands.size());
+
+    if (!isRangeCompacted(trainingHands, rangeSize)) {
+        accumulateWeightedValues(outputExpectedValues, actionExpectedValues, actionStrategy);
+        return;
+    }
+
+    for (std::size_t i = 0; i < trainingHands.size(); ++i) {
+        int hand = trainingHands[i].index;
+        outputExpectedValues[hand] += actionExpectedValues[hand] * actionStrategy[i];
     }
+}
 
-    float numActionsInverse = 1.0f / static_cast<float>(numActions);
+// Moves numActions rows of whole range values to the training hand layout in place
+void compactRangeToTrainingHands(std::span<float> values, int numActions, std::span<const HandInfo> trainingHands, int rangeSize) {
+    int numTrainingHands = static_cast<int>(trainingHands.size());
+    assert(values.size() == static_cast<std::size_t>(numActions * rangeSize));
+    if (!isRangeCompacted(trainingHands, rangeSize)) return;
+
+    // Every value moves to a lower index, so going forwards never overwrites a value that has not been moved yet
     for (int action = 0; action < numActions; ++action) {
-        for (int hand = 0; hand < playerToActRangeSize; ++hand) {
-            if (totalPositiveRegrets[hand] > 0.0f) {
-                currentStrategyBuffer[action * playerToActRangeSize + hand] /= totalPositiveRegrets[hand];
-            }
-            else {
-                // Play a uniform strategy if no action has positive regret
-                assert(totalPositiveRegrets[hand] == 0.0f);
-                currentStrategyBuffer[action * playerToActRangeSize + hand] = numActionsInverse;
-            }
+        for (int i = 0; i < numTrainingHands; ++i) {
+            values[action * numTrainingHands + i] = values[action * rangeSize + trainingHands[i].index];
         }
     }
 }
+} // namespace
+
+// Compressed regrets are stored as signed 16 bit integers and compressed strategy sums as unsigned 16 bit integers
+// Each decision node has one scale factor for each, chosen so that the largest magnitude value in the node maps to the largest integer
+constexpr float MaxCompressedRegret = static_cast<float>(std::numeric_limits<std::int16_t>::max());
+constexpr float MaxCompressedStrategy = static_cast<float>(std::numeric_limits<std::uint16_t>::max());
+
+void decodeRegretSums(std::span<float> outputRegretSums, const Node& decisionNode, const Tree& tree) {
+    assert(tree.isTrainingDataCompressed());
+    assert(isTrainingDataSizeValid(outputRegretSums.size(), decisionNode, tree));
+
+    const auto compressedRegretSums = tree.allCompressedRegretSums.begin() + decisionNode.trainingDataOffset;
+    float scale = tree.allRegretSumScales[decisionNode.decisionNodeIndex];
+
+    for (std::size_t i = 0; i < outputRegretSums.size(); ++i) {
+        outputRegretSums[i] = static_cast<float>(compressedRegretSums[i]) * scale;
+    }
+}
+
+void encodeRegretSums(std::span<const float> inputRegretSums, const Node& decisionNode, Tree& tree) {
+    assert(tree.isTrainingDataCompressed());
+    assert(isTrainingDataSizeValid(inputRegretSums.size(), decisionNode, tree));
+
+    float maxAbsoluteRegret = 0.0f;
+    for (float regret : inputRegretSums) {
+        maxAbsoluteRegret = std::max(maxAbsoluteRegret, std::abs(regret));
+    }
+
+    auto compressedRegretSums = tree.allCompressedRegretSums.begin() + decisionNode.trainingDataOffset;
+
+    if (maxAbsoluteRegret == 0.0f) {
+        std::fill(compressedRegretSums, compressedRegretSums + inputRegretSums.size(), 0);
+        tree.allRegretSumScales[decisionNode.decisionNodeIndex] = 0.0f;
+        return;
+    }
+
+    float inverseScale = MaxCompressedRegret / maxAbsoluteRegret;
+    for (std::size_t i = 0; i < inputRegretSums.size(); ++i) {
+        float scaledRegret = std::clamp(inputRegretSums[i] * inverseScale, -MaxCompressedRegret, MaxCompressedRegret);
+        compressedRegretSums[i] = static_cast<std::int16_t>(std::lrint(scaledRegret));
+    }
+    tree.allRegretSumScales[decisionNode.decisionNodeIndex] = maxAbsoluteRegret / MaxCompressedRegret;
+}
+
+void decodeStrategySums(std::span<float> outputStrategySums, const Node& decisionNode, const Tree& tree) {
+    assert(tree.isTrainingDataCompressed());
+    assert(isTrainingDataSizeValid(outputStrategySums.size(), decisionNode, tree));
+
+    const auto compressedStrategySums = tree.getCompressedStrategySums().begin() + decisionNode.trainingDataOffset;
+    float scale = tree.getStrategySumScales()[decisionNode.decisionNodeIndex];
+
+    for (std::size_t i = 0; i < outputStrategySums.size(); ++i) {
+        outputStrategySums[i] = static_cast<float>(compressedStrategySums[i]) * scale;
+    }
+}
+
+void encodeStrategySums(std::span<const float> inputStrategySums, const Node& decisionNode, Tree& tree) {
+    assert(tree.isTrainingDataCompressed());
+    assert(isTrainingDataSizeValid(inputStrategySums.size(), decisionNode, tree));
+
+    float maxStrategy = 0.0f;
+    for (float strategy : inputStrategySums) {
+        assert(strategy >= 0.0f);
+        maxStrategy = std::max(maxStrategy, strategy);
+    }
+
+    auto compressedStrategySums = tree.allCompressedStrategySums.begin() + decisionNode.trainingDataOffset;
+
+    if (maxStrategy == 0.0f) {
+        std::fill(compressedStrategySums, compressedStrategySums + inputStrategySums.size(), 0);
+        tree.allStrategySumScales[decisionNode.decisionNodeIndex] = 0.0f;
+        return;
+    }
+
+    float inverseScale = MaxCompressedStrategy / maxStrategy;
+    for (std::size_t i = 0; i < inputStrategySums.size(); ++i) {
+        float scaledStrategy = std::min(inputStrategySums[i] * inverseScale, MaxCompressedStrategy);
+        compressedStrategySums[i] = static_cast<std::uint16_t>(std::lrint(scaledStrategy));
+    }
+    tree.allStrategySumScales[decisionNode.decisionNodeIndex] = maxStrategy / MaxCompressedStrategy;
+}
 
-void writeAverageStrategyToBuffer(std::span<float> averageStrategyBuffer, const Node& decisionNode, const Tree& tree, StackAllocator<float>& allocator) {
+namespace {
+// Strategies are written in the training hand layout
+void writeCurrentStrategyToBuffer(
+    std::span<float> currentStrategyBuffer,
+    const Node& decisionNode,
+    std::span<const HandInfo> trainingHands,
+    const Tree& tree
+) {
     assert(decisionNode.nodeType == NodeType::Decision);
 
     int numActions = decisionNode.numChildren;
-    int playerToActRangeSize = tree.rangeSize[decisionNode.state.playerToAct];
+    [[maybe_unused]] int numTrainingHands = static_cast<int>(trainingHands.size());
     assert(numActions > 0);
-    assert(averageStrategyBuffer.size() == numActions * playerToActRangeSize);
+    assert(currentStrategyBuffer.size() == numActions * numTrainingHands);
+    assert(isTrainingDataSizeValid(currentStrategyBuffer.size(), decisionNode, tree));
+
+    // Compressed regrets are decoded directly into the output buffer, which is then normalized in place
+    std::span<const float> regretSums;
+    if (tree.isTrainingDataCompressed()) {
+        decodeRegretSums(currentStrategyBuffer, decisionNode, tree);
+        regretSums = currentStrategyBuffer;
+    }
+    else {
+        regretSums = { tree.allRegretSums.begin() + decisionNode.trainingDataOffset, currentStrategyBuffer.size() };
+    }
 
-    ScopedVector<float> totalStrategy(allocator, getThreadIndex(), playerToActRangeSize);
-    std::fill(totalStrategy.begin(), totalStrategy.end(), 0.0f);
+    // Play a uniform strategy if no action has positive regret
+    normalizeRegretSums(currentStrategyBuffer, regretSums, numActions);
+}
 
-    const auto strategySums = tree.allStrategySums.begin() + decisionNode.trainingDataOffset;
+void writeAverageStrategyToBuffer(
+    std::span<float> averageStrategyBuffer,
+    const Node& decisionNode,
+    std::span<const HandInfo> trainingHands,
+    const Tree& tree
+) {
+    assert(decisionNode.nodeType == NodeType::Decision);
 
-    for (int action = 0; action < numActions; ++action) {
-        for (int hand = 0; hand < playerToActRangeSize; ++hand) {
-            float strategy = strategySums[action * playerToActRangeSize + hand];
-            assert(strategy >= 0.0f);
-            averageStrategyBuffer[action * playerToActRangeSize + hand] = strategy;
-            totalStrategy[hand] += strategy;
-        }
+    int numActions = decisionNode.numChildren;
+    [[maybe_unused]] int numTrainingHands = static_cast<int>(trainingHands.size());
+    assert(numActions > 0);
+    assert(averageStrategyBuffer.size() == numActions * numTrainingHands);
+    assert(isTrainingDataSizeValid(averageStrategyBuffer.size(), decisionNode, tree));
+
+    // Compressed strategy sums are decoded directly into the output buffer, which is then normalized in place
+    std::span<const float> strategySums;
+    if (tree.isTrainingDataCompressed()) {
+        decodeStrategySums(averageStrategyBuffer, decisionNode, tree);
+        strategySums = averageStrategyBuffer;
     }
-
-    float numActionsInverse = 1.0f / static_cast<float>(numActions);
-    for (int action = 0; action < numActions; ++action) {
-        for (int hand = 0; hand < playerToActRangeSize; ++hand) {
-            if (totalStrategy[hand] > 0.0f) {
-                averageStrategyBuffer[action * playerToActRangeSize + hand] /= totalStrategy[hand];
-            }
-            else {
-                // Play a uniform strategy if we don't have a strategy yet
-                assert(totalStrategy[hand] == 0.0f);
-                averageStrategyBuffer[action * playerToActRangeSize + hand] = numActionsInverse;
-            }
-        }
+    else {
+        strategySums = tree.getStrategySums().subspan(decisionNode.trainingDataOffset, averageStrategyBuffer.size());
     }
+
+    // Play a uniform strategy if we don't have a strategy yet
+    normalizeStrategySums(averageStrategyBuffer, strategySums, numActions);
 }
 
 template <int GameHandSize>
@@ -161,11 +331,11 @@ bool areHandAndSetDisjoint(HandInfo playerHandInfo, CardSet cardSet) {
     }
 }
 
-template <int GameHandSize>
+template <int GameHandSize, typename T>
 void addReachProbsToArray(
-    std::array<float, StandardDeckSize>& villainReachProbWithCard,
+    std::array<T, StandardDeckSize>& villainReachProbWithCard,
     HandInfo villainHandInfo,
-    float villainReachProb
+    T villainReachProb
 ) {
     static_assert(GameHandSize == 1 || GameHandSize == 2);
     if constexpr (GameHandSize == 1) {
@@ -181,10 +351,10 @@ void addReachProbsToArray(
     }
 }
 
-template <int GameHandSize>
-float getReachProbBlockedByHeroHand(
+template <int GameHandSize, typename T>
+T getReachProbBlockedByHeroHand(
     HandInfo heroHandInfo,
-    const std::array<float, StandardDeckSize>& villainReachProbWithCard
+    const std::array<T, StandardDeckSize>& villainReachProbWithCard
 ) {
     static_assert(GameHandSize == 1 || GameHandSize == 2);
     if constexpr (GameHandSize == 1) {
@@ -217,111 +387,219 @@ float getInclusionExculsionCorrection(
     // For hand size > 2, logic is more complicated
 }
 
-template <int GameHandSize, TraversalMode Mode>
-void traverseTree(
-    const Node& node,
-    const TraversalConstants& constants,
-    const IGameRules& rules,
-    std::span<const float> heroReachProbs,
-    std::span<const float> villainReachProbs,
-    std::span<float> outputExpectedValues,
-    Tree& tree,
-    StackAllocator<float>& allocator
-);
+// Total reach of the villain's valid hands on a board, and the reach of the villain hands containing each card
+// Fold and showdown nodes only depend on the villain's reach through this summary and the same hand correction
+struct VillainReachSummary {
+    double totalReachProb;
+    std::array<double, StandardDeckSize> reachProbWithCard;
+};
 
-template <int GameHandSize, TraversalMode Mode>
-void traverseChance(
-    const Node& chanceNode,
-    const TraversalConstants& constants,
-    const IGameRules& rules,
-    std::span<const float> heroReachProbs,
-    std::span<const float> villainReachProbs,
-    std::span<float> outputExpectedValues,
-    Tree& tree,
-    StackAllocator<float>& allocator
+template <int GameHandSize, typename GameRules>
+VillainReachSummary buildVillainReachSummary(
+    Player villain,
+    CardSet board,
+    const GameRules& rules,
+    std::span<const float> villainReachProbs
 ) {
-    auto calculateCardEV = [
-        &chanceNode,
-        &constants,
-        &rules,
-        &tree,
-        &heroReachProbs,
-        &villainReachProbs,
-        &allocator
-    ](int cardIndex, std::span<float> newOutputExpectedValues) -> void {
-        Player villain = getOpposingPlayer(constants.hero);
+    VillainReachSummary summary = {
+        .totalReachProb = 0.0,
+        .reachProbWithCard = {}
+    };
 
-        int heroRangeSize = tree.rangeSize[constants.hero];
-        int villainRangeSize = tree.rangeSize[villain];
+    for (HandInfo villainHandInfo : rules.getValidHands(villain, board)) {
+        assert(villainHandInfo != InvalidHand);
+        assert(areHandAndSetDisjoint<GameHandSize>(villainHandInfo, board));
 
-        const Node& nextNode = tree.allNodes[chanceNode.childrenOffset + cardIndex];
-        CardID chanceCard = nextNode.state.lastDealtCard;
-        assert(chanceCard != InvalidCard);
+        double villainReachProb = static_cast<double>(villainReachProbs[villainHandInfo.index]);
+        summary.totalReachProb += villainReachProb;
+        addReachProbsToArray<GameHandSize>(summary.reachProbWithCard, villainHandInfo, villainReachProb);
+    }
 
-        // Normalize expected values by the number of total chance cards possible
-        // Hero and villain both have a hand
-        int chanceCardReachFactor = getSetSize(chanceNode.availableCards) - (2 * GameHandSize);
+    return summary;
+}
 
-        // We only need to calculate hero reach probs during CFR traversal because we only use them to update strategy sums
-        std::optional<ScopedVector<float>> newHeroReachProbs;
-        std::span<const float> newHeroReachProbsData;
-        if constexpr (isCfr(Mode)) {
-            const auto heroValidHands = rules.getValidHands(constants.hero, nextNode.state.currentBoard);
-            newHeroReachProbs.emplace(allocator, getThreadIndex(), heroRangeSize);
-            std::fill(newHeroReachProbs->begin(), newHeroReachProbs->end(), 0.0f);
-            for (HandInfo heroHandInfo : heroValidHands) {
-                assert(heroHandInfo != InvalidHand);
-                assert(areHandAndCardDisjoint<GameHandSize>(heroHandInfo, chanceCard));
-                (*newHeroReachProbs)[heroHandInfo.index] = heroReachProbs[heroHandInfo.index] / static_cast<float>(chanceCardReachFactor);
-            }
-            newHeroReachProbsData = newHeroReachProbs->getData();
-        }
+bool isReachZero(std::span<const float> reachProbs) {
+    return std::all_of(reachProbs.begin(), reachProbs.end(), [](float reachProb) { return reachProb == 0.0f; });
+}
 
-        const auto villainValidHands = rules.getValidHands(villain, nextNode.state.currentBoard);
-        ScopedVector<float> newVillainReachProbs(allocator, getThreadIndex(), villainRangeSize);
-        std::fill(newVillainReachProbs.begin(), newVillainReachProbs.end(), 0.0f);
-        for (HandInfo villainHandInfo : villainValidHands) {
-            assert(villainHandInfo != InvalidHand);
-            assert(areHandAndCardDisjoint<GameHandSize>(villainHandInfo, chanceCard));
-            newVillainReachProbs[villainHandInfo.index] = villainReachProbs[villainHandInfo.index] / static_cast<float>(chanceCardReachFactor);
-        }
+// Bit i is set if action i is skipped by regret based pruning
+using PrunedActionMask = std::uint32_t;
+static_assert(MaxNumActions <= 32);
 
-        auto evCardRangeBegin = newOutputExpectedValues.begin() + cardIndex * heroRangeSize;
-        auto evCardRangeEnd = evCardRangeBegin + heroRangeSize;
-        traverseTree<GameHandSize, Mode>(nextNode, constants, rules, newHeroReachProbsData, newVillainReachProbs.getData(), { evCardRangeBegin, evCardRangeEnd }, tree, allocator);
-    };
+bool isActionPruned(PrunedActionMask prunedActions, int action) {
+    return (prunedActions >> action) & 1;
+}
 
-    assert(chanceNode.nodeType == NodeType::Chance);
+// The regret of an action changes by at most about the pot times the villain's total reach each iteration
+float getPruningRegretThreshold(const Node& decisionNode, std::span<const float> villainReachProbs, const Tree& tree) {
+    const NodeDetails& details = tree.allNodeDetails[&decisionNode - tree.allNodes.data()];
+    int pot = details.totalWagers[Player::P0] + details.totalWagers[Player::P1] + tree.deadMoney;
+    float villainTotalReach = std::accumulate(villainReachProbs.begin(), villainReachProbs.end(), 0.0f);
+    return static_cast<float>(pot) * villainTotalReach;
+}
 
-    std::fill(outputExpectedValues.begin(), outputExpectedValues.end(), 0.0f);
+bool isFoldOrShowdown(const Node& node) {
+    return (node.nodeType == NodeType::Fold) || (node.nodeType == NodeType::Showdown);
+}
 
-    int heroRangeSize = tree.rangeSize[constants.hero];
+std::uint32_t getNodeIndex(const Node& node, const Tree& tree) {
+    assert((&node >= tree.allNodes.data()) && (&node < tree.allNodes.data() + tree.allNodes.size()));
+    return static_cast<std::uint32_t>(&node - tree.allNodes.data());
+}
 
-    ScopedVector<float> newOutputExpectedValues(allocator, getThreadIndex(), chanceNode.numChildren * heroRangeSize);
-    std::span<float> newOutputExpectedValuesData = newOutputExpectedValues.getData();
+std::uint64_t getAllChildrenMask(const Node& chanceNode) {
+    static_assert(StandardDeckSize < 64);
+    assert(chanceNode.numChildren < 64);
+    return (std::uint64_t{ 1 } << chanceNode.numChildren) - 1;
+}
 
-    #ifdef _OPENMP
-    if (shouldParallelize(chanceNode.state.currentStreet, tree.startingStreet)) {
-        for (int cardIndex = 0; cardIndex < chanceNode.numChildren; ++cardIndex) {
-            #pragma omp task default(none) firstprivate(calculateCardEV, cardIndex, newOutputExpectedValuesData)
-            {
-                calculateCardEV(cardIndex, newOutputExpectedValuesData);
-            }
-        }
+bool isChildInMask(std::uint64_t childMask, int childIndex) {
+    return (childMask >> childIndex) & 1;
+}
 
-        #pragma omp taskwait
+bool isChanceNodeSampled(const Node& chanceNode, const TraversalConstants& constants) {
+    return (constants.sampling.numSampledCards > 0) && (constants.sampling.numSampledCards < chanceNode.numChildren);
+}
+
+// SplitMix64, see https://prng.di.unimi.it/splitmix64.c
+std::uint64_t nextRandom(std::uint64_t& state) {
+    state += 0x9E3779B97F4A7C15ULL;
+    std::uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Mask of numSampledCards distinct children chosen uniformly at random
+// The choice only depends on the seed and the node, so it is the same no matter which thread traverses the node
+std::uint64_t sampleChildren(const Node& chanceNode, std::uint32_t nodeIndex, const ChanceSampling& sampling) {
+    std::uint64_t state = sampling.seed;
+    state ^= nextRandom(state) ^ nodeIndex;
+
+    // Partial Fisher-Yates shuffle of the child indices
+    std::array<std::uint8_t, 64> children;
+    std::iota(children.begin(), children.begin() + chanceNode.numChildren, std::uint8_t{ 0 });
+
+    std::uint64_t childMask = 0;
+    for (int i = 0; i < sampling.numSampledCards; ++i) {
+        int remaining = chanceNode.numChildren - i;
+        int j = i + static_cast<int>(nextRandom(state) % static_cast<std::uint64_t>(remaining));
+        std::swap(children[i], children[j]);
+        childMask |= std::uint64_t{ 1 } << children[i];
     }
-    else {
-        for (int cardIndex = 0; cardIndex < chanceNode.numChildren; ++cardIndex) {
-            calculateCardEV(cardIndex, newOutputExpectedValuesData);
-        }
+    return childMask;
+}
+
+// Children of the chance nodes before the first chance card are the subtrees a distributed solve splits between its workers
+// Deeper chance nodes are always traversed locally, since their whole subtree belongs to one worker
+DistributedCoordinator* getChanceNodeCoordinator(const Node& chanceNode, const Tree& tree) {
+    DistributedCoordinator* coordinator = tree.getDistributedCoordinator();
+    if (!coordinator || !tree.getSubtreeIndex(chanceNode.childrenOffset)) return nullptr;
+    return coordinator;
+}
+
+// Rules whose hand lookups go straight to the RunoutHandTables, so that they are inlined into the traversals
+// The other functions are only called a few times per chance or all in runout node, so they stay virtual
+class RunoutHandTableRules {
+public:
+    RunoutHandTableRules(const IGameRules& rules, const RunoutHandTables& handTables) : m_rules{ rules }, m_handTables{ handTables } {}
+
+    std::span<const HandInfo> getValidHands(Player player, CardSet board) const {
+        return m_handTables.getValidHands(player, board);
     }
-    #else
-    // Run on single thread if no OpenMP
-    for (int cardIndex = 0; cardIndex < chanceNode.numChildren; ++cardIndex) {
-        calculateCardEV(cardIndex, newOutputExpectedValuesData);
+
+    std::span<const RankedHand> getValidSortedHandRanks(Player player, CardSet board) const {
+        return m_handTables.getValidSortedHandRanks(player, board);
     }
-    #endif
+
+    CardSet getDeck() const {
+        return m_rules.getDeck();
+    }
+
+    std::span<const CardSet> getRangeHands(Player player) const {
+        return m_rules.getRangeHands(player);
+    }
+
+    std::span<const float> getInitialRangeWeights(Player player) const {
+        return m_rules.getInitialRangeWeights(player);
+    }
+
+    const IGameRules& getGameRules() const {
+        return m_rules;
+    }
+
+private:
+    const IGameRules& m_rules;
+    const RunoutHandTables& m_handTables;
+};
+
+// Rules that are passed on to the tree, which only takes the generic interface
+const IGameRules& getGameRules(const IGameRules& rules) {
+    return rules;
+}
+
+const IGameRules& getGameRules(const RunoutHandTableRules& rules) {
+    return rules.getGameRules();
+}
+
+// Games with runout hand tables are traversed with RunoutHandTableRules, other games go through the generic IGameRules interface
+// The function is called with the game hand size as a std::integral_constant and the rules
+template <typename Function>
+void dispatchGameRules(const IGameRules& rules, int gameHandSize, Function function) {
+    // Runout hand tables are only used by games with two card hands
+    if (const RunoutHandTables* handTables = rules.getRunoutHandTables()) {
+        assert(gameHandSize == 2);
+        function(std::integral_constant<int, 2>{}, RunoutHandTableRules{ rules, *handTables });
+        return;
+    }
+
+    switch (gameHandSize) {
+        case 1:
+            function(std::integral_constant<int, 1>{}, rules);
+            break;
+        case 2:
+            function(std::integral_constant<int, 2>{}, rules);
+            break;
+        default:
+            assert(false);
+            break;
+    }
+}
+
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
+void traverseTree(
+    const Node& node,
+    const TraversalConstants& constants,
+    const GameRules& rules,
+    std::span<const float> heroReachProbs,
+    std::span<const float> villainReachProbs,
+    std::span<float> outputExpectedValues,
+    Tree& tree,
+    StackAllocator& allocator
+);
+
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
+void traverseTerminal(
+    const Node& terminalNode,
+    const TraversalConstants& constants,
+    const GameRules& rules,
+    std::span<const float> villainReachProbs,
+    const VillainReachSummary& villainReachSummary,
+    std::span<float> outputExpectedValues,
+    Tree& tree
+);
+
+// Sums the expected values of the canonical cards dealt at a chance node, and of the cards they are isomorphic to
+template <int GameHandSize, typename GameRules>
+void accumulateChanceExpectedValues(
+    const Node& chanceNode,
+    Player hero,
+    const GameRules& rules,
+    std::span<const float> newOutputExpectedValues,
+    std::span<float> outputExpectedValues,
+    const Tree& tree
+) {
+    int heroRangeSize = tree.rangeSize[hero];
 
     for (int cardIndex = 0; cardIndex < chanceNode.numChildren; ++cardIndex) {
         // Used in debug mode only
@@ -344,26 +622,26 @@ void traverseChance(
             return { .index = static_cast<std::int16_t>(handIndex), .card0 = card0, .card1 = card1 };
         };
 
-        CardID chanceCard = tree.allNodes[chanceNode.childrenOffset + cardIndex].state.lastDealtCard;
+        CardID chanceCard = tree.allNodes[chanceNode.childrenOffset + cardIndex].lastDealtCard;
 
         // First calculate contribution from canonical cards
         for (int hand = 0; hand < heroRangeSize; ++hand) {
             // Because of how fold and showdown nodes are structured, blocked hands will always return 0.0f.
             // Therefore, we can just add them directly and avoid having to branch
             assert(
-                areHandAndCardDisjoint<GameHandSize>(getHandInfo(constants.hero, hand), chanceCard)
+                areHandAndCardDisjoint<GameHandSize>(getHandInfo(hero, hand), chanceCard)
                 || newOutputExpectedValues[cardIndex * heroRangeSize + hand] == 0.0f
             );
             outputExpectedValues[hand] += newOutputExpectedValues[cardIndex * heroRangeSize + hand];
         }
 
         // Then calculate contribution from all isomorphisms
-        for (SuitMapping mapping : chanceNode.suitMappings) {
+        for (SuitMapping mapping : tree.allChanceNodeDetails[chanceNode.chanceNodeIndex].suitMappings) {
             assert(mapping.parent != mapping.child);
 
             if (mapping.parent == getCardSuit(chanceCard)) {
                 CardID isomorphicCard = getCardIDFromValueAndSuit(getCardValue(chanceCard), mapping.child);
-                const auto& isomorphicHandIndices = tree.isomorphicHandIndices[constants.hero][mapTwoSuitsToIndex(mapping.parent, mapping.child)];
+                const auto& isomorphicHandIndices = tree.isomorphicHandIndices[hero][mapTwoSuitsToIndex(mapping.parent, mapping.child)];
                 assert(isomorphicHandIndices.size() == heroRangeSize);
 
                 for (int hand = 0; hand < heroRangeSize; ++hand) {
@@ -373,7 +651,7 @@ void traverseChance(
                     // Because of how fold and showdown nodes are structured, blocked hands will always return 0.0f.
                     // Therefore, we can just add them directly and avoid having to branch
                     assert(
-                        areHandAndCardDisjoint<GameHandSize>(getHandInfo(constants.hero, hand), isomorphicCard)
+                        areHandAndCardDisjoint<GameHandSize>(getHandInfo(hero, hand), isomorphicCard)
                         || newOutputExpectedValues[cardIndex * heroRangeSize + isomorphicHand] == 0.0f
                     );
                     outputExpectedValues[hand] += newOutputExpectedValues[cardIndex * heroRangeSize + isomorphicHand];
@@ -383,55 +661,425 @@ void traverseChance(
     }
 }
 
-template <int GameHandSize, TraversalMode Mode>
-void traverseDecision(
-    const Node& decisionNode,
+// Writes the hero's expected values of each child in the mask to its slice of childExpectedValues, without summing them
+// The reach probabilities of each child are multiplied by childWeight, which makes up for the children left out by chance sampling
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
+void traverseChanceChildren(
+    const Node& chanceNode,
     const TraversalConstants& constants,
-    const IGameRules& rules,
+    const GameRules& rules,
     std::span<const float> heroReachProbs,
     std::span<const float> villainReachProbs,
-    std::span<float> outputExpectedValues,
+    std::span<float> childExpectedValues,
+    std::uint64_t childMask,
+    float childWeight,
     Tree& tree,
-    StackAllocator<float>& allocator
+    StackAllocator& allocator
 ) {
-    auto calculateActionEVs = [
-        &decisionNode,
+    auto calculateCardEV = [
+        &chanceNode,
         &constants,
         &rules,
+        &tree,
         &heroReachProbs,
         &villainReachProbs,
-        &tree,
-        &allocator
-    ](std::span<float> newOutputExpectedValues, std::span<const float> strategy) -> void {
-        auto calculateActionEVHero = [
-            &decisionNode,
-            &constants,
-            &rules,
-            &heroReachProbs,
-            &villainReachProbs,
-            &tree,
-            &allocator,
-            &newOutputExpectedValues,
-            &strategy
-        ](int action) -> void {
-            int heroRangeSize = tree.rangeSize[constants.hero];
+        &allocator,
+        childWeight
+    ](int cardIndex, std::span<float> newOutputExpectedValues) -> void {
+        Player villain = getOpposingPlayer(constants.hero);
 
-            // For the hero we modify heroReachProbs and keep villainReachProbs the same
-            // We only need to calculate hero reach probs during CFR traversal because we only use them to update strategy sums
+        int heroRangeSize = tree.rangeSize[constants.hero];
+        int villainRangeSize = tree.rangeSize[villain];
+
+        const Node& nextNode = tree.allNodes[chanceNode.childrenOffset + cardIndex];
+        CardID chanceCard = nextNode.lastDealtCard;
+        assert(chanceCard != InvalidCard);
+
+        // Normalize expected values by the number of total chance cards possible
+        // Hero and villain both have a hand
+        const ChanceNodeDetails& chanceNodeDetails = tree.allChanceNodeDetails[chanceNode.chanceNodeIndex];
+        int chanceCardReachFactor = getSetSize(chanceNodeDetails.availableCards) - (2 * GameHandSize);
+
+        // We only need to calculate hero reach probs during CFR traversal because we only use them to update strategy sums
+        std::optional<ScopedVector<float>> newHeroReachProbs;
+        std::span<const float> newHeroReachProbsData;
+        if constexpr (isCfr(Mode)) {
+            const auto heroValidHands = rules.getValidHands(constants.hero, nextNode.board);
+            newHeroReachProbs.emplace(allocator, getThreadIndex(), heroRangeSize);
+            std::fill(newHeroReachProbs->begin(), newHeroReachProbs->end(), 0.0f);
+            for (HandInfo heroHandInfo : heroValidHands) {
+                assert(heroHandInfo != InvalidHand);
+                assert(areHandAndCardDisjoint<GameHandSize>(heroHandInfo, chanceCard));
+                (*newHeroReachProbs)[heroHandInfo.index] = heroReachProbs[heroHandInfo.index] * childWeight / static_cast<float>(chanceCardReachFactor);
+            }
+            newHeroReachProbsData = newHeroReachProbs->getData();
+        }
+
+        const auto villainValidHands = rules.getValidHands(villain, nextNode.board);
+        ScopedVector<float> newVillainReachProbs(allocator, getThreadIndex(), villainRangeSize);
+        std::fill(newVillainReachProbs.begin(), newVillainReachProbs.end(), 0.0f);
+        for (HandInfo villainHandInfo : villainValidHands) {
+            assert(villainHandInfo != InvalidHand);
+            assert(areHandAndCardDisjoint<GameHandSize>(villainHandInfo, chanceCard));
+            newVillainReachProbs[villainHandInfo.index] = villainReachProbs[villainHandInfo.index] * childWeight / static_cast<float>(chanceCardReachFactor);
+        }
+
+        // With file backed training data, the next card's subtree is read from disk while this one is traversed
+        std::size_t nextNodeIndex = chanceNode.childrenOffset + cardIndex;
+        if (cardIndex + 1 < chanceNode.numChildren) {
+            tree.prefetchSubtreeTrainingData(nextNodeIndex + 1);
+        }
+
+        auto evCardRangeBegin = newOutputExpectedValues.begin() + cardIndex * heroRangeSize;
+        auto evCardRangeEnd = evCardRangeBegin + heroRangeSize;
+        traverseTree<GameHandSize, Mode>(nextNode, constants, rules, newHeroReachProbsData, newVillainReachProbs.getData(), { evCardRangeBegin, evCardRangeEnd }, tree, allocator);
+
+        // With little free memory, a finished subtree is also evicted before the subtrees that are still being traversed
+        tree.releaseSubtreeTrainingData(nextNodeIndex);
+    };
+
+    assert(chanceNode.nodeType == NodeType::Chance);
+    assert(childExpectedValues.size() == chanceNode.numChildren * tree.rangeSize[constants.hero]);
+
+    #ifdef _OPENMP
+    // Spawn tasks for large subtrees first so that other threads can start on them, then traverse small subtrees inline
+    for (int cardIndex = 0; cardIndex < chanceNode.numChildren; ++cardIndex) {
+        if (isChildInMask(childMask, cardIndex) && shouldSpawnTask(tree.allNodes[chanceNode.childrenOffset + cardIndex], constants)) {
+            profileTaskSpawned();
+            #pragma omp task default(none) firstprivate(calculateCardEV, cardIndex, childExpectedValues)
+            {
+                TaskProfileScope taskProfile{ NodeType::Chance };
+                calculateCardEV(cardIndex, childExpectedValues);
+            }
+        }
+    }
+    for (int cardIndex = 0; cardIndex < chanceNode.numChildren; ++cardIndex) {
+        if (isChildInMask(childMask, cardIndex) && !shouldSpawnTask(tree.allNodes[chanceNode.childrenOffset + cardIndex], constants)) {
+            calculateCardEV(cardIndex, childExpectedValues);
+        }
+    }
+
+    {
+        TaskwaitProfileScope taskwaitProfile;
+        #pragma omp taskwait
+    }
+    #else
+    // Run on single thread if no OpenMP
+    for (int cardIndex = 0; cardIndex < chanceNode.numChildren; ++cardIndex) {
+        if (isChildInMask(childMask, cardIndex)) {
+            calculateCardEV(cardIndex, childExpectedValues);
+        }
+    }
+    #endif
+}
+
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
+void traverseChance(
+    const Node& chanceNode,
+    const TraversalConstants& constants,
+    const GameRules& rules,
+    std::span<const float> heroReachProbs,
+    std::span<const float> villainReachProbs,
+    std::span<float> outputExpectedValues,
+    Tree& tree,
+    StackAllocator& allocator
+) {
+    assert(chanceNode.nodeType == NodeType::Chance);
+
+    std::fill(outputExpectedValues.begin(), outputExpectedValues.end(), 0.0f);
+
+    int heroRangeSize = tree.rangeSize[constants.hero];
+
+    ScopedVector<float> newOutputExpectedValues(allocator, getThreadIndex(), chanceNode.numChildren * heroRangeSize);
+
+    std::uint64_t childMask = getAllChildrenMask(chanceNode);
+    float childWeight = 1.0f;
+    if (isChanceNodeSampled(chanceNode, constants)) {
+        childMask = sampleChildren(chanceNode, getNodeIndex(chanceNode, tree), constants.sampling);
+        childWeight = static_cast<float>(chanceNode.numChildren) / static_cast<float>(constants.sampling.numSampledCards);
+
+        // Children that are not visited contribute nothing to the sum over the chance cards
+        std::fill(newOutputExpectedValues.begin(), newOutputExpectedValues.end(), 0.0f);
+    }
+
+    if (DistributedCoordinator* coordinator = getChanceNodeCoordinator(chanceNode, tree)) {
+        Player villain = getOpposingPlayer(constants.hero);
+
+        ChanceNodeTraversal traversal = {
+            .mode = Mode,
+            .hero = constants.hero,
+            .params = constants.params,
+            .usePruning = constants.usePruning,
+            .sampling = constants.sampling,
+            .childWeight = childWeight,
+            .nodeIndex = getNodeIndex(chanceNode, tree),
+            .childMask = childMask
+        };
+        traversal.reachProbs[constants.hero] = heroReachProbs;
+        traversal.reachProbs[villain] = villainReachProbs;
+        traversal.childExpectedValues[constants.hero] = newOutputExpectedValues.getData();
+        coordinator->traverseChanceNode(traversal);
+    }
+    else {
+        traverseChanceChildren<GameHandSize, Mode>(
+            chanceNode,
+            constants,
+            rules,
+            heroReachProbs,
+            villainReachProbs,
+            newOutputExpectedValues.getData(),
+            childMask,
+            childWeight,
+            tree,
+            allocator
+        );
+    }
+
+    accumulateChanceExpectedValues<GameHandSize>(chanceNode, constants.hero, rules, newOutputExpectedValues.getData(), outputExpectedValues, tree);
+}
+
+// Discounted CFR discounts every decision node of the hero each iteration, but nodes that an iteration skips are only discounted when they are next updated
+// The positive regrets, the other regrets, and the strategy sums of a node are each scaled by a single factor per iteration,
+// so a node that is behind on its discounts still has the same current and average strategy
+// Marks the node as discounted up to the current iteration, whose own discount is applied by the update that follows
+void applyMissedDiscounts(const Node& decisionNode, const DiscountParams& params, std::span<float> regretSums, std::span<float> strategySums, Tree& tree) {
+    assert(decisionNode.nodeType == NodeType::Decision);
+
+    std::int32_t& lastDiscountedIteration = tree.allLastDiscountedIterations[decisionNode.decisionNodeIndex];
+    if (lastDiscountedIteration + 1 < params.iteration) {
+        double positiveRegretDiscount = 1.0;
+        double regretDiscount = 1.0;
+        double strategyDiscount = 1.0;
+        for (int iteration = lastDiscountedIteration + 1; iteration < params.iteration; ++iteration) {
+            DiscountParams missedParams = getDiscountParams(params.alpha, params.beta, params.gamma, iteration);
+            positiveRegretDiscount *= missedParams.alphaT;
+            regretDiscount *= missedParams.betaT;
+            strategyDiscount *= missedParams.gammaT;
+        }
+
+        for (float& regretSum : regretSums) {
+            regretSum *= static_cast<float>((regretSum > 0.0f) ? positiveRegretDiscount : regretDiscount);
+        }
+        for (float& strategySum : strategySums) {
+            strategySum *= static_cast<float>(strategyDiscount);
+        }
+    }
+    lastDiscountedIteration = params.iteration;
+}
+
+// Regret based pruning: an action that no hand plays does not contribute to the expected value of the current strategy,
+// so its subtree is skipped and the action gets zero regret this iteration
+// Only actions with regrets far enough below zero are pruned, since actions that are barely negative could become positive before they are revisited
+PrunedActionMask getPrunedActions(
+    const Node& decisionNode,
+    std::span<const float> regretSums,
+    std::span<const float> currentStrategy,
+    int numTrainingHands,
+    std::span<const float> villainReachProbs,
+    const Tree& tree
+) {
+    PrunedActionMask prunedActions = 0;
+    float pruningThreshold = -getPruningRegretThreshold(decisionNode, villainReachProbs, tree);
+    for (int action = 0; action < decisionNode.numChildren; ++action) {
+        std::span<const float> actionRegretSums = regretSums.subspan(action * numTrainingHands, numTrainingHands);
+        bool isRegretBelowThreshold = std::all_of(actionRegretSums.begin(), actionRegretSums.end(), [pruningThreshold](float regretSum) {
+            return regretSum < pruningThreshold;
+        });
+        if (isRegretBelowThreshold && isReachZero(currentStrategy.subspan(action * numTrainingHands, numTrainingHands))) {
+            prunedActions |= PrunedActionMask{ 1 } << action;
+        }
+    }
+    return prunedActions;
+}
+
+// Updates the regrets and strategy sums of a decision node where the hero acts, and writes the expected value of the current strategy to outputExpectedValues
+// newOutputExpectedValues holds the hero's expected values of each action over the whole range, and is overwritten
+// The subtrees of pruned actions were skipped, so their expected values can be anything
+template <TraversalMode Mode>
+void updateTrainingData(
+    const Node& decisionNode,
+    const TraversalConstants& constants,
+    std::span<const HandInfo> trainingHands,
+    std::span<const float> heroReachProbs,
+    std::span<const float> currentStrategy,
+    PrunedActionMask prunedActions,
+    std::span<float> newOutputExpectedValues,
+    std::span<float> regretSums,
+    std::span<float> strategySums,
+    std::span<float> outputExpectedValues,
+    const Tree& tree,
+    StackAllocator& allocator
+) {
+    assert(decisionNode.playerToAct == constants.hero);
+
+    std::fill(outputExpectedValues.begin(), outputExpectedValues.end(), 0.0f);
+
+    int numActions = static_cast<int>(decisionNode.numChildren);
+    int heroRangeSize = tree.rangeSize[constants.hero];
+    int numTrainingHands = static_cast<int>(trainingHands.size());
+
+    for (int action = 0; action < numActions; ++action) {
+        if (isActionPruned(prunedActions, action)) {
+            std::fill_n(newOutputExpectedValues.begin() + action * heroRangeSize, heroRangeSize, 0.0f);
+        }
+    }
+
+    // The updates are done in the training hand layout
+    // The action expected values are no longer needed in the whole range layout, so they are compacted in place
+    bool isHeroRangeCompacted = isRangeCompacted(trainingHands, heroRangeSize);
+    compactRangeToTrainingHands(newOutputExpectedValues, numActions, trainingHands, heroRangeSize);
+
+    std::optional<ScopedVector<float>> trainingHandReachProbs;
+    std::optional<ScopedVector<float>> trainingHandExpectedValues;
+    std::span<const float> reachProbs = heroReachProbs;
+    std::span<float> expectedValues = outputExpectedValues;
+    if (isHeroRangeCompacted) {
+        trainingHandReachProbs.emplace(allocator, getThreadIndex(), numTrainingHands);
+        trainingHandExpectedValues.emplace(allocator, getThreadIndex(), numTrainingHands);
+        for (int i = 0; i < numTrainingHands; ++i) {
+            (*trainingHandReachProbs)[i] = heroReachProbs[trainingHands[i].index];
+        }
+        std::fill(trainingHandExpectedValues->begin(), trainingHandExpectedValues->end(), 0.0f);
+        reachProbs = trainingHandReachProbs->getData();
+        expectedValues = trainingHandExpectedValues->getData();
+    }
+
+    std::span<float> actionExpectedValues = newOutputExpectedValues.first(numActions * numTrainingHands);
+    std::span<const float> strategy = currentStrategy;
+
+    // Calculate expected value of strategy
+    std::span<float> strategyExpectedValues = expectedValues.first(numTrainingHands);
+    accumulateActionWeightedValues(strategyExpectedValues, actionExpectedValues, strategy, numActions, numTrainingHands);
+
+    // Pruned actions are given the expected value of the strategy, which makes their regret zero
+    for (int action = 0; action < numActions; ++action) {
+        if (isActionPruned(prunedActions, action)) {
+            std::span<float> prunedExpectedValues = actionExpectedValues.subspan(action * numTrainingHands, numTrainingHands);
+            std::copy(strategyExpectedValues.begin(), strategyExpectedValues.end(), prunedExpectedValues.begin());
+        }
+    }
+
+    if constexpr (Mode == TraversalMode::DiscountedCfr) {
+        // In DCFR, we discount previous regrets and strategies by a factor
+        updateDiscountedTrainingData(
+            regretSums,
+            strategySums,
+            actionExpectedValues,
+            strategyExpectedValues,
+            reachProbs.first(numTrainingHands),
+            strategy,
+            constants.params.alphaT,
+            constants.params.betaT,
+            constants.params.gammaT,
+            numActions,
+            numTrainingHands
+        );
+    }
+    else {
+        for (int action = 0; action < numActions; ++action) {
+            for (int hand = 0; hand < numTrainingHands; ++hand) {
+                float& regretSum = regretSums[action * numTrainingHands + hand];
+                float& strategySum = strategySums[action * numTrainingHands + hand];
+
+                float strategyExpectedValue = expectedValues[hand];
+                float actionExpectedValue = actionExpectedValues[action * numTrainingHands + hand];
+                float regret = actionExpectedValue - strategyExpectedValue;
+
+                float handStrategy = reachProbs[hand] * strategy[action * numTrainingHands + hand];
+
+                if constexpr (Mode == TraversalMode::VanillaCfr) {
+                    regretSum += regret;
+                    strategySum += handStrategy;
+                }
+                else if constexpr (Mode == TraversalMode::CfrPlus) {
+                    // In CFR+, we erase negative regrets
+                    regretSum += std::max(regret, 0.0f);
+                    strategySum += handStrategy;
+                }
+            }
+        }
+    }
+
+    // Blocked hands keep the zero expected value they were initialized with
+    if (isHeroRangeCompacted) {
+        for (int i = 0; i < numTrainingHands; ++i) {
+            outputExpectedValues[trainingHands[i].index] = (*trainingHandExpectedValues)[i];
+        }
+    }
+}
+
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
+void traverseDecision(
+    const Node& decisionNode,
+    const TraversalConstants& constants,
+    const GameRules& rules,
+    std::span<const float> heroReachProbs,
+    std::span<const float> villainReachProbs,
+    std::span<float> outputExpectedValues,
+    Tree& tree,
+    StackAllocator& allocator
+) {
+    // When the hero is acting, the villain's reach is the same for every action
+    // Therefore all fold and showdown children can share one summary of the villain's reach
+    std::optional<VillainReachSummary> villainReachSummary;
+    if (decisionNode.playerToAct == constants.hero) {
+        for (int action = 0; action < decisionNode.numChildren; ++action) {
+            if (isFoldOrShowdown(tree.allNodes[decisionNode.childrenOffset + action])) {
+                Player villain = getOpposingPlayer(constants.hero);
+                villainReachSummary = buildVillainReachSummary<GameHandSize>(villain, decisionNode.board, rules, villainReachProbs);
+                break;
+            }
+        }
+    }
+
+    auto calculateActionEVs = [
+        &decisionNode,
+        &constants,
+        &rules,
+        &heroReachProbs,
+        &villainReachProbs,
+        &villainReachSummary,
+        &tree,
+        &allocator
+    ](std::span<float> newOutputExpectedValues, std::span<const float> strategy, std::span<const HandInfo> trainingHands, PrunedActionMask prunedActions) -> void {
+        auto calculateActionEVHero = [
+            &decisionNode,
+            &constants,
+            &rules,
+            &heroReachProbs,
+            &villainReachProbs,
+            &villainReachSummary,
+            &tree,
+            &allocator,
+            &newOutputExpectedValues,
+            &strategy,
+            &trainingHands
+        ](int action) -> void {
+            int heroRangeSize = tree.rangeSize[constants.hero];
+
+            const Node& nextNode = tree.allNodes[decisionNode.childrenOffset + action];
+            auto evActionRangeBegin = newOutputExpectedValues.begin() + action * heroRangeSize;
+            auto evActionRangeEnd = evActionRangeBegin + heroRangeSize;
+
+            // Fold and showdown nodes don't depend on the hero's reach probs
+            if (isFoldOrShowdown(nextNode)) {
+                assert(villainReachSummary);
+                traverseTerminal<GameHandSize, Mode>(nextNode, constants, rules, villainReachProbs, *villainReachSummary, { evActionRangeBegin, evActionRangeEnd }, tree);
+                return;
+            }
+
+            // For the hero we modify heroReachProbs and keep villainReachProbs the same
+            // We only need to calculate hero reach probs during CFR traversal because we only use them to update strategy sums
             std::optional<ScopedVector<float>> newHeroReachProbs;
             std::span<const float> newHeroReachProbsData;
             if constexpr (isCfr(Mode)) {
                 assert(!strategy.empty());
                 newHeroReachProbs.emplace(allocator, getThreadIndex(), heroRangeSize);
-                for (int hand = 0; hand < heroRangeSize; ++hand) {
-                    (*newHeroReachProbs)[hand] = heroReachProbs[hand] * strategy[action * heroRangeSize + hand];
-                }
+                writeActionReachProbs(newHeroReachProbs->getData(), heroReachProbs, strategy.subspan(action * trainingHands.size(), trainingHands.size()), trainingHands);
                 newHeroReachProbsData = newHeroReachProbs->getData();
             }
 
-            auto evActionRangeBegin = newOutputExpectedValues.begin() + action * heroRangeSize;
-            auto evActionRangeEnd = evActionRangeBegin + heroRangeSize;
-            traverseTree<GameHandSize, Mode>(tree.allNodes[decisionNode.childrenOffset + action], constants, rules, newHeroReachProbsData, villainReachProbs, { evActionRangeBegin, evActionRangeEnd }, tree, allocator);
+            traverseTree<GameHandSize, Mode>(nextNode, constants, rules, newHeroReachProbsData, villainReachProbs, { evActionRangeBegin, evActionRangeEnd }, tree, allocator);
         };
 
         auto calculateActionEVVillain = [
@@ -443,7 +1091,8 @@ void traverseDecision(
             &tree,
             &allocator,
             &newOutputExpectedValues,
-            &strategy
+            &strategy,
+            &trainingHands
         ](int action) -> void {
             assert(!strategy.empty());
 
@@ -454,9 +1103,7 @@ void traverseDecision(
 
             // For the villain we modify villainReachProbs and keep heroReachProbs the same
             ScopedVector<float> newVillainReachProbs(allocator, getThreadIndex(), villainRangeSize);
-            for (int hand = 0; hand < villainRangeSize; ++hand) {
-                newVillainReachProbs[hand] = villainReachProbs[hand] * strategy[action * villainRangeSize + hand];
-            }
+            writeActionReachProbs(newVillainReachProbs.getData(), villainReachProbs, strategy.subspan(action * trainingHands.size(), trainingHands.size()), trainingHands);
 
             auto evActionRangeBegin = newOutputExpectedValues.begin() + action * heroRangeSize;
             auto evActionRangeEnd = evActionRangeBegin + heroRangeSize;
@@ -469,7 +1116,7 @@ void traverseDecision(
             &calculateActionEVHero,
             &calculateActionEVVillain
         ](int action) -> void {
-            return (decisionNode.state.playerToAct == constants.hero) ? calculateActionEVHero(action) : calculateActionEVVillain(action);
+            return (decisionNode.playerToAct == constants.hero) ? calculateActionEVHero(action) : calculateActionEVVillain(action);
         };
 
         assert(decisionNode.nodeType == NodeType::Decision);
@@ -477,24 +1124,36 @@ void traverseDecision(
         int numActions = decisionNode.numChildren;
 
         #ifdef _OPENMP
-        if (shouldParallelize(decisionNode.state.currentStreet, tree.startingStreet)) {
-            for (int action = 0; action < numActions; ++action) {
+        // Spawn tasks for large subtrees first so that other threads can start on them, then traverse small subtrees inline
+        for (int action = 0; action < numActions; ++action) {
+            if (isActionPruned(prunedActions, action)) continue;
+
+            if (shouldSpawnTask(tree.allNodes[decisionNode.childrenOffset + action], constants)) {
+                profileTaskSpawned();
                 #pragma omp task default(none) firstprivate(calculateActionEV, action)
                 {
+                    TaskProfileScope taskProfile{ NodeType::Decision };
                     calculateActionEV(action);
                 }
             }
-
-            #pragma omp taskwait
         }
-        else {
-            for (int action = 0; action < numActions; ++action) {
+        for (int action = 0; action < numActions; ++action) {
+            if (isActionPruned(prunedActions, action)) continue;
+
+            if (!shouldSpawnTask(tree.allNodes[decisionNode.childrenOffset + action], constants)) {
                 calculateActionEV(action);
             }
         }
+
+        {
+            TaskwaitProfileScope taskwaitProfile;
+            #pragma omp taskwait
+        }
         #else
         // Run on single thread if no OpenMP
         for (int action = 0; action < numActions; ++action) {
+            if (isActionPruned(prunedActions, action)) continue;
+
             calculateActionEV(action);
         }
         #endif
@@ -503,7 +1162,9 @@ void traverseDecision(
     auto heroToActTraining = [
         &decisionNode,
         &constants,
+        &rules,
         &heroReachProbs,
+        &villainReachProbs,
         &outputExpectedValues,
         &tree,
         &allocator,
@@ -516,61 +1177,69 @@ void traverseDecision(
 
         int heroRangeSize = tree.rangeSize[constants.hero];
 
-        // Calculate current strategy
-        ScopedVector<float> currentStrategy(allocator, getThreadIndex(), numActions * heroRangeSize);
-        writeCurrentStrategyToBuffer(currentStrategy.getData(), decisionNode, tree, allocator);
-
-        ScopedVector<float> newOutputExpectedValues(allocator, getThreadIndex(), numActions * heroRangeSize);
-        calculateActionEVs(newOutputExpectedValues.getData(), currentStrategy.getData());
+        std::span<const HandInfo> trainingHands = getTrainingHands(decisionNode, rules);
+        int numTrainingHands = static_cast<int>(trainingHands.size());
 
-        // Calculate expected value of strategy
-        for (int action = 0; action < numActions; ++action) {
-            for (int hand = 0; hand < heroRangeSize; ++hand) {
-                outputExpectedValues[hand] += newOutputExpectedValues[action * heroRangeSize + hand] * currentStrategy[action * heroRangeSize + hand];
-            }
+        // Calculate current strategy
+        ScopedVector<float> currentStrategy(allocator, getThreadIndex(), numActions * numTrainingHands);
+        writeCurrentStrategyToBuffer(currentStrategy.getData(), decisionNode, trainingHands, tree);
+
+        // Compressed training data is decoded into temporary buffers, updated, and then encoded again
+        std::optional<ScopedVector<float>> decodedRegretSums;
+        std::optional<ScopedVector<float>> decodedStrategySums;
+        std::span<float> regretSums;
+        std::span<float> strategySums;
+        if (tree.isTrainingDataCompressed()) {
+            decodedRegretSums.emplace(allocator, getThreadIndex(), numActions * numTrainingHands);
+            decodedStrategySums.emplace(allocator, getThreadIndex(), numActions * numTrainingHands);
+            decodeRegretSums(decodedRegretSums->getData(), decisionNode, tree);
+            decodeStrategySums(decodedStrategySums->getData(), decisionNode, tree);
+            regretSums = decodedRegretSums->getData();
+            strategySums = decodedStrategySums->getData();
+        }
+        else {
+            regretSums = { tree.allRegretSums.begin() + decisionNode.trainingDataOffset, static_cast<std::size_t>(numActions * numTrainingHands) };
+            strategySums = { tree.allStrategySums.begin() + decisionNode.trainingDataOffset, static_cast<std::size_t>(numActions * numTrainingHands) };
         }
 
-        // Regret and strategy updates
-        auto regretSums = tree.allRegretSums.begin() + decisionNode.trainingDataOffset;
-        auto strategySums = tree.allStrategySums.begin() + decisionNode.trainingDataOffset;
-
-        for (int action = 0; action < numActions; ++action) {
-            for (int hand = 0; hand < heroRangeSize; ++hand) {
-                float& regretSum = regretSums[action * heroRangeSize + hand];
-                float& strategySum = strategySums[action * heroRangeSize + hand];
-
-                float strategyExpectedValue = outputExpectedValues[hand];
-                float actionExpectedValue = newOutputExpectedValues[action * heroRangeSize + hand];
-                float regret = actionExpectedValue - strategyExpectedValue;
+        if constexpr (Mode == TraversalMode::DiscountedCfr) {
+            applyMissedDiscounts(decisionNode, constants.params, regretSums, strategySums, tree);
+        }
 
-                float strategy = heroReachProbs[hand] * currentStrategy[action * heroRangeSize + hand];
+        PrunedActionMask prunedActions = 0;
+        if (constants.usePruning) {
+            prunedActions = getPrunedActions(decisionNode, regretSums, currentStrategy.getData(), numTrainingHands, villainReachProbs, tree);
+        }
 
-                if constexpr (Mode == TraversalMode::VanillaCfr) {
-                    regretSum += regret;
-                    strategySum += strategy;
-                }
-                else if constexpr (Mode == TraversalMode::CfrPlus) {
-                    // In CFR+, we erase negative regrets
-                    regretSum += std::max(regret, 0.0f);
-                    strategySum += strategy;
-                }
-                else if constexpr (Mode == TraversalMode::DiscountedCfr) {
-                    // In DCFR, we discount previous regrets and strategies by a factor
-                    float alpha = constants.params.alphaT;
-                    float beta = constants.params.betaT;
-                    float gamma = constants.params.gammaT;
-
-                    float regretDiscount = (regretSum > 0.0f) ? alpha : beta;
-                    regretSum = regretSum * regretDiscount + regret;
-                    strategySum = strategySum * gamma + strategy;
-                }
-            }
+        ScopedVector<float> newOutputExpectedValues(allocator, getThreadIndex(), numActions * heroRangeSize);
+        calculateActionEVs(newOutputExpectedValues.getData(), currentStrategy.getData(), trainingHands, prunedActions);
+
+        updateTrainingData<Mode>(
+            decisionNode,
+            constants,
+            trainingHands,
+            heroReachProbs,
+            currentStrategy.getData(),
+            prunedActions,
+            newOutputExpectedValues.getData(),
+            regretSums,
+            strategySums,
+            outputExpectedValues,
+            tree,
+            allocator
+        );
+
+        if (tree.isTrainingDataCompressed()) {
+            encodeRegretSums(regretSums, decisionNode, tree);
+            encodeStrategySums(strategySums, decisionNode, tree);
         }
     };
 
     auto heroToActExpectedValue = [
         &decisionNode,
         &constants,
+        &rules,
+        &villainReachProbs,
         &outputExpectedValues,
         &tree,
         &allocator,
@@ -583,18 +1252,53 @@ void traverseDecision(
 
         int heroRangeSize = tree.rangeSize[constants.hero];
 
+        std::span<const HandInfo> trainingHands = getTrainingHands(decisionNode, rules);
+        int numTrainingHands = static_cast<int>(trainingHands.size());
+
         // Calculate average strategy
-        ScopedVector<float> averageStrategy(allocator, getThreadIndex(), numActions * heroRangeSize);
-        writeAverageStrategyToBuffer(averageStrategy.getData(), decisionNode, tree, allocator);
+        ScopedVector<float> averageStrategy(allocator, getThreadIndex(), numActions * numTrainingHands);
+        writeAverageStrategyToBuffer(averageStrategy.getData(), decisionNode, trainingHands, tree);
 
         ScopedVector<float> newOutputExpectedValues(allocator, getThreadIndex(), numActions * heroRangeSize);
-        calculateActionEVs(newOutputExpectedValues.getData(), {});
+        calculateActionEVs(newOutputExpectedValues.getData(), {}, {}, 0);
 
         // Calculate expected value of strategy
         for (int action = 0; action < numActions; ++action) {
-            for (int hand = 0; hand < heroRangeSize; ++hand) {
-                outputExpectedValues[hand] += newOutputExpectedValues[action * heroRangeSize + hand] * averageStrategy[action * heroRangeSize + hand];
+            accumulateStrategyExpectedValues(
+                outputExpectedValues,
+                newOutputExpectedValues.getData().subspan(action * heroRangeSize, heroRangeSize),
+                averageStrategy.getData().subspan(action * numTrainingHands, numTrainingHands),
+                trainingHands
+            );
+        }
+
+        if (constants.visitor) {
+            // The expected values are weighted by the villain's reach, so they are divided by the reach of the villain hands
+            // that don't share a card with each hero hand
+            Player villain = getOpposingPlayer(constants.hero);
+            VillainReachSummary villainReachSummary = buildVillainReachSummary<GameHandSize>(villain, decisionNode.board, rules, villainReachProbs);
+            const auto& heroSameHandIndexTable = tree.sameHandIndexTable[constants.hero];
+
+            ScopedVector<float> handExpectedValues(allocator, getThreadIndex(), numTrainingHands);
+            for (int i = 0; i < numTrainingHands; ++i) {
+                HandInfo heroHandInfo = trainingHands[i];
+                double villainValidReachProb = villainReachSummary.totalReachProb
+                    - getReachProbBlockedByHeroHand<GameHandSize>(heroHandInfo, villainReachSummary.reachProbWithCard)
+                    + static_cast<double>(getInclusionExculsionCorrection<GameHandSize>(heroHandInfo.index, villainReachProbs, heroSameHandIndexTable));
+
+                handExpectedValues[i] = (villainValidReachProb > 0.0)
+                    ? static_cast<float>(outputExpectedValues[heroHandInfo.index] / villainValidReachProb)
+                    : std::numeric_limits<float>::quiet_NaN();
             }
+
+            (*constants.visitor)({
+                .nodeIndex = getNodeIndex(decisionNode, tree),
+                .player = constants.hero,
+                .numActions = numActions,
+                .hands = trainingHands,
+                .strategy = averageStrategy.getData(),
+                .expectedValues = handExpectedValues.getData()
+            });
         }
     };
 
@@ -616,7 +1320,7 @@ void traverseDecision(
         int heroRangeSize = tree.rangeSize[constants.hero];
 
         ScopedVector<float> newOutputExpectedValues(allocator, getThreadIndex(), numActions * heroRangeSize);
-        calculateActionEVs(newOutputExpectedValues.getData(), {});
+        calculateActionEVs(newOutputExpectedValues.getData(), {}, {}, 0);
 
         // To calculate best response, hero plays the maximally exploitative pure strategy
         for (int action = 0; action < numActions; ++action) {
@@ -634,6 +1338,7 @@ void traverseDecision(
     auto villainToAct = [
         &decisionNode,
         &constants,
+        &rules,
         &villainReachProbs,
         &outputExpectedValues,
         &tree,
@@ -645,34 +1350,28 @@ void traverseDecision(
         int numActions = static_cast<int>(decisionNode.numChildren);
         assert(numActions > 0);
 
-        Player villain = getOpposingPlayer(constants.hero);
-
         int heroRangeSize = tree.rangeSize[constants.hero];
-        int villainRangeSize = tree.rangeSize[villain];
 
-        // Calculate strategy
-        ScopedVector<float> strategy(allocator, getThreadIndex(), numActions * villainRangeSize);
+        std::span<const HandInfo> trainingHands = getTrainingHands(decisionNode, rules);
 
+        // Calculate strategy
+        ScopedVector<float> strategy(allocator, getThreadIndex(), numActions * trainingHands.size());
         if constexpr (isCfr(Mode)) {
-            writeCurrentStrategyToBuffer(strategy.getData(), decisionNode, tree, allocator);
+            writeCurrentStrategyToBuffer(strategy.getData(), decisionNode, trainingHands, tree);
         }
         else {
-            writeAverageStrategyToBuffer(strategy.getData(), decisionNode, tree, allocator);
+            writeAverageStrategyToBuffer(strategy.getData(), decisionNode, trainingHands, tree);
         }
 
         ScopedVector<float> newOutputExpectedValues(allocator, getThreadIndex(), numActions * heroRangeSize);
-        calculateActionEVs(newOutputExpectedValues.getData(), strategy.getData());
+        calculateActionEVs(newOutputExpectedValues.getData(), strategy.getData(), trainingHands, 0);
 
         // Calculate expected value of strategy
         // Not the hero's turn; no strategy or regret updates
-        for (int action = 0; action < numActions; ++action) {
-            for (int hand = 0; hand < heroRangeSize; ++hand) {
-                outputExpectedValues[hand] += newOutputExpectedValues[action * heroRangeSize + hand];
-            }
-        }
+        accumulateActionValues(outputExpectedValues, newOutputExpectedValues.getData(), numActions, heroRangeSize);
     };
 
-    if (constants.hero == decisionNode.state.playerToAct) {
+    if (constants.hero == decisionNode.playerToAct) {
         if constexpr (isCfr(Mode)) {
             heroToActTraining();
         }
@@ -688,12 +1387,13 @@ void traverseDecision(
     }
 }
 
-template <int GameHandSize, TraversalMode Mode>
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
 void traverseFold(
     const Node& foldNode,
     const TraversalConstants& constants,
-    const IGameRules& rules,
+    const GameRules& rules,
     std::span<const float> villainReachProbs,
+    const VillainReachSummary& villainReachSummary,
     std::span<float> outputExpectedValues,
     Tree& tree
 ) {
@@ -703,28 +1403,15 @@ void traverseFold(
 
     Player villain = getOpposingPlayer(constants.hero);
 
-    const auto heroValidHands = rules.getValidHands(constants.hero, foldNode.state.currentBoard);
-    const auto villainValidHands = rules.getValidHands(villain, foldNode.state.currentBoard);
-
-    float villainTotalReachProb = 0.0f;
-    std::array<float, StandardDeckSize> villainReachProbWithCard = {};
-
-    for (HandInfo villainHandInfo : villainValidHands) {
-        assert(villainHandInfo != InvalidHand);
-        assert(areHandAndSetDisjoint<GameHandSize>(villainHandInfo, foldNode.state.currentBoard));
-
-        float villainReachProb = villainReachProbs[villainHandInfo.index];
-        villainTotalReachProb += villainReachProb;
-        addReachProbsToArray<GameHandSize>(villainReachProbWithCard, villainHandInfo, villainReachProb);
-    }
+    const auto heroValidHands = rules.getValidHands(constants.hero, foldNode.board);
 
-    if (villainTotalReachProb == 0.0f) {
+    if (villainReachSummary.totalReachProb == 0.0) {
         return;
     }
 
     // The folding player acted last turn
-    Player foldingPlayer = getOpposingPlayer(foldNode.state.playerToAct);
-    int foldingPlayerWager = foldNode.state.totalWagers[foldingPlayer];
+    Player foldingPlayer = getOpposingPlayer(foldNode.playerToAct);
+    int foldingPlayerWager = foldNode.losingPlayerWager;
 
     // Winner wins the folding player's wager and the dead money
     // Loser loses their wager
@@ -737,22 +1424,128 @@ void traverseFold(
 
     for (HandInfo heroHandInfo : heroValidHands) {
         assert(heroHandInfo != InvalidHand);
-        assert(areHandAndSetDisjoint<GameHandSize>(heroHandInfo, foldNode.state.currentBoard));
+        assert(areHandAndSetDisjoint<GameHandSize>(heroHandInfo, foldNode.board));
 
-        float villainValidReachProb = villainTotalReachProb
-            - getReachProbBlockedByHeroHand<GameHandSize>(heroHandInfo, villainReachProbWithCard)
-            + getInclusionExculsionCorrection<GameHandSize>(heroHandInfo.index, villainReachProbs, heroSameHandIndexTable);
+        double villainValidReachProb = villainReachSummary.totalReachProb
+            - getReachProbBlockedByHeroHand<GameHandSize>(heroHandInfo, villainReachSummary.reachProbWithCard)
+            + static_cast<double>(getInclusionExculsionCorrection<GameHandSize>(heroHandInfo.index, villainReachProbs, heroSameHandIndexTable));
 
-        outputExpectedValues[heroHandInfo.index] += heroPayoff * villainValidReachProb;
+        outputExpectedValues[heroHandInfo.index] = static_cast<float>(heroPayoff * villainValidReachProb);
     }
 }
 
-template <int GameHandSize, TraversalMode Mode>
+// Adds the hero's showdown expected values on a river board, scaled by weight, to outputExpectedValues
+// The villain reach summary must be built for the same board
+template <int GameHandSize, typename GameRules>
+void accumulateShowdownExpectedValues(
+    CardSet board,
+    int playerWagers,
+    Player hero,
+    const GameRules& rules,
+    std::span<const float> villainReachProbs,
+    const VillainReachSummary& villainReachSummary,
+    double weight,
+    std::span<float> outputExpectedValues,
+    const Tree& tree
+) {
+    Player villain = getOpposingPlayer(hero);
+
+    const auto heroSortedHandRanks = rules.getValidSortedHandRanks(hero, board);
+    const auto villainSortedHandRanks = rules.getValidSortedHandRanks(villain, board);
+
+    int heroFilteredRangeSize = heroSortedHandRanks.size();
+    int villainFilteredRangeSize = villainSortedHandRanks.size();
+
+    // Winner wins the other player's wager and the dead money
+    // Loser loses their wager
+    // If the players tie, they split the dead money
+    float winPayoff = static_cast<float>(playerWagers + tree.deadMoney);
+    float losePayoff = static_cast<float>(-playerWagers);
+    float tiePayoff = static_cast<float>(tree.deadMoney) / 2.0f;
+
+    // Villain hands are split into three groups relative to the current hero hand: lower rank (hero wins), equal rank (tie), and higher rank (hero loses)
+    // Because both ranges are sorted, lower and tied reach can be accumulated in a single sweep, and higher reach is whatever remains of the total
+    // Sums are accumulated as doubles since the losing reach is found by subtraction
+    double villainTotalReachProb = villainReachSummary.totalReachProb;
+    const auto& villainReachProbWithCard = villainReachSummary.reachProbWithCard;
+
+    if (villainTotalReachProb == 0.0) {
+        return;
+    }
+
+    const auto& heroSameHandIndexTable = tree.sameHandIndexTable[hero];
+
+    double villainLowerReachProb = 0.0;
+    std::array<double, StandardDeckSize> villainLowerReachProbWithCard = {};
+
+    double villainTiedReachProb = 0.0;
+    std::array<double, StandardDeckSize> villainTiedReachProbWithCard = {};
+
+    int villainIndexSorted = 0;
+
+    for (int heroIndexSorted = 0; heroIndexSorted < heroFilteredRangeSize; ++heroIndexSorted) {
+        RankedHand heroRankedHand = heroSortedHandRanks[heroIndexSorted];
+        assert(areHandAndSetDisjoint<GameHandSize>(heroRankedHand.info, board));
+
+        bool heroRankIncreased = (heroIndexSorted == 0) || (heroRankedHand.rank > heroSortedHandRanks[heroIndexSorted - 1].rank);
+        if (heroRankIncreased) {
+            // Villain hands that tied the previous hero rank are now beaten by the hero
+            // Reach probs are non-negative, so a zero total means the tied group is empty
+            if (villainTiedReachProb != 0.0) {
+                villainLowerReachProb += villainTiedReachProb;
+                for (int card = 0; card < StandardDeckSize; ++card) {
+                    villainLowerReachProbWithCard[card] += villainTiedReachProbWithCard[card];
+                }
+
+                villainTiedReachProb = 0.0;
+                villainTiedReachProbWithCard.fill(0.0);
+            }
+
+            while (villainIndexSorted < villainFilteredRangeSize && villainSortedHandRanks[villainIndexSorted].rank < heroRankedHand.rank) {
+                RankedHand villainRankedHand = villainSortedHandRanks[villainIndexSorted];
+                assert(areHandAndSetDisjoint<GameHandSize>(villainRankedHand.info, board));
+
+                double villainReachProb = static_cast<double>(villainReachProbs[villainRankedHand.info.index]);
+                villainLowerReachProb += villainReachProb;
+                addReachProbsToArray<GameHandSize>(villainLowerReachProbWithCard, villainRankedHand.info, villainReachProb);
+                ++villainIndexSorted;
+            }
+
+            while (villainIndexSorted < villainFilteredRangeSize && villainSortedHandRanks[villainIndexSorted].rank == heroRankedHand.rank) {
+                RankedHand villainRankedHand = villainSortedHandRanks[villainIndexSorted];
+                assert(areHandAndSetDisjoint<GameHandSize>(villainRankedHand.info, board));
+
+                double villainReachProb = static_cast<double>(villainReachProbs[villainRankedHand.info.index]);
+                villainTiedReachProb += villainReachProb;
+                addReachProbsToArray<GameHandSize>(villainTiedReachProbWithCard, villainRankedHand.info, villainReachProb);
+                ++villainIndexSorted;
+            }
+        }
+
+        double blockedReachProb = getReachProbBlockedByHeroHand<GameHandSize>(heroRankedHand.info, villainReachProbWithCard);
+        double blockedLowerReachProb = getReachProbBlockedByHeroHand<GameHandSize>(heroRankedHand.info, villainLowerReachProbWithCard);
+        double blockedTiedReachProb = getReachProbBlockedByHeroHand<GameHandSize>(heroRankedHand.info, villainTiedReachProbWithCard);
+
+        // A villain hand identical to the hero hand always ties, so only the tied group needs getInclusionExculsionCorrection
+        // The identical hand is double-counted in both the total and tied blocked reach, so it cancels out in the losing reach
+        double villainWinReachProb = villainLowerReachProb - blockedLowerReachProb;
+        double villainTieReachProb = villainTiedReachProb - blockedTiedReachProb
+            + static_cast<double>(getInclusionExculsionCorrection<GameHandSize>(heroRankedHand.info.index, villainReachProbs, heroSameHandIndexTable));
+        double villainLoseReachProb = (villainTotalReachProb - villainLowerReachProb - villainTiedReachProb)
+            - (blockedReachProb - blockedLowerReachProb - blockedTiedReachProb);
+
+        double heroExpectedValue = winPayoff * villainWinReachProb + losePayoff * villainLoseReachProb + tiePayoff * villainTieReachProb;
+        outputExpectedValues[heroRankedHand.info.index] += static_cast<float>(weight * heroExpectedValue);
+    }
+}
+
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
 void traverseShowdown(
     const Node& showdownNode,
     const TraversalConstants& constants,
-    const IGameRules& rules,
+    const GameRules& rules,
     std::span<const float> villainReachProbs,
+    const VillainReachSummary& villainReachSummary,
     std::span<float> outputExpectedValues,
     Tree& tree
 ) {
@@ -760,231 +1553,876 @@ void traverseShowdown(
 
     std::fill(outputExpectedValues.begin(), outputExpectedValues.end(), 0.0f);
 
+    accumulateShowdownExpectedValues<GameHandSize>(
+        showdownNode.board,
+        showdownNode.losingPlayerWager,
+        constants.hero,
+        rules,
+        villainReachProbs,
+        villainReachSummary,
+        1.0,
+        outputExpectedValues,
+        tree
+    );
+}
+
+// Expected value of a showdown averaged over every way to deal the rest of the board
+// This is what the chance nodes of an expanded runout would calculate, without building or walking them
+// Runouts that overlap either player's hand are impossible, so each pair of hands that doesn't overlap shares the same number of possible runouts
+// The outcomes of each pair over those runouts don't depend on the strategy, so they are read from the board's AllInRunoutTable
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
+void traverseAllInRunout(
+    const Node& allInRunoutNode,
+    const TraversalConstants& constants,
+    const GameRules& rules,
+    std::span<const float> villainReachProbs,
+    std::span<float> outputExpectedValues,
+    Tree& tree
+) {
+    assert(allInRunoutNode.nodeType == NodeType::AllInRunout);
+
+    std::fill(outputExpectedValues.begin(), outputExpectedValues.end(), 0.0f);
+
     Player hero = constants.hero;
     Player villain = getOpposingPlayer(hero);
+    CardSet board = allInRunoutNode.board;
 
-    const auto heroSortedHandRanks = rules.getValidSortedHandRanks(hero, showdownNode.state.currentBoard);
-    const auto villainSortedHandRanks = rules.getValidSortedHandRanks(villain, showdownNode.state.currentBoard);
+    VillainReachSummary villainReachSummary = buildVillainReachSummary<GameHandSize>(villain, board, rules, villainReachProbs);
+    if (villainReachSummary.totalReachProb == 0.0) {
+        return;
+    }
 
-    int heroFilteredRangeSize = heroSortedHandRanks.size();
-    int villainFilteredRangeSize = villainSortedHandRanks.size();
+    CardSet availableCards = rules.getDeck() & ~board;
+    int numCardsToCome = StandardBoardSize - getSetSize(board);
+    int numPossibleCards = getSetSize(availableCards) - (2 * GameHandSize);
+
+    double numPossibleRunouts;
+    switch (numCardsToCome) {
+        case 1:
+            numPossibleRunouts = static_cast<double>(numPossibleCards);
+            break;
+        case 2:
+            numPossibleRunouts = static_cast<double>(numPossibleCards) * static_cast<double>(numPossibleCards - 1) / 2.0;
+            break;
+        default:
+            assert(false);
+            return;
+    }
+
+    const AllInRunoutTable& allInRunoutTable = tree.getAllInRunoutTable(getGameRules(rules), board);
+    std::size_t player1RangeSize = static_cast<std::size_t>(tree.rangeSize[Player::P1]);
+    const auto heroValidHands = rules.getValidHands(hero, board);
+
+    // Sum the outcomes from player 0's point of view, weighted by the villain's reach, into outputExpectedValues
+    // Pairs that overlap each other or the board have an outcome of 0, so the sums can run over the whole range
+    if (hero == Player::P0) {
+        for (HandInfo heroHandInfo : heroValidHands) {
+            const std::uint16_t* outcomes = allInRunoutTable.outcomes.data() + static_cast<std::size_t>(heroHandInfo.index) * player1RangeSize;
+            float outcomeSum = 0.0f;
+            for (std::size_t villainHand = 0; villainHand < player1RangeSize; ++villainHand) {
+                outcomeSum += villainReachProbs[villainHand] * static_cast<float>(outcomes[villainHand]);
+            }
+            outputExpectedValues[heroHandInfo.index] = outcomeSum;
+        }
+    }
+    else {
+        for (HandInfo villainHandInfo : rules.getValidHands(villain, board)) {
+            float villainReachProb = villainReachProbs[villainHandInfo.index];
+            if (villainReachProb == 0.0f) continue;
 
-    assert(showdownNode.state.totalWagers[Player::P0] == showdownNode.state.totalWagers[Player::P1]);
-    int playerWagers = showdownNode.state.totalWagers[Player::P0];
+            const std::uint16_t* outcomes = allInRunoutTable.outcomes.data() + static_cast<std::size_t>(villainHandInfo.index) * player1RangeSize;
+            for (std::size_t heroHand = 0; heroHand < player1RangeSize; ++heroHand) {
+                outputExpectedValues[heroHand] += villainReachProb * static_cast<float>(outcomes[heroHand]);
+            }
+        }
+    }
 
     // Winner wins the other player's wager and the dead money
     // Loser loses their wager
-    // If the players tie, they split the dead money
-    float winPayoff = static_cast<float>(playerWagers + tree.deadMoney);
-    float losePayoff = static_cast<float>(-playerWagers);
-    float tiePayoff = static_cast<float>(tree.deadMoney) / 2.0f;
+    // If the players tie, they split the dead money, which is halfway between winning and losing
+    double winPayoff = static_cast<double>(allInRunoutNode.losingPlayerWager + tree.deadMoney);
+    double losePayoff = static_cast<double>(-allInRunoutNode.losingPlayerWager);
+
+    const auto& heroSameHandIndexTable = tree.sameHandIndexTable[hero];
+
+    for (HandInfo heroHandInfo : heroValidHands) {
+        double villainValidReachProb = villainReachSummary.totalReachProb
+            - getReachProbBlockedByHeroHand<GameHandSize>(heroHandInfo, villainReachSummary.reachProbWithCard)
+            + static_cast<double>(getInclusionExculsionCorrection<GameHandSize>(heroHandInfo.index, villainReachProbs, heroSameHandIndexTable));
+
+        // A win counts 2 and a tie counts 1, so player 1's outcome is 2 per runout minus player 0's
+        double heroOutcomeSum = static_cast<double>(outputExpectedValues[heroHandInfo.index]);
+        if (hero == Player::P1) {
+            heroOutcomeSum = 2.0 * numPossibleRunouts * villainValidReachProb - heroOutcomeSum;
+        }
+
+        double heroExpectedValue = (winPayoff - losePayoff) / 2.0 * heroOutcomeSum / numPossibleRunouts + losePayoff * villainValidReachProb;
+        outputExpectedValues[heroHandInfo.index] = static_cast<float>(heroExpectedValue);
+    }
+}
+
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
+void traverseTerminal(
+    const Node& terminalNode,
+    const TraversalConstants& constants,
+    const GameRules& rules,
+    std::span<const float> villainReachProbs,
+    const VillainReachSummary& villainReachSummary,
+    std::span<float> outputExpectedValues,
+    Tree& tree
+) {
+    assert(isFoldOrShowdown(terminalNode));
+
+    // Decision nodes evaluate their fold and showdown children directly, so terminal nodes are profiled here instead of in traverseTree
+    // A terminal node evaluated for both players is counted once for each
+    NodeProfileScope nodeProfile{ terminalNode.nodeType };
+
+    if (terminalNode.nodeType == NodeType::Fold) {
+        traverseFold<GameHandSize, Mode>(terminalNode, constants, rules, villainReachProbs, villainReachSummary, outputExpectedValues, tree);
+    }
+    else {
+        traverseShowdown<GameHandSize, Mode>(terminalNode, constants, rules, villainReachProbs, villainReachSummary, outputExpectedValues, tree);
+    }
+}
+
+// Training update of a decision node of the hero in a subtree the villain never reaches, where every action has zero regret
+// The regrets only get this iteration's discount, and the strategy sums still get the hero's reach
+template <TraversalMode Mode>
+void updateUnreachedTrainingData(
+    const Node& decisionNode,
+    const TraversalConstants& constants,
+    std::span<const HandInfo> trainingHands,
+    std::span<const float> heroReachProbs,
+    std::span<const float> currentStrategy,
+    Tree& tree,
+    StackAllocator& allocator
+) {
+    assert(decisionNode.playerToAct == constants.hero);
+
+    int numActions = static_cast<int>(decisionNode.numChildren);
+    int numTrainingHands = static_cast<int>(trainingHands.size());
+
+    // Compressed training data is decoded into temporary buffers, updated, and then encoded again
+    std::optional<ScopedVector<float>> decodedRegretSums;
+    std::optional<ScopedVector<float>> decodedStrategySums;
+    std::span<float> regretSums;
+    std::span<float> strategySums;
+    if (tree.isTrainingDataCompressed()) {
+        decodedRegretSums.emplace(allocator, getThreadIndex(), numActions * numTrainingHands);
+        decodedStrategySums.emplace(allocator, getThreadIndex(), numActions * numTrainingHands);
+        decodeRegretSums(decodedRegretSums->getData(), decisionNode, tree);
+        decodeStrategySums(decodedStrategySums->getData(), decisionNode, tree);
+        regretSums = decodedRegretSums->getData();
+        strategySums = decodedStrategySums->getData();
+    }
+    else {
+        regretSums = { tree.allRegretSums.begin() + decisionNode.trainingDataOffset, static_cast<std::size_t>(numActions * numTrainingHands) };
+        strategySums = { tree.allStrategySums.begin() + decisionNode.trainingDataOffset, static_cast<std::size_t>(numActions * numTrainingHands) };
+    }
+
+    if constexpr (Mode == TraversalMode::DiscountedCfr) {
+        applyMissedDiscounts(decisionNode, constants.params, regretSums, strategySums, tree);
+    }
+
+    for (int action = 0; action < numActions; ++action) {
+        for (int i = 0; i < numTrainingHands; ++i) {
+            float& regretSum = regretSums[action * numTrainingHands + i];
+            float& strategySum = strategySums[action * numTrainingHands + i];
+            float handStrategy = heroReachProbs[trainingHands[i].index] * currentStrategy[action * numTrainingHands + i];
+
+            if constexpr (Mode == TraversalMode::DiscountedCfr) {
+                regretSum *= (regretSum > 0.0f) ? constants.params.alphaT : constants.params.betaT;
+                strategySum = strategySum * constants.params.gammaT + handStrategy;
+            }
+            else {
+                strategySum += handStrategy;
+            }
+        }
+    }
+
+    if (tree.isTrainingDataCompressed()) {
+        encodeRegretSums(regretSums, decisionNode, tree);
+        encodeStrategySums(strategySums, decisionNode, tree);
+    }
+}
+
+// The hero's expected values are weighted by the villain's reach, so they are all zero in a subtree the villain never reaches,
+// and so are the regrets of the hero's actions
+// Training the subtree then only has to update the hero's decision nodes that the hero reaches, without evaluating any terminal nodes
+// Decision nodes the hero does not reach either are left as they are, and catch up on their discounts when they are next updated
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
+void updateUnreachedSubtree(
+    const Node& node,
+    const TraversalConstants& constants,
+    const GameRules& rules,
+    std::span<const float> heroReachProbs,
+    std::span<const float> villainReachProbs,
+    Tree& tree,
+    StackAllocator& allocator
+) {
+    static_assert(isCfr(Mode));
+    assert(isReachZero(villainReachProbs));
+
+    if (isReachZero(heroReachProbs)) return;
+
+    switch (node.nodeType) {
+        case NodeType::Chance: {
+            // The regular traversal deals the cards, and comes back here for each of them
+            ScopedVector<float> outputExpectedValues(allocator, getThreadIndex(), tree.rangeSize[constants.hero]);
+            traverseChance<GameHandSize, Mode>(node, constants, rules, heroReachProbs, villainReachProbs, outputExpectedValues.getData(), tree, allocator);
+            break;
+        }
+        case NodeType::Decision: {
+            int numActions = static_cast<int>(node.numChildren);
+            if (node.playerToAct != constants.hero) {
+                for (int action = 0; action < numActions; ++action) {
+                    const Node& child = tree.allNodes[node.childrenOffset + action];
+                    updateUnreachedSubtree<GameHandSize, Mode>(child, constants, rules, heroReachProbs, villainReachProbs, tree, allocator);
+                }
+                break;
+            }
+
+            std::span<const HandInfo> trainingHands = getTrainingHands(node, rules);
+            int numTrainingHands = static_cast<int>(trainingHands.size());
+
+            ScopedVector<float> currentStrategy(allocator, getThreadIndex(), numActions * numTrainingHands);
+            writeCurrentStrategyToBuffer(currentStrategy.getData(), node, trainingHands, tree);
+            updateUnreachedTrainingData<Mode>(node, constants, trainingHands, heroReachProbs, currentStrategy.getData(), tree, allocator);
+
+            ScopedVector<float> newHeroReachProbs(allocator, getThreadIndex(), heroReachProbs.size());
+            for (int action = 0; action < numActions; ++action) {
+                std::span<const float> actionStrategy = currentStrategy.getData().subspan(action * numTrainingHands, numTrainingHands);
+                writeActionReachProbs(newHeroReachProbs.getData(), heroReachProbs, actionStrategy, trainingHands);
+
+                const Node& child = tree.allNodes[node.childrenOffset + action];
+                updateUnreachedSubtree<GameHandSize, Mode>(child, constants, rules, newHeroReachProbs.getData(), villainReachProbs, tree, allocator);
+            }
+            break;
+        }
+        default:
+            // Terminal nodes have nothing to train
+            break;
+    }
+}
+
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
+void traverseTree(
+    const Node& node,
+    const TraversalConstants& constants,
+    const GameRules& rules,
+    std::span<const float> heroReachProbs,
+    std::span<const float> villainReachProbs,
+    std::span<float> outputExpectedValues,
+    Tree& tree,
+    StackAllocator& allocator
+) {
+    assert(tree.isTreeSkeletonBuilt() && tree.areCfrVectorsInitialized());
+
+    // Fold and showdown nodes are profiled in traverseTerminal
+    std::optional<NodeProfileScope> nodeProfile;
+    if (!isFoldOrShowdown(node)) {
+        nodeProfile.emplace(node.nodeType);
+    }
+
+    // The hero's expected values are weighted by the villain's reach, so they are all zero in subtrees the villain never reaches
+    // Training still has to update the hero's training data in the subtree, which updateUnreachedSubtree does without evaluating its terminal nodes
+    // That rounds differently from a full traversal, so it is only done when pruning is enabled
+    // Traversals with a visitor still need to reach every decision node
+    if ((!isCfr(Mode) || constants.usePruning) && !constants.visitor && isReachZero(villainReachProbs)) {
+        std::fill(outputExpectedValues.begin(), outputExpectedValues.end(), 0.0f);
+        if constexpr (isCfr(Mode)) {
+            updateUnreachedSubtree<GameHandSize, Mode>(node, constants, rules, heroReachProbs, villainReachProbs, tree, allocator);
+        }
+        return;
+    }
+
+    switch (node.nodeType) {
+        case NodeType::Chance:
+            traverseChance<GameHandSize, Mode>(node, constants, rules, heroReachProbs, villainReachProbs, outputExpectedValues, tree, allocator);
+            break;
+        case NodeType::Decision:
+            traverseDecision<GameHandSize, Mode>(node, constants, rules, heroReachProbs, villainReachProbs, outputExpectedValues, tree, allocator);
+            break;
+        case NodeType::Fold:
+        case NodeType::Showdown: {
+            Player villain = getOpposingPlayer(constants.hero);
+            VillainReachSummary villainReachSummary = buildVillainReachSummary<GameHandSize>(villain, node.board, rules, villainReachProbs);
+            traverseTerminal<GameHandSize, Mode>(node, constants, rules, villainReachProbs, villainReachSummary, outputExpectedValues, tree);
+            break;
+        }
+        case NodeType::AllInRunout:
+            traverseAllInRunout<GameHandSize, Mode>(node, constants, rules, villainReachProbs, outputExpectedValues, tree);
+            break;
+        default:
+            assert(false);
+            break;
+    }
+}
+
+template <TraversalMode Mode>
+void traverseFromRoot(const TraversalConstants& constants, const IGameRules& rules, std::span<float> outputExpectedValues, Tree& tree, StackAllocator& allocator) {
+    Player villain = getOpposingPlayer(constants.hero);
+
+    int heroRangeSize = tree.rangeSize[constants.hero];
+    int villainRangeSize = tree.rangeSize[villain];
+
+    // We only need to calculate hero reach probs during CFR traversal because we only use them to update strategy sums
+    std::optional<ScopedVector<float>> heroReachProbs;
+    std::span<const float> heroReachProbsData;
+    if constexpr (isCfr(Mode)) {
+        const auto heroInitialRangeWeights = rules.getInitialRangeWeights(constants.hero);
+        heroReachProbs.emplace(allocator, getThreadIndex(), heroRangeSize);
+        for (int hand = 0; hand < heroRangeSize; ++hand) {
+            (*heroReachProbs)[hand] = heroInitialRangeWeights[hand];
+        }
+        heroReachProbsData = heroReachProbs->getData();
+    }
+
+    const auto villainInitialRangeWeights = rules.getInitialRangeWeights(villain);
+    ScopedVector<float> villainReachProbs(allocator, getThreadIndex(), villainRangeSize);
+    for (int hand = 0; hand < villainRangeSize; ++hand) {
+        villainReachProbs[hand] = villainInitialRangeWeights[hand];
+    }
+
+    dispatchGameRules(rules, tree.gameHandSize, [&](auto gameHandSize, const auto& concreteRules) -> void {
+        traverseTree<decltype(gameHandSize)::value, Mode>(
+            tree.allNodes[tree.getRootNodeIndex()],
+            constants,
+            concreteRules,
+            heroReachProbsData,
+            villainReachProbs.getData(),
+            outputExpectedValues,
+            tree,
+            allocator
+        );
+    });
+}
+
+// Traverses the subtree below a node with the given reach probabilities entering it, instead of the initial range weights at the root
+template <TraversalMode Mode>
+void traverseFromNode(
+    const Node& node,
+    const TraversalConstants& constants,
+    const IGameRules& rules,
+    const PlayerArray<std::span<const float>>& reachProbs,
+    std::span<float> outputExpectedValues,
+    Tree& tree,
+    StackAllocator& allocator
+) {
+    Player villain = getOpposingPlayer(constants.hero);
+    assert(reachProbs[constants.hero].size() == tree.rangeSize[constants.hero]);
+    assert(reachProbs[villain].size() == tree.rangeSize[villain]);
+
+    dispatchGameRules(rules, tree.gameHandSize, [&](auto gameHandSize, const auto& concreteRules) -> void {
+        traverseTree<decltype(gameHandSize)::value, Mode>(
+            node,
+            constants,
+            concreteRules,
+            reachProbs[constants.hero],
+            reachProbs[villain],
+            outputExpectedValues,
+            tree,
+            allocator
+        );
+    });
+}
+
+// Traversal for both players at once, which is either a best response traversal or a simultaneous update CFR iteration
+// Each player's reach probabilities are the villain reach probabilities for the other player's expected values,
+// so one pass computes the expected values of both players and shares the tree walk, strategies and task overhead between them
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
+void traverseBothPlayers(
+    const Node& node,
+    const TraversalConstants& constants,
+    const GameRules& rules,
+    const PlayerArray<std::span<const float>>& reachProbs,
+    const PlayerArray<std::span<float>>& outputExpectedValues,
+    Tree& tree,
+    StackAllocator& allocator
+);
+
+TraversalConstants getHeroConstants(const TraversalConstants& constants, Player hero) {
+    TraversalConstants heroConstants = constants;
+    heroConstants.hero = hero;
+    return heroConstants;
+}
+
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
+void traverseBothPlayersTerminal(
+    const Node& terminalNode,
+    const TraversalConstants& constants,
+    const GameRules& rules,
+    const PlayerArray<std::span<const float>>& reachProbs,
+    const PlayerArray<std::span<float>>& outputExpectedValues,
+    Tree& tree
+) {
+    for (Player hero : { Player::P0, Player::P1 }) {
+        Player villain = getOpposingPlayer(hero);
+        VillainReachSummary villainReachSummary = buildVillainReachSummary<GameHandSize>(villain, terminalNode.board, rules, reachProbs[villain]);
+        traverseTerminal<GameHandSize, Mode>(
+            terminalNode,
+            getHeroConstants(constants, hero),
+            rules,
+            reachProbs[villain],
+            villainReachSummary,
+            outputExpectedValues[hero],
+            tree
+        );
+    }
+}
+
+// Writes both players' expected values of each child in the mask to its slice of childExpectedValues, without summing them
+// The reach probabilities of each child are multiplied by childWeight, the same as in traverseChanceChildren
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
+void traverseBothPlayersChanceChildren(
+    const Node& chanceNode,
+    const TraversalConstants& constants,
+    const GameRules& rules,
+    const PlayerArray<std::span<const float>>& reachProbs,
+    const PlayerArray<std::span<float>>& childExpectedValues,
+    std::uint64_t childMask,
+    float childWeight,
+    Tree& tree,
+    StackAllocator& allocator
+) {
+    assert(chanceNode.nodeType == NodeType::Chance);
+
+    PlayerArray<int> rangeSize = tree.rangeSize;
+    const ChanceNodeDetails& chanceNodeDetails = tree.allChanceNodeDetails[chanceNode.chanceNodeIndex];
+
+    // Normalize expected values by the number of total chance cards possible
+    // Both players have a hand
+    int chanceCardReachFactor = getSetSize(chanceNodeDetails.availableCards) - (2 * GameHandSize);
+
+    assert(childExpectedValues[Player::P0].size() == chanceNode.numChildren * rangeSize[Player::P0]);
+    assert(childExpectedValues[Player::P1].size() == chanceNode.numChildren * rangeSize[Player::P1]);
+
+    auto calculateCardEV = [
+        &chanceNode,
+        &constants,
+        &rules,
+        &reachProbs,
+        &tree,
+        &allocator,
+        rangeSize,
+        chanceCardReachFactor,
+        childWeight,
+        childExpectedValues
+    ](int cardIndex) -> void {
+        const Node& nextNode = tree.allNodes[chanceNode.childrenOffset + cardIndex];
+        assert(nextNode.lastDealtCard != InvalidCard);
+
+        ScopedVector<float> player0NewReachProbs(allocator, getThreadIndex(), rangeSize[Player::P0]);
+        ScopedVector<float> player1NewReachProbs(allocator, getThreadIndex(), rangeSize[Player::P1]);
+        PlayerArray<std::span<float>> newReachProbs = { player0NewReachProbs.getData(), player1NewReachProbs.getData() };
+
+        for (Player player : { Player::P0, Player::P1 }) {
+            std::fill(newReachProbs[player].begin(), newReachProbs[player].end(), 0.0f);
+            for (HandInfo handInfo : rules.getValidHands(player, nextNode.board)) {
+                assert(handInfo != InvalidHand);
+                assert(areHandAndCardDisjoint<GameHandSize>(handInfo, nextNode.lastDealtCard));
+                newReachProbs[player][handInfo.index] = reachProbs[player][handInfo.index] * childWeight / static_cast<float>(chanceCardReachFactor);
+            }
+        }
+
+        // Prefetch and release file backed training data the same way as traverseChance
+        std::size_t nextNodeIndex = chanceNode.childrenOffset + cardIndex;
+        if (cardIndex + 1 < chanceNode.numChildren) {
+            tree.prefetchSubtreeTrainingData(nextNodeIndex + 1);
+        }
+
+        traverseBothPlayers<GameHandSize, Mode>(
+            nextNode,
+            constants,
+            rules,
+            { newReachProbs[Player::P0], newReachProbs[Player::P1] },
+            {
+                childExpectedValues[Player::P0].subspan(cardIndex * rangeSize[Player::P0], rangeSize[Player::P0]),
+                childExpectedValues[Player::P1].subspan(cardIndex * rangeSize[Player::P1], rangeSize[Player::P1])
+            },
+            tree,
+            allocator
+        );
+
+        tree.releaseSubtreeTrainingData(nextNodeIndex);
+    };
+
+    #ifdef _OPENMP
+    // Spawn tasks for large subtrees first so that other threads can start on them, then traverse small subtrees inline
+    for (int cardIndex = 0; cardIndex < chanceNode.numChildren; ++cardIndex) {
+        if (isChildInMask(childMask, cardIndex) && shouldSpawnTask(tree.allNodes[chanceNode.childrenOffset + cardIndex], constants)) {
+            profileTaskSpawned();
+            #pragma omp task default(none) firstprivate(calculateCardEV, cardIndex)
+            {
+                TaskProfileScope taskProfile{ NodeType::Chance };
+                calculateCardEV(cardIndex);
+            }
+        }
+    }
+    for (int cardIndex = 0; cardIndex < chanceNode.numChildren; ++cardIndex) {
+        if (isChildInMask(childMask, cardIndex) && !shouldSpawnTask(tree.allNodes[chanceNode.childrenOffset + cardIndex], constants)) {
+            calculateCardEV(cardIndex);
+        }
+    }
 
-    // First pass: Calculate hero winning hands
     {
-        float villainTotalReachProb = 0.0f;
-        std::array<float, StandardDeckSize> villainReachProbWithCard = {};
+        TaskwaitProfileScope taskwaitProfile;
+        #pragma omp taskwait
+    }
+    #else
+    // Run on single thread if no OpenMP
+    for (int cardIndex = 0; cardIndex < chanceNode.numChildren; ++cardIndex) {
+        if (isChildInMask(childMask, cardIndex)) {
+            calculateCardEV(cardIndex);
+        }
+    }
+    #endif
+}
+
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
+void traverseBothPlayersChance(
+    const Node& chanceNode,
+    const TraversalConstants& constants,
+    const GameRules& rules,
+    const PlayerArray<std::span<const float>>& reachProbs,
+    const PlayerArray<std::span<float>>& outputExpectedValues,
+    Tree& tree,
+    StackAllocator& allocator
+) {
+    assert(chanceNode.nodeType == NodeType::Chance);
+
+    PlayerArray<int> rangeSize = tree.rangeSize;
+
+    ScopedVector<float> player0NewOutputExpectedValues(allocator, getThreadIndex(), chanceNode.numChildren * rangeSize[Player::P0]);
+    ScopedVector<float> player1NewOutputExpectedValues(allocator, getThreadIndex(), chanceNode.numChildren * rangeSize[Player::P1]);
+    PlayerArray<std::span<float>> newOutputExpectedValues = {
+        player0NewOutputExpectedValues.getData(),
+        player1NewOutputExpectedValues.getData()
+    };
+
+    std::uint64_t childMask = getAllChildrenMask(chanceNode);
+    float childWeight = 1.0f;
+    if (isChanceNodeSampled(chanceNode, constants)) {
+        childMask = sampleChildren(chanceNode, getNodeIndex(chanceNode, tree), constants.sampling);
+        childWeight = static_cast<float>(chanceNode.numChildren) / static_cast<float>(constants.sampling.numSampledCards);
+
+        // Children that are not visited contribute nothing to the sum over the chance cards
+        for (Player player : { Player::P0, Player::P1 }) {
+            std::fill(newOutputExpectedValues[player].begin(), newOutputExpectedValues[player].end(), 0.0f);
+        }
+    }
+
+    if (DistributedCoordinator* coordinator = getChanceNodeCoordinator(chanceNode, tree)) {
+        coordinator->traverseChanceNode({
+            .mode = Mode,
+            .hero = Player::P0,
+            .params = constants.params,
+            .usePruning = constants.usePruning,
+            .sampling = constants.sampling,
+            .childWeight = childWeight,
+            .nodeIndex = getNodeIndex(chanceNode, tree),
+            .childMask = childMask,
+            .reachProbs = reachProbs,
+            .childExpectedValues = newOutputExpectedValues
+        });
+    }
+    else {
+        traverseBothPlayersChanceChildren<GameHandSize, Mode>(
+            chanceNode,
+            constants,
+            rules,
+            reachProbs,
+            newOutputExpectedValues,
+            childMask,
+            childWeight,
+            tree,
+            allocator
+        );
+    }
+
+    for (Player player : { Player::P0, Player::P1 }) {
+        std::fill(outputExpectedValues[player].begin(), outputExpectedValues[player].end(), 0.0f);
+        accumulateChanceExpectedValues<GameHandSize>(chanceNode, player, rules, newOutputExpectedValues[player], outputExpectedValues[player], tree);
+    }
+}
+
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
+void traverseBothPlayersDecision(
+    const Node& decisionNode,
+    const TraversalConstants& constants,
+    const GameRules& rules,
+    const PlayerArray<std::span<const float>>& reachProbs,
+    const PlayerArray<std::span<float>>& outputExpectedValues,
+    Tree& tree,
+    StackAllocator& allocator
+) {
+    static_assert((Mode == TraversalMode::DiscountedCfr) || (Mode == TraversalMode::BestResponse));
+    assert(decisionNode.nodeType == NodeType::Decision);
 
-        int villainIndexSorted = 0;
+    // In a best response traversal the acting player plays a best response, and during training the acting player's regrets are updated
+    // Either way, the other player's expected value follows the acting player's strategy
+    Player actingPlayer = decisionNode.playerToAct;
+    Player otherPlayer = getOpposingPlayer(actingPlayer);
 
-        for (RankedHand heroRankedHand : heroSortedHandRanks) {
-            assert(areHandAndSetDisjoint<GameHandSize>(heroRankedHand.info, showdownNode.state.currentBoard));
+    int numActions = static_cast<int>(decisionNode.numChildren);
+    assert(numActions > 0);
 
-            while (villainIndexSorted < villainFilteredRangeSize && villainSortedHandRanks[villainIndexSorted].rank < heroRankedHand.rank) {
-                RankedHand villainRankedHand = villainSortedHandRanks[villainIndexSorted];
-                assert(areHandAndSetDisjoint<GameHandSize>(villainRankedHand.info, showdownNode.state.currentBoard));
+    int actingRangeSize = tree.rangeSize[actingPlayer];
+    int otherRangeSize = tree.rangeSize[otherPlayer];
 
-                float villainReachProb = villainReachProbs[villainRankedHand.info.index];
-                villainTotalReachProb += villainReachProb;
-                addReachProbsToArray<GameHandSize>(villainReachProbWithCard, villainRankedHand.info, villainReachProb);
+    std::span<const HandInfo> trainingHands = getTrainingHands(decisionNode, rules);
+    int numTrainingHands = static_cast<int>(trainingHands.size());
 
-                ++villainIndexSorted;
-            }
+    ScopedVector<float> strategy(allocator, getThreadIndex(), numActions * numTrainingHands);
+    if constexpr (isCfr(Mode)) {
+        writeCurrentStrategyToBuffer(strategy.getData(), decisionNode, trainingHands, tree);
+    }
+    else {
+        writeAverageStrategyToBuffer(strategy.getData(), decisionNode, trainingHands, tree);
+    }
 
-            if (villainTotalReachProb == 0.0f) {
-                continue;
-            }
+    // Compressed training data is decoded into temporary buffers, updated, and then encoded again
+    std::optional<ScopedVector<float>> decodedRegretSums;
+    std::optional<ScopedVector<float>> decodedStrategySums;
+    std::span<float> regretSums;
+    std::span<float> strategySums;
+    PrunedActionMask prunedActions = 0;
+    if constexpr (isCfr(Mode)) {
+        if (tree.isTrainingDataCompressed()) {
+            decodedRegretSums.emplace(allocator, getThreadIndex(), numActions * numTrainingHands);
+            decodedStrategySums.emplace(allocator, getThreadIndex(), numActions * numTrainingHands);
+            decodeRegretSums(decodedRegretSums->getData(), decisionNode, tree);
+            decodeStrategySums(decodedStrategySums->getData(), decisionNode, tree);
+            regretSums = decodedRegretSums->getData();
+            strategySums = decodedStrategySums->getData();
+        }
+        else {
+            regretSums = { tree.allRegretSums.begin() + decisionNode.trainingDataOffset, static_cast<std::size_t>(numActions * numTrainingHands) };
+            strategySums = { tree.allStrategySums.begin() + decisionNode.trainingDataOffset, static_cast<std::size_t>(numActions * numTrainingHands) };
+        }
 
-            float villainValidReachProb = villainTotalReachProb
-                - getReachProbBlockedByHeroHand<GameHandSize>(heroRankedHand.info, villainReachProbWithCard);
-            // We don't need to call getInclusionExculsionCorrection because this pass only includes cases where the hero wins
-            // If the hero and villain hands were identical, then it would be a tie
-            // Thus getReachProbBlockedByHeroHand will not have any contribution from identical hero and villain hands
+        applyMissedDiscounts(decisionNode, constants.params, regretSums, strategySums, tree);
 
-            outputExpectedValues[heroRankedHand.info.index] += winPayoff * villainValidReachProb;
+        if (constants.usePruning) {
+            prunedActions = getPrunedActions(decisionNode, regretSums, strategy.getData(), numTrainingHands, reachProbs[otherPlayer], tree);
         }
     }
 
-    // Second pass: Calculate hero losing hands
-    {
-        float villainTotalReachProb = 0.0f;
-        std::array<float, StandardDeckSize> villainReachProbWithCard = {};
+    // The other player's reach is the same for every action
+    // Therefore the acting player's expected values at all fold and showdown children can share one summary of it
+    std::optional<VillainReachSummary> otherReachSummary;
+    for (int action = 0; action < numActions; ++action) {
+        if (isFoldOrShowdown(tree.allNodes[decisionNode.childrenOffset + action])) {
+            otherReachSummary = buildVillainReachSummary<GameHandSize>(otherPlayer, decisionNode.board, rules, reachProbs[otherPlayer]);
+            break;
+        }
+    }
 
-        int villainIndexSorted = villainFilteredRangeSize - 1;
+    ScopedVector<float> actingNewOutputExpectedValues(allocator, getThreadIndex(), numActions * actingRangeSize);
+    ScopedVector<float> otherNewOutputExpectedValues(allocator, getThreadIndex(), numActions * otherRangeSize);
+    std::span<const float> strategyData = strategy.getData();
+    std::span<float> actingNewOutputExpectedValuesData = actingNewOutputExpectedValues.getData();
+    std::span<float> otherNewOutputExpectedValuesData = otherNewOutputExpectedValues.getData();
 
-        for (RankedHand heroRankedHand : std::views::reverse(heroSortedHandRanks)) {
-            assert(areHandAndSetDisjoint<GameHandSize>(heroRankedHand.info, showdownNode.state.currentBoard));
+    auto calculateActionEV = [
+        &decisionNode,
+        &constants,
+        &rules,
+        &reachProbs,
+        &otherReachSummary,
+        &tree,
+        &allocator,
+        actingPlayer,
+        otherPlayer,
+        actingRangeSize,
+        otherRangeSize,
+        trainingHands,
+        numTrainingHands,
+        strategyData,
+        actingNewOutputExpectedValuesData,
+        otherNewOutputExpectedValuesData
+    ](int action) -> void {
+        const Node& nextNode = tree.allNodes[decisionNode.childrenOffset + action];
+        std::span<float> actingActionExpectedValues = actingNewOutputExpectedValuesData.subspan(action * actingRangeSize, actingRangeSize);
+        std::span<float> otherActionExpectedValues = otherNewOutputExpectedValuesData.subspan(action * otherRangeSize, otherRangeSize);
+
+        // Only the acting player's reach depends on the action
+        ScopedVector<float> actingNewReachProbs(allocator, getThreadIndex(), actingRangeSize);
+        writeActionReachProbs(actingNewReachProbs.getData(), reachProbs[actingPlayer], strategyData.subspan(action * numTrainingHands, numTrainingHands), trainingHands);
+
+        if (isFoldOrShowdown(nextNode)) {
+            assert(otherReachSummary);
+            traverseTerminal<GameHandSize, Mode>(
+                nextNode,
+                getHeroConstants(constants, actingPlayer),
+                rules,
+                reachProbs[otherPlayer],
+                *otherReachSummary,
+                actingActionExpectedValues,
+                tree
+            );
 
-            while (villainIndexSorted >= 0 && villainSortedHandRanks[villainIndexSorted].rank > heroRankedHand.rank) {
-                RankedHand villainRankedHand = villainSortedHandRanks[villainIndexSorted];
-                assert(areHandAndSetDisjoint<GameHandSize>(villainRankedHand.info, showdownNode.state.currentBoard));
+            VillainReachSummary actingReachSummary = buildVillainReachSummary<GameHandSize>(actingPlayer, nextNode.board, rules, actingNewReachProbs.getData());
+            traverseTerminal<GameHandSize, Mode>(
+                nextNode,
+                getHeroConstants(constants, otherPlayer),
+                rules,
+                actingNewReachProbs.getData(),
+                actingReachSummary,
+                otherActionExpectedValues,
+                tree
+            );
+            return;
+        }
 
-                float villainReachProb = villainReachProbs[villainRankedHand.info.index];
-                villainTotalReachProb += villainReachProb;
-                addReachProbsToArray<GameHandSize>(villainReachProbWithCard, villainRankedHand.info, villainReachProb);
+        PlayerArray<std::span<const float>> newReachProbs = reachProbs;
+        newReachProbs[actingPlayer] = actingNewReachProbs.getData();
 
-                --villainIndexSorted;
-            }
+        PlayerArray<std::span<float>> newOutputExpectedValues;
+        newOutputExpectedValues[actingPlayer] = actingActionExpectedValues;
+        newOutputExpectedValues[otherPlayer] = otherActionExpectedValues;
 
-            if (villainTotalReachProb == 0.0f) {
-                continue;
-            }
+        traverseBothPlayers<GameHandSize, Mode>(nextNode, constants, rules, newReachProbs, newOutputExpectedValues, tree, allocator);
+    };
 
-            float villainValidReachProb = villainTotalReachProb
-                - getReachProbBlockedByHeroHand<GameHandSize>(heroRankedHand.info, villainReachProbWithCard);
-            // We don't need to call getInclusionExculsionCorrection because this pass only includes cases where the hero loses
-            // If the hero and villain hands were identical, then it would be a tie
-            // Thus getReachProbBlockedByHeroHand will not have any contribution from identical hero and villain hands
+    #ifdef _OPENMP
+    // Spawn tasks for large subtrees first so that other threads can start on them, then traverse small subtrees inline
+    for (int action = 0; action < numActions; ++action) {
+        if (isActionPruned(prunedActions, action)) continue;
 
-            outputExpectedValues[heroRankedHand.info.index] += losePayoff * villainValidReachProb;
+        if (shouldSpawnTask(tree.allNodes[decisionNode.childrenOffset + action], constants)) {
+            profileTaskSpawned();
+            #pragma omp task default(none) firstprivate(calculateActionEV, action)
+            {
+                TaskProfileScope taskProfile{ NodeType::Decision };
+                calculateActionEV(action);
+            }
         }
     }
+    for (int action = 0; action < numActions; ++action) {
+        if (isActionPruned(prunedActions, action)) continue;
 
-    // Third pass: Calculate tie hands
-    // Can ignore ties in zero-sum game, 0 EV for both players
-    if (tree.deadMoney > 0) {
-        const auto& heroSameHandIndexTable = tree.sameHandIndexTable[hero];
-
-        float villainTotalReachProb = 0.0f;
-        std::array<float, StandardDeckSize> villainReachProbWithCard = {};
-
-        int villainIndexSorted = 0;
-
-        for (int heroIndexSorted = 0; heroIndexSorted < heroFilteredRangeSize; ++heroIndexSorted) {
-            RankedHand heroRankedHand = heroSortedHandRanks[heroIndexSorted];
-            assert(areHandAndSetDisjoint<GameHandSize>(heroRankedHand.info, showdownNode.state.currentBoard));
-
-            bool heroRankIncreased = (heroIndexSorted == 0) || (heroRankedHand.rank > heroSortedHandRanks[heroIndexSorted - 1].rank);
-            if (heroRankIncreased) {
-                // We need to reset our reach probs because the hero's rank has increased
-                villainTotalReachProb = 0.0;
-                villainReachProbWithCard.fill(0.0);
+        if (!shouldSpawnTask(tree.allNodes[decisionNode.childrenOffset + action], constants)) {
+            calculateActionEV(action);
+        }
+    }
 
-                // Skip until we find a hand that we tie with
-                while (villainIndexSorted < villainFilteredRangeSize && villainSortedHandRanks[villainIndexSorted].rank < heroRankedHand.rank) {
-                    ++villainIndexSorted;
-                }
+    {
+        TaskwaitProfileScope taskwaitProfile;
+        #pragma omp taskwait
+    }
+    #else
+    // Run on single thread if no OpenMP
+    for (int action = 0; action < numActions; ++action) {
+        if (isActionPruned(prunedActions, action)) continue;
 
-                while (villainIndexSorted < villainFilteredRangeSize && villainSortedHandRanks[villainIndexSorted].rank == heroRankedHand.rank) {
-                    RankedHand villainRankedHand = villainSortedHandRanks[villainIndexSorted];
-                    assert(areHandAndSetDisjoint<GameHandSize>(villainRankedHand.info, showdownNode.state.currentBoard));
+        calculateActionEV(action);
+    }
+    #endif
 
-                    float villainReachProb = villainReachProbs[villainRankedHand.info.index];
-                    villainTotalReachProb += villainReachProb;
-                    addReachProbsToArray<GameHandSize>(villainReachProbWithCard, villainRankedHand.info, villainReachProb);
+    // The other player's reach was already weighted by the strategy, so their expected values are summed
+    // No hand plays a pruned action, so it adds nothing for the other player
+    // The sum starts from positive zero and so can never be negative zero, which makes adding the zeroed rows exact
+    for (int action = 0; action < numActions; ++action) {
+        if (isActionPruned(prunedActions, action)) {
+            std::span<float> prunedExpectedValues = otherNewOutputExpectedValuesData.subspan(action * otherRangeSize, otherRangeSize);
+            std::fill(prunedExpectedValues.begin(), prunedExpectedValues.end(), 0.0f);
+        }
+    }
 
-                    ++villainIndexSorted;
-                }
-            }
+    std::span<float> otherOutputExpectedValues = outputExpectedValues[otherPlayer];
+    std::fill(otherOutputExpectedValues.begin(), otherOutputExpectedValues.end(), 0.0f);
+    accumulateActionValues(otherOutputExpectedValues, otherNewOutputExpectedValuesData, numActions, otherRangeSize);
 
-            if (villainTotalReachProb == 0.0f) {
-                continue;
+    if constexpr (isCfr(Mode)) {
+        updateTrainingData<Mode>(
+            decisionNode,
+            getHeroConstants(constants, actingPlayer),
+            trainingHands,
+            reachProbs[actingPlayer],
+            strategyData,
+            prunedActions,
+            actingNewOutputExpectedValuesData,
+            regretSums,
+            strategySums,
+            outputExpectedValues[actingPlayer],
+            tree,
+            allocator
+        );
+
+        if (tree.isTrainingDataCompressed()) {
+            encodeRegretSums(regretSums, decisionNode, tree);
+            encodeStrategySums(strategySums, decisionNode, tree);
+        }
+    }
+    else {
+        // The acting player plays the action that leads to the highest EV for each hand
+        static constexpr float Lowest = std::numeric_limits<float>::lowest();
+        std::span<float> actingOutputExpectedValues = outputExpectedValues[actingPlayer];
+        std::fill(actingOutputExpectedValues.begin(), actingOutputExpectedValues.end(), Lowest);
+        for (int action = 0; action < numActions; ++action) {
+            for (int hand = 0; hand < actingRangeSize; ++hand) {
+                actingOutputExpectedValues[hand] = std::max(actingOutputExpectedValues[hand], actingNewOutputExpectedValues[action * actingRangeSize + hand]);
             }
-
-            float villainValidReachProb = villainTotalReachProb
-                - getReachProbBlockedByHeroHand<GameHandSize>(heroRankedHand.info, villainReachProbWithCard)
-                + getInclusionExculsionCorrection<GameHandSize>(heroRankedHand.info.index, villainReachProbs, heroSameHandIndexTable);
-
-            outputExpectedValues[heroRankedHand.info.index] += tiePayoff * villainValidReachProb;
         }
     }
 }
 
-template <int GameHandSize, TraversalMode Mode>
-void traverseTree(
+template <int GameHandSize, TraversalMode Mode, typename GameRules>
+void traverseBothPlayers(
     const Node& node,
     const TraversalConstants& constants,
-    const IGameRules& rules,
-    std::span<const float> heroReachProbs,
-    std::span<const float> villainReachProbs,
-    std::span<float> outputExpectedValues,
+    const GameRules& rules,
+    const PlayerArray<std::span<const float>>& reachProbs,
+    const PlayerArray<std::span<float>>& outputExpectedValues,
     Tree& tree,
-    StackAllocator<float>& allocator
+    StackAllocator& allocator
 ) {
     assert(tree.isTreeSkeletonBuilt() && tree.areCfrVectorsInitialized());
 
+    // With pruning, subtrees that one player never reaches are traversed once for each player as the hero of an alternating update traversal,
+    // which skips the expected values of the other player the same as in traverseTree
+    if constexpr (isCfr(Mode)) {
+        if (constants.usePruning && (isReachZero(reachProbs[Player::P0]) || isReachZero(reachProbs[Player::P1]))) {
+            for (Player hero : { Player::P0, Player::P1 }) {
+                Player villain = getOpposingPlayer(hero);
+                traverseTree<GameHandSize, Mode>(node, getHeroConstants(constants, hero), rules, reachProbs[hero], reachProbs[villain], outputExpectedValues[hero], tree, allocator);
+            }
+            return;
+        }
+    }
+
+    // Fold and showdown nodes are profiled in traverseTerminal
+    std::optional<NodeProfileScope> nodeProfile;
+    if (!isFoldOrShowdown(node)) {
+        nodeProfile.emplace(node.nodeType);
+    }
+
     switch (node.nodeType) {
         case NodeType::Chance:
-            traverseChance<GameHandSize, Mode>(node, constants, rules, heroReachProbs, villainReachProbs, outputExpectedValues, tree, allocator);
+            traverseBothPlayersChance<GameHandSize, Mode>(node, constants, rules, reachProbs, outputExpectedValues, tree, allocator);
             break;
         case NodeType::Decision:
-            traverseDecision<GameHandSize, Mode>(node, constants, rules, heroReachProbs, villainReachProbs, outputExpectedValues, tree, allocator);
+            traverseBothPlayersDecision<GameHandSize, Mode>(node, constants, rules, reachProbs, outputExpectedValues, tree, allocator);
             break;
         case NodeType::Fold:
-            traverseFold<GameHandSize, Mode>(node, constants, rules, villainReachProbs, outputExpectedValues, tree);
-            break;
         case NodeType::Showdown:
-            traverseShowdown<GameHandSize, Mode>(node, constants, rules, villainReachProbs, outputExpectedValues, tree);
-            break;
-        default:
-            assert(false);
-            break;
-    }
-}
-
-template <TraversalMode Mode>
-void traverseFromRoot(const TraversalConstants& constants, const IGameRules& rules, std::span<float> outputExpectedValues, Tree& tree, StackAllocator<float>& allocator) {
-    Player villain = getOpposingPlayer(constants.hero);
-
-    int heroRangeSize = tree.rangeSize[constants.hero];
-    int villainRangeSize = tree.rangeSize[villain];
-
-    // We only need to calculate hero reach probs during CFR traversal because we only use them to update strategy sums
-    std::optional<ScopedVector<float>> heroReachProbs;
-    std::span<const float> heroReachProbsData;
-    if constexpr (isCfr(Mode)) {
-        const auto heroInitialRangeWeights = rules.getInitialRangeWeights(constants.hero);
-        heroReachProbs.emplace(allocator, getThreadIndex(), heroRangeSize);
-        for (int hand = 0; hand < heroRangeSize; ++hand) {
-            (*heroReachProbs)[hand] = heroInitialRangeWeights[hand];
-        }
-        heroReachProbsData = heroReachProbs->getData();
-    }
-
-    const auto villainInitialRangeWeights = rules.getInitialRangeWeights(villain);
-    ScopedVector<float> villainReachProbs(allocator, getThreadIndex(), villainRangeSize);
-    for (int hand = 0; hand < villainRangeSize; ++hand) {
-        villainReachProbs[hand] = villainInitialRangeWeights[hand];
-    }
-
-    switch (tree.gameHandSize) {
-        case 1: {
-            traverseTree<1, Mode>(
-                tree.allNodes[tree.getRootNodeIndex()],
-                constants,
-                rules,
-                heroReachProbsData,
-                villainReachProbs.getData(),
-                outputExpectedValues,
-                tree,
-                allocator
-            );
+            traverseBothPlayersTerminal<GameHandSize, Mode>(node, constants, rules, reachProbs, outputExpectedValues, tree);
             break;
-        }
-
-        case 2: {
-            traverseTree<2, Mode>(
-                tree.allNodes[tree.getRootNodeIndex()],
-                constants,
-                rules,
-                heroReachProbsData,
-                villainReachProbs.getData(),
-                outputExpectedValues,
-                tree,
-                allocator
-            );
+        case NodeType::AllInRunout:
+            // Neither player acts again, so each player's expected values only depend on the other player's reach
+            for (Player hero : { Player::P0, Player::P1 }) {
+                Player villain = getOpposingPlayer(hero);
+                traverseAllInRunout<GameHandSize, Mode>(
+                    node,
+                    getHeroConstants(constants, hero),
+                    rules,
+                    reachProbs[villain],
+                    outputExpectedValues[hero],
+                    tree
+                );
+            }
             break;
-        }
-
         default:
             assert(false);
             break;
@@ -996,7 +2434,7 @@ float rootExpectedValue(
     Player hero,
     const IGameRules& rules,
     Tree& tree,
-    StackAllocator<float>& allocator
+    StackAllocator& allocator
 ) {
     static_assert((Mode == TraversalMode::ExpectedValue) || (Mode == TraversalMode::BestResponse));
 
@@ -1005,7 +2443,8 @@ float rootExpectedValue(
 
     TraversalConstants constants = {
        .hero = hero,
-       .params = {} // No params needed for expected value
+       .params = {}, // No params needed for expected value
+       .taskWorkThreshold = getTaskWorkThreshold(tree)
     };
 
     int heroRangeSize = tree.rangeSize[hero];
@@ -1021,6 +2460,58 @@ float rootExpectedValue(
     expectedValue /= tree.totalRangeWeight;
     return static_cast<float>(expectedValue);
 }
+
+// Sums of each player's best response expected values over their hands, weighted by their reach probabilities entering the node
+PlayerArray<double> weightedBestResponseEVs(
+    const IGameRules& rules,
+    const Node& node,
+    const PlayerArray<std::span<const float>>& reachProbs,
+    Tree& tree,
+    StackAllocator& allocator
+) {
+    // Allocator should be empty before starting traversal, otherwise something wasn't deleted correctly
+    assert(allocator.isEmpty());
+
+    TraversalConstants constants = {
+       .hero = Player::P0, // Both players are the hero, see traverseBothPlayers
+       .params = {}, // No params needed for best response
+       .taskWorkThreshold = getTaskWorkThreshold(tree)
+    };
+
+    PlayerArray<int> rangeSize = tree.rangeSize;
+    assert(reachProbs[Player::P0].size() == rangeSize[Player::P0]);
+    assert(reachProbs[Player::P1].size() == rangeSize[Player::P1]);
+
+    ScopedVector<float> player0OutputExpectedValues(allocator, getThreadIndex(), rangeSize[Player::P0]);
+    ScopedVector<float> player1OutputExpectedValues(allocator, getThreadIndex(), rangeSize[Player::P1]);
+    PlayerArray<std::span<float>> outputExpectedValues = { player0OutputExpectedValues.getData(), player1OutputExpectedValues.getData() };
+
+    dispatchGameRules(rules, tree.gameHandSize, [&](auto gameHandSize, const auto& concreteRules) -> void {
+        traverseBothPlayers<decltype(gameHandSize)::value, TraversalMode::BestResponse>(node, constants, concreteRules, reachProbs, outputExpectedValues, tree, allocator);
+    });
+
+    PlayerArray<double> expectedValues;
+    for (Player player : { Player::P0, Player::P1 }) {
+        double expectedValue = 0.0;
+        for (int hand = 0; hand < rangeSize[player]; ++hand) {
+            expectedValue += static_cast<double>(outputExpectedValues[player][hand]) * static_cast<double>(reachProbs[player][hand]);
+        }
+        expectedValues[player] = expectedValue;
+    }
+    return expectedValues;
+}
+
+// Marks the hero's decision nodes in the subtree as never discounted, for solves that count their iterations from 1 again
+void restartSubtreeDiscounting(const Node& node, Player hero, Tree& tree) {
+    if ((node.nodeType != NodeType::Decision) && (node.nodeType != NodeType::Chance)) return;
+
+    if ((node.nodeType == NodeType::Decision) && (node.playerToAct == hero)) {
+        tree.allLastDiscountedIterations[node.decisionNodeIndex] = 0;
+    }
+    for (int child = 0; child < node.numChildren; ++child) {
+        restartSubtreeDiscounting(tree.allNodes[node.childrenOffset + child], hero, tree);
+    }
+}
 } // namespace
 
 DiscountParams getDiscountParams(float alpha, float beta, float gamma, int iteration) {
@@ -1031,7 +2522,11 @@ DiscountParams getDiscountParams(float alpha, float beta, float gamma, int itera
     return {
         .alphaT = static_cast<float>(a / (a + 1)),
         .betaT = static_cast<float>(b / (b + 1)),
-        .gammaT = static_cast<float>(std::pow(t / (t + 1), static_cast<double>(gamma)))
+        .gammaT = static_cast<float>(std::pow(t / (t + 1), static_cast<double>(gamma))),
+        .iteration = iteration,
+        .alpha = alpha,
+        .beta = beta,
+        .gamma = gamma
     };
 }
 
@@ -1039,14 +2534,18 @@ void vanillaCfr(
     Player hero,
     const IGameRules& rules,
     Tree& tree,
-    StackAllocator<float>& allocator
+    StackAllocator& allocator
 ) {
     // Allocator should be empty before starting traversal, otherwise something wasn't deleted correctly
     assert(allocator.isEmpty());
 
+    // Memory mapped trees only contain the average strategy, so they cannot be trained
+    assert(!tree.isTrainingDataMemoryMapped());
+
     TraversalConstants constants = {
         .hero = hero,
-        .params = {} // No params needed for vanilla CFR
+        .params = {}, // No params needed for vanilla CFR
+        .taskWorkThreshold = getTaskWorkThreshold(tree)
     };
 
     ScopedVector<float> outputExpectedValues(allocator, getThreadIndex(), tree.rangeSize[hero]);
@@ -1057,14 +2556,18 @@ void cfrPlus(
     Player hero,
     const IGameRules& rules,
     Tree& tree,
-    StackAllocator<float>& allocator
+    StackAllocator& allocator
 ) {
     // Allocator should be empty before starting traversal, otherwise something wasn't deleted correctly
     assert(allocator.isEmpty());
 
+    // Memory mapped trees only contain the average strategy, so they cannot be trained
+    assert(!tree.isTrainingDataMemoryMapped());
+
     TraversalConstants constants = {
         .hero = hero,
-        .params = {} // No params needed for CFR+
+        .params = {}, // No params needed for CFR+
+        .taskWorkThreshold = getTaskWorkThreshold(tree)
     };
 
     ScopedVector<float> outputExpectedValues(allocator, getThreadIndex(), tree.rangeSize[hero]);
@@ -1076,25 +2579,149 @@ void discountedCfr(
     const IGameRules& rules,
     const DiscountParams& params,
     Tree& tree,
-    StackAllocator<float>& allocator
+    StackAllocator& allocator,
+    bool usePruning
+) {
+    // Allocator should be empty before starting traversal, otherwise something wasn't deleted correctly
+    assert(allocator.isEmpty());
+
+    // Memory mapped trees only contain the average strategy, so they cannot be trained
+    assert(!tree.isTrainingDataMemoryMapped());
+
+    TraversalConstants constants = {
+        .hero = hero,
+        .params = params,
+        .taskWorkThreshold = getTaskWorkThreshold(tree),
+        .usePruning = usePruning
+    };
+
+    ScopedVector<float> outputExpectedValues(allocator, getThreadIndex(), tree.rangeSize[hero]);
+    traverseFromRoot<TraversalMode::DiscountedCfr>(constants, rules, outputExpectedValues, tree, allocator);
+}
+
+void sampledDiscountedCfr(
+    Player hero,
+    const IGameRules& rules,
+    const DiscountParams& params,
+    const ChanceSampling& sampling,
+    Tree& tree,
+    StackAllocator& allocator,
+    bool usePruning
 ) {
     // Allocator should be empty before starting traversal, otherwise something wasn't deleted correctly
     assert(allocator.isEmpty());
 
+    // Memory mapped trees only contain the average strategy, so they cannot be trained
+    assert(!tree.isTrainingDataMemoryMapped());
+
     TraversalConstants constants = {
         .hero = hero,
-        .params = params
+        .params = params,
+        .taskWorkThreshold = getTaskWorkThreshold(tree),
+        .usePruning = usePruning,
+        .sampling = sampling
     };
 
     ScopedVector<float> outputExpectedValues(allocator, getThreadIndex(), tree.rangeSize[hero]);
     traverseFromRoot<TraversalMode::DiscountedCfr>(constants, rules, outputExpectedValues, tree, allocator);
 }
 
+void simultaneousDiscountedCfr(
+    const IGameRules& rules,
+    const DiscountParams& params,
+    const ChanceSampling& sampling,
+    Tree& tree,
+    StackAllocator& allocator,
+    bool usePruning
+) {
+    // Allocator should be empty before starting traversal, otherwise something wasn't deleted correctly
+    assert(allocator.isEmpty());
+
+    // Memory mapped trees only contain the average strategy, so they cannot be trained
+    assert(!tree.isTrainingDataMemoryMapped());
+
+    TraversalConstants constants = {
+        .hero = Player::P0, // Both players are the hero, see traverseBothPlayers
+        .params = params,
+        .taskWorkThreshold = getTaskWorkThreshold(tree),
+        .usePruning = usePruning,
+        .sampling = sampling
+    };
+
+    PlayerArray<int> rangeSize = tree.rangeSize;
+    PlayerArray<std::span<const float>> reachProbs = { rules.getInitialRangeWeights(Player::P0), rules.getInitialRangeWeights(Player::P1) };
+    assert(reachProbs[Player::P0].size() == rangeSize[Player::P0]);
+    assert(reachProbs[Player::P1].size() == rangeSize[Player::P1]);
+
+    ScopedVector<float> player0OutputExpectedValues(allocator, getThreadIndex(), rangeSize[Player::P0]);
+    ScopedVector<float> player1OutputExpectedValues(allocator, getThreadIndex(), rangeSize[Player::P1]);
+    PlayerArray<std::span<float>> outputExpectedValues = { player0OutputExpectedValues.getData(), player1OutputExpectedValues.getData() };
+
+    dispatchGameRules(rules, tree.gameHandSize, [&](auto gameHandSize, const auto& concreteRules) -> void {
+        traverseBothPlayers<decltype(gameHandSize)::value, TraversalMode::DiscountedCfr>(
+            tree.allNodes[tree.getRootNodeIndex()],
+            constants,
+            concreteRules,
+            reachProbs,
+            outputExpectedValues,
+            tree,
+            allocator
+        );
+    });
+}
+
+void discountedCfrSubtree(
+    Player hero,
+    const IGameRules& rules,
+    const DiscountParams& params,
+    std::size_t subtreeRootIndex,
+    const PlayerArray<std::span<const float>>& reachProbs,
+    Tree& tree,
+    StackAllocator& allocator,
+    bool usePruning
+) {
+    // Allocator should be empty before starting traversal, otherwise something wasn't deleted correctly
+    assert(allocator.isEmpty());
+
+    // Memory mapped trees only contain the average strategy, so they cannot be trained
+    assert(!tree.isTrainingDataMemoryMapped());
+
+    TraversalConstants constants = {
+        .hero = hero,
+        .params = params,
+        .taskWorkThreshold = getTaskWorkThreshold(tree),
+        .usePruning = usePruning
+    };
+
+    if (params.iteration == 1) {
+        restartSubtreeDiscounting(tree.allNodes[subtreeRootIndex], hero, tree);
+    }
+
+    ScopedVector<float> outputExpectedValues(allocator, getThreadIndex(), tree.rangeSize[hero]);
+    traverseFromNode<TraversalMode::DiscountedCfr>(tree.allNodes[subtreeRootIndex], constants, rules, reachProbs, outputExpectedValues, tree, allocator);
+}
+
+void visitDecisionNodeSolutions(const IGameRules& rules, Tree& tree, StackAllocator& allocator, const DecisionNodeVisitor& visitor) {
+    assert(allocator.isEmpty());
+
+    for (Player hero : { Player::P0, Player::P1 }) {
+        TraversalConstants constants = {
+            .hero = hero,
+            .params = {},
+            .taskWorkThreshold = getTaskWorkThreshold(tree),
+            .visitor = &visitor
+        };
+
+        ScopedVector<float> outputExpectedValues(allocator, getThreadIndex(), tree.rangeSize[hero]);
+        traverseFromRoot<TraversalMode::ExpectedValue>(constants, rules, outputExpectedValues, tree, allocator);
+    }
+}
+
 float expectedValue(
     Player hero,
     const IGameRules& rules,
     Tree& tree,
-    StackAllocator<float>& allocator
+    StackAllocator& allocator
 ) {
     return rootExpectedValue<TraversalMode::ExpectedValue>(hero, rules, tree, allocator);
 }
@@ -1103,14 +2730,26 @@ float bestResponseEV(
     Player hero,
     const IGameRules& rules,
     Tree& tree,
-    StackAllocator<float>& allocator
+    StackAllocator& allocator
 ) {
     return rootExpectedValue<TraversalMode::BestResponse>(hero, rules, tree, allocator);
 }
 
-float calculateExploitability(const IGameRules& rules, Tree& tree, StackAllocator<float>& allocator) {
-    float player0BestResponseEV = bestResponseEV(Player::P0, rules, tree, allocator);
-    float player1BestResponseEV = bestResponseEV(Player::P1, rules, tree, allocator);
+PlayerArray<float> bestResponseEVs(const IGameRules& rules, Tree& tree, StackAllocator& allocator) {
+    PlayerArray<std::span<const float>> reachProbs = { rules.getInitialRangeWeights(Player::P0), rules.getInitialRangeWeights(Player::P1) };
+    PlayerArray<double> weightedExpectedValues = weightedBestResponseEVs(rules, tree.allNodes[tree.getRootNodeIndex()], reachProbs, tree, allocator);
+
+    PlayerArray<float> expectedValues;
+    for (Player player : { Player::P0, Player::P1 }) {
+        expectedValues[player] = static_cast<float>(weightedExpectedValues[player] / tree.totalRangeWeight);
+    }
+    return expectedValues;
+}
+
+float calculateExploitability(const IGameRules& rules, Tree& tree, StackAllocator& allocator) {
+    PlayerArray<float> bestResponseExpectedValues = bestResponseEVs(rules, tree, allocator);
+    float player0BestResponseEV = bestResponseExpectedValues[Player::P0];
+    float player1BestResponseEV = bestResponseExpectedValues[Player::P1];
 
     float player0ExpectedValue = expectedValue(Player::P0, rules, tree, allocator);
     float player1ExpectedValue = expectedValue(Player::P1, rules, tree, allocator);
@@ -1126,36 +2765,167 @@ float calculateExploitability(const IGameRules& rules, Tree& tree, StackAllocato
     return exploitability;
 }
 
-float calculateExploitabilityFast(const IGameRules& rules, Tree& tree, StackAllocator<float>& allocator) {
+float calculateExploitabilityFast(const IGameRules& rules, Tree& tree, StackAllocator& allocator) {
     // Speeds up the exploitability calculation by assuming that EV(Player0) + EV(Player1) = dead money
     // This is true in theory but not always true from the CFR calculated strategies
-    float player0BestResponseEV = bestResponseEV(Player::P0, rules, tree, allocator);
-    float player1BestResponseEV = bestResponseEV(Player::P1, rules, tree, allocator);
-    float exploitability = (player0BestResponseEV + player1BestResponseEV - tree.deadMoney) / 2.0f;
+    PlayerArray<float> bestResponseExpectedValues = bestResponseEVs(rules, tree, allocator);
+    float exploitability = (bestResponseExpectedValues[Player::P0] + bestResponseExpectedValues[Player::P1] - tree.deadMoney) / 2.0f;
     
     // Exploitability is always >= 0, but sometimes our approximation is slightly negative
     return std::max(exploitability, 0.0f);
 }
 
+float calculateSubtreeExploitability(
+    const IGameRules& rules,
+    std::size_t subtreeRootIndex,
+    const PlayerArray<std::span<const float>>& reachProbs,
+    Tree& tree,
+    StackAllocator& allocator
+) {
+    const Node& node = tree.allNodes[subtreeRootIndex];
+    double reachingRangeWeight = getNonOverlappingPairWeight(rules, node.board, reachProbs);
+    if (reachingRangeWeight == 0.0) return 0.0f;
+
+    // Same approximation as calculateExploitabilityFast, every pair of hands that reaches the node shares the dead money
+    PlayerArray<double> weightedExpectedValues = weightedBestResponseEVs(rules, node, reachProbs, tree, allocator);
+    double bestResponseSum = (weightedExpectedValues[Player::P0] + weightedExpectedValues[Player::P1]) / reachingRangeWeight;
+    float exploitability = static_cast<float>((bestResponseSum - static_cast<double>(tree.deadMoney)) / 2.0);
+    return std::max(exploitability, 0.0f);
+}
+
+bool isBothPlayersTraversal(const ChanceNodeTraversal& traversal) {
+    Player villain = getOpposingPlayer(traversal.hero);
+    return ((traversal.mode == TraversalMode::BestResponse) || (traversal.mode == TraversalMode::DiscountedCfr))
+        && !traversal.childExpectedValues[villain].empty();
+}
+
+void traverseChanceNodeChildren(const ChanceNodeTraversal& traversal, const IGameRules& rules, Tree& tree, StackAllocator& allocator) {
+    // Memory mapped trees only contain the average strategy, so they cannot be trained
+    assert(!isCfr(traversal.mode) || !tree.isTrainingDataMemoryMapped());
+
+    const Node& chanceNode = tree.allNodes[traversal.nodeIndex];
+    assert(chanceNode.nodeType == NodeType::Chance);
+
+    TraversalConstants constants = {
+        .hero = traversal.hero,
+        .params = traversal.params,
+        .taskWorkThreshold = getTaskWorkThreshold(tree),
+        .usePruning = traversal.usePruning,
+        .sampling = traversal.sampling
+    };
+
+    dispatchGameRules(rules, tree.gameHandSize, [&](auto gameHandSize, const auto& concreteRules) -> void {
+        static constexpr int GameHandSize = decltype(gameHandSize)::value;
+
+        auto traverseChildren = [&](auto mode) -> void {
+            Player villain = getOpposingPlayer(traversal.hero);
+            traverseChanceChildren<GameHandSize, decltype(mode)::value>(
+                chanceNode,
+                constants,
+                concreteRules,
+                traversal.reachProbs[traversal.hero],
+                traversal.reachProbs[villain],
+                traversal.childExpectedValues[traversal.hero],
+                traversal.childMask,
+                traversal.childWeight,
+                tree,
+                allocator
+            );
+        };
+
+        switch (traversal.mode) {
+            case TraversalMode::VanillaCfr:
+                traverseChildren(std::integral_constant<TraversalMode, TraversalMode::VanillaCfr>{});
+                break;
+            case TraversalMode::CfrPlus:
+                traverseChildren(std::integral_constant<TraversalMode, TraversalMode::CfrPlus>{});
+                break;
+            case TraversalMode::DiscountedCfr:
+                if (!isBothPlayersTraversal(traversal)) {
+                    traverseChildren(std::integral_constant<TraversalMode, TraversalMode::DiscountedCfr>{});
+                    break;
+                }
+
+                traverseBothPlayersChanceChildren<GameHandSize, TraversalMode::DiscountedCfr>(
+                    chanceNode,
+                    constants,
+                    concreteRules,
+                    traversal.reachProbs,
+                    traversal.childExpectedValues,
+                    traversal.childMask,
+                    traversal.childWeight,
+                    tree,
+                    allocator
+                );
+                break;
+            case TraversalMode::ExpectedValue:
+                traverseChildren(std::integral_constant<TraversalMode, TraversalMode::ExpectedValue>{});
+                break;
+            case TraversalMode::BestResponse:
+                if (!isBothPlayersTraversal(traversal)) {
+                    traverseChildren(std::integral_constant<TraversalMode, TraversalMode::BestResponse>{});
+                    break;
+                }
+
+                traverseBothPlayersChanceChildren<GameHandSize, TraversalMode::BestResponse>(
+                    chanceNode,
+                    constants,
+                    concreteRules,
+                    traversal.reachProbs,
+                    traversal.childExpectedValues,
+                    traversal.childMask,
+                    traversal.childWeight,
+                    tree,
+                    allocator
+                );
+                break;
+            default:
+                assert(false);
+                break;
+        }
+    });
+}
+
 // TODO: This is basically the same as writeAverageStrategyToBuffer
-FixedVector<float, MaxNumActions> getFinalStrategy(int hand, const Node& decisionNode, const Tree& tree) {
+FixedVector<float, MaxNumActions> getFinalStrategy(const IGameRules& rules, int hand, const Node& decisionNode, const Tree& tree) {
     assert(decisionNode.nodeType == NodeType::Decision);
 
-    int playerToActRangeSize = tree.rangeSize[decisionNode.state.playerToAct];
     int numActions = static_cast<int>(decisionNode.numChildren);
     assert(numActions > 0);
 
-    const auto strategySums = tree.allStrategySums.begin() + decisionNode.trainingDataOffset;
+    // Hands blocked by the board have no training data, so they play a uniform strategy
+    std::span<const HandInfo> trainingHands = getTrainingHands(decisionNode, rules);
+    auto trainingHandIt = std::lower_bound(trainingHands.begin(), trainingHands.end(), hand, [](HandInfo handInfo, int handIndex) {
+        return handInfo.index < handIndex;
+    });
+    if (trainingHandIt == trainingHands.end() || trainingHandIt->index != hand) {
+        return FixedVector<float, MaxNumActions>(numActions, 1.0f / static_cast<float>(numActions));
+    }
+
+    int numTrainingHands = static_cast<int>(trainingHands.size());
+    int trainingHand = static_cast<int>(trainingHandIt - trainingHands.begin());
+
+    FixedVector<float, MaxNumActions> handStrategySums(numActions);
+    for (int action = 0; action < numActions; ++action) {
+        std::size_t trainingDataIndex = decisionNode.trainingDataOffset + action * numTrainingHands + trainingHand;
+        if (tree.isTrainingDataCompressed()) {
+            float scale = tree.getStrategySumScales()[decisionNode.decisionNodeIndex];
+            handStrategySums[action] = static_cast<float>(tree.getCompressedStrategySums()[trainingDataIndex]) * scale;
+        }
+        else {
+            handStrategySums[action] = tree.getStrategySums()[trainingDataIndex];
+        }
+    }
 
     float total = 0.0f;
     for (int action = 0; action < numActions; ++action) {
-        total += strategySums[action * playerToActRangeSize + hand];
+        total += handStrategySums[action];
     }
 
     if (total > 0.0f) {
         FixedVector<float, MaxNumActions> finalStrategy(numActions);
         for (int action = 0; action < numActions; ++action) {
-            finalStrategy[action] = strategySums[action * playerToActRangeSize + hand] / total;
+            finalStrategy[action] = handStrategySums[action] / total;
         }
         return finalStrategy;
     }
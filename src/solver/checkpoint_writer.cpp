@@ -0,0 +1,75 @@
+#include "solver/checkpoint_writer.hpp"
+
+#include "game/game_rules.hpp"
+#include "solver/tree.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <filesystem>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define POSTFLOP_SOLVER_HAS_FORK
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+CheckpointWriter::CheckpointWriter(const IGameRules& rules, const std::filesystem::path& path) :
+    m_rules{ rules },
+    m_path{ path },
+    m_writerProcess{ -1 },
+    m_lastWriteSucceeded{ true } {
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    wait();
+}
+
+bool CheckpointWriter::writeAsync(const Tree& tree) {
+    assert(tree.isTreeSkeletonBuilt() && tree.areCfrVectorsInitialized());
+    assert(!tree.isTrainingDataMemoryMapped());
+
+    bool previousWriteSucceeded = wait();
+
+    #ifdef POSTFLOP_SOLVER_HAS_FORK
+    if (!tree.isTrainingDataFileBacked()) {
+        pid_t process = ::fork();
+        if (process == 0) {
+            // Only the forking thread exists in the child, and it must not run the parent's exit handlers or flush its buffers
+            bool success = tree.saveToFile(m_rules, m_path);
+            ::_exit(success ? 0 : 1);
+        }
+        if (process > 0) {
+            m_writerProcess = process;
+            return previousWriteSucceeded;
+        }
+        // Forking can fail when memory is overcommitted, in which case the checkpoint is written directly
+    }
+    #endif
+
+    m_lastWriteSucceeded = tree.saveToFile(m_rules, m_path);
+    return previousWriteSucceeded;
+}
+
+bool CheckpointWriter::wait() {
+    #ifdef POSTFLOP_SOLVER_HAS_FORK
+    if (m_writerProcess != -1) {
+        int status = 0;
+        pid_t result;
+        do {
+            result = ::waitpid(m_writerProcess, &status, 0);
+        } while (result == -1 && errno == EINTR);
+
+        m_lastWriteSucceeded = (result == m_writerProcess) && WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+        m_writerProcess = -1;
+    }
+    #endif
+
+    bool success = m_lastWriteSucceeded;
+    m_lastWriteSucceeded = true;
+    return success;
+}
+
+bool CheckpointWriter::isWriting() const {
+    return m_writerProcess != -1;
+}
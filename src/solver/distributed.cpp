@@ -0,0 +1,472 @@
+#include "solver/distributed.hpp"
+
+#include "game/game_rules.hpp"
+#include "game/game_types.hpp"
+#include "game/game_utils.hpp"
+#include "solver/cfr.hpp"
+#include "solver/tree.hpp"
+#include "util/binary_io.hpp"
+#include "util/result.hpp"
+#include "util/stack_allocator.hpp"
+#include "util/tcp_socket.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+static constexpr std::uint64_t ProtocolMagic = 0x5453494450464C50ULL; // "PLFPDIST"
+static constexpr std::uint32_t ProtocolVersion = 4;
+
+enum class MessageType : std::uint32_t {
+    Traverse,
+    EndSession,
+    Shutdown
+};
+
+enum class ResponseStatus : std::uint32_t {
+    Ok,
+    DifferentTree,
+    InvalidRequest
+};
+
+struct HandshakeRequest {
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t workerIndex;
+    std::uint32_t numWorkers;
+    std::uint64_t treeFingerprint;
+};
+
+struct TraverseRequest {
+    TraversalMode mode;
+    Player hero;
+    bool usePruning;
+    bool hasHeroReachProbs;
+    bool bothPlayers;
+    DiscountParams params;
+    ChanceSampling sampling;
+    float childWeight;
+    std::uint32_t nodeIndex;
+    std::uint64_t childMask;
+};
+
+// Hash of everything that the expected values of a subtree depend on, so that a worker with a different tree or ranges is rejected
+std::uint64_t getTreeFingerprint(const IGameRules& rules, const Tree& tree) {
+    Fnv1aHasher hasher;
+
+    hasher.add(ProtocolVersion);
+    hasher.add(tree.gameHandSize);
+    hasher.add(tree.deadMoney);
+    hasher.add(tree.isTrainingDataCompressed());
+    hasher.add<std::uint64_t>(tree.getNumberOfDecisionNodes());
+    hasher.add<std::uint64_t>(tree.getNumberOfSubtrees());
+
+    for (Player player : { Player::P0, Player::P1 }) {
+        hasher.addArray(rules.getRangeHands(player));
+        hasher.addArray(rules.getInitialRangeWeights(player));
+    }
+
+    // Nodes have padding, so their fields are hashed one at a time
+    hasher.add<std::uint64_t>(tree.allNodes.size());
+    for (const Node& node : tree.allNodes) {
+        hasher.add(node.board);
+        hasher.add(node.trainingDataOffset);
+        hasher.add(node.childrenOffset);
+        hasher.add(node.losingPlayerWager);
+        hasher.add(node.numChildren);
+        hasher.add(node.nodeType);
+        hasher.add(node.playerToAct);
+        hasher.add(node.lastDealtCard);
+    }
+
+    return hasher.getHash();
+}
+
+// Children of a chance node whose subtrees belong to a worker, out of the children in the mask
+std::uint64_t getWorkerChildMask(const Node& chanceNode, std::uint64_t childMask, int workerIndex, int numWorkers, const Tree& tree) {
+    std::uint64_t workerChildMask = 0;
+    for (int child = 0; child < chanceNode.numChildren; ++child) {
+        if (((childMask >> child) & 1) == 0) continue;
+
+        std::optional<std::size_t> subtreeIndex = tree.getSubtreeIndex(chanceNode.childrenOffset + child);
+        assert(subtreeIndex);
+        if (isSubtreeOwnedByWorker(*subtreeIndex, workerIndex, numWorkers)) {
+            workerChildMask |= std::uint64_t{ 1 } << child;
+        }
+    }
+    return workerChildMask;
+}
+
+// Players whose expected values are sent back, the hero first
+std::vector<Player> getResponsePlayers(Player hero, bool bothPlayers) {
+    if (bothPlayers) {
+        return { hero, getOpposingPlayer(hero) };
+    }
+    return { hero };
+}
+
+// Calls function(childExpectedValues) on the slice of each child in the mask, in the order they are sent over the network
+template <typename Function>
+void forEachChildSlice(
+    const Node& chanceNode,
+    std::uint64_t childMask,
+    const std::vector<Player>& players,
+    const PlayerArray<std::span<float>>& childExpectedValues,
+    const Tree& tree,
+    Function function
+) {
+    for (Player player : players) {
+        std::size_t rangeSize = static_cast<std::size_t>(tree.rangeSize[player]);
+        for (int child = 0; child < chanceNode.numChildren; ++child) {
+            if ((childMask >> child) & 1) {
+                function(childExpectedValues[player].subspan(child * rangeSize, rangeSize));
+            }
+        }
+    }
+}
+
+bool isChanceNodeBeforeSubtrees(std::uint32_t nodeIndex, const Tree& tree) {
+    if (nodeIndex >= tree.allNodes.size()) return false;
+
+    const Node& node = tree.allNodes[nodeIndex];
+    return (node.nodeType == NodeType::Chance) && (node.numChildren < 64) && tree.getSubtreeIndex(node.childrenOffset).has_value();
+}
+
+bool isValidRequest(const TraverseRequest& request, const Tree& tree) {
+    if (static_cast<std::uint8_t>(request.mode) > static_cast<std::uint8_t>(TraversalMode::BestResponse)) return false;
+    if ((request.hero != Player::P0) && (request.hero != Player::P1)) return false;
+    if (request.bothPlayers && (request.mode != TraversalMode::BestResponse) && (request.mode != TraversalMode::DiscountedCfr)) return false;
+    return isChanceNodeBeforeSubtrees(request.nodeIndex, tree);
+}
+
+// Handles requests until the coordinator ends the session, must be called by one thread of the worker's parallel region
+Result<WorkerSessionEnd> serveRequests(
+    const IGameRules& rules,
+    Tree& tree,
+    int workerIndex,
+    int numWorkers,
+    TcpConnection& connection,
+    StackAllocator& allocator
+) {
+    PlayerArray<std::vector<float>> reachProbs = {
+        std::vector<float>(tree.rangeSize[Player::P0]),
+        std::vector<float>(tree.rangeSize[Player::P1])
+    };
+    PlayerArray<std::vector<float>> childExpectedValues;
+
+    while (true) {
+        MessageType messageType;
+        if (!connection.receive(messageType)) {
+            return "Error: Lost connection to the coordinator.";
+        }
+
+        switch (messageType) {
+            case MessageType::EndSession:
+                return WorkerSessionEnd::Finished;
+            case MessageType::Shutdown:
+                return WorkerSessionEnd::Shutdown;
+            case MessageType::Traverse:
+                break;
+            default:
+                return "Error: Received an invalid message from the coordinator.";
+        }
+
+        TraverseRequest request;
+        if (!connection.receive(request)) {
+            return "Error: Lost connection to the coordinator.";
+        }
+        if (!isValidRequest(request, tree)) {
+            connection.send(ResponseStatus::InvalidRequest);
+            return "Error: Received an invalid traversal from the coordinator.";
+        }
+
+        Player villain = getOpposingPlayer(request.hero);
+        bool receivedReachProbs = connection.receiveBytes(std::as_writable_bytes(std::span<float>{ reachProbs[villain] }));
+        if (request.hasHeroReachProbs) {
+            receivedReachProbs = receivedReachProbs && connection.receiveBytes(std::as_writable_bytes(std::span<float>{ reachProbs[request.hero] }));
+        }
+        if (!receivedReachProbs) {
+            return "Error: Lost connection to the coordinator.";
+        }
+
+        const Node& chanceNode = tree.allNodes[request.nodeIndex];
+        std::uint64_t childMask = getWorkerChildMask(chanceNode, request.childMask, workerIndex, numWorkers, tree);
+        std::vector<Player> players = getResponsePlayers(request.hero, request.bothPlayers);
+
+        ChanceNodeTraversal traversal = {
+            .mode = request.mode,
+            .hero = request.hero,
+            .params = request.params,
+            .usePruning = request.usePruning,
+            .sampling = request.sampling,
+            .childWeight = request.childWeight,
+            .nodeIndex = request.nodeIndex,
+            .childMask = childMask
+        };
+        traversal.reachProbs[villain] = reachProbs[villain];
+        if (request.hasHeroReachProbs) {
+            traversal.reachProbs[request.hero] = reachProbs[request.hero];
+        }
+        for (Player player : players) {
+            childExpectedValues[player].resize(chanceNode.numChildren * tree.rangeSize[player]);
+            traversal.childExpectedValues[player] = childExpectedValues[player];
+        }
+
+        traverseChanceNodeChildren(traversal, rules, tree, allocator);
+
+        bool sentExpectedValues = connection.send(ResponseStatus::Ok);
+        forEachChildSlice(chanceNode, childMask, players, traversal.childExpectedValues, tree, [&](std::span<float> values) {
+            sentExpectedValues = sentExpectedValues && connection.sendBytes(std::as_bytes(values));
+        });
+        if (!sentExpectedValues) {
+            return "Error: Lost connection to the coordinator.";
+        }
+    }
+}
+} // namespace
+
+bool isSubtreeOwnedByWorker(std::size_t subtreeIndex, int workerIndex, int numWorkers) {
+    assert((numWorkers > 0) && (workerIndex >= 0) && (workerIndex < numWorkers));
+    return subtreeIndex % static_cast<std::size_t>(numWorkers) == static_cast<std::size_t>(workerIndex);
+}
+
+Result<std::unique_ptr<DistributedCoordinator>> DistributedCoordinator::connect(
+    const std::vector<std::string>& addresses,
+    const IGameRules& rules,
+    Tree& tree,
+    int numThreads
+) {
+    assert(tree.isTreeSkeletonBuilt());
+
+    if (addresses.empty()) {
+        return "Error: No distributed workers given.";
+    }
+
+    std::vector<Worker> workers;
+    for (const std::string& address : addresses) {
+        Result<TcpConnection> connectionResult = TcpConnection::connect(address);
+        if (connectionResult.isError()) {
+            return connectionResult.getError();
+        }
+        workers.push_back({ .address = address, .connection = std::move(connectionResult.getValue()) });
+    }
+
+    // Send every handshake before waiting for any response, so that the workers allocate their training data at the same time
+    std::uint64_t treeFingerprint = getTreeFingerprint(rules, tree);
+    for (std::size_t i = 0; i < workers.size(); ++i) {
+        HandshakeRequest handshake = {
+            .magic = ProtocolMagic,
+            .version = ProtocolVersion,
+            .workerIndex = static_cast<std::uint32_t>(i),
+            .numWorkers = static_cast<std::uint32_t>(workers.size()),
+            .treeFingerprint = treeFingerprint
+        };
+        if (!workers[i].connection.send(handshake)) {
+            return "Error: Lost connection to worker " + workers[i].address + ".";
+        }
+    }
+
+    for (Worker& worker : workers) {
+        ResponseStatus status;
+        if (!worker.connection.receive(status)) {
+            return "Error: Lost connection to worker " + worker.address + ".";
+        }
+        if (status == ResponseStatus::DifferentTree) {
+            return "Error: Worker " + worker.address + " built a different tree. Workers must use the same settings as the coordinator.";
+        }
+        if (status != ResponseStatus::Ok) {
+            return "Error: Worker " + worker.address + " rejected the connection.";
+        }
+    }
+
+    // All subtrees are trained by the workers
+    tree.initCfrVectors(numThreads, [](std::size_t) { return false; });
+
+    return std::unique_ptr<DistributedCoordinator>{ new DistributedCoordinator{ std::move(workers), tree } };
+}
+
+DistributedCoordinator::DistributedCoordinator(std::vector<Worker> workers, Tree& tree) :
+    m_workers{ std::move(workers) },
+    m_tree{ tree } {
+}
+
+DistributedCoordinator::~DistributedCoordinator() {
+    if (m_tree.getDistributedCoordinator() == this) {
+        stop();
+    }
+    endSessions(false);
+}
+
+void DistributedCoordinator::start() {
+    assert(!m_tree.getDistributedCoordinator());
+    m_tree.setDistributedCoordinator(this);
+}
+
+void DistributedCoordinator::stop() {
+    assert(m_tree.getDistributedCoordinator() == this);
+    m_tree.setDistributedCoordinator(nullptr);
+}
+
+void DistributedCoordinator::traverseChanceNode(const ChanceNodeTraversal& traversal) {
+    std::lock_guard<std::mutex> lock{ m_mutex };
+
+    [[maybe_unused]] const Node& chanceNode = m_tree.allNodes[traversal.nodeIndex];
+    assert(chanceNode.nodeType == NodeType::Chance);
+    assert(traversal.childMask < (std::uint64_t{ 1 } << chanceNode.numChildren));
+
+    if (m_error) {
+        fail(m_workers.front(), traversal);
+        return;
+    }
+
+    // Send every request before receiving any response, so that the workers traverse their subtrees at the same time
+    bool hasHeroReachProbs = !traversal.reachProbs[traversal.hero].empty();
+    for (Worker& worker : m_workers) {
+        if (!sendTraversal(worker, traversal, hasHeroReachProbs)) {
+            fail(worker, traversal);
+            return;
+        }
+    }
+
+    for (int workerIndex = 0; workerIndex < getNumWorkers(); ++workerIndex) {
+        if (!receiveChildExpectedValues(m_workers[workerIndex], workerIndex, traversal)) {
+            fail(m_workers[workerIndex], traversal);
+            return;
+        }
+    }
+}
+
+bool DistributedCoordinator::sendTraversal(Worker& worker, const ChanceNodeTraversal& traversal, bool hasHeroReachProbs) {
+    // Value initialized so that the padding bytes sent over the network are zero
+    TraverseRequest request{};
+    request.mode = traversal.mode;
+    request.hero = traversal.hero;
+    request.usePruning = traversal.usePruning;
+    request.hasHeroReachProbs = hasHeroReachProbs;
+    request.bothPlayers = isBothPlayersTraversal(traversal);
+    request.params = traversal.params;
+    request.sampling = traversal.sampling;
+    request.childWeight = traversal.childWeight;
+    request.nodeIndex = traversal.nodeIndex;
+    request.childMask = traversal.childMask;
+
+    Player villain = getOpposingPlayer(traversal.hero);
+    bool sent = worker.connection.send(MessageType::Traverse)
+        && worker.connection.send(request)
+        && worker.connection.sendBytes(std::as_bytes(traversal.reachProbs[villain]));
+    if (hasHeroReachProbs) {
+        sent = sent && worker.connection.sendBytes(std::as_bytes(traversal.reachProbs[traversal.hero]));
+    }
+    return sent;
+}
+
+bool DistributedCoordinator::receiveChildExpectedValues(Worker& worker, int workerIndex, const ChanceNodeTraversal& traversal) {
+    ResponseStatus status;
+    if (!worker.connection.receive(status) || (status != ResponseStatus::Ok)) {
+        return false;
+    }
+
+    const Node& chanceNode = m_tree.allNodes[traversal.nodeIndex];
+    std::uint64_t workerChildMask = getWorkerChildMask(chanceNode, traversal.childMask, workerIndex, getNumWorkers(), m_tree);
+    std::vector<Player> players = getResponsePlayers(traversal.hero, isBothPlayersTraversal(traversal));
+
+    // The expected values are received straight into the slices of the children
+    bool received = true;
+    forEachChildSlice(chanceNode, workerChildMask, players, traversal.childExpectedValues, m_tree, [&](std::span<float> values) {
+        received = received && worker.connection.receiveBytes(std::as_writable_bytes(values));
+    });
+    return received;
+}
+
+void DistributedCoordinator::fail(const Worker& worker, const ChanceNodeTraversal& traversal) {
+    if (!m_error) {
+        m_error = "Error: Lost connection to worker " + worker.address + ".";
+
+        // The other workers may be in the middle of a request, so their connections cannot be reused either
+        for (Worker& otherWorker : m_workers) {
+            otherWorker.connection.close();
+        }
+    }
+
+    const Node& chanceNode = m_tree.allNodes[traversal.nodeIndex];
+    std::vector<Player> players = getResponsePlayers(traversal.hero, isBothPlayersTraversal(traversal));
+    forEachChildSlice(chanceNode, traversal.childMask, players, traversal.childExpectedValues, m_tree, [](std::span<float> values) {
+        std::fill(values.begin(), values.end(), 0.0f);
+    });
+}
+
+std::optional<std::string> DistributedCoordinator::getError() const {
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    return m_error;
+}
+
+void DistributedCoordinator::shutdownWorkers() {
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    endSessions(true);
+}
+
+void DistributedCoordinator::endSessions(bool shutdown) {
+    for (Worker& worker : m_workers) {
+        if (worker.connection.isOpen()) {
+            worker.connection.send(shutdown ? MessageType::Shutdown : MessageType::EndSession);
+            worker.connection.close();
+        }
+    }
+}
+
+int DistributedCoordinator::getNumWorkers() const {
+    return static_cast<int>(m_workers.size());
+}
+
+Result<WorkerSessionEnd> serveCoordinator(const IGameRules& rules, Tree& tree, int numThreads, TcpConnection& connection) {
+    assert(tree.isTreeSkeletonBuilt());
+
+    HandshakeRequest handshake;
+    if (!connection.receive(handshake)) {
+        return "Error: Lost connection to the coordinator.";
+    }
+    if ((handshake.magic != ProtocolMagic) || (handshake.version != ProtocolVersion)) {
+        return "Error: The coordinator uses a different protocol version.";
+    }
+    if ((handshake.numWorkers == 0) || (handshake.workerIndex >= handshake.numWorkers)) {
+        connection.send(ResponseStatus::InvalidRequest);
+        return "Error: Received an invalid handshake from the coordinator.";
+    }
+    if (handshake.treeFingerprint != getTreeFingerprint(rules, tree)) {
+        connection.send(ResponseStatus::DifferentTree);
+        return "Error: The coordinator built a different tree. Workers must use the same settings as the coordinator.";
+    }
+
+    int workerIndex = static_cast<int>(handshake.workerIndex);
+    int numWorkers = static_cast<int>(handshake.numWorkers);
+    tree.initCfrVectors(numThreads, [workerIndex, numWorkers](std::size_t subtreeIndex) {
+        return isSubtreeOwnedByWorker(subtreeIndex, workerIndex, numWorkers);
+    });
+
+    if (!connection.send(ResponseStatus::Ok)) {
+        return "Error: Lost connection to the coordinator.";
+    }
+
+    StackAllocator allocator(numThreads, tree.estimateStackAllocatorSize());
+    std::optional<Result<WorkerSessionEnd>> result;
+
+    // One thread handles the requests, and the traversals spawn tasks for the rest of the threads
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(numThreads)
+    #pragma omp single
+    #endif
+    {
+        result.emplace(serveRequests(rules, tree, workerIndex, numWorkers, connection, allocator));
+    }
+
+    return *result;
+}
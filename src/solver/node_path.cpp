@@ -0,0 +1,307 @@
+#include "solver/node_path.hpp"
+
+#include "game/game_rules.hpp"
+#include "game/game_types.hpp"
+#include "game/game_utils.hpp"
+#include "solver/cfr.hpp"
+#include "solver/tree.hpp"
+#include "util/fixed_vector.hpp"
+#include "util/result.hpp"
+#include "util/string_utils.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+std::vector<NodeInfo> getRootNodePath(const Tree& tree) {
+    return { { tree.getRootNodeIndex(), std::nullopt } };
+}
+
+Result<NodeInfo> getActionChild(const Tree& tree, const std::vector<NodeInfo>& nodePath, int action) {
+    assert(!nodePath.empty());
+    const Node& node = tree.allNodes[nodePath.back().index];
+    if (node.nodeType != NodeType::Decision) {
+        return "Error: Current node is not a decision node.";
+    }
+
+    if (action < 0 || action >= node.numChildren) {
+        return "Error: Action id is out of range.";
+    }
+
+    return NodeInfo{ node.childrenOffset + action, std::nullopt };
+}
+
+Result<NodeInfo> getDealtChild(const Tree& tree, const std::vector<NodeInfo>& nodePath, CardID card) {
+    assert(!nodePath.empty());
+    const Node& node = tree.allNodes[nodePath.back().index];
+    if (node.nodeType != NodeType::Chance) {
+        return "Error: Current node is not a chance node.";
+    }
+
+    // Apply swap list from previous nodes
+    // There can only be one, since at most the turn could have happened before this
+    CardID dealCard = card;
+    for (const auto& [index, swapList] : nodePath) {
+        if (swapList) {
+            dealCard = swapCardSuits(dealCard, swapList->child, swapList->parent);
+            break;
+        }
+    }
+
+    // Available cards are stored in the suits of the tree, so the card is checked after the earlier swap has been applied
+    const ChanceNodeDetails& chanceNodeDetails = tree.allChanceNodeDetails[node.chanceNodeIndex];
+    if (!setContainsCard(chanceNodeDetails.availableCards, dealCard)) {
+        return "Error: Card is not available to be dealt.";
+    }
+
+    // Because of isomorphism, the card might not actually exist in the tree
+    std::optional<SuitMapping> swapList;
+    for (SuitMapping mapping : chanceNodeDetails.suitMappings) {
+        if (getCardSuit(dealCard) == mapping.child) {
+            swapList = mapping;
+            break;
+        }
+    }
+
+    CardID isomorphicDealCard = swapList ? getCardIDFromValueAndSuit(getCardValue(dealCard), swapList->parent) : dealCard;
+
+    for (int cardIndex = 0; cardIndex < node.numChildren; ++cardIndex) {
+        CardID childCard = tree.allNodes[node.childrenOffset + cardIndex].lastDealtCard;
+        assert(childCard != InvalidCard);
+
+        if (childCard == isomorphicDealCard) {
+            return NodeInfo{ node.childrenOffset + cardIndex, swapList };
+        }
+    }
+
+    assert(false);
+    return "Error: Card is not available to be dealt.";
+}
+
+Result<std::vector<NodeInfo>> resolveNodePath(const Tree& tree, std::span<const std::string> steps) {
+    std::vector<NodeInfo> nodePath = getRootNodePath(tree);
+
+    for (const std::string& step : steps) {
+        const Node& node = tree.allNodes[nodePath.back().index];
+
+        std::optional<Result<NodeInfo>> child;
+        switch (node.nodeType) {
+            case NodeType::Decision: {
+                std::optional<int> action = parseInt(step);
+                if (!action) {
+                    return "Error: Expected an action id at a decision node, got \"" + step + "\".";
+                }
+                child = getActionChild(tree, nodePath, *action);
+                break;
+            }
+
+            case NodeType::Chance: {
+                Result<CardID> cardResult = getCardIDFromName(step);
+                if (cardResult.isError()) {
+                    return cardResult.getError();
+                }
+                child = getDealtChild(tree, nodePath, cardResult.getValue());
+                break;
+            }
+
+            case NodeType::Fold:
+            case NodeType::Showdown:
+            case NodeType::AllInRunout:
+                return "Error: The path continues past the end of the hand at \"" + step + "\".";
+
+            default:
+                assert(false);
+                return "Error: Invalid node.";
+        }
+
+        if (child->isError()) {
+            return child->getError();
+        }
+        nodePath.push_back(child->getValue());
+    }
+
+    return nodePath;
+}
+
+std::vector<CardID> getNodePathBoard(const IGameRules& rules, const Tree& tree, const std::vector<NodeInfo>& nodePath) {
+    // First get the cards from the starting board
+    std::vector<CardID> board;
+    CardSet startingBoard = rules.getInitialGameState().currentBoard;
+    while (startingBoard != 0) {
+        board.push_back(popLowestCardFromSet(startingBoard));
+    }
+
+    // Descending order, the same as getCardSetNames
+    std::reverse(board.begin(), board.end());
+
+    // Then get turn/river cards, applying suit swap lists if needed
+    CardID lastChanceCard = InvalidCard;
+    std::optional<SuitMapping> lastSwapList;
+    for (const auto& [index, swapList] : nodePath) {
+        const Node& currentNode = tree.allNodes[index];
+        CardID lastDealtCard = currentNode.lastDealtCard;
+        if (lastDealtCard != lastChanceCard) {
+            // We've reached a new chance card, add it to the board after applying swap lists
+            // To go from tree suits to user suits, we need to apply the swaps in reverse order
+            // There can be at most 2 swap lists, one for turn and one for river
+            CardID cardToAdd = lastDealtCard;
+            if (swapList) {
+                cardToAdd = swapCardSuits(cardToAdd, swapList->child, swapList->parent);
+            }
+            if (lastSwapList) {
+                cardToAdd = swapCardSuits(cardToAdd, lastSwapList->child, lastSwapList->parent);
+            }
+            board.push_back(cardToAdd);
+
+            lastChanceCard = lastDealtCard;
+            lastSwapList = swapList;
+        }
+    }
+
+    return board;
+}
+
+std::string getActionName(const IGameRules& rules, const Tree& tree, std::size_t decisionNodeIndex, int action) {
+    assert(tree.allNodes[decisionNodeIndex].nodeType == NodeType::Decision);
+    std::size_t nextNodeIndex = tree.allNodes[decisionNodeIndex].childrenOffset + action;
+    GameState state = tree.getNodeState(decisionNodeIndex);
+    GameState nextState = tree.getNodeState(nextNodeIndex);
+
+    int lastBetTotal = std::max(nextState.totalWagers[Player::P0], nextState.totalWagers[Player::P1]);
+    int betOrRaiseSize = lastBetTotal - state.previousStreetsWager;
+
+    return rules.getActionName(nextState.lastAction, betOrRaiseSize);
+}
+
+namespace {
+std::vector<int> getStartingHandIndices(const IGameRules& rules, const Tree& tree, Player player) {
+    CardSet startingBoard = rules.getInitialGameState().currentBoard;
+    const auto rangeHands = rules.getRangeHands(player);
+    int rangeSize = tree.rangeSize[player];
+
+    std::vector<int> handIndices(rangeSize, -1);
+    for (int hand = 0; hand < rangeSize; ++hand) {
+        if (!doSetsOverlap(rangeHands[hand], startingBoard)) {
+            handIndices[hand] = hand;
+        }
+    }
+    return handIndices;
+}
+
+// Maps every hand through the suit swap of a chance card at once, then drops the hands that hold the card
+void applyDealtCard(const IGameRules& rules, const Tree& tree, const NodeInfo& dealtChild, Player player, std::vector<int>& handIndices) {
+    const auto rangeHands = rules.getRangeHands(player);
+    CardID dealtCard = tree.allNodes[dealtChild.index].lastDealtCard;
+
+    for (int& handIndex : handIndices) {
+        if (handIndex == -1) continue;
+
+        if (dealtChild.swapList) {
+            const auto& isomorphicHandIndices = tree.isomorphicHandIndices[player][mapTwoSuitsToIndex(dealtChild.swapList->parent, dealtChild.swapList->child)];
+            assert(isomorphicHandIndices.size() == tree.rangeSize[player]);
+            handIndex = isomorphicHandIndices[handIndex];
+        }
+
+        if (setContainsCard(rangeHands[handIndex], dealtCard)) {
+            handIndex = -1;
+        }
+    }
+}
+} // namespace
+
+std::vector<int> getNodePathHandIndices(const IGameRules& rules, const Tree& tree, const std::vector<NodeInfo>& nodePath, Player player) {
+    assert(!nodePath.empty());
+
+    std::vector<int> handIndices = getStartingHandIndices(rules, tree, player);
+    for (std::size_t i = 1; i < nodePath.size(); ++i) {
+        if (tree.allNodes[nodePath[i - 1].index].nodeType == NodeType::Chance) {
+            applyDealtCard(rules, tree, nodePath[i], player, handIndices);
+        }
+    }
+    return handIndices;
+}
+
+NodePathRange getNodePathRange(const IGameRules& rules, const Tree& tree, const std::vector<NodeInfo>& nodePath, Player player) {
+    assert(!nodePath.empty());
+
+    std::vector<int> handIndices = getStartingHandIndices(rules, tree, player);
+    const auto initialRangeWeights = rules.getInitialRangeWeights(player);
+    std::vector<double> reachWeights(handIndices.size(), 0.0);
+    for (std::size_t hand = 0; hand < handIndices.size(); ++hand) {
+        if (handIndices[hand] != -1) {
+            reachWeights[hand] = static_cast<double>(initialRangeWeights[hand]);
+        }
+    }
+
+    for (std::size_t i = 1; i < nodePath.size(); ++i) {
+        const Node& previousNode = tree.allNodes[nodePath[i - 1].index];
+        switch (previousNode.nodeType) {
+            case NodeType::Chance:
+                applyDealtCard(rules, tree, nodePath[i], player, handIndices);
+                break;
+
+            case NodeType::Decision: {
+                assert(!nodePath[i].swapList);
+                if (previousNode.playerToAct != player) break;
+
+                int actionIndexTaken = static_cast<int>(nodePath[i].index - previousNode.childrenOffset);
+                assert((actionIndexTaken >= 0) && (actionIndexTaken < previousNode.numChildren));
+                for (std::size_t hand = 0; hand < handIndices.size(); ++hand) {
+                    if (handIndices[hand] == -1) continue;
+                    FixedVector<float, MaxNumActions> finalStrategy = getFinalStrategy(rules, handIndices[hand], previousNode, tree);
+                    reachWeights[hand] *= static_cast<double>(finalStrategy[actionIndexTaken]);
+                }
+                break;
+            }
+
+            case NodeType::Fold:
+            case NodeType::Showdown:
+            case NodeType::AllInRunout:
+            default:
+                assert(false);
+                break;
+        }
+    }
+
+    NodePathRange range;
+    range.reachWeights.resize(handIndices.size(), 0.0f);
+    for (std::size_t hand = 0; hand < handIndices.size(); ++hand) {
+        if (handIndices[hand] != -1) {
+            range.reachWeights[hand] = static_cast<float>(reachWeights[hand]);
+        }
+    }
+    range.handIndices = std::move(handIndices);
+    return range;
+}
+
+NodePathRangeStrategy getNodePathRangeStrategy(const IGameRules& rules, const Tree& tree, const std::vector<NodeInfo>& nodePath) {
+    assert(!nodePath.empty());
+    const Node& node = tree.allNodes[nodePath.back().index];
+    assert(node.nodeType == NodeType::Decision);
+
+    NodePathRangeStrategy rangeStrategy = {
+        .player = node.playerToAct,
+        .numActions = node.numChildren,
+        .range = getNodePathRange(rules, tree, nodePath, node.playerToAct),
+        .strategy = {}
+    };
+
+    std::size_t rangeSize = rangeStrategy.range.handIndices.size();
+    rangeStrategy.strategy.assign(static_cast<std::size_t>(node.numChildren) * rangeSize, 0.0f);
+    for (std::size_t hand = 0; hand < rangeSize; ++hand) {
+        int handIndex = rangeStrategy.range.handIndices[hand];
+        if (handIndex == -1) continue;
+
+        FixedVector<float, MaxNumActions> finalStrategy = getFinalStrategy(rules, handIndex, node, tree);
+        for (int action = 0; action < node.numChildren; ++action) {
+            rangeStrategy.strategy[action * rangeSize + hand] = finalStrategy[action];
+        }
+    }
+
+    return rangeStrategy;
+}
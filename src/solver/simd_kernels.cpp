@@ -0,0 +1,637 @@
+#include "solver/simd_kernels.hpp"
+
+#include "game/game_types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <utility>
+
+// This file is compiled without floating point contraction, so a * b + c is never fused into a single instruction
+// This keeps every implementation below bitwise identical to the scalar one
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_KERNELS_X86
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define SIMD_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+using NormalizeActionsKernel = void (*)(float* strategy, const float* sums, float uniformProbability, std::size_t actionStride, std::size_t size);
+using AccumulateActionsKernel = void (*)(float* output, const float* values, const float* weights, std::size_t actionStride, std::size_t size);
+using UpdateActionsKernel = void (*)(
+    float* regretSums,
+    float* strategySums,
+    const float* actionExpectedValues,
+    const float* strategyExpectedValues,
+    const float* reachProbs,
+    const float* currentStrategy,
+    float alphaT,
+    float betaT,
+    float gammaT,
+    std::size_t actionStride,
+    std::size_t size
+);
+
+// Indexed by the number of actions, index 0 is unused since every decision node has at least one action
+template <typename Kernel>
+using ActionKernels = std::array<Kernel, MaxNumActions + 1>;
+
+template <typename Kernel, typename MakeKernel, std::size_t... ActionIndices>
+constexpr ActionKernels<Kernel> makeActionKernels(MakeKernel makeKernel, std::index_sequence<ActionIndices...>) {
+    return { nullptr, makeKernel.template operator()<static_cast<int>(ActionIndices) + 1>()... };
+}
+
+// makeKernel.template operator()<NumActions>() returns the kernel instantiated for NumActions actions
+template <typename Kernel, typename MakeKernel>
+constexpr ActionKernels<Kernel> makeActionKernels(MakeKernel makeKernel) {
+    return makeActionKernels<Kernel>(makeKernel, std::make_index_sequence<MaxNumActions>{});
+}
+
+struct KernelTable {
+    std::string_view name;
+    ActionKernels<NormalizeActionsKernel> normalizeRegretSums;
+    ActionKernels<NormalizeActionsKernel> normalizeStrategySums;
+    void (*accumulateWeightedValues)(float* output, const float* values, const float* weights, std::size_t size);
+    ActionKernels<AccumulateActionsKernel> accumulateActionWeightedValues;
+    ActionKernels<AccumulateActionsKernel> accumulateActionValues;
+    ActionKernels<UpdateActionsKernel> updateDiscountedTrainingData;
+};
+
+// Scalar implementations, also used to process the elements left over after the vectorized loops
+// The sums start from zero and add the actions in order, the same as a loop over the actions that accumulates into a zeroed buffer
+template <int NumActions, bool ClampToPositive>
+void scalarNormalizeActions(float* strategy, const float* sums, float uniformProbability, std::size_t actionStride, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i) {
+        float values[NumActions];
+        float total = 0.0f;
+        for (int action = 0; action < NumActions; ++action) {
+            float value = sums[action * actionStride + i];
+            if constexpr (ClampToPositive) {
+                value = std::max(value, 0.0f);
+            }
+            values[action] = value;
+            total += value;
+        }
+
+        for (int action = 0; action < NumActions; ++action) {
+            strategy[action * actionStride + i] = (total > 0.0f) ? (values[action] / total) : uniformProbability;
+        }
+    }
+}
+
+void scalarAccumulateWeightedValues(float* output, const float* values, const float* weights, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i) {
+        output[i] += values[i] * weights[i];
+    }
+}
+
+template <int NumActions, bool IsWeighted>
+void scalarAccumulateActions(float* output, const float* values, const float* weights, std::size_t actionStride, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i) {
+        float sum = output[i];
+        for (int action = 0; action < NumActions; ++action) {
+            float value = values[action * actionStride + i];
+            if constexpr (IsWeighted) {
+                value = value * weights[action * actionStride + i];
+            }
+            sum += value;
+        }
+        output[i] = sum;
+    }
+}
+
+template <int NumActions>
+void scalarUpdateDiscountedActions(
+    float* regretSums,
+    float* strategySums,
+    const float* actionExpectedValues,
+    const float* strategyExpectedValues,
+    const float* reachProbs,
+    const float* currentStrategy,
+    float alphaT,
+    float betaT,
+    float gammaT,
+    std::size_t actionStride,
+    std::size_t size
+) {
+    for (std::size_t i = 0; i < size; ++i) {
+        float strategyExpectedValue = strategyExpectedValues[i];
+        float reachProb = reachProbs[i];
+        for (int action = 0; action < NumActions; ++action) {
+            std::size_t index = action * actionStride + i;
+
+            float regret = actionExpectedValues[index] - strategyExpectedValue;
+            float regretDiscount = (regretSums[index] > 0.0f) ? alphaT : betaT;
+            regretSums[index] = regretSums[index] * regretDiscount + regret;
+
+            float strategy = reachProb * currentStrategy[index];
+            strategySums[index] = strategySums[index] * gammaT + strategy;
+        }
+    }
+}
+
+constexpr KernelTable ScalarKernels = {
+    .name = "scalar",
+    .normalizeRegretSums = makeActionKernels<NormalizeActionsKernel>([]<int NumActions>() { return &scalarNormalizeActions<NumActions, true>; }),
+    .normalizeStrategySums = makeActionKernels<NormalizeActionsKernel>([]<int NumActions>() { return &scalarNormalizeActions<NumActions, false>; }),
+    .accumulateWeightedValues = scalarAccumulateWeightedValues,
+    .accumulateActionWeightedValues = makeActionKernels<AccumulateActionsKernel>([]<int NumActions>() { return &scalarAccumulateActions<NumActions, true>; }),
+    .accumulateActionValues = makeActionKernels<AccumulateActionsKernel>([]<int NumActions>() { return &scalarAccumulateActions<NumActions, false>; }),
+    .updateDiscountedTrainingData = makeActionKernels<UpdateActionsKernel>([]<int NumActions>() { return &scalarUpdateDiscountedActions<NumActions>; })
+};
+
+#ifdef SIMD_KERNELS_X86
+// AVX2
+template <int NumActions, bool ClampToPositive>
+__attribute__((target("avx2")))
+void avx2NormalizeActions(float* strategy, const float* sums, float uniformProbability, std::size_t actionStride, std::size_t size) {
+    static constexpr std::size_t Width = 8;
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 uniform = _mm256_set1_ps(uniformProbability);
+
+    std::size_t i = 0;
+    for (; i + Width <= size; i += Width) {
+        __m256 values[NumActions];
+        __m256 total = zero;
+        for (int action = 0; action < NumActions; ++action) {
+            __m256 value = _mm256_loadu_ps(sums + action * actionStride + i);
+            if constexpr (ClampToPositive) {
+                // maxps returns the second operand unless the first is greater, which matches std::max(regret, 0.0f) for -0.0f and NaN
+                value = _mm256_max_ps(zero, value);
+            }
+            values[action] = value;
+            total = _mm256_add_ps(total, value);
+        }
+
+        __m256 isPositive = _mm256_cmp_ps(total, zero, _CMP_GT_OQ);
+        for (int action = 0; action < NumActions; ++action) {
+            __m256 normalized = _mm256_div_ps(values[action], total);
+            _mm256_storeu_ps(strategy + action * actionStride + i, _mm256_blendv_ps(uniform, normalized, isPositive));
+        }
+    }
+    scalarNormalizeActions<NumActions, ClampToPositive>(strategy + i, sums + i, uniformProbability, actionStride, size - i);
+}
+
+__attribute__((target("avx2")))
+void avx2AccumulateWeightedValues(float* output, const float* values, const float* weights, std::size_t size) {
+    static constexpr std::size_t Width = 8;
+
+    std::size_t i = 0;
+    for (; i + Width <= size; i += Width) {
+        __m256 weighted = _mm256_mul_ps(_mm256_loadu_ps(values + i), _mm256_loadu_ps(weights + i));
+        _mm256_storeu_ps(output + i, _mm256_add_ps(_mm256_loadu_ps(output + i), weighted));
+    }
+    scalarAccumulateWeightedValues(output + i, values + i, weights + i, size - i);
+}
+
+template <int NumActions, bool IsWeighted>
+__attribute__((target("avx2")))
+void avx2AccumulateActions(float* output, const float* values, const float* weights, std::size_t actionStride, std::size_t size) {
+    static constexpr std::size_t Width = 8;
+
+    std::size_t i = 0;
+    for (; i + Width <= size; i += Width) {
+        __m256 sum = _mm256_loadu_ps(output + i);
+        for (int action = 0; action < NumActions; ++action) {
+            __m256 value = _mm256_loadu_ps(values + action * actionStride + i);
+            if constexpr (IsWeighted) {
+                value = _mm256_mul_ps(value, _mm256_loadu_ps(weights + action * actionStride + i));
+            }
+            sum = _mm256_add_ps(sum, value);
+        }
+        _mm256_storeu_ps(output + i, sum);
+    }
+    scalarAccumulateActions<NumActions, IsWeighted>(output + i, values + i, IsWeighted ? weights + i : nullptr, actionStride, size - i);
+}
+
+template <int NumActions>
+__attribute__((target("avx2")))
+void avx2UpdateDiscountedActions(
+    float* regretSums,
+    float* strategySums,
+    const float* actionExpectedValues,
+    const float* strategyExpectedValues,
+    const float* reachProbs,
+    const float* currentStrategy,
+    float alphaT,
+    float betaT,
+    float gammaT,
+    std::size_t actionStride,
+    std::size_t size
+) {
+    static constexpr std::size_t Width = 8;
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 alpha = _mm256_set1_ps(alphaT);
+    const __m256 beta = _mm256_set1_ps(betaT);
+    const __m256 gamma = _mm256_set1_ps(gammaT);
+
+    std::size_t i = 0;
+    for (; i + Width <= size; i += Width) {
+        __m256 strategyExpectedValue = _mm256_loadu_ps(strategyExpectedValues + i);
+        __m256 reachProb = _mm256_loadu_ps(reachProbs + i);
+        for (int action = 0; action < NumActions; ++action) {
+            std::size_t index = action * actionStride + i;
+
+            __m256 regret = _mm256_sub_ps(_mm256_loadu_ps(actionExpectedValues + index), strategyExpectedValue);
+            __m256 regretSum = _mm256_loadu_ps(regretSums + index);
+            __m256 regretDiscount = _mm256_blendv_ps(beta, alpha, _mm256_cmp_ps(regretSum, zero, _CMP_GT_OQ));
+            _mm256_storeu_ps(regretSums + index, _mm256_add_ps(_mm256_mul_ps(regretSum, regretDiscount), regret));
+
+            __m256 strategy = _mm256_mul_ps(reachProb, _mm256_loadu_ps(currentStrategy + index));
+            __m256 strategySum = _mm256_loadu_ps(strategySums + index);
+            _mm256_storeu_ps(strategySums + index, _mm256_add_ps(_mm256_mul_ps(strategySum, gamma), strategy));
+        }
+    }
+    scalarUpdateDiscountedActions<NumActions>(
+        regretSums + i,
+        strategySums + i,
+        actionExpectedValues + i,
+        strategyExpectedValues + i,
+        reachProbs + i,
+        currentStrategy + i,
+        alphaT,
+        betaT,
+        gammaT,
+        actionStride,
+        size - i
+    );
+}
+
+constexpr KernelTable Avx2Kernels = {
+    .name = "AVX2",
+    .normalizeRegretSums = makeActionKernels<NormalizeActionsKernel>([]<int NumActions>() { return &avx2NormalizeActions<NumActions, true>; }),
+    .normalizeStrategySums = makeActionKernels<NormalizeActionsKernel>([]<int NumActions>() { return &avx2NormalizeActions<NumActions, false>; }),
+    .accumulateWeightedValues = avx2AccumulateWeightedValues,
+    .accumulateActionWeightedValues = makeActionKernels<AccumulateActionsKernel>([]<int NumActions>() { return &avx2AccumulateActions<NumActions, true>; }),
+    .accumulateActionValues = makeActionKernels<AccumulateActionsKernel>([]<int NumActions>() { return &avx2AccumulateActions<NumActions, false>; }),
+    .updateDiscountedTrainingData = makeActionKernels<UpdateActionsKernel>([]<int NumActions>() { return &avx2UpdateDiscountedActions<NumActions>; })
+};
+
+// AVX-512
+template <int NumActions, bool ClampToPositive>
+__attribute__((target("avx512f")))
+void avx512NormalizeActions(float* strategy, const float* sums, float uniformProbability, std::size_t actionStride, std::size_t size) {
+    static constexpr std::size_t Width = 16;
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 uniform = _mm512_set1_ps(uniformProbability);
+
+    std::size_t i = 0;
+    for (; i + Width <= size; i += Width) {
+        __m512 values[NumActions];
+        __m512 total = zero;
+        for (int action = 0; action < NumActions; ++action) {
+            __m512 value = _mm512_loadu_ps(sums + action * actionStride + i);
+            if constexpr (ClampToPositive) {
+                value = _mm512_max_ps(zero, value);
+            }
+            values[action] = value;
+            total = _mm512_add_ps(total, value);
+        }
+
+        // Only divide in lanes with a positive total, the rest are set to the uniform probability
+        __mmask16 isPositive = _mm512_cmp_ps_mask(total, zero, _CMP_GT_OQ);
+        for (int action = 0; action < NumActions; ++action) {
+            _mm512_storeu_ps(strategy + action * actionStride + i, _mm512_mask_div_ps(uniform, isPositive, values[action], total));
+        }
+    }
+    scalarNormalizeActions<NumActions, ClampToPositive>(strategy + i, sums + i, uniformProbability, actionStride, size - i);
+}
+
+__attribute__((target("avx512f")))
+void avx512AccumulateWeightedValues(float* output, const float* values, const float* weights, std::size_t size) {
+    static constexpr std::size_t Width = 16;
+
+    std::size_t i = 0;
+    for (; i + Width <= size; i += Width) {
+        __m512 weighted = _mm512_mul_ps(_mm512_loadu_ps(values + i), _mm512_loadu_ps(weights + i));
+        _mm512_storeu_ps(output + i, _mm512_add_ps(_mm512_loadu_ps(output + i), weighted));
+    }
+    scalarAccumulateWeightedValues(output + i, values + i, weights + i, size - i);
+}
+
+template <int NumActions, bool IsWeighted>
+__attribute__((target("avx512f")))
+void avx512AccumulateActions(float* output, const float* values, const float* weights, std::size_t actionStride, std::size_t size) {
+    static constexpr std::size_t Width = 16;
+
+    std::size_t i = 0;
+    for (; i + Width <= size; i += Width) {
+        __m512 sum = _mm512_loadu_ps(output + i);
+        for (int action = 0; action < NumActions; ++action) {
+            __m512 value = _mm512_loadu_ps(values + action * actionStride + i);
+            if constexpr (IsWeighted) {
+                value = _mm512_mul_ps(value, _mm512_loadu_ps(weights + action * actionStride + i));
+            }
+            sum = _mm512_add_ps(sum, value);
+        }
+        _mm512_storeu_ps(output + i, sum);
+    }
+    scalarAccumulateActions<NumActions, IsWeighted>(output + i, values + i, IsWeighted ? weights + i : nullptr, actionStride, size - i);
+}
+
+template <int NumActions>
+__attribute__((target("avx512f")))
+void avx512UpdateDiscountedActions(
+    float* regretSums,
+    float* strategySums,
+    const float* actionExpectedValues,
+    const float* strategyExpectedValues,
+    const float* reachProbs,
+    const float* currentStrategy,
+    float alphaT,
+    float betaT,
+    float gammaT,
+    std::size_t actionStride,
+    std::size_t size
+) {
+    static constexpr std::size_t Width = 16;
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 alpha = _mm512_set1_ps(alphaT);
+    const __m512 beta = _mm512_set1_ps(betaT);
+    const __m512 gamma = _mm512_set1_ps(gammaT);
+
+    std::size_t i = 0;
+    for (; i + Width <= size; i += Width) {
+        __m512 strategyExpectedValue = _mm512_loadu_ps(strategyExpectedValues + i);
+        __m512 reachProb = _mm512_loadu_ps(reachProbs + i);
+        for (int action = 0; action < NumActions; ++action) {
+            std::size_t index = action * actionStride + i;
+
+            __m512 regret = _mm512_sub_ps(_mm512_loadu_ps(actionExpectedValues + index), strategyExpectedValue);
+            __m512 regretSum = _mm512_loadu_ps(regretSums + index);
+            __m512 regretDiscount = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(regretSum, zero, _CMP_GT_OQ), beta, alpha);
+            _mm512_storeu_ps(regretSums + index, _mm512_add_ps(_mm512_mul_ps(regretSum, regretDiscount), regret));
+
+            __m512 strategy = _mm512_mul_ps(reachProb, _mm512_loadu_ps(currentStrategy + index));
+            __m512 strategySum = _mm512_loadu_ps(strategySums + index);
+            _mm512_storeu_ps(strategySums + index, _mm512_add_ps(_mm512_mul_ps(strategySum, gamma), strategy));
+        }
+    }
+    scalarUpdateDiscountedActions<NumActions>(
+        regretSums + i,
+        strategySums + i,
+        actionExpectedValues + i,
+        strategyExpectedValues + i,
+        reachProbs + i,
+        currentStrategy + i,
+        alphaT,
+        betaT,
+        gammaT,
+        actionStride,
+        size - i
+    );
+}
+
+constexpr KernelTable Avx512Kernels = {
+    .name = "AVX-512",
+    .normalizeRegretSums = makeActionKernels<NormalizeActionsKernel>([]<int NumActions>() { return &avx512NormalizeActions<NumActions, true>; }),
+    .normalizeStrategySums = makeActionKernels<NormalizeActionsKernel>([]<int NumActions>() { return &avx512NormalizeActions<NumActions, false>; }),
+    .accumulateWeightedValues = avx512AccumulateWeightedValues,
+    .accumulateActionWeightedValues = makeActionKernels<AccumulateActionsKernel>([]<int NumActions>() { return &avx512AccumulateActions<NumActions, true>; }),
+    .accumulateActionValues = makeActionKernels<AccumulateActionsKernel>([]<int NumActions>() { return &avx512AccumulateActions<NumActions, false>; }),
+    .updateDiscountedTrainingData = makeActionKernels<UpdateActionsKernel>([]<int NumActions>() { return &avx512UpdateDiscountedActions<NumActions>; })
+};
+#endif // SIMD_KERNELS_X86
+
+#ifdef SIMD_KERNELS_NEON
+template <int NumActions, bool ClampToPositive>
+void neonNormalizeActions(float* strategy, const float* sums, float uniformProbability, std::size_t actionStride, std::size_t size) {
+    static constexpr std::size_t Width = 4;
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t uniform = vdupq_n_f32(uniformProbability);
+
+    std::size_t i = 0;
+    for (; i + Width <= size; i += Width) {
+        float32x4_t values[NumActions];
+        float32x4_t total = zero;
+        for (int action = 0; action < NumActions; ++action) {
+            float32x4_t value = vld1q_f32(sums + action * actionStride + i);
+            if constexpr (ClampToPositive) {
+                // vmaxq_f32 handles -0.0f and NaN differently from std::max, so select explicitly
+                value = vbslq_f32(vcltq_f32(value, zero), zero, value);
+            }
+            values[action] = value;
+            total = vaddq_f32(total, value);
+        }
+
+        uint32x4_t isPositive = vcgtq_f32(total, zero);
+        for (int action = 0; action < NumActions; ++action) {
+            float32x4_t normalized = vdivq_f32(values[action], total);
+            vst1q_f32(strategy + action * actionStride + i, vbslq_f32(isPositive, normalized, uniform));
+        }
+    }
+    scalarNormalizeActions<NumActions, ClampToPositive>(strategy + i, sums + i, uniformProbability, actionStride, size - i);
+}
+
+void neonAccumulateWeightedValues(float* output, const float* values, const float* weights, std::size_t size) {
+    static constexpr std::size_t Width = 4;
+
+    std::size_t i = 0;
+    for (; i + Width <= size; i += Width) {
+        float32x4_t weighted = vmulq_f32(vld1q_f32(values + i), vld1q_f32(weights + i));
+        vst1q_f32(output + i, vaddq_f32(vld1q_f32(output + i), weighted));
+    }
+    scalarAccumulateWeightedValues(output + i, values + i, weights + i, size - i);
+}
+
+template <int NumActions, bool IsWeighted>
+void neonAccumulateActions(float* output, const float* values, const float* weights, std::size_t actionStride, std::size_t size) {
+    static constexpr std::size_t Width = 4;
+
+    std::size_t i = 0;
+    for (; i + Width <= size; i += Width) {
+        float32x4_t sum = vld1q_f32(output + i);
+        for (int action = 0; action < NumActions; ++action) {
+            float32x4_t value = vld1q_f32(values + action * actionStride + i);
+            if constexpr (IsWeighted) {
+                value = vmulq_f32(value, vld1q_f32(weights + action * actionStride + i));
+            }
+            sum = vaddq_f32(sum, value);
+        }
+        vst1q_f32(output + i, sum);
+    }
+    scalarAccumulateActions<NumActions, IsWeighted>(output + i, values + i, IsWeighted ? weights + i : nullptr, actionStride, size - i);
+}
+
+template <int NumActions>
+void neonUpdateDiscountedActions(
+    float* regretSums,
+    float* strategySums,
+    const float* actionExpectedValues,
+    const float* strategyExpectedValues,
+    const float* reachProbs,
+    const float* currentStrategy,
+    float alphaT,
+    float betaT,
+    float gammaT,
+    std::size_t actionStride,
+    std::size_t size
+) {
+    static constexpr std::size_t Width = 4;
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t alpha = vdupq_n_f32(alphaT);
+    const float32x4_t beta = vdupq_n_f32(betaT);
+    const float32x4_t gamma = vdupq_n_f32(gammaT);
+
+    std::size_t i = 0;
+    for (; i + Width <= size; i += Width) {
+        float32x4_t strategyExpectedValue = vld1q_f32(strategyExpectedValues + i);
+        float32x4_t reachProb = vld1q_f32(reachProbs + i);
+        for (int action = 0; action < NumActions; ++action) {
+            std::size_t index = action * actionStride + i;
+
+            float32x4_t regret = vsubq_f32(vld1q_f32(actionExpectedValues + index), strategyExpectedValue);
+            float32x4_t regretSum = vld1q_f32(regretSums + index);
+            float32x4_t regretDiscount = vbslq_f32(vcgtq_f32(regretSum, zero), alpha, beta);
+            vst1q_f32(regretSums + index, vaddq_f32(vmulq_f32(regretSum, regretDiscount), regret));
+
+            float32x4_t strategy = vmulq_f32(reachProb, vld1q_f32(currentStrategy + index));
+            float32x4_t strategySum = vld1q_f32(strategySums + index);
+            vst1q_f32(strategySums + index, vaddq_f32(vmulq_f32(strategySum, gamma), strategy));
+        }
+    }
+    scalarUpdateDiscountedActions<NumActions>(
+        regretSums + i,
+        strategySums + i,
+        actionExpectedValues + i,
+        strategyExpectedValues + i,
+        reachProbs + i,
+        currentStrategy + i,
+        alphaT,
+        betaT,
+        gammaT,
+        actionStride,
+        size - i
+    );
+}
+
+constexpr KernelTable NeonKernels = {
+    .name = "NEON",
+    .normalizeRegretSums = makeActionKernels<NormalizeActionsKernel>([]<int NumActions>() { return &neonNormalizeActions<NumActions, true>; }),
+    .normalizeStrategySums = makeActionKernels<NormalizeActionsKernel>([]<int NumActions>() { return &neonNormalizeActions<NumActions, false>; }),
+    .accumulateWeightedValues = neonAccumulateWeightedValues,
+    .accumulateActionWeightedValues = makeActionKernels<AccumulateActionsKernel>([]<int NumActions>() { return &neonAccumulateActions<NumActions, true>; }),
+    .accumulateActionValues = makeActionKernels<AccumulateActionsKernel>([]<int NumActions>() { return &neonAccumulateActions<NumActions, false>; }),
+    .updateDiscountedTrainingData = makeActionKernels<UpdateActionsKernel>([]<int NumActions>() { return &neonUpdateDiscountedActions<NumActions>; })
+};
+#endif // SIMD_KERNELS_NEON
+
+const KernelTable& selectKernels() {
+    #if defined(SIMD_KERNELS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return Avx512Kernels;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Avx2Kernels;
+    }
+    return ScalarKernels;
+    #elif defined(SIMD_KERNELS_NEON)
+    // NEON is always available on AArch64
+    return NeonKernels;
+    #else
+    return ScalarKernels;
+    #endif
+}
+
+const KernelTable& getKernels() {
+    static const KernelTable& kernels = selectKernels();
+    return kernels;
+}
+
+[[maybe_unused]] bool isActionCountValid(int numActions) {
+    return (numActions > 0) && (numActions <= MaxNumActions);
+}
+
+// Every row must fit in the span, the last one only needs size elements
+[[maybe_unused]] bool areActionRowsValid(std::size_t rowsSize, int numActions, std::size_t actionStride, std::size_t size) {
+    return (size <= actionStride) && (rowsSize >= (numActions - 1) * actionStride + size);
+}
+} // namespace
+
+void normalizeRegretSums(std::span<float> strategy, std::span<const float> regretSums, int numActions) {
+    assert(isActionCountValid(numActions));
+    assert(strategy.size() == regretSums.size() && strategy.size() % numActions == 0);
+
+    std::size_t numHands = strategy.size() / numActions;
+    float uniformProbability = 1.0f / static_cast<float>(numActions);
+    getKernels().normalizeRegretSums[numActions](strategy.data(), regretSums.data(), uniformProbability, numHands, numHands);
+}
+
+void normalizeStrategySums(std::span<float> strategy, std::span<const float> strategySums, int numActions) {
+    assert(isActionCountValid(numActions));
+    assert(strategy.size() == strategySums.size() && strategy.size() % numActions == 0);
+
+    std::size_t numHands = strategy.size() / numActions;
+    float uniformProbability = 1.0f / static_cast<float>(numActions);
+    getKernels().normalizeStrategySums[numActions](strategy.data(), strategySums.data(), uniformProbability, numHands, numHands);
+}
+
+void accumulateWeightedValues(std::span<float> output, std::span<const float> values, std::span<const float> weights) {
+    assert(output.size() == values.size() && output.size() == weights.size());
+    getKernels().accumulateWeightedValues(output.data(), values.data(), weights.data(), output.size());
+}
+
+void accumulateActionWeightedValues(
+    std::span<float> output,
+    std::span<const float> values,
+    std::span<const float> weights,
+    int numActions,
+    std::size_t actionStride
+) {
+    assert(isActionCountValid(numActions));
+    assert(areActionRowsValid(values.size(), numActions, actionStride, output.size()));
+    assert(areActionRowsValid(weights.size(), numActions, actionStride, output.size()));
+    getKernels().accumulateActionWeightedValues[numActions](output.data(), values.data(), weights.data(), actionStride, output.size());
+}
+
+void accumulateActionValues(std::span<float> output, std::span<const float> values, int numActions, std::size_t actionStride) {
+    assert(isActionCountValid(numActions));
+    assert(areActionRowsValid(values.size(), numActions, actionStride, output.size()));
+    getKernels().accumulateActionValues[numActions](output.data(), values.data(), nullptr, actionStride, output.size());
+}
+
+void updateDiscountedTrainingData(
+    std::span<float> regretSums,
+    std::span<float> strategySums,
+    std::span<const float> actionExpectedValues,
+    std::span<const float> strategyExpectedValues,
+    std::span<const float> reachProbs,
+    std::span<const float> currentStrategy,
+    float alphaT,
+    float betaT,
+    float gammaT,
+    int numActions,
+    std::size_t actionStride
+) {
+    std::size_t size = strategyExpectedValues.size();
+    assert(isActionCountValid(numActions));
+    assert(reachProbs.size() == size);
+    assert(areActionRowsValid(regretSums.size(), numActions, actionStride, size));
+    assert(areActionRowsValid(strategySums.size(), numActions, actionStride, size));
+    assert(areActionRowsValid(actionExpectedValues.size(), numActions, actionStride, size));
+    assert(areActionRowsValid(currentStrategy.size(), numActions, actionStride, size));
+
+    getKernels().updateDiscountedTrainingData[numActions](
+        regretSums.data(),
+        strategySums.data(),
+        actionExpectedValues.data(),
+        strategyExpectedValues.data(),
+        reachProbs.data(),
+        currentStrategy.data(),
+        alphaT,
+        betaT,
+        gammaT,
+        actionStride,
+        size
+    );
+}
+
+std::string_view getSimdInstructionSetName() {
+    return getKernels().name;
+}
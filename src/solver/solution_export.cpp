@@ -0,0 +1,348 @@
+#include "solver/solution_export.hpp"
+
+#include "game/game_rules.hpp"
+#include "game/game_types.hpp"
+#include "game/game_utils.hpp"
+#include "solver/cfr.hpp"
+#include "solver/node_path.hpp"
+#include "solver/tree.hpp"
+#include "util/binary_io.hpp"
+#include "util/result.hpp"
+#include "util/stack_allocator.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+static constexpr std::uint32_t SolutionExportMagic = 0x50534558; // "PSEX"
+static constexpr std::uint32_t SolutionExportVersion = 1;
+
+// Columns start on a cache line so that they can be used directly from a mapped file
+static constexpr std::size_t ColumnAlignment = 64;
+
+static constexpr std::uint32_t NoParent = std::numeric_limits<std::uint32_t>::max();
+
+int getThreadIndex() {
+    #ifdef _OPENMP
+    return omp_get_thread_num();
+    #else
+    return 0;
+    #endif
+}
+
+template <typename T>
+constexpr SolutionExportColumnType getColumnType() {
+    if constexpr (std::is_same_v<T, std::uint8_t>) return SolutionExportColumnType::UInt8;
+    else if constexpr (std::is_same_v<T, std::uint32_t>) return SolutionExportColumnType::UInt32;
+    else if constexpr (std::is_same_v<T, std::int32_t>) return SolutionExportColumnType::Int32;
+    else {
+        static_assert(std::is_same_v<T, float>);
+        return SolutionExportColumnType::Float32;
+    }
+}
+
+struct StringColumn {
+    std::vector<std::uint32_t> offsets = { 0 };
+    std::vector<char> characters;
+
+    void push(std::string_view value) {
+        characters.insert(characters.end(), value.begin(), value.end());
+        offsets.push_back(static_cast<std::uint32_t>(characters.size()));
+    }
+
+    void clear() {
+        offsets.assign(1, 0);
+        characters.clear();
+    }
+};
+
+void writeChunkHeader(BinaryWriter& writer, SolutionExportTable table, std::size_t numRows, std::size_t numColumns) {
+    writer.write(table);
+    writer.write<std::uint64_t>(numRows);
+    writer.write<std::uint32_t>(numColumns);
+}
+
+void writeColumnName(BinaryWriter& writer, std::string_view name, SolutionExportColumnType type) {
+    writer.writeArray(std::span<const char>{ name });
+    writer.write(type);
+}
+
+template <typename T>
+void writeColumn(BinaryWriter& writer, std::string_view name, std::span<const T> values) {
+    writeColumnName(writer, name, getColumnType<T>());
+    writer.writeAlignedArray(values, ColumnAlignment);
+}
+
+void writeStringColumn(BinaryWriter& writer, std::string_view name, const StringColumn& column) {
+    writeColumnName(writer, name, SolutionExportColumnType::String);
+    writer.writeAlignedArray(std::span<const std::uint32_t>{ column.offsets }, ColumnAlignment);
+    writer.writeAlignedArray(std::span<const char>{ column.characters }, ColumnAlignment);
+}
+
+std::string getBoardName(CardSet board) {
+    std::string name;
+    for (const std::string& cardName : getCardSetNames(board)) {
+        name += cardName;
+    }
+    return name;
+}
+
+std::string getHandName(HandInfo hand) {
+    std::string name = getNameFromCardID(hand.card0);
+    if (hand.card1 != InvalidCard) {
+        name += getNameFromCardID(hand.card1);
+    }
+    return name;
+}
+
+// Parent of every node, or NoParent at the root
+std::vector<std::uint32_t> buildParentIndices(const Tree& tree) {
+    std::vector<std::uint32_t> parentIndices(tree.allNodes.size(), NoParent);
+    for (std::size_t nodeIndex = 0; nodeIndex < tree.allNodes.size(); ++nodeIndex) {
+        const Node& node = tree.allNodes[nodeIndex];
+        if ((node.nodeType != NodeType::Decision) && (node.nodeType != NodeType::Chance)) continue;
+
+        for (int child = 0; child < node.numChildren; ++child) {
+            parentIndices[node.childrenOffset + child] = static_cast<std::uint32_t>(nodeIndex);
+        }
+    }
+    return parentIndices;
+}
+
+struct NodeRowBuffer {
+    std::vector<std::uint32_t> nodeIndices;
+    std::vector<std::uint32_t> parentIndices;
+    std::vector<std::uint8_t> players;
+    std::vector<std::uint8_t> streets;
+    std::vector<std::uint8_t> numActions;
+    std::vector<std::int32_t> pots;
+    StringColumn boards;
+    StringColumn histories;
+    StringColumn actions;
+
+    std::size_t size() const {
+        return nodeIndices.size();
+    }
+
+    void write(BinaryWriter& writer) const {
+        writeChunkHeader(writer, SolutionExportTable::Nodes, size(), 9);
+        writeColumn<std::uint32_t>(writer, "node_index", nodeIndices);
+        writeColumn<std::uint32_t>(writer, "parent_index", parentIndices);
+        writeColumn<std::uint8_t>(writer, "player", players);
+        writeColumn<std::uint8_t>(writer, "street", streets);
+        writeColumn<std::uint8_t>(writer, "num_actions", numActions);
+        writeColumn<std::int32_t>(writer, "pot", pots);
+        writeStringColumn(writer, "board", boards);
+        writeStringColumn(writer, "history", histories);
+        writeStringColumn(writer, "actions", actions);
+    }
+
+    void clear() {
+        nodeIndices.clear();
+        parentIndices.clear();
+        players.clear();
+        streets.clear();
+        numActions.clear();
+        pots.clear();
+        boards.clear();
+        histories.clear();
+        actions.clear();
+    }
+};
+
+struct HandRowBuffer {
+    std::vector<std::uint32_t> nodeIndices;
+    StringColumn hands;
+    std::vector<float> expectedValues;
+    std::array<std::vector<float>, MaxNumActions> strategies;
+
+    std::size_t size() const {
+        return nodeIndices.size();
+    }
+
+    void write(BinaryWriter& writer) const {
+        writeChunkHeader(writer, SolutionExportTable::Hands, size(), 3 + MaxNumActions);
+        writeColumn<std::uint32_t>(writer, "node_index", nodeIndices);
+        writeStringColumn(writer, "hand", hands);
+        writeColumn<float>(writer, "ev", expectedValues);
+        for (int action = 0; action < MaxNumActions; ++action) {
+            writeColumn<float>(writer, "strategy_" + std::to_string(action), strategies[action]);
+        }
+    }
+
+    void clear() {
+        nodeIndices.clear();
+        hands.clear();
+        expectedValues.clear();
+        for (std::vector<float>& strategy : strategies) {
+            strategy.clear();
+        }
+    }
+};
+
+// Actions and dealt cards from the root to the node
+std::string getNodeHistory(const IGameRules& rules, const Tree& tree, const std::vector<std::uint32_t>& parentIndices, std::size_t nodeIndex) {
+    std::vector<std::string> steps;
+    for (std::size_t childIndex = nodeIndex; parentIndices[childIndex] != NoParent; childIndex = parentIndices[childIndex]) {
+        std::size_t parentIndex = parentIndices[childIndex];
+        const Node& parent = tree.allNodes[parentIndex];
+        if (parent.nodeType == NodeType::Decision) {
+            steps.push_back(getActionName(rules, tree, parentIndex, static_cast<int>(childIndex - parent.childrenOffset)));
+        }
+        else {
+            steps.push_back(getNameFromCardID(tree.allNodes[childIndex].lastDealtCard));
+        }
+    }
+
+    std::string history;
+    for (auto step = steps.rbegin(); step != steps.rend(); ++step) {
+        if (!history.empty()) history += ",";
+        history += *step;
+    }
+    return history;
+}
+
+// Closest decision node above the node, or NoParent if there is none
+std::uint32_t getParentDecisionNode(const Tree& tree, const std::vector<std::uint32_t>& parentIndices, std::size_t nodeIndex) {
+    std::uint32_t parentIndex = parentIndices[nodeIndex];
+    while ((parentIndex != NoParent) && (tree.allNodes[parentIndex].nodeType != NodeType::Decision)) {
+        parentIndex = parentIndices[parentIndex];
+    }
+    return parentIndex;
+}
+
+void writeNodesTable(const IGameRules& rules, const Tree& tree, std::size_t rowsPerChunk, BinaryWriter& writer, SolutionExportSummary& summary) {
+    std::vector<std::uint32_t> parentIndices = buildParentIndices(tree);
+
+    NodeRowBuffer buffer;
+    auto flush = [&buffer, &writer, &summary]() -> void {
+        if (buffer.size() == 0) return;
+        buffer.write(writer);
+        summary.numDecisionNodes += buffer.size();
+        ++summary.numChunks;
+        buffer.clear();
+    };
+
+    for (std::size_t nodeIndex = 0; nodeIndex < tree.allNodes.size(); ++nodeIndex) {
+        const Node& node = tree.allNodes[nodeIndex];
+        if (node.nodeType != NodeType::Decision) continue;
+
+        GameState state = tree.getNodeState(nodeIndex);
+
+        std::string actionNames;
+        for (int action = 0; action < node.numChildren; ++action) {
+            if (action > 0) actionNames += ",";
+            actionNames += getActionName(rules, tree, nodeIndex, action);
+        }
+
+        buffer.nodeIndices.push_back(static_cast<std::uint32_t>(nodeIndex));
+        buffer.parentIndices.push_back(getParentDecisionNode(tree, parentIndices, nodeIndex));
+        buffer.players.push_back(static_cast<std::uint8_t>(node.playerToAct));
+        buffer.streets.push_back(static_cast<std::uint8_t>(state.currentStreet));
+        buffer.numActions.push_back(node.numChildren);
+        buffer.pots.push_back(state.totalWagers[Player::P0] + state.totalWagers[Player::P1] + tree.deadMoney);
+        buffer.boards.push(getBoardName(node.board));
+        buffer.histories.push(getNodeHistory(rules, tree, parentIndices, nodeIndex));
+        buffer.actions.push(actionNames);
+
+        if (buffer.size() >= rowsPerChunk) {
+            flush();
+        }
+    }
+
+    flush();
+}
+} // namespace
+
+Result<SolutionExportSummary> exportSolution(
+    const IGameRules& rules,
+    Tree& tree,
+    const std::filesystem::path& path,
+    StackAllocator& allocator,
+    std::size_t rowsPerChunk
+) {
+    assert(rowsPerChunk > 0);
+
+    if (!tree.isTreeSkeletonBuilt() || !tree.areCfrVectorsInitialized()) {
+        return "Error: Tree must be solved first.";
+    }
+
+    if (tree.isTrainingDataPartial()) {
+        return "Error: Trees trained with distributed workers cannot be exported, since the workers keep the subtrees after the first chance card.";
+    }
+
+    BinaryWriter writer{ path };
+    if (!writer.isGood()) {
+        return "Error: Could not open " + path.string() + " for writing.";
+    }
+
+    writer.write(SolutionExportMagic);
+    writer.write(SolutionExportVersion);
+    writer.write<std::uint32_t>(MaxNumActions);
+
+    SolutionExportSummary summary = {
+        .numDecisionNodes = 0,
+        .numHandRows = 0,
+        .numChunks = 0
+    };
+    writeNodesTable(rules, tree, rowsPerChunk, writer, summary);
+
+    // Each traversal thread fills its own buffer, and only takes the lock to write a full buffer to the file
+    std::vector<HandRowBuffer> buffers(allocator.getNumThreads());
+    std::mutex writerMutex;
+    auto flush = [&writer, &writerMutex, &summary](HandRowBuffer& buffer) -> void {
+        if (buffer.size() == 0) return;
+        {
+            std::lock_guard<std::mutex> lock{ writerMutex };
+            buffer.write(writer);
+            summary.numHandRows += buffer.size();
+            ++summary.numChunks;
+        }
+        buffer.clear();
+    };
+
+    visitDecisionNodeSolutions(rules, tree, allocator, [&buffers, &flush, rowsPerChunk](const DecisionNodeSolution& solution) -> void {
+        assert(getThreadIndex() < static_cast<int>(buffers.size()));
+        HandRowBuffer& buffer = buffers[getThreadIndex()];
+
+        static constexpr float Missing = std::numeric_limits<float>::quiet_NaN();
+        std::size_t numHands = solution.hands.size();
+        for (std::size_t i = 0; i < numHands; ++i) {
+            buffer.nodeIndices.push_back(static_cast<std::uint32_t>(solution.nodeIndex));
+            buffer.hands.push(getHandName(solution.hands[i]));
+            buffer.expectedValues.push_back(solution.expectedValues[i]);
+            for (int action = 0; action < MaxNumActions; ++action) {
+                buffer.strategies[action].push_back((action < solution.numActions) ? solution.strategy[action * numHands + i] : Missing);
+            }
+        }
+
+        if (buffer.size() >= rowsPerChunk) {
+            flush(buffer);
+        }
+    });
+
+    for (HandRowBuffer& buffer : buffers) {
+        flush(buffer);
+    }
+
+    writer.write(SolutionExportTable::End);
+    if (!writer.commit()) {
+        return "Error: Could not write solution to " + path.string() + ".";
+    }
+
+    return summary;
+}
@@ -0,0 +1,304 @@
+#include "solver/solver_session.hpp"
+
+#include "game/game_rules.hpp"
+#include "game/game_types.hpp"
+#include "game/holdem/holdem.hpp"
+#include "solver/cfr.hpp"
+#include "solver/distributed.hpp"
+#include "solver/tree.hpp"
+#include "util/fixed_vector.hpp"
+#include "util/result.hpp"
+#include "util/stack_allocator.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+int getNumSolveThreads(const SolveSettings& settings) {
+    #ifdef _OPENMP
+    return settings.numThreads;
+    #else
+    return 1;
+    #endif
+}
+} // namespace
+
+std::optional<std::string> getSolveSettingsError(const SolveSettings& settings) {
+    if (settings.maxIterations < 1) return "Error: maxIterations must be at least 1.";
+    if (settings.exploitabilityCheckFrequency < 1) return "Error: exploitabilityCheckFrequency must be at least 1.";
+    if (settings.numThreads < 1) return "Error: numThreads must be at least 1.";
+    if (settings.pruningRevisitFrequency < 1) return "Error: pruningRevisitFrequency must be at least 1.";
+    if (settings.chanceSamplingIterations < 0) return "Error: chanceSamplingIterations must not be negative.";
+    if (settings.chanceSamplingCards < 1) return "Error: chanceSamplingCards must be at least 1.";
+    return std::nullopt;
+}
+
+SolveResult trainDiscountedCfr(
+    const IGameRules& rules,
+    const SolveSettings& settings,
+    Tree& tree,
+    StackAllocator& allocator,
+    const SolveIterationCallback& onIteration
+) {
+    assert(!getSolveSettingsError(settings));
+    assert(tree.areCfrVectorsInitialized() && !tree.isTrainingDataMemoryMapped());
+
+    GameState initialState = rules.getInitialGameState();
+    float startingPot = static_cast<float>(initialState.totalWagers[Player::P0] + initialState.totalWagers[Player::P1] + tree.deadMoney);
+    auto getExploitabilityPercent = [startingPot](float exploitability) -> float {
+        return (exploitability / startingPot) * 100.0f;
+    };
+
+    SolveResult result = {
+        .status = SolveStatus::MaxIterationsReached,
+        .numIterations = tree.numCompletedIterations,
+        .exploitability = std::nullopt,
+        .exploitabilityPercent = std::nullopt
+    };
+
+    for (int iteration = tree.numCompletedIterations + 1; iteration <= settings.maxIterations; ++iteration) {
+        bool usePruning = settings.usePruning && (iteration % settings.pruningRevisitFrequency != 0);
+
+        // Simultaneous updates train both players in a single traversal, see simultaneousDiscountedCfr
+        if (settings.useSimultaneousUpdates) {
+            int numSampledCards = (iteration <= settings.chanceSamplingIterations) ? settings.chanceSamplingCards : 0;
+            ChanceSampling sampling = { .numSampledCards = numSampledCards, .seed = static_cast<std::uint64_t>(iteration) };
+            simultaneousDiscountedCfr(rules, getDiscountParams(1.5f, 0.0f, 2.0f, iteration), sampling, tree, allocator, usePruning);
+        }
+        else {
+            for (Player hero : { Player::P0, Player::P1 }) {
+                // Using Discounted CFR with alpha = 1.5, beta = 0, gamma = 2
+                // These values work very well in practice, as shown in below paper
+
+                // Brown, N., & Sandholm, T. (2019).
+                // Solving Imperfect-Information Games via Discounted Regret Minimization.
+                // Proceedings of the AAAI Conference on Artificial Intelligence, 33(01), 1829-1836.
+                // https://doi.org/10.1609/aaai.v33i01.33011829
+
+                // Early iterations can sample the chance cards to move away from the uniform starting strategy faster
+                if (iteration <= settings.chanceSamplingIterations) {
+                    ChanceSampling sampling = { .numSampledCards = settings.chanceSamplingCards, .seed = static_cast<std::uint64_t>(iteration) };
+                    sampledDiscountedCfr(hero, rules, getDiscountParams(1.5f, 0.0f, 2.0f, iteration), sampling, tree, allocator, usePruning);
+                }
+                else {
+                    discountedCfr(hero, rules, getDiscountParams(1.5f, 0.0f, 2.0f, iteration), tree, allocator, usePruning);
+                }
+            }
+        }
+
+        // Once a worker is lost every traversal gets zero expected values from the subtrees, so the iteration is not counted
+        const DistributedCoordinator* coordinator = tree.getDistributedCoordinator();
+        if (coordinator && coordinator->getError()) {
+            result.status = SolveStatus::WorkerLost;
+            break;
+        }
+        tree.numCompletedIterations = iteration;
+
+        SolveProgress progress = { .iteration = iteration, .exploitability = std::nullopt, .exploitabilityPercent = std::nullopt };
+        if (iteration % settings.exploitabilityCheckFrequency == 0) {
+            float exploitability = calculateExploitabilityFast(rules, tree, allocator);
+            progress.exploitability = exploitability;
+            progress.exploitabilityPercent = getExploitabilityPercent(exploitability);
+        }
+        bool shouldContinue = !onIteration || onIteration(progress);
+
+        if (progress.exploitabilityPercent && (*progress.exploitabilityPercent <= settings.targetPercentExploitability)) {
+            result.status = SolveStatus::TargetReached;
+            result.exploitability = progress.exploitability;
+            result.exploitabilityPercent = progress.exploitabilityPercent;
+            break;
+        }
+        if (!shouldContinue) {
+            result.status = SolveStatus::Cancelled;
+            break;
+        }
+    }
+
+    if ((result.status == SolveStatus::MaxIterationsReached) && !result.exploitability) {
+        float exploitability = calculateExploitabilityFast(rules, tree, allocator);
+        result.exploitability = exploitability;
+        result.exploitabilityPercent = getExploitabilityPercent(exploitability);
+    }
+
+    result.numIterations = tree.numCompletedIterations;
+    return result;
+}
+
+SolverSession::SolverSession(std::unique_ptr<IGameRules> rules, const SolveSettings& settings) :
+    m_rules{ std::move(rules) },
+    m_settings{ settings },
+    m_tree{ settings.useTrainingDataCompression },
+    m_isSolving{ false },
+    m_isCancelRequested{ false } {
+    assert(m_rules);
+}
+
+Result<std::unique_ptr<SolverSession>> SolverSession::create(std::unique_ptr<IGameRules> rules, const SolveSettings& settings) {
+    if (std::optional<std::string> error = getSolveSettingsError(settings)) {
+        return *error;
+    }
+    return std::unique_ptr<SolverSession>{ new SolverSession{ std::move(rules), settings } };
+}
+
+Result<std::unique_ptr<SolverSession>> SolverSession::createHoldem(const Holdem::Settings& gameSettings, const SolveSettings& settings) {
+    // Checked before the hand tables are built, since that is the slow part
+    if (std::optional<std::string> error = getSolveSettingsError(settings)) {
+        return *error;
+    }
+    return create(std::make_unique<Holdem>(gameSettings), settings);
+}
+
+SolverSession::~SolverSession() {
+    cancel();
+    waitForSolveThread();
+}
+
+std::future<SolveResult> SolverSession::solveAsync(SolveProgressCallback onProgress) {
+    assert(!isSolving());
+
+    // The previous solve has finished, but its thread still has to be joined before it can be replaced
+    waitForSolveThread();
+
+    m_isCancelRequested = false;
+    m_isSolving = true;
+    std::promise<SolveResult> resultPromise;
+    std::future<SolveResult> result = resultPromise.get_future();
+    m_solveThread = std::thread([this, resultPromise = std::move(resultPromise), onProgress = std::move(onProgress)]() mutable {
+        try {
+            SolveResult solveResult = runSolve(onProgress);
+            m_isSolving = false;
+            resultPromise.set_value(solveResult);
+        }
+        catch (...) {
+            m_isSolving = false;
+            resultPromise.set_exception(std::current_exception());
+        }
+    });
+    return result;
+}
+
+SolveResult SolverSession::solve(const SolveProgressCallback& onProgress) {
+    assert(!isSolving());
+
+    m_isCancelRequested = false;
+    m_isSolving = true;
+    try {
+        SolveResult result = runSolve(onProgress);
+        m_isSolving = false;
+        return result;
+    }
+    catch (...) {
+        m_isSolving = false;
+        throw;
+    }
+}
+
+void SolverSession::cancel() {
+    if (isSolving()) {
+        m_isCancelRequested = true;
+    }
+}
+
+bool SolverSession::isSolving() const {
+    return m_isSolving;
+}
+
+const IGameRules& SolverSession::getRules() const {
+    return *m_rules;
+}
+
+const SolveSettings& SolverSession::getSettings() const {
+    return m_settings;
+}
+
+const Tree& SolverSession::getTree() const {
+    assert(!isSolving());
+    return m_tree;
+}
+
+std::span<const float> SolverSession::getStrategy(std::size_t nodeIndex) {
+    if (isSolving() || !m_tree.areCfrVectorsInitialized()) return {};
+
+    assert(nodeIndex < m_tree.allNodes.size());
+    const Node& node = m_tree.allNodes[nodeIndex];
+    if (node.nodeType != NodeType::Decision) return {};
+
+    std::lock_guard<std::mutex> lock{ m_strategyMutex };
+    auto [strategyIt, isNewStrategy] = m_strategies.try_emplace(nodeIndex);
+    std::vector<float>& strategy = strategyIt->second;
+    if (isNewStrategy) {
+        int rangeSize = m_tree.rangeSize[node.playerToAct];
+        strategy.resize(static_cast<std::size_t>(node.numChildren) * rangeSize);
+        for (int hand = 0; hand < rangeSize; ++hand) {
+            FixedVector<float, MaxNumActions> handStrategy = getFinalStrategy(*m_rules, hand, node, m_tree);
+            for (int action = 0; action < node.numChildren; ++action) {
+                strategy[action * rangeSize + hand] = handStrategy[action];
+            }
+        }
+    }
+    return strategy;
+}
+
+SolveResult SolverSession::runSolve(const SolveProgressCallback& onProgress) {
+    {
+        std::lock_guard<std::mutex> lock{ m_strategyMutex };
+        m_strategies.clear();
+    }
+
+    int numThreads = getNumSolveThreads(m_settings);
+    if (!m_tree.isTreeSkeletonBuilt()) {
+        m_tree.buildTreeSkeleton(*m_rules, numThreads);
+    }
+    if (!m_tree.areCfrVectorsInitialized()) {
+        m_tree.initCfrVectors(numThreads);
+    }
+    if (!m_allocator) {
+        m_allocator = std::make_unique<StackAllocator>(numThreads, m_tree.estimateStackAllocatorSize());
+    }
+
+    SolveResult result;
+
+    // An exception must not leave the parallel region, so it is caught on the thread that trains and rethrown after the region
+    std::exception_ptr exception;
+
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(numThreads)
+    #pragma omp single
+    #endif
+    {
+        try {
+            result = trainDiscountedCfr(*m_rules, m_settings, m_tree, *m_allocator, [this, &onProgress](const SolveProgress& progress) {
+                if (onProgress) {
+                    onProgress(progress);
+                }
+                return !m_isCancelRequested;
+            });
+        }
+        catch (...) {
+            exception = std::current_exception();
+        }
+    }
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+    return result;
+}
+
+void SolverSession::waitForSolveThread() {
+    if (m_solveThread.joinable()) {
+        m_solveThread.join();
+    }
+}
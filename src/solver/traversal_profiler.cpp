@@ -0,0 +1,128 @@
+#include "solver/traversal_profiler.hpp"
+
+#include "game/game_types.hpp"
+#include "util/stack_allocator.hpp"
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+TraversalProfiler* activeProfiler = nullptr;
+
+static constexpr std::array<const char*, NumNodeTypes> NodeTypeNames = { "chance", "decision", "fold", "showdown", "allInRunout" };
+} // namespace
+
+#ifdef POSTFLOP_PROFILING
+ThreadProfile* getActiveThreadProfile() {
+    if (!activeProfiler) return nullptr;
+
+    #ifdef _OPENMP
+    std::size_t threadIndex = static_cast<std::size_t>(omp_get_thread_num());
+    #else
+    std::size_t threadIndex = 0;
+    #endif
+
+    // Threads beyond the ones the profiler was created for are not counted
+    std::vector<ThreadProfile>& threadProfiles = activeProfiler->m_threadProfiles;
+    return (threadIndex < threadProfiles.size()) ? &threadProfiles[threadIndex] : nullptr;
+}
+#endif
+
+TraversalProfiler::TraversalProfiler(int numThreads) :
+    m_threadProfiles(numThreads, ThreadProfile{}),
+    m_startTime{},
+    m_wallTime{},
+    m_startCycles{ 0 },
+    m_wallCycles{ 0 } {
+    assert(numThreads > 0);
+}
+
+TraversalProfiler::~TraversalProfiler() {
+    if (activeProfiler == this) {
+        stop();
+    }
+}
+
+void TraversalProfiler::start() {
+    assert(!activeProfiler);
+    activeProfiler = this;
+
+    m_startTime = std::chrono::steady_clock::now();
+    #ifdef POSTFLOP_PROFILING
+    m_startCycles = readCycleCounter();
+    #endif
+}
+
+void TraversalProfiler::stop() {
+    assert(activeProfiler == this);
+    activeProfiler = nullptr;
+
+    m_wallTime += std::chrono::steady_clock::now() - m_startTime;
+    #ifdef POSTFLOP_PROFILING
+    m_wallCycles += readCycleCounter() - m_startCycles;
+    #endif
+}
+
+const std::vector<ThreadProfile>& TraversalProfiler::getThreadProfiles() const {
+    return m_threadProfiles;
+}
+
+bool TraversalProfiler::writeJsonReport(const std::filesystem::path& path, const StackAllocator& allocator) const {
+    std::ofstream file{ path };
+    if (!file) return false;
+
+    std::vector<std::size_t> stackUsages = allocator.getMaximumStackUsage();
+    std::vector<std::size_t> stackBlocks = allocator.getMaximumNumBlocks();
+
+    file << "{\n";
+    file << "  \"profilingEnabled\": " << (IsProfilingEnabled ? "true" : "false") << ",\n";
+    file << "  \"wallSeconds\": " << std::chrono::duration<double>(m_wallTime).count() << ",\n";
+    file << "  \"wallCycles\": " << m_wallCycles << ",\n";
+    file << "  \"threads\": [\n";
+
+    for (std::size_t thread = 0; thread < m_threadProfiles.size(); ++thread) {
+        const ThreadProfile& profile = m_threadProfiles[thread];
+
+        std::uint64_t busyCycles = 0;
+        file << "    {\n";
+        file << "      \"nodes\": {\n";
+        for (int nodeType = 0; nodeType < NumNodeTypes; ++nodeType) {
+            busyCycles += profile.nodeCycles[nodeType];
+            file << "        \"" << NodeTypeNames[nodeType] << "\": { \"count\": " << profile.numNodes[nodeType]
+                << ", \"cycles\": " << profile.nodeCycles[nodeType] << " }" << (nodeType + 1 < NumNodeTypes ? "," : "") << "\n";
+        }
+        file << "      },\n";
+
+        // Whatever is left of the wall time was spent outside of the traversals, or waiting for work at the end of the parallel region
+        std::uint64_t accountedCycles = busyCycles + profile.taskwaitIdleCycles;
+        std::uint64_t idleCycles = (m_wallCycles > accountedCycles) ? m_wallCycles - accountedCycles : 0;
+
+        file << "      \"busyCycles\": " << busyCycles << ",\n";
+        file << "      \"taskwaits\": " << profile.numTaskwaits << ",\n";
+        file << "      \"taskwaitIdleCycles\": " << profile.taskwaitIdleCycles << ",\n";
+        file << "      \"otherIdleCycles\": " << idleCycles << ",\n";
+        file << "      \"tasksSpawned\": " << profile.numTasksSpawned << ",\n";
+        file << "      \"tasksRun\": " << profile.numTasksRun << ",\n";
+
+        bool hasStackUsage = thread < stackUsages.size();
+        file << "      \"maximumStackBytes\": " << (hasStackUsage ? stackUsages[thread] : 0) << ",\n";
+        file << "      \"maximumStackArrays\": " << (hasStackUsage ? stackBlocks[thread] : 0) << "\n";
+        file << "    }" << (thread + 1 < m_threadProfiles.size() ? "," : "") << "\n";
+    }
+
+    file << "  ]\n";
+    file << "}\n";
+
+    return static_cast<bool>(file);
+}
@@ -3,19 +3,38 @@
 #include "game/game_types.hpp"
 #include "game/game_rules.hpp"
 #include "game/game_utils.hpp"
+#include "util/binary_io.hpp"
 #include "util/fixed_vector.hpp"
+#include "util/mapped_file.hpp"
+#include "util/result.hpp"
+#include "util/large_array_allocator.hpp"
+#include "util/stack_allocator.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <queue>
+#include <span>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 namespace {
 // sameHandIndexTable[p][i] = j iff the ith entry in player p's range is equal to the jth entry in the other player's range
 // (or -1 if no such index exists)
 // Used to calculate showdown and fold equity for games with two card hands
+// IGameRules::getRangeIndex finds the hand in the other player's range with a single lookup
 PlayerArray<std::vector<std::int16_t>> buildSameHandIndexTable(const IGameRules& rules) {
     const auto player0Hands = rules.getRangeHands(Player::P0);
     const auto player1Hands = rules.getRangeHands(Player::P1);
@@ -29,11 +48,10 @@ PlayerArray<std::vector<std::int16_t>> buildSameHandIndexTable(const IGameRules&
     };
 
     for (int i = 0; i < player0RangeSize; ++i) {
-        for (int j = i; j < player1RangeSize; ++j) {
-            if (player0Hands[i] == player1Hands[j]) {
-                sameHandIndexTable[Player::P0][i] = static_cast<std::int16_t>(j);
-                sameHandIndexTable[Player::P1][j] = static_cast<std::int16_t>(i);
-            }
+        int j = rules.getRangeIndex(Player::P1, player0Hands[i]);
+        if (j != -1) {
+            sameHandIndexTable[Player::P0][i] = static_cast<std::int16_t>(j);
+            sameHandIndexTable[Player::P1][j] = static_cast<std::int16_t>(i);
         }
     }
 
@@ -52,12 +70,17 @@ PlayerArray<std::array<std::vector<std::int16_t>, 6>> buildIsomorphicHandIndices
                 int twoSuitIndex = mapTwoSuitsToIndex(x, y);
 
                 for (Player player : { Player::P0, Player::P1 }) {
-                    int playerRangeSize = rules.getRangeHands(player).size();
+                    const auto playerHands = rules.getRangeHands(player);
+                    int playerRangeSize = playerHands.size();
 
                     assert(isomorphicHandIndices[player][twoSuitIndex].empty());
                     isomorphicHandIndices[player][twoSuitIndex].resize(playerRangeSize);
                     for (int hand = 0; hand < playerRangeSize; ++hand) {
-                        isomorphicHandIndices[player][twoSuitIndex][hand] = static_cast<std::int16_t>(rules.getHandIndexAfterSuitSwap(player, hand, x, y));
+                        // The suits are isomorphic, so the swapped hand is always in the range
+                        int swappedHand = rules.getRangeIndex(player, swapSetSuits(playerHands[hand], x, y));
+                        assert(swappedHand != -1);
+                        assert(swappedHand == rules.getHandIndexAfterSuitSwap(player, hand, x, y));
+                        isomorphicHandIndices[player][twoSuitIndex][hand] = static_cast<std::int16_t>(swappedHand);
                     }
                 }
             }
@@ -67,34 +90,38 @@ PlayerArray<std::array<std::vector<std::int16_t>, 6>> buildIsomorphicHandIndices
     return isomorphicHandIndices;
 }
 
-double getTotalRangeWeight(const IGameRules& rules) {
-    const auto player0RangeWeights = rules.getInitialRangeWeights(Player::P0);
-    const auto player1RangeWeights = rules.getInitialRangeWeights(Player::P1);
-
-    const auto player0Hands = rules.getRangeHands(Player::P0);
-    const auto player1Hands = rules.getRangeHands(Player::P1);
-
-    int player0RangeSize = player0Hands.size();
-    int player1RangeSize = player1Hands.size();
-
-    CardSet startingBoard = rules.getInitialGameState().currentBoard;
-
-    double totalRangeWeight = 0.0;
-
-    for (int i = 0; i < player0RangeSize; ++i) {
-        if (doSetsOverlap(player0Hands[i], startingBoard)) continue;
-
-        for (int j = 0; j < player1RangeSize; ++j) {
-            if (doSetsOverlap(player0Hands[i] | startingBoard, player1Hands[j])) continue;
-
-            totalRangeWeight += static_cast<double>(player0RangeWeights[i]) * static_cast<double>(player1RangeWeights[j]);
-        }
-    }
+double getSecondsSince(std::chrono::steady_clock::time_point startTime) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
 
-    return totalRangeWeight;
+NodeDetails getNodeDetails(const GameState& state) {
+    return {
+        .totalWagers = state.totalWagers,
+        .previousStreetsWager = state.previousStreetsWager,
+        .lastAction = state.lastAction,
+        .currentStreet = state.currentStreet,
+    };
 }
 
-void createChanceNode(const IGameRules& rules, const GameState& state, std::vector<Node>& allNodes, std::queue<GameState>& queue) {
+// Nodes built breadth first from a single root state
+// Node indices, chance node indices, decision node indices, and training data offsets are all relative to the start of the part
+struct TreePart {
+    std::vector<Node> nodes;
+    std::vector<NodeDetails> nodeDetails;
+    std::vector<ChanceNodeDetails> chanceNodeDetails;
+    std::size_t numDecisionNodes = 0;
+    std::size_t trainingDataSize = 0;
+};
+
+// Subtree that is left as a placeholder node in its parent part and built separately
+struct DeferredSubtree {
+    std::size_t nodeIndex;
+    GameState state;
+};
+
+// Chance cards that get their own child node, in increasing order
+// Cards that are isomorphic to a card with the same value and a representative suit are left out and recorded in suitMappings
+CardSet getCanonicalChanceCards(const IGameRules& rules, CardSet board, FixedVector<SuitMapping, 3>& suitMappings) {
     auto getParentSuit = [](Suit suit, const FixedVector<SuitEquivalenceClass, 4>& isomorphisms) -> Suit {
         for (SuitEquivalenceClass isomorphism : isomorphisms) {
             if (isomorphism.contains(suit)) {
@@ -107,40 +134,19 @@ void createChanceNode(const IGameRules& rules, const GameState& state, std::vect
         return suit;
     };
 
-    std::uint32_t childrenOffset = allNodes.size() + queue.size() + 1;
-
-    // Process child nodes
-    FixedVector<SuitMapping, 3> suitMappings;
-    FixedVector<SuitEquivalenceClass, 4> isomorphisms = rules.getChanceNodeIsomorphisms(state.currentBoard);
-    CardSet availableCards = rules.getDeck() & ~state.currentBoard;
-    int numTotalChanceCards = getSetSize(availableCards);
-    int numCanonicalChanceCards = 0;
+    FixedVector<SuitEquivalenceClass, 4> isomorphisms = rules.getChanceNodeIsomorphisms(board);
+    CardSet availableCards = rules.getDeck() & ~board;
+    CardSet canonicalCards = 0;
 
     CardSet temp = availableCards;
-    for (int i = 0; i < numTotalChanceCards; ++i) {
+    while (temp != 0) {
         CardID nextCard = popLowestCardFromSet(temp);
 
         Suit suit = getCardSuit(nextCard);
         Suit parentSuit = getParentSuit(suit, isomorphisms);
 
         if (suit == parentSuit) {
-            // At a chance node both players should have wagered same amount
-            assert(state.totalWagers[Player::P0] == state.totalWagers[Player::P1]);
-
-            ActionID streetStart = rules.getInitialGameState().lastAction;
-
-            GameState nextState = {
-                .currentBoard = state.currentBoard | cardIDToSet(nextCard), // Add next card to board
-                .totalWagers = state.totalWagers,
-                .previousStreetsWager = state.totalWagers[Player::P0],
-                .playerToAct = Player::P0, // Player 0 always starts a new betting round
-                .lastAction = streetStart,
-                .lastDealtCard = nextCard,
-                .currentStreet = getNextStreet(state.currentStreet), // Advance to the next street after a chance node
-            };
-
-            ++numCanonicalChanceCards;
-            queue.push(nextState);
+            canonicalCards |= cardIDToSet(nextCard);
         }
         else {
             // This card would be equivalent to a card with the same value and the parent suit
@@ -152,29 +158,499 @@ void createChanceNode(const IGameRules& rules, const GameState& state, std::vect
             }
         }
     }
-    assert(temp == 0);
+
+    return canonicalCards;
+}
+
+GameState getStateAfterChanceCard(const IGameRules& rules, const GameState& state, CardID nextCard) {
+    // At a chance node both players should have wagered same amount
+    assert(state.totalWagers[Player::P0] == state.totalWagers[Player::P1]);
+
+    ActionID streetStart = rules.getInitialGameState().lastAction;
+
+    return {
+        .currentBoard = state.currentBoard | cardIDToSet(nextCard), // Add next card to board
+        .totalWagers = state.totalWagers,
+        .previousStreetsWager = state.totalWagers[Player::P0],
+        .playerToAct = Player::P0, // Player 0 always starts a new betting round
+        .lastAction = streetStart,
+        .lastDealtCard = nextCard,
+        .currentStreet = getNextStreet(state.currentStreet), // Advance to the next street after a chance node
+    };
+}
+
+void createChanceNode(
+    const IGameRules& rules,
+    const GameState& state,
+    TreePart& part,
+    std::queue<GameState>& queue
+) {
+    std::uint32_t childrenOffset = part.nodes.size() + queue.size() + 1;
+
+    // Process child nodes
+    FixedVector<SuitMapping, 3> suitMappings;
+    CardSet canonicalCards = getCanonicalChanceCards(rules, state.currentBoard, suitMappings);
+    int numCanonicalChanceCards = getSetSize(canonicalCards);
+    for (int i = 0; i < numCanonicalChanceCards; ++i) {
+        queue.push(getStateAfterChanceCard(rules, state, popLowestCardFromSet(canonicalCards)));
+    }
 
     // Fill in current node information
     Node chanceNode = {
-        .state = state,
+        .board = state.currentBoard,
         .childrenOffset = childrenOffset,
+        .chanceNodeIndex = static_cast<std::uint32_t>(part.chanceNodeDetails.size()),
         .numChildren = static_cast<std::uint8_t>(numCanonicalChanceCards),
         .nodeType = NodeType::Chance,
-        .availableCards = availableCards,
-        .suitMappings = suitMappings
+        .playerToAct = state.playerToAct,
+        .lastDealtCard = state.lastDealtCard,
     };
-    allNodes.push_back(chanceNode);
+    part.nodes.push_back(chanceNode);
+    part.chanceNodeDetails.push_back({ .availableCards = rules.getDeck() & ~state.currentBoard, .suitMappings = suitMappings });
+}
+
+// Builds the part of the tree below the root state using BFS so that the children of a node are adjacent in memory
+// If deferredSubtrees is given, states after the first chance card are only added as placeholder nodes, to be built as their own parts
+void buildTreePart(const IGameRules& rules, const GameState& rootState, TreePart& part, std::vector<DeferredSubtree>* deferredSubtrees) {
+    std::queue<GameState> queue;
+    queue.push(rootState);
+
+    while (!queue.empty()) {
+        GameState state = queue.front();
+        queue.pop();
+
+        if (deferredSubtrees != nullptr && state.currentStreet != rootState.currentStreet) {
+            deferredSubtrees->push_back({ .nodeIndex = part.nodes.size(), .state = state });
+            part.nodes.push_back({});
+            part.nodeDetails.push_back({});
+            continue;
+        }
+
+        switch (rules.getNodeType(state)) {
+            case NodeType::Chance:
+                createChanceNode(rules, state, part, queue);
+                break;
+
+            case NodeType::Decision: {
+                std::uint32_t childrenOffset = part.nodes.size() + queue.size() + 1;
+
+                // Process child nodes
+                FixedVector<ActionID, MaxNumActions> validActions = rules.getValidActions(state);
+                for (ActionID actionID : validActions) {
+                    queue.push(rules.getNewStateAfterDecision(state, actionID));
+                }
+
+                // Fill in current node information
+                Node decisionNode = {
+                    .board = state.currentBoard,
+                    .trainingDataOffset = part.trainingDataSize,
+                    .childrenOffset = childrenOffset,
+                    .decisionNodeIndex = static_cast<std::uint32_t>(part.numDecisionNodes),
+                    .numChildren = static_cast<std::uint8_t>(validActions.size()),
+                    .nodeType = NodeType::Decision,
+                    .playerToAct = state.playerToAct,
+                    .lastDealtCard = state.lastDealtCard,
+                };
+
+                // Update tree
+                part.nodes.push_back(decisionNode);
+                ++part.numDecisionNodes;
+                // Hands blocked by the board never reach this node, so they have no training data
+                part.trainingDataSize += rules.getValidHands(state.playerToAct, state.currentBoard).size() * decisionNode.numChildren;
+
+                break;
+            }
+
+            case NodeType::Fold: {
+                Node foldNode = {
+                    .board = state.currentBoard,
+                    .losingPlayerWager = state.totalWagers[getOpposingPlayer(state.playerToAct)],
+                    .nodeType = NodeType::Fold,
+                    .playerToAct = state.playerToAct,
+                    .lastDealtCard = state.lastDealtCard,
+                };
+                part.nodes.push_back(foldNode);
+
+                break;
+            }
+
+            case NodeType::Showdown: {
+                // At showdown players should have wagered same amount
+                assert(state.totalWagers[Player::P0] == state.totalWagers[Player::P1]);
+
+                // Showdowns can only happen on the river
+                assert(state.currentStreet == Street::River);
+
+                Node showdownNode = {
+                    .board = state.currentBoard,
+                    .losingPlayerWager = state.totalWagers[Player::P0],
+                    .nodeType = NodeType::Showdown,
+                    .playerToAct = state.playerToAct,
+                    .lastDealtCard = state.lastDealtCard,
+                };
+                part.nodes.push_back(showdownNode);
+
+                break;
+            }
+
+            case NodeType::AllInRunout: {
+                // All in runouts only happen after a call, so both players have wagered the same amount
+                assert(state.totalWagers[Player::P0] == state.totalWagers[Player::P1]);
+                assert(state.currentStreet != Street::River);
+
+                Node allInRunoutNode = {
+                    .board = state.currentBoard,
+                    .losingPlayerWager = state.totalWagers[Player::P0],
+                    .nodeType = NodeType::AllInRunout,
+                    .playerToAct = state.playerToAct,
+                    .lastDealtCard = state.lastDealtCard,
+                };
+                part.nodes.push_back(allInRunoutNode);
+
+                break;
+            }
+
+            default:
+                assert(false);
+                break;
+        }
+
+        part.nodeDetails.push_back(getNodeDetails(state));
+    }
+}
+
+// Counts the nodes that buildTreePart would build below the given state, without building them
+// If deferredStates is given, states after the first chance card are collected instead of counted
+void countTreePart(
+    const IGameRules& rules,
+    const GameState& state,
+    Street rootStreet,
+    TreeSizeCounts& counts,
+    std::vector<GameState>* deferredStates
+) {
+    if (deferredStates != nullptr && state.currentStreet != rootStreet) {
+        deferredStates->push_back(state);
+        return;
+    }
+
+    Street street = state.currentStreet;
+    ++counts.numNodes[street];
+
+    switch (rules.getNodeType(state)) {
+        case NodeType::Chance: {
+            ++counts.numChanceNodes[street];
+
+            FixedVector<SuitMapping, 3> suitMappings;
+            CardSet canonicalCards = getCanonicalChanceCards(rules, state.currentBoard, suitMappings);
+            while (canonicalCards != 0) {
+                GameState nextState = getStateAfterChanceCard(rules, state, popLowestCardFromSet(canonicalCards));
+                countTreePart(rules, nextState, rootStreet, counts, deferredStates);
+            }
+            break;
+        }
+
+        case NodeType::Decision: {
+            FixedVector<ActionID, MaxNumActions> validActions = rules.getValidActions(state);
+            ++counts.numDecisionNodes[street];
+            counts.trainingDataSize[street] += rules.getValidHands(state.playerToAct, state.currentBoard).size() * validActions.size();
+
+            for (ActionID actionID : validActions) {
+                countTreePart(rules, rules.getNewStateAfterDecision(state, actionID), rootStreet, counts, deferredStates);
+            }
+            break;
+        }
+
+        case NodeType::AllInRunout: {
+            // Boards are shared by many nodes, so inserting in order is cheap
+            auto& boards = counts.allInRunoutBoards;
+            auto it = std::lower_bound(boards.begin(), boards.end(), state.currentBoard);
+            if (it == boards.end() || *it != state.currentBoard) {
+                boards.insert(it, state.currentBoard);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+TreeSizeCounts addTreeSizeCounts(const TreeSizeCounts& x, const TreeSizeCounts& y) {
+    TreeSizeCounts sum;
+    for (Street street : { Street::Flop, Street::Turn, Street::River }) {
+        sum.numNodes[street] = x.numNodes[street] + y.numNodes[street];
+        sum.numDecisionNodes[street] = x.numDecisionNodes[street] + y.numDecisionNodes[street];
+        sum.numChanceNodes[street] = x.numChanceNodes[street] + y.numChanceNodes[street];
+        sum.trainingDataSize[street] = x.trainingDataSize[street] + y.trainingDataSize[street];
+    }
+
+    // The same board can be reached from several lines of the previous street, so the boards are merged instead of counted
+    std::set_union(
+        x.allInRunoutBoards.begin(), x.allInRunoutBoards.end(),
+        y.allInRunoutBoards.begin(), y.allInRunoutBoards.end(),
+        std::back_inserter(sum.allInRunoutBoards)
+    );
+    return sum;
+}
+
+std::size_t sumOverStreets(const StreetArray<std::size_t>& values) {
+    return values[Street::Flop] + values[Street::Turn] + values[Street::River];
+}
+
+std::size_t getStackBlockSize(std::size_t numFloats) {
+    std::size_t numBytes = numFloats * sizeof(float);
+    return (numBytes + StackAllocator::Alignment - 1) / StackAllocator::Alignment * StackAllocator::Alignment;
+}
+
+// Number of ways to deal the rest of the board at an all in runout node
+int getNumAllInRunouts(const IGameRules& rules, CardSet board) {
+    int numAvailableCards = getSetSize(rules.getDeck() & ~board);
+    int numCardsToCome = StandardBoardSize - getSetSize(board);
+    switch (numCardsToCome) {
+        case 1:
+            return numAvailableCards;
+        case 2:
+            return numAvailableCards * (numAvailableCards - 1) / 2;
+        default:
+            assert(false);
+            return 0;
+    }
+}
+
+// Calls addRunout with the cards that complete the board, for every way to deal the rest of the board at an all in runout node
+template <typename Function>
+void forEachAllInRunout(const IGameRules& rules, CardSet board, Function addRunout) {
+    int numCardsToCome = StandardBoardSize - getSetSize(board);
+    assert(numCardsToCome == 1 || numCardsToCome == 2);
+
+    CardSet firstCards = rules.getDeck() & ~board;
+    while (firstCards != 0) {
+        CardID firstCard = popLowestCardFromSet(firstCards);
+        if (numCardsToCome == 1) {
+            addRunout(cardIDToSet(firstCard));
+            continue;
+        }
+
+        // Only deal the second card from the cards above the first so that each runout is visited once
+        CardSet secondCards = firstCards;
+        while (secondCards != 0) {
+            addRunout(cardIDToSet(firstCard) | cardIDToSet(popLowestCardFromSet(secondCards)));
+        }
+    }
+}
+
+// Compares the hand ranks of every pair of hands after every runout of the table's board
+void buildAllInRunoutOutcomes(const IGameRules& rules, AllInRunoutTable& table) {
+    const auto player0Hands = rules.getRangeHands(Player::P0);
+    const auto player1Hands = rules.getRangeHands(Player::P1);
+    std::size_t player1RangeSize = player1Hands.size();
+
+    // Each outcome adds at most 2 per runout
+    assert(2 * getNumAllInRunouts(rules, table.board) <= std::numeric_limits<std::uint16_t>::max());
+    table.outcomes.assign(player0Hands.size() * player1RangeSize, 0);
+
+    // Player 1 hands that overlap the runout are marked invalid instead of being removed, so that the inner loop runs over the whole range
+    std::vector<HandRank> player1HandRanks(player1RangeSize, 0);
+    std::vector<std::uint8_t> isPlayer1HandValid(player1RangeSize, 0);
+
+    forEachAllInRunout(rules, table.board, [&](CardSet runout) -> void {
+        CardSet riverBoard = table.board | runout;
+
+        std::fill(isPlayer1HandValid.begin(), isPlayer1HandValid.end(), 0);
+        for (RankedHand rankedHand : rules.getValidSortedHandRanks(Player::P1, riverBoard)) {
+            player1HandRanks[rankedHand.info.index] = rankedHand.rank;
+            isPlayer1HandValid[rankedHand.info.index] = 1;
+        }
+
+        for (RankedHand player0RankedHand : rules.getValidSortedHandRanks(Player::P0, riverBoard)) {
+            std::uint16_t* outcomes = table.outcomes.data() + static_cast<std::size_t>(player0RankedHand.info.index) * player1RangeSize;
+            for (std::size_t hand1 = 0; hand1 < player1RangeSize; ++hand1) {
+                std::uint16_t outcome = (player0RankedHand.rank > player1HandRanks[hand1]) ? 2 : (player0RankedHand.rank == player1HandRanks[hand1]) ? 1 : 0;
+                outcomes[hand1] += isPlayer1HandValid[hand1] ? outcome : 0;
+            }
+        }
+    });
+
+    // Pairs of hands that overlap each other were compared as if both could be dealt
+    for (std::size_t hand0 = 0; hand0 < player0Hands.size(); ++hand0) {
+        for (std::size_t hand1 = 0; hand1 < player1RangeSize; ++hand1) {
+            if (doSetsOverlap(player0Hands[hand0], player1Hands[hand1])) {
+                table.outcomes[hand0 * player1RangeSize + hand1] = 0;
+            }
+        }
+    }
+}
+
+// The outcome tables are counted at their full size, even before a traversal builds them
+std::size_t getAllInRunoutTablesHeapSize(std::size_t numBoards, const PlayerArray<std::size_t>& rangeSizes) {
+    std::size_t outcomesSize = rangeSizes[Player::P0] * rangeSizes[Player::P1] * sizeof(std::uint16_t);
+    return numBoards * (sizeof(std::unique_ptr<AllInRunoutTable>) + sizeof(AllInRunoutTable) + outcomesSize);
+}
+
+// Largest total size of the temporary arrays that are live at once on the path from the given node to a leaf
+std::size_t getMaximumPathStackSize(const Tree& tree, std::size_t nodeIndex, std::size_t maxRangeSize) {
+    const Node& node = tree.allNodes[nodeIndex];
+
+    std::size_t nodeStackSize;
+    switch (node.nodeType) {
+        case NodeType::Chance:
+            // Expected values for every card for both players, and reach probabilities for the card being traversed
+            nodeStackSize = 2 * getStackBlockSize(node.numChildren * maxRangeSize) + 2 * getStackBlockSize(maxRangeSize);
+            break;
+
+        case NodeType::Decision:
+            // Strategy, expected values and decoded training data for every action,
+            // a strategy normalization buffer, and reach probabilities for the action being traversed
+            nodeStackSize = 4 * getStackBlockSize(node.numChildren * maxRangeSize) + 3 * getStackBlockSize(maxRangeSize);
+            break;
+
+        case NodeType::Fold:
+        case NodeType::Showdown:
+        case NodeType::AllInRunout:
+            return 0;
+
+        default:
+            assert(false);
+            return 0;
+    }
+
+    std::size_t maxChildStackSize = 0;
+    for (int child = 0; child < node.numChildren; ++child) {
+        maxChildStackSize = std::max(maxChildStackSize, getMaximumPathStackSize(tree, node.childrenOffset + child, maxRangeSize));
+    }
+    return nodeStackSize + maxChildStackSize;
+}
+
+// Bump the version whenever Node or the file layout changes
+static constexpr std::uint32_t TreeFileMagic = 0x50465354; // "PFST"
+static constexpr std::uint32_t TreeFileVersion = 7;
+
+// Training data starts at a cache line aligned offset so that it can be used directly from a memory mapped file
+static constexpr std::size_t TrainingDataAlignment = 64;
+
+static_assert(std::is_trivially_copyable_v<Node>);
+static_assert(std::is_trivially_copyable_v<NodeDetails>);
+static_assert(std::is_trivially_copyable_v<ChanceNodeDetails>);
+
+template <typename T>
+bool areSpansEqual(std::span<const T> x, std::span<const T> y) {
+    return std::equal(x.begin(), x.end(), y.begin(), y.end());
+}
+
+// The game rules only know about boards that can be dealt from the starting board, so boards read from a file are checked before they are used
+bool isLoadedBoardValid(CardSet board, Street street, const IGameRules& rules, const GameState& initialState) {
+    if (street > Street::River) return false;
+    if ((board & initialState.currentBoard) != initialState.currentBoard) return false;
+    if ((board & ~rules.getDeck()) != 0) return false;
+
+    int numDealtCards = getSetSize(board & ~initialState.currentBoard);
+    return numDealtCards == static_cast<int>(street) - static_cast<int>(initialState.currentStreet);
+}
+
+// Checks that a node read from a file cannot cause out of bounds accesses
+bool isLoadedNodeValid(
+    const Node& node,
+    const NodeDetails& details,
+    const IGameRules& rules,
+    const GameState& initialState,
+    const Tree& tree,
+    std::size_t trainingDataSize,
+    std::size_t numDecisionNodes
+) {
+    if (!isLoadedBoardValid(node.board, details.currentStreet, rules, initialState)) return false;
+
+    std::size_t numNodes = tree.allNodes.size();
+    switch (node.nodeType) {
+        case NodeType::Chance:
+            if (node.chanceNodeIndex >= tree.allChanceNodeDetails.size()) return false;
+            return (node.numChildren > 0) && (static_cast<std::size_t>(node.childrenOffset) + node.numChildren <= numNodes);
+
+        case NodeType::Decision: {
+            if (node.numChildren == 0 || node.numChildren > MaxNumActions) return false;
+            if (static_cast<std::size_t>(node.childrenOffset) + node.numChildren > numNodes) return false;
+            if (node.playerToAct != Player::P0 && node.playerToAct != Player::P1) return false;
+            if (node.decisionNodeIndex >= numDecisionNodes) return false;
+
+            std::size_t nodeTrainingDataSize = static_cast<std::size_t>(node.numChildren) * rules.getValidHands(node.playerToAct, node.board).size();
+            return (node.trainingDataOffset <= trainingDataSize) && (nodeTrainingDataSize <= trainingDataSize - node.trainingDataOffset);
+        }
+
+        case NodeType::Fold:
+            return node.playerToAct == Player::P0 || node.playerToAct == Player::P1;
+
+        case NodeType::Showdown:
+            return true;
+
+        case NodeType::AllInRunout:
+            return details.currentStreet != Street::River;
+
+        default:
+            return false;
+    }
+}
+
+template <typename T>
+void zeroTrainingDataRange(TrainingDataVector<T>& trainingData, std::size_t offset, std::size_t size) {
+    std::fill_n(trainingData.begin() + offset, size, T{ 0 });
 }
 } // namespace
 
-Tree::Tree() :
+double getNonOverlappingPairWeight(const IGameRules& rules, CardSet board, const PlayerArray<std::span<const float>>& weights) {
+    const auto player0Hands = rules.getRangeHands(Player::P0);
+    const auto player1Hands = rules.getRangeHands(Player::P1);
+
+    // Instead of checking every pair, each player 0 hand takes the total weight of the player 1 range and subtracts the hands it blocks:
+    // the hands that contain any of its cards, adding back the identical hand, which contains both cards and was subtracted twice
+    double player1TotalWeight = 0.0;
+    std::array<double, StandardDeckSize> player1CardWeights = {};
+    for (std::size_t j = 0; j < player1Hands.size(); ++j) {
+        if (doSetsOverlap(player1Hands[j], board)) continue;
+
+        double weight = static_cast<double>(weights[Player::P1][j]);
+        player1TotalWeight += weight;
+
+        CardSet hand = player1Hands[j];
+        while (hand != 0) {
+            player1CardWeights[popLowestCardFromSet(hand)] += weight;
+        }
+    }
+
+    double totalWeight = 0.0;
+
+    for (std::size_t i = 0; i < player0Hands.size(); ++i) {
+        if ((weights[Player::P0][i] == 0.0f) || doSetsOverlap(player0Hands[i], board)) continue;
+
+        double player1ValidWeight = player1TotalWeight;
+        CardSet hand = player0Hands[i];
+        while (hand != 0) {
+            player1ValidWeight -= player1CardWeights[popLowestCardFromSet(hand)];
+        }
+
+        if (getSetSize(player0Hands[i]) == 2) {
+            int sameHand = rules.getRangeIndex(Player::P1, player0Hands[i]);
+            if (sameHand != -1) {
+                player1ValidWeight += static_cast<double>(weights[Player::P1][sameHand]);
+            }
+        }
+
+        totalWeight += static_cast<double>(weights[Player::P0][i]) * player1ValidWeight;
+    }
+
+    return totalWeight;
+}
+
+Tree::Tree(bool useTrainingDataCompression) :
     gameHandSize{ 0 },
     rangeSize{ 0, 0 },
     deadMoney{ 0 },
     totalRangeWeight{ 0.0 },
     startingStreet{ Street::Flop },
+    numCompletedIterations{ 0 },
     m_trainingDataSize{ 0 },
-    m_numDecisionNodes{ 0 } {
+    m_numDecisionNodes{ 0 },
+    m_useTrainingDataCompression{ useTrainingDataCompression },
+    m_isTrainingDataPartial{ false },
+    m_distributedCoordinator{ nullptr } {
 }
 
 bool Tree::isTreeSkeletonBuilt() const {
@@ -182,15 +658,19 @@ bool Tree::isTreeSkeletonBuilt() const {
 }
 
 bool Tree::areCfrVectorsInitialized() const {
-    return !allStrategySums.empty();
+    return !allStrategySums.empty() || !allCompressedStrategySums.empty() || isTrainingDataMemoryMapped();
+}
+
+bool Tree::isTrainingDataCompressed() const {
+    return m_useTrainingDataCompression;
 }
 
-void Tree::buildTreeSkeleton(const IGameRules& rules) {
+void Tree::buildTreeSkeleton(const IGameRules& rules, int numThreads) {
     if (isTreeSkeletonBuilt()) {
         return;
     };
 
-    buildAllNodes(rules);
+    auto setupStartTime = std::chrono::steady_clock::now();
 
     PlayerArray<std::span<const CardSet>> rangeHands = {
         rules.getRangeHands(Player::P0),
@@ -208,19 +688,39 @@ void Tree::buildTreeSkeleton(const IGameRules& rules) {
         static_cast<int>(rangeHands[Player::P1].size()),
     };
 
-    if (gameHandSize == 2) {
-        sameHandIndexTable = buildSameHandIndexTable(rules);
-    }
-
-    isomorphicHandIndices = buildIsomorphicHandIndices(rules);
+    // The hand tables and range weight only depend on the ranges, so they are built on another thread while the nodes are built
+    // The node building already uses every thread, so the hand table stages run one after another
+    auto handTablesFuture = std::async(std::launch::async, [this, &rules]() -> void {
+        auto stageStartTime = std::chrono::steady_clock::now();
+        if (gameHandSize == 2) {
+            sameHandIndexTable = buildSameHandIndexTable(rules);
+        }
+        isomorphicHandIndices = buildIsomorphicHandIndices(rules);
+        m_setupTimings.handIndexTablesSeconds = getSecondsSince(stageStartTime);
+
+        // Range weight of 0 means that there are no valid combos of hands
+        stageStartTime = std::chrono::steady_clock::now();
+        PlayerArray<std::span<const float>> rangeWeights = { rules.getInitialRangeWeights(Player::P0), rules.getInitialRangeWeights(Player::P1) };
+        totalRangeWeight = getNonOverlappingPairWeight(rules, rules.getInitialGameState().currentBoard, rangeWeights);
+        assert(totalRangeWeight > 0.0);
+        m_setupTimings.rangeWeightSeconds = getSecondsSince(stageStartTime);
+    });
+
+    auto nodesStartTime = std::chrono::steady_clock::now();
+    buildAllNodes(rules, numThreads);
+    initAllInRunoutTables();
+    m_setupTimings.nodesSeconds = getSecondsSince(nodesStartTime);
 
     deadMoney = rules.getDeadMoney();
+    startingStreet = rules.getInitialGameState().currentStreet;
 
-    // Range weight of 0 means that there are no valid combos of hands
-    totalRangeWeight = getTotalRangeWeight(rules);
-    assert(totalRangeWeight > 0.0);
+    // get() rethrows an exception from the hand table thread, such as std::bad_alloc
+    handTablesFuture.get();
+    m_setupTimings.totalSeconds = getSecondsSince(setupStartTime);
+}
 
-    startingStreet = rules.getInitialGameState().currentStreet;
+const TreeSetupTimings& Tree::getSetupTimings() const {
+    return m_setupTimings;
 }
 
 std::size_t Tree::getNumberOfDecisionNodes() const {
@@ -232,109 +732,675 @@ std::size_t Tree::getTreeSkeletonSize() const {
     assert(isTreeSkeletonBuilt());
 
     std::size_t treeStackSize = sizeof(Tree);
-    std::size_t nodesHeapSize = allNodes.capacity() * sizeof(Node);
+    std::size_t nodesHeapSize = allNodes.capacity() * sizeof(Node)
+        + allNodeDetails.capacity() * sizeof(NodeDetails)
+        + allChanceNodeDetails.capacity() * sizeof(ChanceNodeDetails);
     std::size_t sameHandIndexTableHeapSize = (sameHandIndexTable[Player::P0].capacity() + sameHandIndexTable[Player::P1].capacity()) * sizeof(std::int16_t);
     std::size_t isomorphicHandIndicesHeapSize = 0;
     for (int i = 0; i < 6; ++i) {
         isomorphicHandIndicesHeapSize += (isomorphicHandIndices[Player::P0][i].capacity() + isomorphicHandIndices[Player::P1][i].capacity()) * sizeof(std::int16_t);
     }
 
-    return treeStackSize + nodesHeapSize + sameHandIndexTableHeapSize + isomorphicHandIndicesHeapSize;
+    PlayerArray<std::size_t> rangeSizes = {
+        static_cast<std::size_t>(rangeSize[Player::P0]),
+        static_cast<std::size_t>(rangeSize[Player::P1])
+    };
+    std::size_t allInRunoutTablesHeapSize = getAllInRunoutTablesHeapSize(m_allInRunoutTables.size(), rangeSizes);
+
+    return treeStackSize + nodesHeapSize + sameHandIndexTableHeapSize + isomorphicHandIndicesHeapSize + allInRunoutTablesHeapSize;
 }
 
-std::size_t Tree::estimateFullTreeSize() const {
-    assert(isTreeSkeletonBuilt());
+TreeSizeCounts Tree::countTreeSize(const IGameRules& rules, int numThreads) {
+    GameState initialState = rules.getInitialGameState();
 
-    // allStrategySums and allRegretSums each have m_trainingDataLength elements
-    std::size_t trainingDataHeapSize = (m_trainingDataSize * 2) * sizeof(float);
+    // Split the tree the same way as buildAllNodes so that the subtrees after the first chance card can be counted in parallel
+    TreeSizeCounts rootCounts = {};
+    std::vector<GameState> deferredStates;
+    countTreePart(rules, initialState, initialState.currentStreet, rootCounts, &deferredStates);
 
-    return getTreeSkeletonSize() + trainingDataHeapSize;
+    std::vector<TreeSizeCounts> subtreeCounts(deferredStates.size(), TreeSizeCounts{});
+    #ifdef _OPENMP
+    #pragma omp parallel for num_threads(numThreads) schedule(dynamic)
+    #endif
+    for (int i = 0; i < static_cast<int>(deferredStates.size()); ++i) {
+        countTreePart(rules, deferredStates[i], deferredStates[i].currentStreet, subtreeCounts[i], nullptr);
+    }
+
+    TreeSizeCounts counts = rootCounts;
+    for (const TreeSizeCounts& subtree : subtreeCounts) {
+        counts = addTreeSizeCounts(counts, subtree);
+    }
+    return counts;
 }
 
-void Tree::buildAllNodes(const IGameRules& rules) {
-    // We build the tree using BFS so that the children of a node are adjacent in memory
-    std::queue<GameState> queue;
-    queue.push(rules.getInitialGameState());
+std::size_t Tree::estimateTreeSkeletonSize(const IGameRules& rules, const TreeSizeCounts& counts) const {
+    PlayerArray<std::size_t> rangeSizes = {
+        rules.getRangeHands(Player::P0).size(),
+        rules.getRangeHands(Player::P1).size()
+    };
+    std::size_t totalRangeSize = rangeSizes[Player::P0] + rangeSizes[Player::P1];
 
-    while (!queue.empty()) {
-        GameState state = queue.front();
-        queue.pop();
+    std::size_t treeStackSize = sizeof(Tree);
+    std::size_t nodesHeapSize = sumOverStreets(counts.numNodes) * (sizeof(Node) + sizeof(NodeDetails))
+        + sumOverStreets(counts.numChanceNodes) * sizeof(ChanceNodeDetails);
 
-        switch (rules.getNodeType(state)) {
-            case NodeType::Chance:
-                createChanceNode(rules, state, allNodes, queue);
-                break;
+    // The same hand index table is only built for games with two card hands
+    bool hasTwoCardHands = getSetSize(rules.getRangeHands(Player::P0)[0]) == 2;
+    std::size_t sameHandIndexTableHeapSize = hasTwoCardHands ? totalRangeSize * sizeof(std::int16_t) : 0;
 
-            case NodeType::Decision: {
-                std::uint32_t childrenOffset = allNodes.size() + queue.size() + 1;
+    // There is one isomorphic hand index table for each pair of isomorphic suits on the starting board
+    std::size_t numIsomorphicSuitPairs = 0;
+    for (const SuitEquivalenceClass& isomorphism : rules.getChanceNodeIsomorphisms(rules.getInitialGameState().currentBoard)) {
+        numIsomorphicSuitPairs += static_cast<std::size_t>(isomorphism.size() * (isomorphism.size() - 1) / 2);
+    }
+    std::size_t isomorphicHandIndicesHeapSize = numIsomorphicSuitPairs * totalRangeSize * sizeof(std::int16_t);
 
-                // Process child nodes
-                FixedVector<ActionID, MaxNumActions> validActions = rules.getValidActions(state);
-                for (ActionID actionID : validActions) {
-                    queue.push(rules.getNewStateAfterDecision(state, actionID));
-                }
+    std::size_t allInRunoutTablesHeapSize = getAllInRunoutTablesHeapSize(counts.allInRunoutBoards.size(), rangeSizes);
 
-                // Fill in current node information
-                Node decisionNode = {
-                    .state = state,
-                    .childrenOffset = childrenOffset,
-                    .numChildren = static_cast<std::uint8_t>(validActions.size()),
-                    .nodeType = NodeType::Decision,
-                    .trainingDataOffset = m_trainingDataSize,
-                };
+    return treeStackSize + nodesHeapSize + sameHandIndexTableHeapSize + isomorphicHandIndicesHeapSize + allInRunoutTablesHeapSize;
+}
 
-                // Update tree
-                allNodes.push_back(decisionNode);
-                ++m_numDecisionNodes;
-                m_trainingDataSize += rules.getInitialRangeWeights(state.playerToAct).size() * decisionNode.numChildren;
+std::size_t Tree::estimateFullTreeSize(const IGameRules& rules, const TreeSizeCounts& counts) const {
+    std::size_t trainingDataHeapSize = getTrainingDataHeapSize(sumOverStreets(counts.trainingDataSize), sumOverStreets(counts.numDecisionNodes));
+    return estimateTreeSkeletonSize(rules, counts) + trainingDataHeapSize;
+}
 
-                break;
-            }
+std::size_t Tree::getTrainingDataHeapSize(std::size_t trainingDataSize, std::size_t numDecisionNodes) const {
+    if (m_useTrainingDataCompression) {
+        // allCompressedStrategySums and allCompressedRegretSums each have trainingDataSize elements
+        // allStrategySumScales and allRegretSumScales each have numDecisionNodes elements
+        // allLastDiscountedIterations has numDecisionNodes elements
+        return trainingDataSize * (sizeof(std::uint16_t) + sizeof(std::int16_t)) + (numDecisionNodes * 2) * sizeof(float) + numDecisionNodes * sizeof(std::int32_t);
+    }
+    else {
+        // allStrategySums and allRegretSums each have trainingDataSize elements
+        // allLastDiscountedIterations has numDecisionNodes elements
+        return (trainingDataSize * 2) * sizeof(float) + numDecisionNodes * sizeof(std::int32_t);
+    }
+}
 
-            case NodeType::Fold: {
-                Node foldNode = {
-                    .state = state,
-                    .nodeType = NodeType::Fold
-                };
-                allNodes.push_back(foldNode);
+std::size_t Tree::estimateStackAllocatorSize() const {
+    assert(isTreeSkeletonBuilt());
 
-                break;
+    std::size_t maxRangeSize = static_cast<std::size_t>(std::max(rangeSize[Player::P0], rangeSize[Player::P1]));
+
+    // The root allocates reach probabilities for both players and the output expected values
+    return 3 * getStackBlockSize(maxRangeSize) + getMaximumPathStackSize(*this, 0, maxRangeSize);
+}
+
+void Tree::buildAllNodes(const IGameRules& rules, int numThreads) {
+    // Build everything before the first chance card, leaving a placeholder for each subtree after it
+    // The split does not depend on the number of threads, so the layout of the tree is always the same
+    TreePart rootPart;
+    std::vector<DeferredSubtree> deferredSubtrees;
+    buildTreePart(rules, rules.getInitialGameState(), rootPart, &deferredSubtrees);
+
+    // Build the subtrees concurrently, each with its own node indices starting from 0
+    std::vector<TreePart> subtreeParts(deferredSubtrees.size());
+    #ifdef _OPENMP
+    #pragma omp parallel for num_threads(numThreads) schedule(dynamic)
+    #endif
+    for (int i = 0; i < static_cast<int>(deferredSubtrees.size()); ++i) {
+        buildTreePart(rules, deferredSubtrees[i].state, subtreeParts[i], nullptr);
+    }
+
+    // Each subtree root replaces its placeholder, and the rest of the subtree is appended after the previous subtrees
+    // Children of a node stay adjacent because each part was built breadth first
+    struct SubtreeOffsets {
+        std::size_t node;
+        std::size_t chanceNode;
+        std::size_t decisionNode;
+        std::size_t trainingData;
+    };
+    std::vector<SubtreeOffsets> subtreeOffsets(subtreeParts.size());
+    SubtreeOffsets nextOffsets = {
+        .node = rootPart.nodes.size(),
+        .chanceNode = rootPart.chanceNodeDetails.size(),
+        .decisionNode = rootPart.numDecisionNodes,
+        .trainingData = rootPart.trainingDataSize,
+    };
+    for (std::size_t i = 0; i < subtreeParts.size(); ++i) {
+        subtreeOffsets[i] = nextOffsets;
+        nextOffsets.node += subtreeParts[i].nodes.size() - 1;
+        nextOffsets.chanceNode += subtreeParts[i].chanceNodeDetails.size();
+        nextOffsets.decisionNode += subtreeParts[i].numDecisionNodes;
+        nextOffsets.trainingData += subtreeParts[i].trainingDataSize;
+    }
+
+    // Node indices must fit in childrenOffset
+    assert(nextOffsets.node <= std::numeric_limits<std::uint32_t>::max());
+
+    m_subtreeTrainingDataBlocks.clear();
+    for (std::size_t i = 0; i < subtreeParts.size(); ++i) {
+        m_subtreeTrainingDataBlocks.push_back({
+            .nodeIndex = deferredSubtrees[i].nodeIndex,
+            .trainingDataOffset = subtreeOffsets[i].trainingData,
+            .trainingDataSize = subtreeParts[i].trainingDataSize,
+        });
+    }
+    std::sort(m_subtreeTrainingDataBlocks.begin(), m_subtreeTrainingDataBlocks.end(), [](const SubtreeTrainingDataBlock& a, const SubtreeTrainingDataBlock& b) {
+        return a.nodeIndex < b.nodeIndex;
+    });
+
+    allNodes = std::move(rootPart.nodes);
+    allNodeDetails = std::move(rootPart.nodeDetails);
+    allChanceNodeDetails = std::move(rootPart.chanceNodeDetails);
+    allNodes.resize(nextOffsets.node);
+    allNodeDetails.resize(nextOffsets.node);
+    allChanceNodeDetails.resize(nextOffsets.chanceNode);
+    m_numDecisionNodes = nextOffsets.decisionNode;
+    m_trainingDataSize = nextOffsets.trainingData;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for num_threads(numThreads) schedule(dynamic)
+    #endif
+    for (int i = 0; i < static_cast<int>(subtreeParts.size()); ++i) {
+        TreePart& part = subtreeParts[i];
+        const SubtreeOffsets& offsets = subtreeOffsets[i];
+
+        for (std::size_t localIndex = 0; localIndex < part.nodes.size(); ++localIndex) {
+            Node node = part.nodes[localIndex];
+            switch (node.nodeType) {
+                case NodeType::Chance:
+                    // Children are never the subtree root, so they are shifted the same way as every other non root node
+                    node.childrenOffset += static_cast<std::uint32_t>(offsets.node - 1);
+                    node.chanceNodeIndex += static_cast<std::uint32_t>(offsets.chanceNode);
+                    break;
+
+                case NodeType::Decision:
+                    node.childrenOffset += static_cast<std::uint32_t>(offsets.node - 1);
+                    node.decisionNodeIndex += static_cast<std::uint32_t>(offsets.decisionNode);
+                    node.trainingDataOffset += offsets.trainingData;
+                    break;
+
+                default:
+                    break;
             }
 
-            case NodeType::Showdown: {
-                // At showdown players should have wagered same amount
-                assert(state.totalWagers[Player::P0] == state.totalWagers[Player::P1]);
+            std::size_t nodeIndex = (localIndex == 0) ? deferredSubtrees[i].nodeIndex : offsets.node + localIndex - 1;
+            allNodes[nodeIndex] = node;
+            allNodeDetails[nodeIndex] = part.nodeDetails[localIndex];
+        }
 
-                // Showdowns can only happen on the river
-                assert(state.currentStreet == Street::River);
+        std::copy(part.chanceNodeDetails.begin(), part.chanceNodeDetails.end(), allChanceNodeDetails.begin() + offsets.chanceNode);
 
-                Node showdownNode = {
-                    .state = state,
-                    .nodeType = NodeType::Showdown
-                };
-                allNodes.push_back(showdownNode);
+        // Free each part as soon as it is copied to keep the peak memory down
+        part = {};
+    }
 
+    // Free unnecessary memory - vectors are done growing
+    allNodes.shrink_to_fit();
+    allNodeDetails.shrink_to_fit();
+    allChanceNodeDetails.shrink_to_fit();
+
+    // Estimate the work in each subtree in units of per hand operations
+    // Children always come after their parent in the node array, so iterating in reverse visits children first
+    float handsPerNode = static_cast<float>(rules.getRangeHands(Player::P0).size() + rules.getRangeHands(Player::P1).size());
+    for (std::size_t i = allNodes.size(); i-- > 0;) {
+        Node& node = allNodes[i];
+        switch (node.nodeType) {
+            case NodeType::Chance:
+            case NodeType::Decision:
+                // Each child needs new reach probabilities and expected values for every hand
+                node.subtreeWork = static_cast<float>(node.numChildren) * handsPerNode;
+                for (int child = 0; child < node.numChildren; ++child) {
+                    node.subtreeWork += allNodes[node.childrenOffset + child].subtreeWork;
+                }
+                break;
+
+            case NodeType::Fold:
+            case NodeType::Showdown:
+                // Terminal nodes sweep over both ranges
+                node.subtreeWork = handsPerNode;
+                break;
+
+            case NodeType::AllInRunout:
+                // All in runout nodes read the outcome of every pair of hands from the board's all in runout table
+                node.subtreeWork = static_cast<float>(rules.getRangeHands(Player::P0).size() * rules.getRangeHands(Player::P1).size());
                 break;
-            }
 
             default:
                 assert(false);
                 break;
         }
     }
+}
 
-    // Free unnecessary memory - vector is done growing
-    allNodes.shrink_to_fit();
+void Tree::initAllInRunoutTables() {
+    std::vector<CardSet> allInRunoutBoards;
+    for (const Node& node : allNodes) {
+        if (node.nodeType == NodeType::AllInRunout) {
+            allInRunoutBoards.push_back(node.board);
+        }
+    }
+    std::sort(allInRunoutBoards.begin(), allInRunoutBoards.end());
+    allInRunoutBoards.erase(std::unique(allInRunoutBoards.begin(), allInRunoutBoards.end()), allInRunoutBoards.end());
+
+    m_allInRunoutTables.clear();
+    m_allInRunoutTables.reserve(allInRunoutBoards.size());
+    for (CardSet board : allInRunoutBoards) {
+        m_allInRunoutTables.push_back(std::make_unique<AllInRunoutTable>());
+        m_allInRunoutTables.back()->board = board;
+    }
+}
+
+const AllInRunoutTable& Tree::getAllInRunoutTable(const IGameRules& rules, CardSet board) {
+    auto it = std::lower_bound(
+        m_allInRunoutTables.begin(),
+        m_allInRunoutTables.end(),
+        board,
+        [](const std::unique_ptr<AllInRunoutTable>& table, CardSet board) { return table->board < board; }
+    );
+    assert(it != m_allInRunoutTables.end() && (*it)->board == board);
+
+    AllInRunoutTable& table = **it;
+    std::call_once(table.buildFlag, [&rules, &table]() { buildAllInRunoutOutcomes(rules, table); });
+    return table;
+}
+
+void Tree::initCfrVectors(int numThreads) {
+    resizeTrainingData();
+    zeroTrainingData(numThreads, [](std::size_t) { return true; });
+    m_isTrainingDataPartial = false;
+}
+
+void Tree::initCfrVectors(int numThreads, const std::function<bool(std::size_t)>& isSubtreeOwned) {
+    resizeTrainingData();
+    zeroTrainingData(numThreads, isSubtreeOwned);
+    m_isTrainingDataPartial = true;
+}
+
+bool Tree::isTrainingDataPartial() const {
+    return m_isTrainingDataPartial;
+}
+
+void Tree::setDistributedCoordinator(DistributedCoordinator* coordinator) {
+    m_distributedCoordinator = coordinator;
 }
 
-void Tree::initCfrVectors() {
+DistributedCoordinator* Tree::getDistributedCoordinator() const {
+    return m_distributedCoordinator;
+}
+
+std::size_t Tree::getNumberOfSubtrees() const {
+    return m_subtreeTrainingDataBlocks.size();
+}
+
+std::optional<std::size_t> Tree::getSubtreeIndex(std::size_t nodeIndex) const {
+    auto block = std::lower_bound(
+        m_subtreeTrainingDataBlocks.begin(),
+        m_subtreeTrainingDataBlocks.end(),
+        nodeIndex,
+        [](const SubtreeTrainingDataBlock& block, std::size_t index) { return block.nodeIndex < index; }
+    );
+    if ((block == m_subtreeTrainingDataBlocks.end()) || (block->nodeIndex != nodeIndex)) return std::nullopt;
+    return static_cast<std::size_t>(block - m_subtreeTrainingDataBlocks.begin());
+}
+
+void Tree::resizeTrainingData() {
     assert(isTreeSkeletonBuilt());
 
-    allStrategySums.assign(m_trainingDataSize, 0.0f);
-    allRegretSums.assign(m_trainingDataSize, 0.0f);
+    // Growing the vectors does not write to them, so that zeroTrainingData is the first to touch every page
+    if (m_useTrainingDataCompression) {
+        allCompressedStrategySums.clear();
+        allCompressedRegretSums.clear();
+        allCompressedStrategySums.resize(m_trainingDataSize);
+        allCompressedRegretSums.resize(m_trainingDataSize);
+        allStrategySumScales.assign(m_numDecisionNodes, 0.0f);
+        allRegretSumScales.assign(m_numDecisionNodes, 0.0f);
+    }
+    else {
+        allStrategySums.clear();
+        allRegretSums.clear();
+        allStrategySums.resize(m_trainingDataSize);
+        allRegretSums.resize(m_trainingDataSize);
+    }
+    allLastDiscountedIterations.assign(m_numDecisionNodes, 0);
+
+    // Training starts over, so the mapped file is no longer needed
+    numCompletedIterations = 0;
+    m_mappedFile.reset();
+    m_mappedStrategySums = {};
+    m_mappedCompressedStrategySums = {};
+    m_mappedStrategySumScales = {};
+}
+
+void Tree::zeroTrainingData(int numThreads, const std::function<bool(std::size_t)>& isSubtreeOwned) {
+    struct TrainingDataRange {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    // The training data before the first chance card comes first, followed by the block of each subtree after it
+    std::vector<TrainingDataRange> ranges;
+    std::size_t subtreesTrainingDataSize = 0;
+    for (std::size_t i = 0; i < m_subtreeTrainingDataBlocks.size(); ++i) {
+        const SubtreeTrainingDataBlock& block = m_subtreeTrainingDataBlocks[i];
+        if (isSubtreeOwned(i)) {
+            ranges.push_back({ .offset = block.trainingDataOffset, .size = block.trainingDataSize });
+        }
+        subtreesTrainingDataSize += block.trainingDataSize;
+    }
+    assert(subtreesTrainingDataSize <= m_trainingDataSize);
+    ranges.push_back({ .offset = 0, .size = m_trainingDataSize - subtreesTrainingDataSize });
+
+    #ifdef _OPENMP
+    // Each thread zeroes a run of neighbouring subtrees, and the threads are spread over the sockets
+    #pragma omp parallel for num_threads(numThreads) schedule(static) proc_bind(spread)
+    #endif
+    for (int i = 0; i < static_cast<int>(ranges.size()); ++i) {
+        const TrainingDataRange& range = ranges[i];
+        if (m_useTrainingDataCompression) {
+            zeroTrainingDataRange(allCompressedStrategySums, range.offset, range.size);
+            zeroTrainingDataRange(allCompressedRegretSums, range.offset, range.size);
+        }
+        else {
+            zeroTrainingDataRange(allStrategySums, range.offset, range.size);
+            zeroTrainingDataRange(allRegretSums, range.offset, range.size);
+        }
+    }
+}
+
+bool Tree::setTrainingDataDirectory(const std::filesystem::path& directory) {
+    if (!canMapScratchFiles(directory)) {
+        return false;
+    }
+
+    m_trainingDataOptions.scratchDirectory = directory;
+    resetTrainingDataAllocators();
+    return true;
+}
+
+void Tree::setTrainingDataHugePages(bool useHugePages) {
+    m_trainingDataOptions.useHugePages = useHugePages;
+    resetTrainingDataAllocators();
+}
+
+void Tree::resetTrainingDataAllocators() {
+    // The vectors keep the allocator they were created with, so they are replaced by empty vectors with the new allocator
+    LargeArrayAllocator<float> allocator{ m_trainingDataOptions };
+    allStrategySums = TrainingDataVector<float>(allocator);
+    allRegretSums = TrainingDataVector<float>(allocator);
+    allCompressedStrategySums = TrainingDataVector<std::uint16_t>(LargeArrayAllocator<std::uint16_t>{ allocator });
+    allCompressedRegretSums = TrainingDataVector<std::int16_t>(LargeArrayAllocator<std::int16_t>{ allocator });
+}
+
+bool Tree::isTrainingDataFileBacked() const {
+    return !m_trainingDataOptions.scratchDirectory.empty();
+}
+
+void Tree::prefetchSubtreeTrainingData(std::size_t nodeIndex) const {
+    if (!isTrainingDataFileBacked()) return;
+
+    std::optional<std::size_t> subtreeIndex = getSubtreeIndex(nodeIndex);
+    if (!subtreeIndex) return;
+    hintSubtreeTrainingData(*subtreeIndex, prefetchScratchPages);
+}
+
+void Tree::releaseSubtreeTrainingData(std::size_t nodeIndex) const {
+    if (!isTrainingDataFileBacked()) return;
+
+    std::optional<std::size_t> subtreeIndex = getSubtreeIndex(nodeIndex);
+    if (!subtreeIndex || !isPhysicalMemoryLow()) return;
+    hintSubtreeTrainingData(*subtreeIndex, releaseScratchPages);
+}
+
+void Tree::hintSubtreeTrainingData(std::size_t subtreeIndex, void (*hint)(const void*, std::size_t)) const {
+    const SubtreeTrainingDataBlock& block = m_subtreeTrainingDataBlocks[subtreeIndex];
+
+    auto hintTrainingData = [&block, hint](const auto& trainingData) -> void {
+        if (trainingData.empty()) return;
+        hint(trainingData.data() + block.trainingDataOffset, block.trainingDataSize * sizeof(trainingData[0]));
+    };
+
+    if (m_useTrainingDataCompression) {
+        hintTrainingData(allCompressedStrategySums);
+        hintTrainingData(allCompressedRegretSums);
+    }
+    else {
+        hintTrainingData(allStrategySums);
+        hintTrainingData(allRegretSums);
+    }
 }
 
 std::size_t Tree::getRootNodeIndex() const {
     assert(isTreeSkeletonBuilt() && areCfrVectorsInitialized());
     return 0;
-}
\ No newline at end of file
+}
+
+GameState Tree::getNodeState(std::size_t nodeIndex) const {
+    assert(isTreeSkeletonBuilt());
+
+    const Node& node = allNodes[nodeIndex];
+    const NodeDetails& details = allNodeDetails[nodeIndex];
+    return {
+        .currentBoard = node.board,
+        .totalWagers = details.totalWagers,
+        .previousStreetsWager = details.previousStreetsWager,
+        .playerToAct = node.playerToAct,
+        .lastAction = details.lastAction,
+        .lastDealtCard = node.lastDealtCard,
+        .currentStreet = details.currentStreet,
+    };
+}
+
+bool Tree::isTrainingDataMemoryMapped() const {
+    return m_mappedFile != nullptr;
+}
+
+std::span<const float> Tree::getStrategySums() const {
+    return isTrainingDataMemoryMapped() ? m_mappedStrategySums : std::span<const float>{ allStrategySums };
+}
+
+std::span<const std::uint16_t> Tree::getCompressedStrategySums() const {
+    return isTrainingDataMemoryMapped() ? m_mappedCompressedStrategySums : std::span<const std::uint16_t>{ allCompressedStrategySums };
+}
+
+std::span<const float> Tree::getStrategySumScales() const {
+    return isTrainingDataMemoryMapped() ? m_mappedStrategySumScales : std::span<const float>{ allStrategySumScales };
+}
+
+bool Tree::saveToFile(const IGameRules& rules, const std::filesystem::path& path) const {
+    assert(isTreeSkeletonBuilt() && areCfrVectorsInitialized());
+
+    // A memory mapped tree only has the average strategy, so it cannot be saved again
+    // A partial tree is missing the training data that was kept on other machines
+    if (isTrainingDataMemoryMapped() || isTrainingDataPartial()) return false;
+
+    BinaryWriter writer{ path };
+    if (!writer.isGood()) return false;
+
+    writer.write(TreeFileMagic);
+    writer.write(TreeFileVersion);
+    writer.write(static_cast<std::uint8_t>(m_useTrainingDataCompression));
+
+    // Game data used to check that the file matches the loaded game settings
+    writer.write(rules.getInitialGameState().currentBoard);
+    for (Player player : { Player::P0, Player::P1 }) {
+        writer.writeArray(rules.getRangeHands(player));
+        writer.writeArray(rules.getInitialRangeWeights(player));
+    }
+
+    // Game data
+    writer.write(gameHandSize);
+    writer.write(rangeSize);
+    for (Player player : { Player::P0, Player::P1 }) {
+        writer.writeArray(std::span<const std::int16_t>{ sameHandIndexTable[player] });
+        for (const auto& handIndices : isomorphicHandIndices[player]) {
+            writer.writeArray(std::span<const std::int16_t>{ handIndices });
+        }
+    }
+    writer.write(deadMoney);
+    writer.write(totalRangeWeight);
+    writer.write(startingStreet);
+
+    // Node data
+    writer.write<std::uint64_t>(m_trainingDataSize);
+    writer.write<std::uint64_t>(m_numDecisionNodes);
+    writer.writeArray(std::span<const Node>{ allNodes });
+    writer.writeArray(std::span<const NodeDetails>{ allNodeDetails });
+    writer.writeArray(std::span<const ChanceNodeDetails>{ allChanceNodeDetails });
+
+    // Training data
+    writer.write(numCompletedIterations);
+    if (m_useTrainingDataCompression) {
+        writer.writeAlignedArray(std::span<const std::uint16_t>{ allCompressedStrategySums }, TrainingDataAlignment);
+        writer.writeAlignedArray(std::span<const float>{ allStrategySumScales }, TrainingDataAlignment);
+        writer.writeAlignedArray(std::span<const std::int16_t>{ allCompressedRegretSums }, TrainingDataAlignment);
+        writer.writeAlignedArray(std::span<const float>{ allRegretSumScales }, TrainingDataAlignment);
+    }
+    else {
+        writer.writeAlignedArray(std::span<const float>{ allStrategySums }, TrainingDataAlignment);
+        writer.writeAlignedArray(std::span<const float>{ allRegretSums }, TrainingDataAlignment);
+    }
+    writer.writeAlignedArray(std::span<const std::int32_t>{ allLastDiscountedIterations }, TrainingDataAlignment);
+
+    if (!writer.isGood()) return false;
+    return writer.commit();
+}
+
+Result<std::unique_ptr<Tree>> Tree::loadFromFile(const IGameRules& rules, const std::filesystem::path& path, bool useMemoryMapping) {
+    auto file = std::make_shared<const MappedFile>(path);
+    if (!file->isGood()) {
+        return "Error: Could not open file " + path.string() + ".";
+    }
+
+    static const std::string CorruptedFileError = "Error: File is not a valid tree file or is corrupted.";
+    BinaryReader reader{ file->getBytes() };
+
+    if (!reader.expect(TreeFileMagic)) {
+        return CorruptedFileError;
+    }
+
+    std::uint32_t version;
+    if (!reader.read(version)) {
+        return CorruptedFileError;
+    }
+    if (version != TreeFileVersion) {
+        return "Error: Tree file has version " + std::to_string(version) + ", but only version " + std::to_string(TreeFileVersion) + " is supported.";
+    }
+
+    std::uint8_t useTrainingDataCompression;
+    if (!reader.read(useTrainingDataCompression) || useTrainingDataCompression > 1) {
+        return CorruptedFileError;
+    }
+
+    // Check that the tree was solved with the same game settings
+    static const std::string MismatchedGameError = "Error: Tree file was solved with a different board or ranges than the loaded game settings.";
+    CardSet startingBoard;
+    if (!reader.read(startingBoard)) {
+        return CorruptedFileError;
+    }
+    if (startingBoard != rules.getInitialGameState().currentBoard) {
+        return MismatchedGameError;
+    }
+
+    for (Player player : { Player::P0, Player::P1 }) {
+        std::vector<CardSet> rangeHands;
+        std::vector<float> rangeWeights;
+        std::size_t maxRangeSize = rules.getRangeHands(player).size();
+        if (!reader.readArray(rangeHands, maxRangeSize) || !reader.readArray(rangeWeights, maxRangeSize)) {
+            return MismatchedGameError;
+        }
+        if (!areSpansEqual<CardSet>(rangeHands, rules.getRangeHands(player)) || !areSpansEqual<float>(rangeWeights, rules.getInitialRangeWeights(player))) {
+            return MismatchedGameError;
+        }
+    }
+
+    auto tree = std::make_unique<Tree>(static_cast<bool>(useTrainingDataCompression));
+
+    // Game data
+    bool success = reader.read(tree->gameHandSize) && reader.read(tree->rangeSize);
+    success = success && (tree->rangeSize[Player::P0] == static_cast<int>(rules.getRangeHands(Player::P0).size()));
+    success = success && (tree->rangeSize[Player::P1] == static_cast<int>(rules.getRangeHands(Player::P1).size()));
+    for (Player player : { Player::P0, Player::P1 }) {
+        if (!success) break;
+
+        std::size_t playerRangeSize = tree->rangeSize[player];
+        success = reader.readArray(tree->sameHandIndexTable[player], playerRangeSize);
+        for (auto& handIndices : tree->isomorphicHandIndices[player]) {
+            success = success && reader.readArray(handIndices, playerRangeSize);
+        }
+    }
+    success = success && reader.read(tree->deadMoney) && reader.read(tree->totalRangeWeight) && reader.read(tree->startingStreet);
+
+    // Node data
+    std::uint64_t trainingDataSize = 0;
+    std::uint64_t numDecisionNodes = 0;
+    success = success && reader.read(trainingDataSize) && reader.read(numDecisionNodes);
+    success = success && reader.readArray(tree->allNodes, file->getBytes().size() / sizeof(Node));
+    success = success && !tree->allNodes.empty();
+    success = success && reader.readArray(tree->allNodeDetails, tree->allNodes.size());
+    success = success && (tree->allNodeDetails.size() == tree->allNodes.size());
+    success = success && reader.readArray(tree->allChanceNodeDetails, tree->allNodes.size());
+    if (!success) {
+        return CorruptedFileError;
+    }
+
+    GameState initialState = rules.getInitialGameState();
+    for (std::size_t nodeIndex = 0; nodeIndex < tree->allNodes.size(); ++nodeIndex) {
+        const Node& node = tree->allNodes[nodeIndex];
+        if (!isLoadedNodeValid(node, tree->allNodeDetails[nodeIndex], rules, initialState, *tree, trainingDataSize, numDecisionNodes)) {
+            return CorruptedFileError;
+        }
+    }
+
+    tree->m_trainingDataSize = trainingDataSize;
+    tree->m_numDecisionNodes = numDecisionNodes;
+    tree->initAllInRunoutTables();
+
+    if (!reader.read(tree->numCompletedIterations) || tree->numCompletedIterations < 0) {
+        return CorruptedFileError;
+    }
+
+    // Training data
+    auto readTrainingData = [&reader](auto& target, std::size_t expectedSize) -> bool {
+        using T = std::remove_const_t<typename std::remove_reference_t<decltype(target)>::element_type>;
+        std::span<const T> view;
+        if (!reader.readAlignedArrayView(view, TrainingDataAlignment, expectedSize) || view.size() != expectedSize) return false;
+        target = view;
+        return true;
+    };
+
+    std::span<const float> strategySums;
+    std::span<const std::uint16_t> compressedStrategySums;
+    std::span<const float> strategySumScales;
+    std::span<const float> regretSums;
+    std::span<const std::int16_t> compressedRegretSums;
+    std::span<const float> regretSumScales;
+    std::span<const std::int32_t> lastDiscountedIterations;
+
+    if (tree->m_useTrainingDataCompression) {
+        success = readTrainingData(compressedStrategySums, trainingDataSize)
+            && readTrainingData(strategySumScales, numDecisionNodes)
+            && readTrainingData(compressedRegretSums, trainingDataSize)
+            && readTrainingData(regretSumScales, numDecisionNodes);
+    }
+    else {
+        success = readTrainingData(strategySums, trainingDataSize) && readTrainingData(regretSums, trainingDataSize);
+    }
+    success = success && readTrainingData(lastDiscountedIterations, numDecisionNodes);
+
+    if (!success || !reader.isAtEnd()) {
+        return CorruptedFileError;
+    }
+
+    if (useMemoryMapping && file->isMemoryMapped()) {
+        // Only the average strategy is needed to browse the tree
+        tree->m_mappedStrategySums = strategySums;
+        tree->m_mappedCompressedStrategySums = compressedStrategySums;
+        tree->m_mappedStrategySumScales = strategySumScales;
+        tree->m_mappedFile = std::move(file);
+    }
+    else {
+        tree->allStrategySums.assign(strategySums.begin(), strategySums.end());
+        tree->allRegretSums.assign(regretSums.begin(), regretSums.end());
+        tree->allCompressedStrategySums.assign(compressedStrategySums.begin(), compressedStrategySums.end());
+        tree->allCompressedRegretSums.assign(compressedRegretSums.begin(), compressedRegretSums.end());
+        tree->allStrategySumScales.assign(strategySumScales.begin(), strategySumScales.end());
+        tree->allRegretSumScales.assign(regretSumScales.begin(), regretSumScales.end());
+        tree->allLastDiscountedIterations.assign(lastDiscountedIterations.begin(), lastDiscountedIterations.end());
+    }
+
+    return tree;
+}
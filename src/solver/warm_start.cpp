@@ -0,0 +1,198 @@
+#include "solver/warm_start.hpp"
+
+#include "game/game_rules.hpp"
+#include "game/game_types.hpp"
+#include "game/game_utils.hpp"
+#include "solver/cfr.hpp"
+#include "solver/tree.hpp"
+#include "util/fixed_vector.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace {
+enum class ActionKind {
+    Fold,
+    Passive,
+    Aggressive
+};
+
+struct ActionOutcome {
+    ActionKind kind;
+    int actingPlayerWager;
+};
+
+ActionOutcome getActionOutcome(const Tree& tree, const Node& decisionNode, int action) {
+    std::size_t childIndex = decisionNode.childrenOffset + action;
+    if (tree.allNodes[childIndex].nodeType == NodeType::Fold) {
+        return { .kind = ActionKind::Fold, .actingPlayerWager = 0 };
+    }
+
+    const PlayerArray<int>& totalWagers = tree.allNodeDetails[childIndex].totalWagers;
+    int actingPlayerWager = totalWagers[decisionNode.playerToAct];
+    int opposingPlayerWager = totalWagers[getOpposingPlayer(decisionNode.playerToAct)];
+    return {
+        .kind = (actingPlayerWager > opposingPlayerWager) ? ActionKind::Aggressive : ActionKind::Passive,
+        .actingPlayerWager = actingPlayerWager,
+    };
+}
+
+// For each target action, the source action of the same kind with the closest resulting wager, or -1 if there is none
+FixedVector<int, MaxNumActions> matchActions(const Tree& sourceTree, const Node& sourceNode, const Tree& targetTree, const Node& targetNode) {
+    FixedVector<int, MaxNumActions> sourceActions(targetNode.numChildren, -1);
+
+    for (int targetAction = 0; targetAction < targetNode.numChildren; ++targetAction) {
+        ActionOutcome targetOutcome = getActionOutcome(targetTree, targetNode, targetAction);
+
+        int closestDistance = std::numeric_limits<int>::max();
+        for (int sourceAction = 0; sourceAction < sourceNode.numChildren; ++sourceAction) {
+            ActionOutcome sourceOutcome = getActionOutcome(sourceTree, sourceNode, sourceAction);
+            if (sourceOutcome.kind != targetOutcome.kind) continue;
+
+            int distance = std::abs(sourceOutcome.actingPlayerWager - targetOutcome.actingPlayerWager);
+            if (distance < closestDistance) {
+                closestDistance = distance;
+                sourceActions[targetAction] = sourceAction;
+            }
+        }
+    }
+
+    return sourceActions;
+}
+
+void readTrainingData(std::span<float> regretSums, std::span<float> strategySums, const Node& decisionNode, const Tree& tree) {
+    if (tree.isTrainingDataCompressed()) {
+        decodeRegretSums(regretSums, decisionNode, tree);
+        decodeStrategySums(strategySums, decisionNode, tree);
+    }
+    else {
+        std::copy_n(tree.allRegretSums.begin() + decisionNode.trainingDataOffset, regretSums.size(), regretSums.begin());
+        std::copy_n(tree.allStrategySums.begin() + decisionNode.trainingDataOffset, strategySums.size(), strategySums.begin());
+    }
+}
+
+void writeTrainingData(std::span<const float> regretSums, std::span<const float> strategySums, const Node& decisionNode, Tree& tree) {
+    if (tree.isTrainingDataCompressed()) {
+        encodeRegretSums(regretSums, decisionNode, tree);
+        encodeStrategySums(strategySums, decisionNode, tree);
+    }
+    else {
+        std::copy(regretSums.begin(), regretSums.end(), tree.allRegretSums.begin() + decisionNode.trainingDataOffset);
+        std::copy(strategySums.begin(), strategySums.end(), tree.allStrategySums.begin() + decisionNode.trainingDataOffset);
+    }
+}
+
+class WarmStarter {
+public:
+    WarmStarter(const IGameRules& rules, const Tree& sourceTree, Tree& targetTree) :
+        m_rules{ rules },
+        m_sourceTree{ sourceTree },
+        m_targetTree{ targetTree },
+        m_numSeededDecisionNodes{ 0 } {
+    }
+
+    void seedSubtree(std::size_t sourceIndex, std::size_t targetIndex) {
+        const Node& sourceNode = m_sourceTree.allNodes[sourceIndex];
+        const Node& targetNode = m_targetTree.allNodes[targetIndex];
+
+        // The histories stop matching when the node types differ, for example when only one of the trees has an all in at this point
+        if (sourceNode.nodeType != targetNode.nodeType || sourceNode.board != targetNode.board) return;
+
+        switch (targetNode.nodeType) {
+            case NodeType::Chance:
+                // With isomorphism, a card can be missing from the source tree when its board had different suit symmetries
+                for (int targetCard = 0; targetCard < targetNode.numChildren; ++targetCard) {
+                    std::size_t targetChildIndex = targetNode.childrenOffset + targetCard;
+                    CardID dealtCard = m_targetTree.allNodes[targetChildIndex].lastDealtCard;
+                    for (int sourceCard = 0; sourceCard < sourceNode.numChildren; ++sourceCard) {
+                        std::size_t sourceChildIndex = sourceNode.childrenOffset + sourceCard;
+                        if (m_sourceTree.allNodes[sourceChildIndex].lastDealtCard == dealtCard) {
+                            seedSubtree(sourceChildIndex, targetChildIndex);
+                            break;
+                        }
+                    }
+                }
+                break;
+
+            case NodeType::Decision: {
+                if (sourceNode.playerToAct != targetNode.playerToAct) return;
+
+                FixedVector<int, MaxNumActions> sourceActions = matchActions(m_sourceTree, sourceNode, m_targetTree, targetNode);
+                seedDecisionNode(sourceNode, targetNode, sourceActions);
+
+                for (int targetAction = 0; targetAction < targetNode.numChildren; ++targetAction) {
+                    if (sourceActions[targetAction] == -1) continue;
+                    seedSubtree(sourceNode.childrenOffset + sourceActions[targetAction], targetNode.childrenOffset + targetAction);
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    std::size_t getNumSeededDecisionNodes() const {
+        return m_numSeededDecisionNodes;
+    }
+
+private:
+    void seedDecisionNode(const Node& sourceNode, const Node& targetNode, const FixedVector<int, MaxNumActions>& sourceActions) {
+        // Both trees have the same board and ranges, so their training hands are the same
+        std::size_t numTrainingHands = m_rules.getValidHands(targetNode.playerToAct, targetNode.board).size();
+
+        std::vector<float> sourceRegretSums(sourceNode.numChildren * numTrainingHands);
+        std::vector<float> sourceStrategySums(sourceNode.numChildren * numTrainingHands);
+        readTrainingData(sourceRegretSums, sourceStrategySums, sourceNode, m_sourceTree);
+
+        // A source action matched by several target actions is split evenly between them,
+        // so that together they keep the probability the source action had in the current and the average strategy
+        FixedVector<int, MaxNumActions> numMatchingTargetActions(sourceNode.numChildren, 0);
+        for (int targetAction = 0; targetAction < targetNode.numChildren; ++targetAction) {
+            if (sourceActions[targetAction] != -1) {
+                ++numMatchingTargetActions[sourceActions[targetAction]];
+            }
+        }
+
+        // Unmatched actions keep zero regret, so they start with the probability that the other actions leave them
+        std::vector<float> targetRegretSums(targetNode.numChildren * numTrainingHands, 0.0f);
+        std::vector<float> targetStrategySums(targetNode.numChildren * numTrainingHands, 0.0f);
+        for (int targetAction = 0; targetAction < targetNode.numChildren; ++targetAction) {
+            int sourceAction = sourceActions[targetAction];
+            if (sourceAction == -1) continue;
+
+            float share = 1.0f / static_cast<float>(numMatchingTargetActions[sourceAction]);
+            for (std::size_t i = 0; i < numTrainingHands; ++i) {
+                targetRegretSums[targetAction * numTrainingHands + i] = sourceRegretSums[sourceAction * numTrainingHands + i] * share;
+                targetStrategySums[targetAction * numTrainingHands + i] = sourceStrategySums[sourceAction * numTrainingHands + i] * share;
+            }
+        }
+
+        writeTrainingData(targetRegretSums, targetStrategySums, targetNode, m_targetTree);
+
+        // The copied regrets may still be missing discounts from iterations that skipped the source node
+        m_targetTree.allLastDiscountedIterations[targetNode.decisionNodeIndex] = m_sourceTree.allLastDiscountedIterations[sourceNode.decisionNodeIndex];
+        ++m_numSeededDecisionNodes;
+    }
+
+    const IGameRules& m_rules;
+    const Tree& m_sourceTree;
+    Tree& m_targetTree;
+    std::size_t m_numSeededDecisionNodes;
+};
+} // namespace
+
+std::size_t warmStartTree(const IGameRules& rules, const Tree& sourceTree, Tree& targetTree) {
+    assert(sourceTree.isTreeSkeletonBuilt() && sourceTree.areCfrVectorsInitialized() && !sourceTree.isTrainingDataMemoryMapped());
+    assert(targetTree.isTreeSkeletonBuilt() && targetTree.areCfrVectorsInitialized());
+
+    WarmStarter warmStarter{ rules, sourceTree, targetTree };
+    warmStarter.seedSubtree(sourceTree.getRootNodeIndex(), targetTree.getRootNodeIndex());
+    targetTree.numCompletedIterations = sourceTree.numCompletedIterations;
+    return warmStarter.getNumSeededDecisionNodes();
+}
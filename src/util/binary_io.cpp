@@ -0,0 +1,110 @@
+#include "util/binary_io.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <span>
+#include <string>
+#include <system_error>
+
+BinaryWriter::BinaryWriter(const std::filesystem::path& path) :
+    m_path{ path },
+    // Random suffix so that concurrent writers of the same file don't share a temporary file
+    m_temporaryPath{ path.string() + "." + std::to_string(std::random_device{}()) + ".tmp" },
+    m_file{ m_temporaryPath, std::ios::binary | std::ios::trunc },
+    m_position{ 0 },
+    m_committed{ false } {
+}
+
+BinaryWriter::~BinaryWriter() {
+    if (!m_committed) {
+        m_file.close();
+        std::error_code error;
+        std::filesystem::remove(m_temporaryPath, error);
+    }
+}
+
+bool BinaryWriter::isGood() const {
+    return m_file.good();
+}
+
+bool BinaryWriter::commit() {
+    m_file.close();
+    if (m_file.fail()) return false;
+
+    std::error_code error;
+    std::filesystem::rename(m_temporaryPath, m_path, error);
+    if (error) return false;
+
+    m_committed = true;
+    return true;
+}
+
+void BinaryWriter::writeBytes(std::span<const std::byte> bytes) {
+    m_file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    m_position += bytes.size();
+}
+
+void BinaryWriter::writePadding(std::size_t alignment) {
+    static constexpr std::size_t MaxAlignment = 4096;
+    static constexpr std::array<std::byte, MaxAlignment> Zeros{};
+    assert(alignment > 0 && alignment <= MaxAlignment);
+
+    std::size_t remainder = m_position % alignment;
+    if (remainder != 0) {
+        writeBytes(std::span<const std::byte>{ Zeros }.first(alignment - remainder));
+    }
+}
+
+BinaryReader::BinaryReader(std::span<const std::byte> bytes) : m_bytes{ bytes }, m_position{ 0 } {}
+
+bool BinaryReader::readBytes(std::span<std::byte> bytes) {
+    std::span<const std::byte> source = takeBytes(bytes.size());
+    if (source.size() != bytes.size()) return false;
+    if (!source.empty()) {
+        std::memcpy(bytes.data(), source.data(), source.size());
+    }
+    return true;
+}
+
+bool BinaryReader::skipPadding(std::size_t alignment) {
+    assert(alignment > 0);
+    std::size_t remainder = m_position % alignment;
+    if (remainder == 0) return true;
+
+    std::size_t paddingSize = alignment - remainder;
+    return takeBytes(paddingSize).size() == paddingSize;
+}
+
+bool BinaryReader::isAtEnd() const {
+    return m_position == m_bytes.size();
+}
+
+std::span<const std::byte> BinaryReader::takeBytes(std::size_t numBytes) {
+    // On failure the reader is moved to the end so that every later read fails too
+    if (numBytes > m_bytes.size() - m_position) {
+        m_position = m_bytes.size();
+        return {};
+    }
+
+    std::span<const std::byte> bytes = m_bytes.subspan(m_position, numBytes);
+    m_position += numBytes;
+    return bytes;
+}
+
+void Fnv1aHasher::addBytes(std::span<const std::byte> bytes) {
+    static constexpr std::uint64_t FnvPrime = 0x100000001b3ULL;
+    for (std::byte byte : bytes) {
+        m_hash ^= static_cast<std::uint64_t>(byte);
+        m_hash *= FnvPrime;
+    }
+}
+
+std::uint64_t Fnv1aHasher::getHash() const {
+    return m_hash;
+}
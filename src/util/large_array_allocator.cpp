@@ -0,0 +1,129 @@
+#include "util/large_array_allocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <new>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define POSTFLOP_SOLVER_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Size of a huge page on x86-64 and most ARM systems, larger alignments would only waste memory
+static constexpr std::size_t HugePageSize = 2 * 1024 * 1024;
+
+std::size_t roundUpToHugePages(std::size_t size) {
+    return (size + HugePageSize - 1) / HugePageSize * HugePageSize;
+}
+
+#ifdef POSTFLOP_SOLVER_HAS_MMAP
+struct PageRange {
+    void* begin;
+    std::size_t size;
+};
+
+PageRange getPageRange(const void* data, std::size_t size) {
+    static const std::uintptr_t PageSize = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+
+    std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(data) & ~(PageSize - 1);
+    std::uintptr_t end = reinterpret_cast<std::uintptr_t>(data) + size;
+    return { reinterpret_cast<void*>(begin), static_cast<std::size_t>(end - begin) };
+}
+#endif
+} // namespace
+
+void* mapScratchFile(const std::filesystem::path& directory, std::size_t size) {
+    #ifdef POSTFLOP_SOLVER_HAS_MMAP
+    std::string path = (directory / "postflop-solver-XXXXXX").string();
+    int fileDescriptor = ::mkstemp(path.data());
+    if (fileDescriptor == -1) return nullptr;
+    ::unlink(path.c_str());
+
+    // Extending the file does not write anything to disk, the new pages read as zero until they are written
+    void* mapping = MAP_FAILED;
+    if (::ftruncate(fileDescriptor, static_cast<off_t>(size)) == 0) {
+        mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+    }
+
+    // The mapping stays valid after the file is closed
+    ::close(fileDescriptor);
+    return (mapping == MAP_FAILED) ? nullptr : mapping;
+    #else
+    return ::operator new(size, std::nothrow);
+    #endif
+}
+
+void unmapScratchFile(void* data, std::size_t size) {
+    #ifdef POSTFLOP_SOLVER_HAS_MMAP
+    ::munmap(data, size);
+    #else
+    ::operator delete(data);
+    #endif
+}
+
+bool canMapScratchFiles(const std::filesystem::path& directory) {
+    static constexpr std::size_t TestSize = 1;
+
+    void* data = mapScratchFile(directory, TestSize);
+    if (!data) return false;
+
+    unmapScratchFile(data, TestSize);
+    return true;
+}
+
+void prefetchScratchPages(const void* data, std::size_t size) {
+    #ifdef POSTFLOP_SOLVER_HAS_MMAP
+    if (size == 0) return;
+    PageRange range = getPageRange(data, size);
+    ::posix_madvise(range.begin, range.size, POSIX_MADV_WILLNEED);
+    #endif
+}
+
+void releaseScratchPages(const void* data, std::size_t size) {
+    #ifdef POSTFLOP_SOLVER_HAS_MMAP
+    if (size == 0) return;
+    PageRange range = getPageRange(data, size);
+    #ifdef MADV_PAGEOUT
+    // Linux reclaims the pages right away, writing the dirty ones back in the background
+    ::madvise(range.begin, range.size, MADV_PAGEOUT);
+    #else
+    ::msync(range.begin, range.size, MS_ASYNC);
+    #endif
+    #endif
+}
+
+bool isPhysicalMemoryLow() {
+    #if defined(POSTFLOP_SOLVER_HAS_MMAP) && defined(_SC_AVPHYS_PAGES)
+    static constexpr long LowMemoryFraction = 16;
+    long numPhysicalPages = ::sysconf(_SC_PHYS_PAGES);
+    long numFreePages = ::sysconf(_SC_AVPHYS_PAGES);
+    if (numPhysicalPages <= 0 || numFreePages < 0) return false;
+    return numFreePages < numPhysicalPages / LowMemoryFraction;
+    #else
+    return false;
+    #endif
+}
+
+void* allocateHugePageMemory(std::size_t size) {
+    // Whole huge pages, so that the end of the array does not share a huge page with other allocations
+    std::size_t roundedSize = roundUpToHugePages(size);
+    void* data = ::operator new(roundedSize, std::align_val_t{ HugePageSize }, std::nothrow);
+
+    #if defined(POSTFLOP_SOLVER_HAS_MMAP) && defined(MADV_HUGEPAGE)
+    if (data) {
+        // Only a hint, the memory is still usable with regular pages when transparent huge pages are disabled
+        ::madvise(data, roundedSize, MADV_HUGEPAGE);
+    }
+    #endif
+
+    return data;
+}
+
+void freeHugePageMemory(void* data, std::size_t size) {
+    ::operator delete(data, roundUpToHugePages(size), std::align_val_t{ HugePageSize });
+}
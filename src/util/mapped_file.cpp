@@ -0,0 +1,81 @@
+#include "util/mapped_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <system_error>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define POSTFLOP_SOLVER_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path& path) :
+    m_data{ nullptr },
+    m_size{ 0 },
+    m_good{ false },
+    m_memoryMapped{ false } {
+    #ifdef POSTFLOP_SOLVER_HAS_MMAP
+    int fileDescriptor = ::open(path.c_str(), O_RDONLY);
+    if (fileDescriptor == -1) return;
+
+    struct stat fileStatus;
+    if (::fstat(fileDescriptor, &fileStatus) == 0 && S_ISREG(fileStatus.st_mode)) {
+        m_size = static_cast<std::size_t>(fileStatus.st_size);
+        if (m_size == 0) {
+            // Empty files cannot be mapped
+            m_good = true;
+        }
+        else {
+            void* mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+            if (mapping != MAP_FAILED) {
+                m_data = static_cast<const std::byte*>(mapping);
+                m_good = true;
+                m_memoryMapped = true;
+            }
+        }
+    }
+
+    // The mapping stays valid after the file is closed
+    ::close(fileDescriptor);
+    #else
+    std::error_code error;
+    std::uintmax_t fileSize = std::filesystem::file_size(path, error);
+    if (error) return;
+
+    std::ifstream file{ path, std::ios::binary };
+    m_fallbackBuffer.resize(static_cast<std::size_t>(fileSize));
+    file.read(reinterpret_cast<char*>(m_fallbackBuffer.data()), static_cast<std::streamsize>(m_fallbackBuffer.size()));
+    if (!file) return;
+
+    m_data = m_fallbackBuffer.data();
+    m_size = m_fallbackBuffer.size();
+    m_good = true;
+    #endif
+}
+
+MappedFile::~MappedFile() {
+    #ifdef POSTFLOP_SOLVER_HAS_MMAP
+    if (m_memoryMapped) {
+        ::munmap(const_cast<std::byte*>(m_data), m_size);
+    }
+    #endif
+}
+
+bool MappedFile::isGood() const {
+    return m_good;
+}
+
+bool MappedFile::isMemoryMapped() const {
+    return m_memoryMapped;
+}
+
+std::span<const std::byte> MappedFile::getBytes() const {
+    return { m_data, m_size };
+}
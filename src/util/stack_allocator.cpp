@@ -0,0 +1,125 @@
+#include "util/stack_allocator.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace {
+std::size_t roundUpToAlignment(std::size_t numBytes) {
+    return (numBytes + StackAllocator::Alignment - 1) & ~(StackAllocator::Alignment - 1);
+}
+} // namespace
+
+StackAllocator::StackAllocator(int numThreads, std::size_t initialBytesPerThread) :
+    m_chunkBytes{ roundUpToAlignment(std::max<std::size_t>(initialBytesPerThread, Alignment)) },
+    m_threadStacks(numThreads) {
+    assert(numThreads > 0);
+
+    for (ThreadStack& stack : m_threadStacks) {
+        stack.chunks.push_back(allocateChunk(m_chunkBytes));
+        stack.currentChunk = 0;
+        stack.bytesInUse = 0;
+        stack.numBlocks = 0;
+        stack.maximumBytesInUse = 0;
+        stack.maximumNumBlocks = 0;
+    }
+}
+
+int StackAllocator::getNumThreads() const {
+    return static_cast<int>(m_threadStacks.size());
+}
+
+bool StackAllocator::isEmpty() const {
+    for (const ThreadStack& stack : m_threadStacks) {
+        if (stack.numBlocks > 0) return false;
+    }
+    return true;
+}
+
+std::vector<std::size_t> StackAllocator::getMaximumStackUsage() const {
+    std::vector<std::size_t> maximumStackUsage;
+    for (const ThreadStack& stack : m_threadStacks) {
+        maximumStackUsage.push_back(stack.maximumBytesInUse);
+    }
+    return maximumStackUsage;
+}
+
+std::vector<std::size_t> StackAllocator::getMaximumNumBlocks() const {
+    std::vector<std::size_t> maximumNumBlocks;
+    for (const ThreadStack& stack : m_threadStacks) {
+        maximumNumBlocks.push_back(stack.maximumNumBlocks);
+    }
+    return maximumNumBlocks;
+}
+
+std::vector<std::size_t> StackAllocator::getReservedBytes() const {
+    std::vector<std::size_t> reservedBytes;
+    for (const ThreadStack& stack : m_threadStacks) {
+        std::size_t threadReservedBytes = 0;
+        for (const Chunk& chunk : stack.chunks) {
+            threadReservedBytes += chunk.capacity;
+        }
+        reservedBytes.push_back(threadReservedBytes);
+    }
+    return reservedBytes;
+}
+
+void StackAllocator::AlignedDeleter::operator()(std::byte* data) const {
+    ::operator delete[](data, std::align_val_t{ Alignment });
+}
+
+StackAllocator::Chunk StackAllocator::allocateChunk(std::size_t capacity) {
+    std::byte* data = static_cast<std::byte*>(::operator new[](capacity, std::align_val_t{ Alignment }));
+    return { .data = std::unique_ptr<std::byte[], AlignedDeleter>{ data }, .capacity = capacity, .used = 0 };
+}
+
+std::byte* StackAllocator::allocateBytes(int thread, std::size_t numBytes) {
+    assert(thread >= 0 && thread < getNumThreads());
+    ThreadStack& stack = m_threadStacks[thread];
+
+    std::size_t blockBytes = roundUpToAlignment(numBytes);
+    if (stack.chunks[stack.currentChunk].used + blockBytes > stack.chunks[stack.currentChunk].capacity) {
+        // Move on to the next chunk, chunks after the current one are always empty
+        ++stack.currentChunk;
+        if (stack.currentChunk == stack.chunks.size()) {
+            stack.chunks.push_back(allocateChunk(std::max(m_chunkBytes, blockBytes)));
+        }
+        else if (stack.chunks[stack.currentChunk].capacity < blockBytes) {
+            stack.chunks[stack.currentChunk] = allocateChunk(blockBytes);
+        }
+    }
+
+    Chunk& chunk = stack.chunks[stack.currentChunk];
+    std::byte* data = chunk.data.get() + chunk.used;
+    chunk.used += blockBytes;
+
+    stack.bytesInUse += blockBytes;
+    ++stack.numBlocks;
+    stack.maximumBytesInUse = std::max(stack.maximumBytesInUse, stack.bytesInUse);
+    stack.maximumNumBlocks = std::max(stack.maximumNumBlocks, stack.numBlocks);
+
+    return data;
+}
+
+void StackAllocator::deallocateBytes(int thread, [[maybe_unused]] std::byte* data, std::size_t numBytes) {
+    assert(thread >= 0 && thread < getNumThreads());
+    ThreadStack& stack = m_threadStacks[thread];
+
+    std::size_t blockBytes = roundUpToAlignment(numBytes);
+    Chunk& chunk = stack.chunks[stack.currentChunk];
+    assert(stack.numBlocks > 0);
+    assert(chunk.used >= blockBytes);
+    assert(data == chunk.data.get() + chunk.used - blockBytes);
+
+    chunk.used -= blockBytes;
+    stack.bytesInUse -= blockBytes;
+    --stack.numBlocks;
+
+    // Go back to the previous chunk once this one is empty, since it holds the blocks below this one
+    if (chunk.used == 0 && stack.currentChunk > 0) {
+        --stack.currentChunk;
+    }
+}
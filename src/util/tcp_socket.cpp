@@ -0,0 +1,232 @@
+#include "util/tcp_socket.hpp"
+
+#include "util/result.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define POSTFLOP_SOLVER_HAS_SOCKETS
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace {
+static constexpr int InvalidSocket = -1;
+
+void closeSocket(int& socket) {
+    #ifdef POSTFLOP_SOLVER_HAS_SOCKETS
+    if (socket != InvalidSocket) {
+        ::close(socket);
+    }
+    #endif
+    socket = InvalidSocket;
+}
+
+#ifdef POSTFLOP_SOLVER_HAS_SOCKETS
+// Requests and responses are written in a few large pieces, so there is nothing to gain from waiting to fill packets
+void disableNagle(int socket) {
+    int enabled = 1;
+    ::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+}
+#endif
+} // namespace
+
+TcpConnection::TcpConnection() : m_socket{ InvalidSocket } {}
+
+TcpConnection::TcpConnection(int socket) : m_socket{ socket } {}
+
+TcpConnection::~TcpConnection() {
+    close();
+}
+
+TcpConnection::TcpConnection(TcpConnection&& other) noexcept : m_socket{ std::exchange(other.m_socket, InvalidSocket) } {}
+
+TcpConnection& TcpConnection::operator=(TcpConnection&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_socket = std::exchange(other.m_socket, InvalidSocket);
+    }
+    return *this;
+}
+
+Result<TcpConnection> TcpConnection::connect(const std::string& address) {
+    std::size_t separator = address.rfind(':');
+    if (separator == std::string::npos || separator == 0 || separator + 1 == address.size()) {
+        return "Error: Invalid address \"" + address + "\", expected host:port.";
+    }
+    std::string host = address.substr(0, separator);
+    std::string port = address.substr(separator + 1);
+
+    #ifdef POSTFLOP_SOLVER_HAS_SOCKETS
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* addresses = nullptr;
+    if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0) {
+        return "Error: Could not resolve " + address + ".";
+    }
+
+    int socket = InvalidSocket;
+    for (addrinfo* candidate = addresses; candidate != nullptr; candidate = candidate->ai_next) {
+        socket = ::socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+        if (socket == InvalidSocket) continue;
+
+        if (::connect(socket, candidate->ai_addr, candidate->ai_addrlen) == 0) break;
+        closeSocket(socket);
+    }
+    ::freeaddrinfo(addresses);
+
+    if (socket == InvalidSocket) {
+        return "Error: Could not connect to " + address + ".";
+    }
+
+    disableNagle(socket);
+    return TcpConnection{ socket };
+    #else
+    return "Error: Distributed solving is not supported on this platform.";
+    #endif
+}
+
+bool TcpConnection::isOpen() const {
+    return m_socket != InvalidSocket;
+}
+
+void TcpConnection::close() {
+    closeSocket(m_socket);
+}
+
+bool TcpConnection::setReceiveTimeout(std::chrono::milliseconds timeout) {
+    #ifdef POSTFLOP_SOLVER_HAS_SOCKETS
+    timeval time{};
+    time.tv_sec = static_cast<decltype(time.tv_sec)>(timeout.count() / 1000);
+    time.tv_usec = static_cast<decltype(time.tv_usec)>((timeout.count() % 1000) * 1000);
+    return ::setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &time, sizeof(time)) == 0;
+    #else
+    return false;
+    #endif
+}
+
+bool TcpConnection::sendBytes(std::span<const std::byte> bytes) {
+    #ifdef POSTFLOP_SOLVER_HAS_SOCKETS
+    while (!bytes.empty()) {
+        #ifdef MSG_NOSIGNAL
+        ssize_t numSent = ::send(m_socket, bytes.data(), bytes.size(), MSG_NOSIGNAL);
+        #else
+        ssize_t numSent = ::send(m_socket, bytes.data(), bytes.size(), 0);
+        #endif
+        if (numSent <= 0) return false;
+        bytes = bytes.subspan(static_cast<std::size_t>(numSent));
+    }
+    return true;
+    #else
+    return bytes.empty();
+    #endif
+}
+
+bool TcpConnection::receiveBytes(std::span<std::byte> bytes) {
+    #ifdef POSTFLOP_SOLVER_HAS_SOCKETS
+    while (!bytes.empty()) {
+        ssize_t numReceived = ::recv(m_socket, bytes.data(), bytes.size(), 0);
+        if (numReceived <= 0) return false;
+        bytes = bytes.subspan(static_cast<std::size_t>(numReceived));
+    }
+    return true;
+    #else
+    return bytes.empty();
+    #endif
+}
+
+std::size_t TcpConnection::receiveAvailableBytes(std::span<std::byte> buffer) {
+    #ifdef POSTFLOP_SOLVER_HAS_SOCKETS
+    if (buffer.empty()) return 0;
+    ssize_t numReceived = ::recv(m_socket, buffer.data(), buffer.size(), 0);
+    return (numReceived > 0) ? static_cast<std::size_t>(numReceived) : 0;
+    #else
+    return 0;
+    #endif
+}
+
+TcpListener::TcpListener() : m_socket{ InvalidSocket } {}
+
+TcpListener::TcpListener(int socket) : m_socket{ socket } {}
+
+TcpListener::~TcpListener() {
+    closeSocket(m_socket);
+}
+
+TcpListener::TcpListener(TcpListener&& other) noexcept : m_socket{ std::exchange(other.m_socket, InvalidSocket) } {}
+
+TcpListener& TcpListener::operator=(TcpListener&& other) noexcept {
+    if (this != &other) {
+        closeSocket(m_socket);
+        m_socket = std::exchange(other.m_socket, InvalidSocket);
+    }
+    return *this;
+}
+
+Result<TcpListener> TcpListener::listen(std::uint16_t port, int backlog) {
+    #ifdef POSTFLOP_SOLVER_HAS_SOCKETS
+    int socket = ::socket(AF_INET6, SOCK_STREAM, 0);
+    if (socket == InvalidSocket) {
+        return "Error: Could not create a socket.";
+    }
+
+    // Accept IPv4 connections as well, and allow restarting a worker on the same port right away
+    int disabled = 0;
+    int enabled = 1;
+    ::setsockopt(socket, IPPROTO_IPV6, IPV6_V6ONLY, &disabled, sizeof(disabled));
+    ::setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+
+    sockaddr_in6 address{};
+    address.sin6_family = AF_INET6;
+    address.sin6_addr = in6addr_any;
+    address.sin6_port = htons(port);
+
+    if (::bind(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(socket, backlog) != 0) {
+        closeSocket(socket);
+        return "Error: Could not listen on port " + std::to_string(port) + ".";
+    }
+
+    return TcpListener{ socket };
+    #else
+    return "Error: Distributed solving is not supported on this platform.";
+    #endif
+}
+
+std::uint16_t TcpListener::getPort() const {
+    #ifdef POSTFLOP_SOLVER_HAS_SOCKETS
+    sockaddr_in6 address{};
+    socklen_t addressSize = sizeof(address);
+    if (::getsockname(m_socket, reinterpret_cast<sockaddr*>(&address), &addressSize) != 0) {
+        return 0;
+    }
+    return ntohs(address.sin6_port);
+    #else
+    return 0;
+    #endif
+}
+
+Result<TcpConnection> TcpListener::accept() {
+    #ifdef POSTFLOP_SOLVER_HAS_SOCKETS
+    int socket = ::accept(m_socket, nullptr, nullptr);
+    if (socket == InvalidSocket) {
+        return "Error: Could not accept a connection.";
+    }
+
+    disableNagle(socket);
+    return TcpConnection{ socket };
+    #else
+    return "Error: Distributed solving is not supported on this platform.";
+    #endif
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "holdem_test_settings.hpp"
+#include "test_helpers.hpp"
+
+#include "game/game_types.hpp"
+#include "game/leduc_poker.hpp"
+#include "game/holdem/holdem_parser.hpp"
+#include "game/holdem/holdem.hpp"
+#include "solver/cfr.hpp"
+#include "solver/distributed.hpp"
+#include "solver/tree.hpp"
+#include "util/fixed_vector.hpp"
+#include "util/result.hpp"
+#include "util/stack_allocator.hpp"
+#include "util/tcp_socket.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+static constexpr int NumWorkers = 2;
+static constexpr int NumIterations = 10;
+
+// Worker thread serving one coordinator on a free local port
+struct LocalWorker {
+    explicit LocalWorker(const IGameRules& rules) : listener{ std::move(TcpListener::listen(0).getValue()) } {
+        tree.buildTreeSkeleton(rules);
+        address = "localhost:" + std::to_string(listener.getPort());
+        thread = std::thread([this, &rules]() {
+            Result<TcpConnection> connection = listener.accept();
+            if (connection.isValue()) {
+                sessionEnd.emplace(serveCoordinator(rules, tree, 1, connection.getValue()));
+            }
+        });
+    }
+
+    Tree tree;
+    TcpListener listener;
+    std::string address;
+    std::thread thread;
+    std::optional<Result<WorkerSessionEnd>> sessionEnd;
+};
+} // namespace
+
+TEST(DistributedTest, DistributedSolveMatchesLocalSolve) {
+    Holdem holdemRules{ getHoldemTestSettings(TurnTestSpot) };
+    StackAllocator allocator(1);
+
+    // Simultaneous updates send both players' reach probabilities and expected values through the workers
+    for (bool useSimultaneousUpdates : { false, true }) {
+        SCOPED_TRACE(useSimultaneousUpdates ? "simultaneous updates" : "alternating updates");
+
+        Tree localTree;
+        localTree.buildTreeSkeleton(holdemRules);
+        localTree.initCfrVectors();
+        trainDiscountedCfrIterations(holdemRules, localTree, NumIterations, allocator, useSimultaneousUpdates);
+        float localExploitability = calculateExploitabilityFast(holdemRules, localTree, allocator);
+        float localExpectedValue = expectedValue(Player::P0, holdemRules, localTree, allocator);
+
+        std::vector<std::unique_ptr<LocalWorker>> workers;
+        std::vector<std::string> addresses;
+        for (int i = 0; i < NumWorkers; ++i) {
+            workers.push_back(std::make_unique<LocalWorker>(holdemRules));
+            addresses.push_back(workers.back()->address);
+        }
+
+        Tree coordinatorTree;
+        coordinatorTree.buildTreeSkeleton(holdemRules);
+        ASSERT_GT(coordinatorTree.getNumberOfSubtrees(), static_cast<std::size_t>(NumWorkers));
+
+        Result<std::unique_ptr<DistributedCoordinator>> coordinatorResult = DistributedCoordinator::connect(addresses, holdemRules, coordinatorTree, 1);
+        ASSERT_TRUE(coordinatorResult.isValue());
+        DistributedCoordinator& coordinator = *coordinatorResult.getValue();
+        EXPECT_TRUE(coordinatorTree.isTrainingDataPartial());
+
+        coordinator.start();
+        trainDiscountedCfrIterations(holdemRules, coordinatorTree, NumIterations, allocator, useSimultaneousUpdates);
+        float distributedExploitability = calculateExploitabilityFast(holdemRules, coordinatorTree, allocator);
+        float distributedExpectedValue = expectedValue(Player::P0, holdemRules, coordinatorTree, allocator);
+        coordinator.stop();
+
+        EXPECT_FALSE(coordinator.getError().has_value());
+        coordinator.shutdownWorkers();
+        for (const std::unique_ptr<LocalWorker>& worker : workers) {
+            worker->thread.join();
+            ASSERT_TRUE(worker->sessionEnd.has_value() && worker->sessionEnd->isValue());
+            EXPECT_EQ(worker->sessionEnd->getValue(), WorkerSessionEnd::Shutdown);
+        }
+
+        // Each child is traversed the same way as in a local solve, so the results match exactly
+        EXPECT_FLOAT_EQ(distributedExploitability, localExploitability);
+        EXPECT_FLOAT_EQ(distributedExpectedValue, localExpectedValue);
+
+        const Node& root = localTree.allNodes[localTree.getRootNodeIndex()];
+        std::size_t numRootTrainingValues = root.numChildren * holdemRules.getValidHands(root.playerToAct, root.board).size();
+        for (std::size_t i = 0; i < numRootTrainingValues; ++i) {
+            EXPECT_EQ(coordinatorTree.allRegretSums[root.trainingDataOffset + i], localTree.allRegretSums[root.trainingDataOffset + i]);
+        }
+    }
+}
+
+TEST(DistributedTest, WorkerWithDifferentTreeIsRejected) {
+    Holdem holdemRules{ getHoldemTestSettings(TurnTestSpot) };
+    LeducPoker leducRules{ true };
+
+    LocalWorker worker{ leducRules };
+
+    Tree coordinatorTree;
+    coordinatorTree.buildTreeSkeleton(holdemRules);
+    Result<std::unique_ptr<DistributedCoordinator>> coordinatorResult = DistributedCoordinator::connect({ worker.address }, holdemRules, coordinatorTree, 1);
+    EXPECT_TRUE(coordinatorResult.isError());
+
+    worker.thread.join();
+    ASSERT_TRUE(worker.sessionEnd.has_value());
+    EXPECT_TRUE(worker.sessionEnd->isError());
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include "holdem_test_settings.hpp"
+
 #include "game/game_types.hpp"
 #include "game/kuhn_poker.hpp"
 #include "game/leduc_poker.hpp"
@@ -7,8 +9,15 @@
 #include "game/holdem/holdem.hpp"
 #include "solver/cfr.hpp"
 #include "solver/tree.hpp"
+#include "util/fixed_vector.hpp"
 #include "util/stack_allocator.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 namespace {
 static constexpr int KuhnIterations = 100000;
 static constexpr int LeducIterations = 10000;
@@ -37,27 +46,53 @@ DiscountParams getTestingDiscountParams(int index) {
     return getDiscountParams(1.5f, 0.0f, 2.0f, index + 1);
 }
 
-Holdem::Settings getHoldemTestSettings() {
-    CardSet testingCommunityCards = buildCommunityCardsFromString("9s, 8h, 3s").getValue();
+const HoldemTestSpot FlopTestSpot = {
+    .communityCards = "9s, 8h, 3s",
+    .ranges = { "AA, KK, QQ, AK, AQs, A5s", "QQ, JJ, TT, 99, AKo, AQ, AJs, ATs, KQs, KJs, KTs, QJs, JTs, T9s" },
+    .raiseSizes = { 50 },
+    .startingPlayerWagers = 50,
+    .numThreads = NumHoldemThreads,
+};
+
+struct AllInRunoutTestResult {
+    std::size_t numNodes;
+    PlayerArray<float> expectedValues;
+    float exploitability;
+    std::vector<FixedVector<float, MaxNumActions>> rootStrategies;
+};
+
+// Trains the Holdem test tree with all in runouts evaluated directly or expanded into chance nodes
+AllInRunoutTestResult solveAllInRunoutTestTree(bool expandAllInRunouts, int numIterations) {
+    Holdem::Settings testSettings = getHoldemTestSettings(FlopTestSpot);
+    testSettings.expandAllInRunouts = expandAllInRunouts;
 
-    PlayerArray<Holdem::Range> testingRanges = {
-        buildRangeFromString("AA, KK, QQ, AK, AQs, A5s", testingCommunityCards).getValue(),
-        buildRangeFromString("QQ, JJ, TT, 99, AKo, AQ, AJs, ATs, KQs, KJs, KTs, QJs, JTs, T9s", testingCommunityCards).getValue(),
-    };
+    Holdem holdemRules(testSettings);
+    Tree tree;
+    tree.buildTreeSkeleton(holdemRules);
+    tree.initCfrVectors();
 
-    static constexpr FixedVector<int, holdem::MaxNumBetSizes> BetSizes = { 50 };
-    static constexpr FixedVector<int, holdem::MaxNumRaiseSizes> RaiseSizes = { 50 };
+    StackAllocator allocator(NumHoldemThreads);
+
+    for (int i = 0; i < numIterations; ++i) {
+        for (Player hero : { Player::P0, Player::P1 }) {
+            discountedCfr(hero, holdemRules, getTestingDiscountParams(i), tree, allocator);
+        }
+    }
+
+    const Node& root = tree.allNodes[tree.getRootNodeIndex()];
+    std::vector<FixedVector<float, MaxNumActions>> rootStrategies;
+    for (int hand = 0; hand < tree.rangeSize[root.playerToAct]; ++hand) {
+        rootStrategies.push_back(getFinalStrategy(holdemRules, hand, root, tree));
+    }
 
     return {
-        .ranges = testingRanges,
-        .startingCommunityCards = testingCommunityCards,
-        .betSizes = { { BetSizes, BetSizes, BetSizes },  { BetSizes, BetSizes, BetSizes } },
-        .raiseSizes = { { RaiseSizes, RaiseSizes, RaiseSizes },  { RaiseSizes, RaiseSizes, RaiseSizes } },
-        .startingPlayerWagers = 50,
-        .effectiveStackRemaining = 100,
-        .deadMoney = 0,
-        .useChanceCardIsomorphism = true,
-        .numThreads = NumHoldemThreads
+        .numNodes = tree.allNodes.size(),
+        .expectedValues = {
+            expectedValue(Player::P0, holdemRules, tree, allocator),
+            expectedValue(Player::P1, holdemRules, tree, allocator)
+        },
+        .exploitability = calculateExploitability(holdemRules, tree, allocator),
+        .rootStrategies = rootStrategies
     };
 }
 } // namespace
@@ -73,7 +108,7 @@ TEST(EndToEndTest, Kuhn) {
 
     tree.initCfrVectors();
 
-    StackAllocator<float> allocator(1);
+    StackAllocator allocator(1);
 
     for (int i = 0; i < KuhnIterations; ++i) {
         for (Player hero : { Player::P0, Player::P1 }) {
@@ -109,31 +144,31 @@ TEST(EndToEndTest, Kuhn) {
     // The first player is free to choose a probability 0 <= alpha <= 1/3 that they will bet with a Jack
     const Node& root = tree.allNodes[tree.getRootNodeIndex()];
     ASSERT_EQ(root.nodeType, NodeType::Decision);
-    float alpha = getFinalStrategy(KuhnHandID::Jack, root, tree)[KuhnActionID::BetOrCall];
+    float alpha = getFinalStrategy(kuhnPokerRules, KuhnHandID::Jack, root, tree)[KuhnActionID::BetOrCall];
     ASSERT_GE(alpha, 0.0f);
     ASSERT_LE(alpha, 1.0f / 3.0f);
-    ASSERT_NEAR(getFinalStrategy(KuhnHandID::Queen, root, tree)[KuhnActionID::BetOrCall], 0.0f, StrategyEpsilon);
-    ASSERT_NEAR(getFinalStrategy(KuhnHandID::King, root, tree)[KuhnActionID::BetOrCall], 3.0f * alpha, StrategyEpsilon);
+    ASSERT_NEAR(getFinalStrategy(kuhnPokerRules, KuhnHandID::Queen, root, tree)[KuhnActionID::BetOrCall], 0.0f, StrategyEpsilon);
+    ASSERT_NEAR(getFinalStrategy(kuhnPokerRules, KuhnHandID::King, root, tree)[KuhnActionID::BetOrCall], 3.0f * alpha, StrategyEpsilon);
 
     // Check, player 1 to act
     const Node& check = tree.allNodes[root.childrenOffset + KuhnActionID::CheckOrFold];
     ASSERT_EQ(check.nodeType, NodeType::Decision);
-    ASSERT_NEAR(getFinalStrategy(KuhnHandID::Jack, check, tree)[KuhnActionID::BetOrCall], 1.0f / 3.0f, StrategyEpsilon);
-    ASSERT_NEAR(getFinalStrategy(KuhnHandID::Queen, check, tree)[KuhnActionID::BetOrCall], 0.0f, StrategyEpsilon);
-    ASSERT_NEAR(getFinalStrategy(KuhnHandID::King, check, tree)[KuhnActionID::BetOrCall], 1.0f, StrategyEpsilon);
+    ASSERT_NEAR(getFinalStrategy(kuhnPokerRules, KuhnHandID::Jack, check, tree)[KuhnActionID::BetOrCall], 1.0f / 3.0f, StrategyEpsilon);
+    ASSERT_NEAR(getFinalStrategy(kuhnPokerRules, KuhnHandID::Queen, check, tree)[KuhnActionID::BetOrCall], 0.0f, StrategyEpsilon);
+    ASSERT_NEAR(getFinalStrategy(kuhnPokerRules, KuhnHandID::King, check, tree)[KuhnActionID::BetOrCall], 1.0f, StrategyEpsilon);
 
     // Check Bet, player 0 to act
     const Node& checkBet = tree.allNodes[check.childrenOffset + KuhnActionID::BetOrCall];
     ASSERT_EQ(checkBet.nodeType, NodeType::Decision);
-    ASSERT_NEAR(getFinalStrategy(KuhnHandID::Jack, checkBet, tree)[KuhnActionID::BetOrCall], 0.0f, StrategyEpsilon);
-    ASSERT_NEAR(getFinalStrategy(KuhnHandID::Queen, checkBet, tree)[KuhnActionID::BetOrCall], alpha + (1.0f / 3.0f), StrategyEpsilon);
-    ASSERT_NEAR(getFinalStrategy(KuhnHandID::King, checkBet, tree)[KuhnActionID::BetOrCall], 1.0f, StrategyEpsilon);
+    ASSERT_NEAR(getFinalStrategy(kuhnPokerRules, KuhnHandID::Jack, checkBet, tree)[KuhnActionID::BetOrCall], 0.0f, StrategyEpsilon);
+    ASSERT_NEAR(getFinalStrategy(kuhnPokerRules, KuhnHandID::Queen, checkBet, tree)[KuhnActionID::BetOrCall], alpha + (1.0f / 3.0f), StrategyEpsilon);
+    ASSERT_NEAR(getFinalStrategy(kuhnPokerRules, KuhnHandID::King, checkBet, tree)[KuhnActionID::BetOrCall], 1.0f, StrategyEpsilon);
 
     // Bet, player 1 to act
     const Node& bet = tree.allNodes[root.childrenOffset + KuhnActionID::BetOrCall];
-    ASSERT_NEAR(getFinalStrategy(KuhnHandID::Jack, bet, tree)[KuhnActionID::BetOrCall], 0.0f, StrategyEpsilon);
-    ASSERT_NEAR(getFinalStrategy(KuhnHandID::Queen, bet, tree)[KuhnActionID::BetOrCall], 1.0f / 3.0f, StrategyEpsilon);
-    ASSERT_NEAR(getFinalStrategy(KuhnHandID::King, bet, tree)[KuhnActionID::BetOrCall], 1.0f, StrategyEpsilon);
+    ASSERT_NEAR(getFinalStrategy(kuhnPokerRules, KuhnHandID::Jack, bet, tree)[KuhnActionID::BetOrCall], 0.0f, StrategyEpsilon);
+    ASSERT_NEAR(getFinalStrategy(kuhnPokerRules, KuhnHandID::Queen, bet, tree)[KuhnActionID::BetOrCall], 1.0f / 3.0f, StrategyEpsilon);
+    ASSERT_NEAR(getFinalStrategy(kuhnPokerRules, KuhnHandID::King, bet, tree)[KuhnActionID::BetOrCall], 1.0f, StrategyEpsilon);
 }
 
 TEST(EndToEndTest, LeducWithoutIsomorphism) {
@@ -147,7 +182,7 @@ TEST(EndToEndTest, LeducWithoutIsomorphism) {
 
     tree.initCfrVectors();
 
-    StackAllocator<float> allocator(1);
+    StackAllocator allocator(1);
 
     for (int i = 0; i < LeducIterations; ++i) {
         for (Player hero : { Player::P0, Player::P1 }) {
@@ -178,7 +213,7 @@ TEST(EndToEndTest, LeducWithIsomorphism) {
 
     tree.initCfrVectors();
 
-    StackAllocator<float> allocator(1);
+    StackAllocator allocator(1);
 
     for (int i = 0; i < LeducIterations; ++i) {
         for (Player hero : { Player::P0, Player::P1 }) {
@@ -198,6 +233,31 @@ TEST(EndToEndTest, LeducWithIsomorphism) {
     ASSERT_NEAR(exploitability, 0.0f, ExploitabilityEpsilon);
 }
 
+TEST(EndToEndTest, LeducWithPruning) {
+    static constexpr int PruningRevisitFrequency = 10;
+
+    LeducPoker leducPokerRules(true);
+    Tree tree;
+    tree.buildTreeSkeleton(leducPokerRules);
+    tree.initCfrVectors();
+
+    StackAllocator allocator(1);
+
+    for (int i = 0; i < LeducIterations; ++i) {
+        bool usePruning = ((i + 1) % PruningRevisitFrequency != 0);
+        for (Player hero : { Player::P0, Player::P1 }) {
+            discountedCfr(hero, leducPokerRules, getTestingDiscountParams(i), tree, allocator, usePruning);
+        }
+    }
+
+    float player0ExpectedValue = expectedValue(Player::P0, leducPokerRules, tree, allocator);
+    EXPECT_NEAR(player0ExpectedValue, LeducPlayer0ExpectedValue, StrategyEpsilon);
+
+    float exploitability = calculateExploitability(leducPokerRules, tree, allocator);
+    ASSERT_GE(exploitability, 0.0f);
+    ASSERT_NEAR(exploitability, 0.0f, ExploitabilityEpsilon);
+}
+
 TEST(EndToEndTest, LeducWithIsomorphismParallel) {
     #ifdef _OPENMP
     LeducPoker leducPokerRules(true);
@@ -210,7 +270,7 @@ TEST(EndToEndTest, LeducWithIsomorphismParallel) {
 
     tree.initCfrVectors();
 
-    StackAllocator<float> allocator(NumParallelThreads);
+    StackAllocator allocator(NumParallelThreads);
     #pragma omp parallel num_threads(NumParallelThreads)
     {
         #pragma omp single
@@ -257,7 +317,7 @@ TEST(EndToEndTest, LeducSerialAndParallelAreIdentical) {
         tree.buildTreeSkeleton(leducPokerRules);
         tree.initCfrVectors();
 
-        StackAllocator<float> allocator(1);
+        StackAllocator allocator(1);
 
         for (int i = 0; i < LeducIterations; ++i) {
             for (Player hero : { Player::P0, Player::P1 }) {
@@ -279,7 +339,7 @@ TEST(EndToEndTest, LeducSerialAndParallelAreIdentical) {
         tree.buildTreeSkeleton(leducPokerRules);
         tree.initCfrVectors();
 
-        StackAllocator<float> allocator(NumParallelThreads);
+        StackAllocator allocator(NumParallelThreads);
         #pragma omp parallel num_threads(NumParallelThreads)
         {
             #pragma omp single
@@ -306,12 +366,12 @@ TEST(EndToEndTest, LeducSerialAndParallelAreIdentical) {
 }
 
 TEST(EndToEndTest, HoldemWithoutDeadMoney) {
-    Holdem holdemRules(getHoldemTestSettings());
+    Holdem holdemRules(getHoldemTestSettings(FlopTestSpot));
     Tree tree;
     tree.buildTreeSkeleton(holdemRules);
     tree.initCfrVectors();
 
-    StackAllocator<float> allocator(NumHoldemThreads);
+    StackAllocator allocator(NumHoldemThreads);
 
     for (int i = 0; i < HoldemIterations; ++i) {
         for (Player hero : { Player::P0, Player::P1 }) {
@@ -329,7 +389,7 @@ TEST(EndToEndTest, HoldemWithoutDeadMoney) {
 
 TEST(EndToEndTest, HoldemWithDeadMoney) {
     static constexpr int DeadMoney = 10;
-    Holdem::Settings testSettings = getHoldemTestSettings();
+    Holdem::Settings testSettings = getHoldemTestSettings(FlopTestSpot);
     testSettings.deadMoney = DeadMoney;
 
     Holdem holdemRules(testSettings);
@@ -337,7 +397,7 @@ TEST(EndToEndTest, HoldemWithDeadMoney) {
     tree.buildTreeSkeleton(holdemRules);
     tree.initCfrVectors();
 
-    StackAllocator<float> allocator(NumHoldemThreads);
+    StackAllocator allocator(NumHoldemThreads);
 
     for (int i = 0; i < HoldemIterations; ++i) {
         for (Player hero : { Player::P0, Player::P1 }) {
@@ -349,4 +409,363 @@ TEST(EndToEndTest, HoldemWithDeadMoney) {
     float player0ExpectedValue = expectedValue(Player::P0, holdemRules, tree, allocator);
     float player1ExpectedValue = expectedValue(Player::P1, holdemRules, tree, allocator);
     EXPECT_NEAR(player0ExpectedValue + player1ExpectedValue, DeadMoney, 0.1f);
-}
\ No newline at end of file
+}
+
+TEST(EndToEndTest, HoldemPruningKeepsUpdatesOfUnreachedSubtrees) {
+    // The regrets of the first iterations are too small for any action to be pruned,
+    // so pruning only skips the expected values of the subtrees the villain never reaches, which must not change the solution
+    static constexpr int NumIterations = 5;
+
+    Holdem holdemRules(getHoldemTestSettings(FlopTestSpot));
+    Tree regularTree;
+    Tree prunedTree;
+    for (Tree* tree : { &regularTree, &prunedTree }) {
+        tree->buildTreeSkeleton(holdemRules);
+        tree->initCfrVectors();
+    }
+
+    StackAllocator allocator(NumHoldemThreads);
+
+    for (int i = 0; i < NumIterations; ++i) {
+        for (Player hero : { Player::P0, Player::P1 }) {
+            discountedCfr(hero, holdemRules, getTestingDiscountParams(i), regularTree, allocator, false);
+            discountedCfr(hero, holdemRules, getTestingDiscountParams(i), prunedTree, allocator, true);
+        }
+    }
+
+    float regularExploitability = calculateExploitability(holdemRules, regularTree, allocator);
+    float prunedExploitability = calculateExploitability(holdemRules, prunedTree, allocator);
+    EXPECT_NEAR(prunedExploitability, regularExploitability, 1e-3f * regularExploitability);
+
+    float regularExpectedValue = expectedValue(Player::P0, holdemRules, regularTree, allocator);
+    float prunedExpectedValue = expectedValue(Player::P0, holdemRules, prunedTree, allocator);
+    EXPECT_NEAR(prunedExpectedValue, regularExpectedValue, 1e-3f);
+}
+
+TEST(EndToEndTest, HoldemAllInRunoutsMatchExpandedRunouts) {
+    // The trees are evaluated with the starting uniform strategy, so only the all in runout calculation differs between them
+    AllInRunoutTestResult direct = solveAllInRunoutTestTree(false, 0);
+    AllInRunoutTestResult expanded = solveAllInRunoutTestTree(true, 0);
+
+    // Only float rounding should differ
+    static constexpr float AllInRunoutEpsilon = 1e-3f;
+
+    EXPECT_LT(direct.numNodes, expanded.numNodes);
+    EXPECT_NEAR(direct.expectedValues[Player::P0], expanded.expectedValues[Player::P0], AllInRunoutEpsilon);
+    EXPECT_NEAR(direct.expectedValues[Player::P1], expanded.expectedValues[Player::P1], AllInRunoutEpsilon);
+    EXPECT_NEAR(direct.exploitability, expanded.exploitability, AllInRunoutEpsilon);
+}
+
+TEST(EndToEndTest, HoldemTrainedAllInRunoutsMatchExpandedRunouts) {
+    // Training moves both players away from the uniform strategy, so the all in runouts are weighted by uneven reach probabilities
+    // Both layouts calculate the same expected values, so they train the same strategy up to float rounding
+    static constexpr int NumIterations = 20;
+    AllInRunoutTestResult direct = solveAllInRunoutTestTree(false, NumIterations);
+    AllInRunoutTestResult expanded = solveAllInRunoutTestTree(true, NumIterations);
+
+    static constexpr float AllInRunoutEpsilon = 1e-2f;
+
+    EXPECT_NEAR(direct.expectedValues[Player::P0], expanded.expectedValues[Player::P0], AllInRunoutEpsilon);
+    EXPECT_NEAR(direct.expectedValues[Player::P1], expanded.expectedValues[Player::P1], AllInRunoutEpsilon);
+    EXPECT_NEAR(direct.exploitability, expanded.exploitability, AllInRunoutEpsilon);
+
+    bool isRootStrategyUniform = true;
+    ASSERT_EQ(direct.rootStrategies.size(), expanded.rootStrategies.size());
+    for (std::size_t hand = 0; hand < direct.rootStrategies.size(); ++hand) {
+        ASSERT_EQ(direct.rootStrategies[hand].size(), expanded.rootStrategies[hand].size());
+        for (int action = 0; action < direct.rootStrategies[hand].size(); ++action) {
+            EXPECT_NEAR(direct.rootStrategies[hand][action], expanded.rootStrategies[hand][action], StrategyEpsilon);
+            float uniformProbability = 1.0f / static_cast<float>(direct.rootStrategies[hand].size());
+            isRootStrategyUniform = isRootStrategyUniform && std::abs(direct.rootStrategies[hand][action] - uniformProbability) < StrategyEpsilon;
+        }
+    }
+    EXPECT_FALSE(isRootStrategyUniform);
+}
+
+TEST(EndToEndTest, LeducWithCompressedTrainingData) {
+    LeducPoker leducPokerRules(true);
+    Tree tree(true);
+    tree.buildTreeSkeleton(leducPokerRules);
+    tree.initCfrVectors();
+    ASSERT_TRUE(tree.isTrainingDataCompressed());
+
+    StackAllocator allocator(1);
+
+    for (int i = 0; i < LeducIterations; ++i) {
+        for (Player hero : { Player::P0, Player::P1 }) {
+            discountedCfr(hero, leducPokerRules, getTestingDiscountParams(i), tree, allocator);
+        }
+    }
+
+    // Quantization loses some precision, so use a looser bound than the uncompressed tests
+    static constexpr float CompressedEpsilon = 1e-2f;
+
+    float player0ExpectedValue = expectedValue(Player::P0, leducPokerRules, tree, allocator);
+    float player1ExpectedValue = expectedValue(Player::P1, leducPokerRules, tree, allocator);
+    EXPECT_NEAR(player0ExpectedValue, LeducPlayer0ExpectedValue, CompressedEpsilon);
+    EXPECT_NEAR(player1ExpectedValue, -LeducPlayer0ExpectedValue, CompressedEpsilon);
+
+    float exploitability = calculateExploitability(leducPokerRules, tree, allocator);
+    ASSERT_GE(exploitability, 0.0f);
+    ASSERT_NEAR(exploitability, 0.0f, ExploitabilityEpsilon);
+}
+
+TEST(EndToEndTest, HoldemWithCompressedTrainingData) {
+    Holdem holdemRules(getHoldemTestSettings(FlopTestSpot));
+    Tree tree(true);
+    tree.buildTreeSkeleton(holdemRules);
+    tree.initCfrVectors();
+    ASSERT_TRUE(tree.isTrainingDataCompressed());
+
+    StackAllocator allocator(NumHoldemThreads);
+
+    for (int i = 0; i < HoldemIterations; ++i) {
+        for (Player hero : { Player::P0, Player::P1 }) {
+            discountedCfr(hero, holdemRules, getTestingDiscountParams(i), tree, allocator);
+        }
+    }
+
+    static constexpr float HoldemTestExpectedValue = 19.0f;
+
+    float player0ExpectedValue = expectedValue(Player::P0, holdemRules, tree, allocator);
+    float player1ExpectedValue = expectedValue(Player::P1, holdemRules, tree, allocator);
+    EXPECT_NEAR(player0ExpectedValue, HoldemTestExpectedValue, 0.1f);
+    EXPECT_NEAR(player1ExpectedValue, -HoldemTestExpectedValue, 0.1f);
+}
+
+TEST(EndToEndTest, CombinedBestResponseMatchesSeparateTraversals) {
+    static constexpr int NumIterations = 10;
+
+    auto expectSameBestResponses = [](const IGameRules& rules, Tree& tree, StackAllocator& allocator) -> void {
+        PlayerArray<float> bestResponseExpectedValues = bestResponseEVs(rules, tree, allocator);
+        EXPECT_EQ(bestResponseExpectedValues[Player::P0], bestResponseEV(Player::P0, rules, tree, allocator));
+        EXPECT_EQ(bestResponseExpectedValues[Player::P1], bestResponseEV(Player::P1, rules, tree, allocator));
+    };
+
+    LeducPoker leducPokerRules(true);
+    Tree leducTree;
+    leducTree.buildTreeSkeleton(leducPokerRules);
+    leducTree.initCfrVectors();
+
+    StackAllocator leducAllocator(1);
+    for (int i = 0; i < NumIterations; ++i) {
+        for (Player hero : { Player::P0, Player::P1 }) {
+            discountedCfr(hero, leducPokerRules, getTestingDiscountParams(i), leducTree, leducAllocator);
+        }
+    }
+    expectSameBestResponses(leducPokerRules, leducTree, leducAllocator);
+
+    Holdem holdemRules(getHoldemTestSettings(FlopTestSpot));
+    Tree holdemTree;
+    holdemTree.buildTreeSkeleton(holdemRules);
+    holdemTree.initCfrVectors();
+
+    StackAllocator holdemAllocator(1);
+    for (int i = 0; i < NumIterations; ++i) {
+        for (Player hero : { Player::P0, Player::P1 }) {
+            discountedCfr(hero, holdemRules, getTestingDiscountParams(i), holdemTree, holdemAllocator);
+        }
+    }
+    expectSameBestResponses(holdemRules, holdemTree, holdemAllocator);
+}
+
+TEST(EndToEndTest, LeducWithChanceSampling) {
+    static constexpr ChanceSampling Sampling = { .numSampledCards = 1, .seed = 0 };
+
+    LeducPoker leducPokerRules(true);
+    Tree tree;
+    tree.buildTreeSkeleton(leducPokerRules);
+    tree.initCfrVectors();
+
+    StackAllocator allocator(1);
+
+    // Sampled iterations at the start, then regular iterations to remove the sampling noise
+    for (int i = 0; i < LeducIterations; ++i) {
+        for (Player hero : { Player::P0, Player::P1 }) {
+            if (i < LeducIterations / 10) {
+                ChanceSampling sampling = Sampling;
+                sampling.seed = static_cast<std::uint64_t>(i);
+                sampledDiscountedCfr(hero, leducPokerRules, getTestingDiscountParams(i), sampling, tree, allocator);
+            }
+            else {
+                discountedCfr(hero, leducPokerRules, getTestingDiscountParams(i), tree, allocator);
+            }
+        }
+    }
+
+    float player0ExpectedValue = expectedValue(Player::P0, leducPokerRules, tree, allocator);
+    EXPECT_NEAR(player0ExpectedValue, LeducPlayer0ExpectedValue, StrategyEpsilon);
+
+    float exploitability = calculateExploitability(leducPokerRules, tree, allocator);
+    ASSERT_GE(exploitability, 0.0f);
+    ASSERT_NEAR(exploitability, 0.0f, ExploitabilityEpsilon);
+}
+
+TEST(EndToEndTest, ChanceSamplingDiscountsSkippedNodesLater) {
+    static constexpr int NumSampledIterations = 10;
+    static constexpr ChanceSampling Sampling = { .numSampledCards = 1, .seed = 0 };
+
+    LeducPoker leducPokerRules(true);
+    Tree tree;
+    tree.buildTreeSkeleton(leducPokerRules);
+    tree.initCfrVectors();
+
+    StackAllocator allocator(1);
+
+    for (int i = 0; i < NumSampledIterations; ++i) {
+        for (Player hero : { Player::P0, Player::P1 }) {
+            sampledDiscountedCfr(hero, leducPokerRules, getTestingDiscountParams(i), Sampling, tree, allocator);
+        }
+    }
+
+    // The nodes after the cards that were not dealt are behind on their discounts
+    EXPECT_TRUE(std::any_of(tree.allLastDiscountedIterations.begin(), tree.allLastDiscountedIterations.end(), [](std::int32_t iteration) {
+        return iteration < NumSampledIterations;
+    }));
+
+    // A regular iteration visits every node, which catches each of them up on the discounts it missed
+    for (Player hero : { Player::P0, Player::P1 }) {
+        discountedCfr(hero, leducPokerRules, getTestingDiscountParams(NumSampledIterations), tree, allocator);
+    }
+    EXPECT_TRUE(std::all_of(tree.allLastDiscountedIterations.begin(), tree.allLastDiscountedIterations.end(), [](std::int32_t iteration) {
+        return iteration == NumSampledIterations + 1;
+    }));
+}
+
+TEST(EndToEndTest, HoldemWithChanceSampling) {
+    static constexpr int NumSampledIterations = HoldemIterations / 5;
+
+    Holdem holdemRules(getHoldemTestSettings(FlopTestSpot));
+    StackAllocator allocator(NumHoldemThreads);
+
+    // Sampling at least as many cards as every chance node has children visits every card, so it matches Discounted CFR exactly
+    Tree regularTree;
+    regularTree.buildTreeSkeleton(holdemRules);
+    regularTree.initCfrVectors();
+
+    Tree everyCardTree;
+    everyCardTree.buildTreeSkeleton(holdemRules);
+    everyCardTree.initCfrVectors();
+
+    for (int i = 0; i < NumSampledIterations; ++i) {
+        for (Player hero : { Player::P0, Player::P1 }) {
+            ChanceSampling sampling = { .numSampledCards = StandardDeckSize, .seed = static_cast<std::uint64_t>(i) };
+            discountedCfr(hero, holdemRules, getTestingDiscountParams(i), regularTree, allocator);
+            sampledDiscountedCfr(hero, holdemRules, getTestingDiscountParams(i), sampling, everyCardTree, allocator);
+        }
+    }
+    EXPECT_EQ(regularTree.allRegretSums, everyCardTree.allRegretSums);
+    EXPECT_EQ(calculateExploitabilityFast(holdemRules, regularTree, allocator), calculateExploitabilityFast(holdemRules, everyCardTree, allocator));
+
+    // A few sampled cards per chance node still converge once regular iterations take over
+    Tree sampledTree;
+    sampledTree.buildTreeSkeleton(holdemRules);
+    sampledTree.initCfrVectors();
+
+    for (int i = 0; i < HoldemIterations; ++i) {
+        for (Player hero : { Player::P0, Player::P1 }) {
+            if (i < NumSampledIterations) {
+                ChanceSampling sampling = { .numSampledCards = 4, .seed = static_cast<std::uint64_t>(i) };
+                sampledDiscountedCfr(hero, holdemRules, getTestingDiscountParams(i), sampling, sampledTree, allocator);
+            }
+            else {
+                discountedCfr(hero, holdemRules, getTestingDiscountParams(i), sampledTree, allocator);
+            }
+        }
+    }
+
+    // Within 1% of the starting pot
+    static constexpr float MaxExploitability = 1.0f;
+
+    float exploitability = calculateExploitabilityFast(holdemRules, sampledTree, allocator);
+    ASSERT_GE(exploitability, 0.0f);
+    EXPECT_LT(exploitability, MaxExploitability);
+}
+
+TEST(EndToEndTest, SimultaneousUpdatesMatchSeparateUpdates) {
+    static constexpr int NumWarmupIterations = 10;
+
+    LeducPoker leducPokerRules(true);
+    StackAllocator allocator(1);
+
+    // One tree is updated simultaneously, the other two only update one player each from the same starting point
+    PlayerArray<Tree> separateTrees;
+    Tree simultaneousTree;
+    for (Tree* tree : { &separateTrees[Player::P0], &separateTrees[Player::P1], &simultaneousTree }) {
+        tree->buildTreeSkeleton(leducPokerRules);
+        tree->initCfrVectors();
+
+        for (int i = 0; i < NumWarmupIterations; ++i) {
+            for (Player hero : { Player::P0, Player::P1 }) {
+                discountedCfr(hero, leducPokerRules, getTestingDiscountParams(i), *tree, allocator);
+            }
+        }
+    }
+
+    DiscountParams params = getTestingDiscountParams(NumWarmupIterations);
+    for (Player hero : { Player::P0, Player::P1 }) {
+        discountedCfr(hero, leducPokerRules, params, separateTrees[hero], allocator);
+    }
+    simultaneousDiscountedCfr(leducPokerRules, params, { .numSampledCards = 0, .seed = 0 }, simultaneousTree, allocator);
+
+    // Every decision node is updated against the strategies from before the iteration, so it matches the tree of the player to act
+    for (const Node& node : simultaneousTree.allNodes) {
+        if (node.nodeType != NodeType::Decision) continue;
+
+        const Tree& separateTree = separateTrees[node.playerToAct];
+        std::size_t trainingDataSize = node.numChildren * leducPokerRules.getValidHands(node.playerToAct, node.board).size();
+        for (std::size_t i = node.trainingDataOffset; i < node.trainingDataOffset + trainingDataSize; ++i) {
+            EXPECT_EQ(simultaneousTree.allRegretSums[i], separateTree.allRegretSums[i]);
+            EXPECT_EQ(simultaneousTree.allStrategySums[i], separateTree.allStrategySums[i]);
+        }
+    }
+}
+
+TEST(EndToEndTest, LeducWithSimultaneousUpdates) {
+    static constexpr int PruningRevisitFrequency = 10;
+
+    LeducPoker leducPokerRules(true);
+    Tree tree;
+    tree.buildTreeSkeleton(leducPokerRules);
+    tree.initCfrVectors();
+
+    StackAllocator allocator(1);
+
+    for (int i = 0; i < LeducIterations; ++i) {
+        bool usePruning = ((i + 1) % PruningRevisitFrequency != 0);
+        simultaneousDiscountedCfr(leducPokerRules, getTestingDiscountParams(i), { .numSampledCards = 0, .seed = 0 }, tree, allocator, usePruning);
+    }
+
+    float player0ExpectedValue = expectedValue(Player::P0, leducPokerRules, tree, allocator);
+    EXPECT_NEAR(player0ExpectedValue, LeducPlayer0ExpectedValue, StrategyEpsilon);
+
+    float exploitability = calculateExploitability(leducPokerRules, tree, allocator);
+    ASSERT_GE(exploitability, 0.0f);
+    ASSERT_NEAR(exploitability, 0.0f, ExploitabilityEpsilon);
+}
+
+TEST(EndToEndTest, HoldemWithSimultaneousUpdates) {
+    Holdem holdemRules(getHoldemTestSettings(FlopTestSpot));
+    Tree tree;
+    tree.buildTreeSkeleton(holdemRules);
+    tree.initCfrVectors();
+
+    StackAllocator allocator(NumHoldemThreads);
+
+    // Each simultaneous iteration is a single traversal, so twice as many are run as in the alternating tests
+    for (int i = 0; i < 2 * HoldemIterations; ++i) {
+        simultaneousDiscountedCfr(holdemRules, getTestingDiscountParams(i), { .numSampledCards = 0, .seed = 0 }, tree, allocator);
+    }
+
+    static constexpr float HoldemTestExpectedValue = 19.0f;
+
+    float player0ExpectedValue = expectedValue(Player::P0, holdemRules, tree, allocator);
+    EXPECT_NEAR(player0ExpectedValue, HoldemTestExpectedValue, 0.1f);
+
+    // Within 1% of the starting pot
+    static constexpr float MaxExploitability = 1.0f;
+
+    float exploitability = calculateExploitabilityFast(holdemRules, tree, allocator);
+    ASSERT_GE(exploitability, 0.0f);
+    EXPECT_LT(exploitability, MaxExploitability);
+}
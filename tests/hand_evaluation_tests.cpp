@@ -4,8 +4,11 @@
 #include "game/game_utils.hpp"
 #include "game/holdem/hand_evaluation.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
+#include <random>
+#include <string>
 #include <unordered_set>
 
 namespace {
@@ -73,4 +76,62 @@ TEST_F(HandEvaluationTest, CorrectNumberOfIsomorphicHands) {
     std::unordered_set<HandRank> handIsomorphisms(handRanks.begin(), handRanks.end());
     int numIsomorphicHands = handIsomorphisms.size();
     EXPECT_EQ(numIsomorphicHands, ExpectedNumIsomorphicHands);
-}
\ No newline at end of file
+}
+
+TEST(SevenCardHandEvaluationTest, MatchesBestFiveCardSubset) {
+    static constexpr int NumRandomHands = 200000;
+
+    auto getBestFiveCardHandRank = [](CardSet hand) -> HandRank {
+        std::array<CardID, 7> cards;
+        CardSet temp = hand;
+        for (CardID& card : cards) {
+            card = popLowestCardFromSet(temp);
+        }
+
+        HandRank bestHandRank = 0;
+        for (int i = 0; i < 7; ++i) {
+            for (int j = i + 1; j < 7; ++j) {
+                CardSet fiveCardHand = hand & ~(cardIDToSet(cards[i]) | cardIDToSet(cards[j]));
+                bestHandRank = std::max(bestHandRank, getFiveCardHandRank(fiveCardHand));
+            }
+        }
+        return bestHandRank;
+    };
+
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int> cardDistribution(0, 51);
+
+    for (int i = 0; i < NumRandomHands; ++i) {
+        CardSet hand = 0;
+        while (getSetSize(hand) < 7) {
+            hand |= cardIDToSet(static_cast<CardID>(cardDistribution(rng)));
+        }
+        ASSERT_EQ(getSevenCardHandRank(hand), getBestFiveCardHandRank(hand)) << "Hand: " << hand;
+    }
+}
+
+TEST(SevenCardHandEvaluationTest, HandlesSpecialCases) {
+    auto getRankFromString = [](const std::string& cards) -> HandRank {
+        CardSet hand = 0;
+        for (std::size_t i = 0; i < cards.size(); i += 2) {
+            hand |= cardIDToSet(getCardIDFromName(cards.substr(i, 2)).getValue());
+        }
+        return getSevenCardHandRank(hand);
+    };
+
+    // Wheel straight flush beats a higher flush in the same suit
+    EXPECT_EQ(getHandType(getRankFromString("Ah2h3h4h5hKhQc")), HandType::StraightFlush);
+
+    // Royal flush alongside a lower straight flush
+    EXPECT_EQ(getHandType(getRankFromString("AsKsQsJsTs9s2c")), HandType::RoyalFlush);
+
+    // Two sets of trips make a full house
+    EXPECT_EQ(getHandType(getRankFromString("KcKdKh7c7d7s2h")), HandType::FullHouse);
+
+    // Three pairs use the highest remaining card as the kicker
+    EXPECT_EQ(getHandType(getRankFromString("AcAd9c9d4c4dKh")), HandType::TwoPair);
+
+    // Flush and straight on the same board
+    EXPECT_EQ(getHandType(getRankFromString("2c5c9cJcKcTdQh")), HandType::Flush);
+    EXPECT_EQ(getHandType(getRankFromString("9c8d7h6s5c2d2h")), HandType::Straight);
+}
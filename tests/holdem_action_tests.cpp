@@ -193,15 +193,31 @@ TEST_F(HoldemActionTest, RiverAllInIsShowdown) {
     EXPECT_EQ(holdemRules.getNodeType(state), NodeType::Showdown);
 }
 
-TEST_F(HoldemActionTest, TurnAllInIsChanceShowdown) {
+TEST_F(HoldemActionTest, TurnAllInIsAllInRunout) {
     Holdem holdemRules{ testSettings };
     GameState state = simulateStreet(holdemRules, Street::Turn, { Check, BetSize1, AllIn, Call });
+    EXPECT_EQ(holdemRules.getNodeType(state), NodeType::AllInRunout);
+}
+
+TEST_F(HoldemActionTest, FlopAllInIsAllInRunout) {
+    Holdem holdemRules{ testSettings };
+    GameState state = simulateStreet(holdemRules, Street::Flop, { Check, BetSize1, AllIn, Call });
+    EXPECT_EQ(holdemRules.getNodeType(state), NodeType::AllInRunout);
+}
+
+TEST_F(HoldemActionTest, ExpandedTurnAllInIsChanceShowdown) {
+    Holdem::Settings expandedSettings = testSettings;
+    expandedSettings.expandAllInRunouts = true;
+    Holdem holdemRules{ expandedSettings };
+    GameState state = simulateStreet(holdemRules, Street::Turn, { Check, BetSize1, AllIn, Call });
     EXPECT_EQ(holdemRules.getNodeType(state), NodeType::Chance);
     EXPECT_EQ(holdemRules.getNodeType(getStateAfterChance(state)), NodeType::Showdown);
 }
 
-TEST_F(HoldemActionTest, FlopAllInIsChanceChanceShowdown) {
-    Holdem holdemRules{ testSettings };
+TEST_F(HoldemActionTest, ExpandedFlopAllInIsChanceChanceShowdown) {
+    Holdem::Settings expandedSettings = testSettings;
+    expandedSettings.expandAllInRunouts = true;
+    Holdem holdemRules{ expandedSettings };
     GameState state = simulateStreet(holdemRules, Street::Flop, { Check, BetSize1, AllIn, Call });
     EXPECT_EQ(holdemRules.getNodeType(state), NodeType::Chance);
 
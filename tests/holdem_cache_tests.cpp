@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include "test_helpers.hpp"
+
+#include "game/game_types.hpp"
+#include "game/game_utils.hpp"
+#include "game/holdem/config.hpp"
+#include "game/holdem/holdem_parser.hpp"
+#include "game/holdem/holdem.hpp"
+#include "util/fixed_vector.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+class HoldemCacheTest : public TemporaryPathTest {
+protected:
+    static inline Holdem::Settings testSettings;
+
+    static void SetUpTestSuite() {
+        PlayerArray<Holdem::Range> testingRanges = {
+            buildRangeFromString("AA, KJ, TT, AQo:0.50, 65s").getValue(),
+            buildRangeFromString("KK:0.25, QQ, T9s:0.33, 27o:0.99").getValue(),
+        };
+
+        static constexpr FixedVector<int, holdem::MaxNumBetSizes> BetSizes = { 50 };
+        static constexpr FixedVector<int, holdem::MaxNumRaiseSizes> RaiseSizes = { 100 };
+
+        testSettings = {
+            .ranges = testingRanges,
+            .startingCommunityCards = buildCommunityCardsFromString("Ah, 7c, 2s, 3d").getValue(),
+            .betSizes = { { BetSizes, BetSizes, BetSizes },  { BetSizes, BetSizes, BetSizes } },
+            .raiseSizes = { { RaiseSizes, RaiseSizes, RaiseSizes },  { RaiseSizes, RaiseSizes, RaiseSizes } },
+            .startingPlayerWagers = 10,
+            .effectiveStackRemaining = 100,
+            .deadMoney = 0,
+            .useChanceCardIsomorphism = true,
+            .numThreads = 1
+        };
+    }
+};
+
+void expectSameHandTables(const Holdem& actual, const Holdem& expected, CardSet startingBoard) {
+    for (CardID riverCard = 0; riverCard < holdem::DeckSize; ++riverCard) {
+        if (setContainsCard(startingBoard, riverCard)) continue;
+
+        CardSet board = startingBoard | cardIDToSet(riverCard);
+        for (Player player : { Player::P0, Player::P1 }) {
+            auto actualHands = actual.getValidHands(player, board);
+            auto expectedHands = expected.getValidHands(player, board);
+            ASSERT_TRUE(std::equal(actualHands.begin(), actualHands.end(), expectedHands.begin(), expectedHands.end()));
+
+            auto actualRanks = actual.getValidSortedHandRanks(player, board);
+            auto expectedRanks = expected.getValidSortedHandRanks(player, board);
+            ASSERT_TRUE(std::equal(actualRanks.begin(), actualRanks.end(), expectedRanks.begin(), expectedRanks.end()));
+        }
+    }
+}
+} // namespace
+
+TEST_F(HoldemCacheTest, EstimatedHandTablesSizeMatchesBuiltTables) {
+    for (const char* communityCards : { "Ah, 7c, 2s", "Ah, 7c, 2s, 3d", "Ah, 7c, 2s, 3d, 9h" }) {
+        Holdem::Settings customSettings = testSettings;
+        customSettings.startingCommunityCards = buildCommunityCardsFromString(communityCards).getValue();
+
+        Holdem holdemRules{ customSettings };
+        EXPECT_EQ(Holdem::estimateHandTablesSize(customSettings), holdemRules.getHandTablesSize()) << communityCards;
+    }
+}
+
+TEST_F(HoldemCacheTest, CacheIsDisabledByDefault) {
+    Holdem holdemRules{ testSettings };
+    EXPECT_FALSE(holdemRules.wereHandTablesLoadedFromCache());
+}
+
+TEST_F(HoldemCacheTest, SecondBuildLoadsSameTablesFromCache) {
+    Holdem::Settings customSettings = testSettings;
+    customSettings.handTableCacheDirectory = m_path.string();
+
+    Holdem uncachedRules{ testSettings };
+    Holdem firstRules{ customSettings };
+    Holdem secondRules{ customSettings };
+
+    EXPECT_FALSE(firstRules.wereHandTablesLoadedFromCache());
+    EXPECT_TRUE(secondRules.wereHandTablesLoadedFromCache());
+    expectSameHandTables(secondRules, uncachedRules, customSettings.startingCommunityCards);
+}
+
+TEST_F(HoldemCacheTest, DifferentRangesDoNotShareCache) {
+    Holdem::Settings customSettings = testSettings;
+    customSettings.handTableCacheDirectory = m_path.string();
+    Holdem firstRules{ customSettings };
+
+    customSettings.ranges[Player::P1] = buildRangeFromString("KK, QQ").getValue();
+    Holdem secondRules{ customSettings };
+    EXPECT_FALSE(secondRules.wereHandTablesLoadedFromCache());
+}
+
+TEST_F(HoldemCacheTest, CorruptedCacheFallsBackToBuilding) {
+    Holdem::Settings customSettings = testSettings;
+    customSettings.handTableCacheDirectory = m_path.string();
+    Holdem firstRules{ customSettings };
+
+    // Flip a byte at the end of each cache file
+    for (const auto& entry : std::filesystem::directory_iterator(m_path)) {
+        std::fstream file{ entry.path(), std::ios::binary | std::ios::in | std::ios::out };
+        file.seekg(-1, std::ios::end);
+        char lastByte = static_cast<char>(file.get());
+        file.seekp(-1, std::ios::end);
+        file.put(static_cast<char>(lastByte ^ 0x5a));
+    }
+
+    Holdem secondRules{ customSettings };
+    EXPECT_FALSE(secondRules.wereHandTablesLoadedFromCache());
+
+    Holdem uncachedRules{ testSettings };
+    expectSameHandTables(secondRules, uncachedRules, customSettings.startingCommunityCards);
+}
+
+TEST_F(HoldemCacheTest, SpotsWithSameBoardAndHandsShareTables) {
+    // Weights and bet sizes do not change the hand tables
+    Holdem::Settings sharingSettings = testSettings;
+    sharingSettings.ranges[Player::P0].weights.assign(sharingSettings.ranges[Player::P0].hands.size(), 0.5f);
+    sharingSettings.betSizes[Player::P1][Street::River] = { 75 };
+    ASSERT_TRUE(Holdem::canShareHandTables(testSettings, sharingSettings));
+
+    Holdem sourceRules{ testSettings };
+    Holdem sharedRules{ sharingSettings, sourceRules };
+    expectSameHandTables(sharedRules, sourceRules, testSettings.startingCommunityCards);
+    EXPECT_EQ(sharedRules.getInitialRangeWeights(Player::P0)[0], 0.5f);
+
+    Holdem::Settings otherBoardSettings = testSettings;
+    otherBoardSettings.startingCommunityCards = buildCommunityCardsFromString("Ah, 7c, 2s, 4d").getValue();
+    EXPECT_FALSE(Holdem::canShareHandTables(testSettings, otherBoardSettings));
+
+    Holdem::Settings otherHandsSettings = testSettings;
+    otherHandsSettings.ranges[Player::P1] = buildRangeFromString("KK, QQ").getValue();
+    EXPECT_FALSE(Holdem::canShareHandTables(testSettings, otherHandsSettings));
+}
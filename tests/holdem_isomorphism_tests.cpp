@@ -3,10 +3,13 @@
 #include "game/game_types.hpp"
 #include "game/game_utils.hpp"
 #include "game/holdem/config.hpp"
+#include "game/holdem/flop_isomorphism.hpp"
 #include "game/holdem/holdem_parser.hpp"
 #include "game/holdem/holdem.hpp"
 #include "util/fixed_vector.hpp"
 
+#include <vector>
+
 namespace {
 class HoldemIsomorphismTest : public ::testing::Test {
 protected:
@@ -151,4 +154,74 @@ TEST_F(HoldemIsomorphismTest, OneIsomorphismOnDoublePairedDealtTurn) {
     auto riverCardIsomorphisms = holdemRules.getChanceNodeIsomorphisms(customSettings.startingCommunityCards | turn);
     ASSERT_EQ(getNumberOfNontrivialEquivalences(riverCardIsomorphisms), 1);
     ASSERT_TRUE(containsEquivalence(riverCardIsomorphisms, { Suit::Clubs, Suit::Diamonds }));
-}
\ No newline at end of file
+}
+
+TEST(FlopIsomorphismTest, SymmetricRangesLeave1755CanonicalFlops) {
+    PlayerArray<Holdem::Range> ranges = {
+        buildRangeFromString("AA, KJ, TT, AQo:0.50").getValue(),
+        buildRangeFromString("AA, KK:0.25, QQ, T9s:0.33, 27o:0.99").getValue(),
+    };
+
+    std::vector<SuitPermutation> symmetries = getRangeSuitSymmetries(ranges);
+    ASSERT_EQ(symmetries.size(), 24);
+
+    std::vector<CardSet> flops = getAllFlops();
+    ASSERT_EQ(flops.size(), 22100);
+
+    std::vector<CanonicalFlop> canonicalFlops = getCanonicalFlops(flops, symmetries);
+    EXPECT_EQ(canonicalFlops.size(), 1755);
+
+    int numFlops = 0;
+    for (const CanonicalFlop& canonicalFlop : canonicalFlops) {
+        numFlops += canonicalFlop.numFlops;
+    }
+    EXPECT_EQ(numFlops, 22100);
+
+    // Rainbow flops of three distinct values stand for the 24 ways to assign the suits
+    CardSet rainbowFlop = buildCommunityCardsFromString("Ac, Kd, 7h").getValue();
+    std::vector<CanonicalFlop> rainbowClass = getCanonicalFlops(std::vector<CardSet>{ rainbowFlop }, symmetries);
+    ASSERT_EQ(rainbowClass.size(), 1);
+    for (const CanonicalFlop& canonicalFlop : canonicalFlops) {
+        if (canonicalFlop.flop == rainbowClass[0].flop) {
+            EXPECT_EQ(canonicalFlop.numFlops, 24);
+        }
+    }
+}
+
+TEST(FlopIsomorphismTest, AsymmetricRangesOnlyMergeSymmetricSuits) {
+    PlayerArray<Holdem::Range> ranges = {
+        buildRangeFromString("AA, AK").getValue(),
+        buildRangeFromString("QQ, T9s").getValue(),
+    };
+
+    // Playing AsKs at a different weight breaks every symmetry that moves spades
+    CardSet suitedSpades = buildCommunityCardsFromString("As, Ks, 2c").getValue() & ~buildCommunityCardsFromString("2c, 3c, 4c").getValue();
+    for (std::size_t hand = 0; hand < ranges[Player::P0].hands.size(); ++hand) {
+        if (ranges[Player::P0].hands[hand] == suitedSpades) {
+            ranges[Player::P0].weights[hand] = 0.5f;
+        }
+    }
+
+    std::vector<SuitPermutation> symmetries = getRangeSuitSymmetries(ranges);
+    EXPECT_EQ(symmetries.size(), 6);
+    for (const SuitPermutation& permutation : symmetries) {
+        EXPECT_EQ(permutation[static_cast<int>(Suit::Spades)], Suit::Spades);
+    }
+
+    // Rainbow flops are only merged when their spade is on the same card
+    CardSet flop0 = buildCommunityCardsFromString("2s, 7c, 9d").getValue();
+    CardSet flop1 = buildCommunityCardsFromString("2s, 7h, 9d").getValue();
+    CardSet flop2 = buildCommunityCardsFromString("2h, 7c, 9s").getValue();
+    std::vector<CanonicalFlop> canonicalFlops = getCanonicalFlops(std::vector<CardSet>{ flop0, flop1, flop2 }, symmetries);
+    ASSERT_EQ(canonicalFlops.size(), 2);
+    EXPECT_EQ(canonicalFlops[0].numFlops, 2);
+    EXPECT_EQ(canonicalFlops[1].numFlops, 1);
+}
+
+TEST(FlopIsomorphismTest, RemovingBlockedHandsMatchesBuildingRangeForBoard) {
+    static const std::string RangeString = "AA, KK:0.25, AKs, T9o:0.5";
+    CardSet board = buildCommunityCardsFromString("Ah, Kd, 9c").getValue();
+
+    Holdem::Range expectedRange = buildRangeFromString(RangeString, board).getValue();
+    EXPECT_EQ(removeBlockedHands(buildRangeFromString(RangeString).getValue(), board), expectedRange);
+}
@@ -0,0 +1,54 @@
+#ifndef HOLDEM_TEST_SETTINGS_HPP
+#define HOLDEM_TEST_SETTINGS_HPP
+
+#include "game/game_types.hpp"
+#include "game/holdem/config.hpp"
+#include "game/holdem/holdem_parser.hpp"
+#include "game/holdem/holdem.hpp"
+#include "util/fixed_vector.hpp"
+
+#include <string>
+
+// Small Holdem spot for tests, the same bet and raise sizes are used on every street for both players
+struct HoldemTestSpot {
+    std::string communityCards;
+    PlayerArray<std::string> ranges;
+    FixedVector<int, holdem::MaxNumBetSizes> betSizes = { 50 };
+    FixedVector<int, holdem::MaxNumRaiseSizes> raiseSizes = { 100 };
+    int startingPlayerWagers = 20;
+    int numThreads = 1;
+};
+
+// Turn spot shared by the subtree resolve, warm start and distributed tests
+inline const HoldemTestSpot TurnTestSpot = {
+    .communityCards = "Kd, 7c, 2h, 9s",
+    .ranges = { "AA, KK, AK, KQs, 76s, T8s", "QQ, JJ, AQ, KJs, 87s, 22" },
+};
+
+inline Holdem::Settings getHoldemTestSettings(const HoldemTestSpot& spot) {
+    CardSet communityCards = buildCommunityCardsFromString(spot.communityCards).getValue();
+
+    PlayerArray<Holdem::Range> ranges = {
+        buildRangeFromString(spot.ranges[Player::P0], communityCards).getValue(),
+        buildRangeFromString(spot.ranges[Player::P1], communityCards).getValue(),
+    };
+
+    const FixedVector<int, holdem::MaxNumBetSizes>& betSizes = spot.betSizes;
+    const FixedVector<int, holdem::MaxNumRaiseSizes>& raiseSizes = spot.raiseSizes;
+
+    return {
+        .ranges = ranges,
+        .startingCommunityCards = communityCards,
+        .betSizes = { { betSizes, betSizes, betSizes },  { betSizes, betSizes, betSizes } },
+        .raiseSizes = { { raiseSizes, raiseSizes, raiseSizes },  { raiseSizes, raiseSizes, raiseSizes } },
+        .startingPlayerWagers = spot.startingPlayerWagers,
+        .effectiveStackRemaining = 100,
+        .deadMoney = 0,
+        .useChanceCardIsomorphism = true,
+        .expandAllInRunouts = false,
+        .numThreads = spot.numThreads,
+        .handTableCacheDirectory = "",
+    };
+}
+
+#endif // HOLDEM_TEST_SETTINGS_HPP
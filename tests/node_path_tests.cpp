@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+
+#include "holdem_test_settings.hpp"
+#include "test_helpers.hpp"
+
+#include "game/game_types.hpp"
+#include "game/game_utils.hpp"
+#include "game/holdem/holdem_parser.hpp"
+#include "game/holdem/holdem.hpp"
+#include "solver/cfr.hpp"
+#include "solver/node_path.hpp"
+#include "solver/tree.hpp"
+#include "util/fixed_vector.hpp"
+#include "util/result.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+// Monotone flop, so the three other suits are isomorphic on the turn
+const HoldemTestSpot MonotoneTestSpot = {
+    .communityCards = "Kh, 7h, 2h",
+    .ranges = { "AA, KQ, 76s", "QQ, AJs, 98" },
+    .raiseSizes = {},
+};
+
+std::vector<NodeInfo> resolve(const Tree& tree, const std::vector<std::string>& steps) {
+    Result<std::vector<NodeInfo>> nodePathResult = resolveNodePath(tree, steps);
+    EXPECT_FALSE(nodePathResult.isError()) << nodePathResult.getError();
+    return nodePathResult.getValue();
+}
+
+CardID getCard(const std::string& cardName) {
+    return getCardIDFromName(cardName).getValue();
+}
+} // namespace
+
+class NodePathTest : public ::testing::Test {
+protected:
+    NodePathTest() : rules{ getHoldemTestSettings(MonotoneTestSpot) } {
+        tree.buildTreeSkeleton(rules);
+        tree.initCfrVectors();
+    }
+
+    Holdem rules;
+    Tree tree;
+};
+
+TEST_F(NodePathTest, InvalidStepsAreRejected) {
+    // Check, check reaches the turn
+    std::vector<NodeInfo> turnPath = resolve(tree, { "0", "0" });
+    ASSERT_EQ(turnPath.size(), 3);
+    EXPECT_EQ(tree.allNodes[turnPath.back().index].nodeType, NodeType::Chance);
+
+    EXPECT_TRUE(resolveNodePath(tree, std::vector<std::string>{ "9" }).isError());
+    EXPECT_TRUE(resolveNodePath(tree, std::vector<std::string>{ "As" }).isError());
+    EXPECT_TRUE(resolveNodePath(tree, std::vector<std::string>{ "0", "0", "1" }).isError());
+    EXPECT_TRUE(resolveNodePath(tree, std::vector<std::string>{ "0", "0", "Zz" }).isError());
+
+    // Cards on the board cannot be dealt again
+    EXPECT_TRUE(resolveNodePath(tree, std::vector<std::string>{ "0", "0", "Kh" }).isError());
+
+    // Bet, fold ends the hand
+    std::vector<NodeInfo> foldPath = resolve(tree, { "1", "0" });
+    EXPECT_EQ(tree.allNodes[foldPath.back().index].nodeType, NodeType::Fold);
+    EXPECT_TRUE(resolveNodePath(tree, std::vector<std::string>{ "1", "0", "0" }).isError());
+}
+
+TEST_F(NodePathTest, IsomorphicCardsShareSubtree) {
+    std::vector<NodeInfo> clubsPath = resolve(tree, { "0", "0", "Ac" });
+    std::vector<NodeInfo> diamondsPath = resolve(tree, { "0", "0", "Ad" });
+    std::vector<NodeInfo> spadesPath = resolve(tree, { "0", "0", "As" });
+
+    EXPECT_EQ(clubsPath.back().index, diamondsPath.back().index);
+    EXPECT_EQ(clubsPath.back().index, spadesPath.back().index);
+
+    // Exactly one of the isomorphic cards is stored in the tree, the others are reached through a suit swap
+    int numSwapped = clubsPath.back().swapList.has_value() + diamondsPath.back().swapList.has_value() + spadesPath.back().swapList.has_value();
+    EXPECT_EQ(numSwapped, 2);
+
+    // The board is named in the suits that were requested, not the suits of the shared subtree
+    for (const auto& [path, cardName] : { std::pair{ clubsPath, "Ac" }, std::pair{ diamondsPath, "Ad" }, std::pair{ spadesPath, "As" } }) {
+        std::vector<CardID> board = getNodePathBoard(rules, tree, path);
+        std::vector<CardID> expectedBoard = { getCard("Kh"), getCard("7h"), getCard("2h"), getCard(cardName) };
+        EXPECT_EQ(board, expectedBoard);
+    }
+
+    // A river card after a swapped turn is also named in the requested suits
+    std::vector<NodeInfo> riverPath = resolve(tree, { "0", "0", "As", "0", "0", "Qs" });
+    std::vector<CardID> riverBoard = getNodePathBoard(rules, tree, riverPath);
+    ASSERT_EQ(riverBoard.size(), 5);
+    EXPECT_EQ(riverBoard[3], getCard("As"));
+    EXPECT_EQ(riverBoard[4], getCard("Qs"));
+}
+
+TEST_F(NodePathTest, HandIndicesFollowSuitSwaps) {
+    for (const char* turnCardName : { "Ac", "Ad", "As" }) {
+        std::vector<NodeInfo> nodePath = resolve(tree, { "0", "0", turnCardName });
+        std::optional<SuitMapping> swapList = nodePath.back().swapList;
+        CardID turnCard = getCard(turnCardName);
+
+        for (Player player : { Player::P0, Player::P1 }) {
+            const auto rangeHands = rules.getRangeHands(player);
+            std::vector<int> handIndices = getNodePathHandIndices(rules, tree, nodePath, player);
+            ASSERT_EQ(handIndices.size(), rangeHands.size());
+
+            for (std::size_t hand = 0; hand < rangeHands.size(); ++hand) {
+                if (setContainsCard(rangeHands[hand], turnCard)) {
+                    EXPECT_EQ(handIndices[hand], -1);
+                    continue;
+                }
+
+                ASSERT_NE(handIndices[hand], -1);
+                CardSet expectedHand = swapList ? swapSetSuits(rangeHands[hand], swapList->child, swapList->parent) : rangeHands[hand];
+                EXPECT_EQ(rangeHands[handIndices[hand]], expectedHand);
+            }
+        }
+    }
+}
+
+TEST_F(NodePathTest, RangeIndexLookup) {
+    for (Player player : { Player::P0, Player::P1 }) {
+        const auto rangeHands = rules.getRangeHands(player);
+        for (std::size_t hand = 0; hand < rangeHands.size(); ++hand) {
+            EXPECT_EQ(rules.getRangeIndex(player, rangeHands[hand]), static_cast<int>(hand));
+        }
+    }
+
+    EXPECT_EQ(rules.getRangeIndex(Player::P0, getCard("3c") | getCard("4d")), -1);
+    EXPECT_EQ(rules.getRangeIndex(Player::P0, cardIDToSet(getCard("As"))), -1);
+}
+
+TEST_F(NodePathTest, RangeStrategyMatchesPerHandQueries) {
+    tree.initCfrVectors();
+    trainDiscountedCfrIterations(rules, tree, 10);
+
+    // Bet, call, a swapped turn card, then check reaches the in position player
+    std::vector<NodeInfo> nodePath = resolve(tree, { "1", "1", "Ad", "0" });
+    const Node& node = tree.allNodes[nodePath.back().index];
+    ASSERT_EQ(node.nodeType, NodeType::Decision);
+
+    NodePathRangeStrategy rangeStrategy = getNodePathRangeStrategy(rules, tree, nodePath);
+    EXPECT_EQ(rangeStrategy.player, node.playerToAct);
+    EXPECT_EQ(rangeStrategy.numActions, node.numChildren);
+
+    const auto rangeHands = rules.getRangeHands(node.playerToAct);
+    const auto initialRangeWeights = rules.getInitialRangeWeights(node.playerToAct);
+    std::vector<int> handIndices = getNodePathHandIndices(rules, tree, nodePath, node.playerToAct);
+    EXPECT_EQ(rangeStrategy.range.handIndices, handIndices);
+    ASSERT_EQ(rangeStrategy.strategy.size(), node.numChildren * rangeHands.size());
+
+    // The in position player's only earlier action is the call after the bet
+    const Node& callNode = tree.allNodes[nodePath[1].index];
+    ASSERT_EQ(callNode.playerToAct, node.playerToAct);
+
+    for (std::size_t hand = 0; hand < rangeHands.size(); ++hand) {
+        if (handIndices[hand] == -1) {
+            EXPECT_EQ(rangeStrategy.range.reachWeights[hand], 0.0f);
+            for (int action = 0; action < node.numChildren; ++action) {
+                EXPECT_EQ(rangeStrategy.strategy[action * rangeHands.size() + hand], 0.0f);
+            }
+            continue;
+        }
+
+        // Hands before the turn are not swapped yet
+        float callProbability = getFinalStrategy(rules, static_cast<int>(hand), callNode, tree)[1];
+        EXPECT_FLOAT_EQ(rangeStrategy.range.reachWeights[hand], initialRangeWeights[hand] * callProbability);
+
+        FixedVector<float, MaxNumActions> handStrategy = getFinalStrategy(rules, handIndices[hand], node, tree);
+        for (int action = 0; action < node.numChildren; ++action) {
+            EXPECT_EQ(rangeStrategy.strategy[action * rangeHands.size() + hand], handStrategy[action]);
+        }
+    }
+}
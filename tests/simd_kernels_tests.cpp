@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+
+#include "game/game_types.hpp"
+#include "solver/simd_kernels.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace {
+// Odd size so that both the vectorized loop and the scalar remainder are exercised
+static constexpr int KernelTestSize = 103;
+
+// A chunk of hands in the middle of the rows, as used when a large node splits its hands between threads
+static constexpr int ChunkStart = 5;
+static constexpr int ChunkSize = 37;
+
+std::vector<float> getRandomValues(std::mt19937& rng, float low, float high, int size = KernelTestSize) {
+    std::uniform_real_distribution<float> distribution(low, high);
+    std::vector<float> values(size);
+    for (float& value : values) {
+        value = distribution(rng);
+    }
+
+    // Include special values that the kernels must handle exactly like the scalar code
+    values[0] = 0.0f;
+    values[1] = -0.0f;
+    values[size - 1] = 0.0f;
+    return values;
+}
+
+void expectBitwiseEqual(const std::vector<float>& actual, const std::vector<float>& expected) {
+    ASSERT_EQ(actual.size(), expected.size());
+    for (std::size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_EQ(std::bit_cast<std::uint32_t>(actual[i]), std::bit_cast<std::uint32_t>(expected[i])) << "Mismatch at index " << i;
+    }
+}
+
+// Same as the loops over the actions that the fused kernels replaced
+std::vector<float> getExpectedStrategy(const std::vector<float>& sums, int numActions, bool clampToPositive) {
+    std::vector<float> totals(KernelTestSize, 0.0f);
+    std::vector<float> strategy(sums.size());
+    for (int action = 0; action < numActions; ++action) {
+        for (int i = 0; i < KernelTestSize; ++i) {
+            float value = sums[action * KernelTestSize + i];
+            if (clampToPositive) {
+                value = std::max(value, 0.0f);
+            }
+            strategy[action * KernelTestSize + i] = value;
+            totals[i] += value;
+        }
+    }
+
+    float uniform = 1.0f / static_cast<float>(numActions);
+    for (int action = 0; action < numActions; ++action) {
+        for (int i = 0; i < KernelTestSize; ++i) {
+            float& value = strategy[action * KernelTestSize + i];
+            value = (totals[i] > 0.0f) ? (value / totals[i]) : uniform;
+        }
+    }
+    return strategy;
+}
+} // namespace
+
+TEST(SimdKernelsTest, InstructionSetNameIsNotEmpty) {
+    EXPECT_FALSE(getSimdInstructionSetName().empty());
+}
+
+TEST(SimdKernelsTest, RegretMatchingMatchesScalar) {
+    std::mt19937 rng(0);
+    for (int numActions = 1; numActions <= MaxNumActions; ++numActions) {
+        std::vector<float> regretSums = getRandomValues(rng, -10.0f, 10.0f, numActions * KernelTestSize);
+
+        // Some hands have no positive regret and play uniformly
+        for (int action = 0; action < numActions; ++action) {
+            regretSums[action * KernelTestSize + 2] = -1.0f;
+            regretSums[action * KernelTestSize + 50] = -0.0f;
+        }
+
+        std::vector<float> strategy(regretSums.size());
+        normalizeRegretSums(strategy, regretSums, numActions);
+        expectBitwiseEqual(strategy, getExpectedStrategy(regretSums, numActions, true));
+
+        // Normalizing in place gives the same result
+        std::vector<float> inPlace = regretSums;
+        normalizeRegretSums(inPlace, inPlace, numActions);
+        expectBitwiseEqual(inPlace, strategy);
+    }
+}
+
+TEST(SimdKernelsTest, AverageStrategyMatchesScalar) {
+    std::mt19937 rng(1);
+    for (int numActions = 1; numActions <= MaxNumActions; ++numActions) {
+        std::vector<float> strategySums = getRandomValues(rng, 0.0f, 10.0f, numActions * KernelTestSize);
+
+        // Some hands have no strategy yet and play uniformly
+        for (int action = 0; action < numActions; ++action) {
+            strategySums[action * KernelTestSize + 2] = 0.0f;
+        }
+
+        std::vector<float> strategy(strategySums.size());
+        normalizeStrategySums(strategy, strategySums, numActions);
+        expectBitwiseEqual(strategy, getExpectedStrategy(strategySums, numActions, false));
+
+        std::vector<float> inPlace = strategySums;
+        normalizeStrategySums(inPlace, inPlace, numActions);
+        expectBitwiseEqual(inPlace, strategy);
+    }
+}
+
+TEST(SimdKernelsTest, WeightedAccumulationMatchesScalar) {
+    std::mt19937 rng(3);
+    std::vector<float> initialOutput = getRandomValues(rng, -100.0f, 100.0f);
+    std::vector<float> values = getRandomValues(rng, -100.0f, 100.0f);
+    std::vector<float> weights = getRandomValues(rng, 0.0f, 1.0f);
+
+    std::vector<float> expectedOutput = initialOutput;
+    for (int i = 0; i < KernelTestSize; ++i) {
+        expectedOutput[i] += values[i] * weights[i];
+    }
+
+    std::vector<float> output = initialOutput;
+    accumulateWeightedValues(output, values, weights);
+
+    expectBitwiseEqual(output, expectedOutput);
+}
+
+TEST(SimdKernelsTest, ActionAccumulationMatchesScalar) {
+    std::mt19937 rng(2);
+    for (int numActions = 1; numActions <= MaxNumActions; ++numActions) {
+        std::vector<float> initialOutput = getRandomValues(rng, -100.0f, 100.0f);
+        std::vector<float> values = getRandomValues(rng, -100.0f, 100.0f, numActions * KernelTestSize);
+        std::vector<float> weights = getRandomValues(rng, 0.0f, 1.0f, numActions * KernelTestSize);
+
+        std::vector<float> expectedWeightedOutput = initialOutput;
+        std::vector<float> expectedOutput = initialOutput;
+        for (int action = 0; action < numActions; ++action) {
+            for (int i = 0; i < KernelTestSize; ++i) {
+                expectedWeightedOutput[i] += values[action * KernelTestSize + i] * weights[action * KernelTestSize + i];
+                expectedOutput[i] += values[action * KernelTestSize + i];
+            }
+        }
+
+        std::vector<float> weightedOutput = initialOutput;
+        accumulateActionWeightedValues(weightedOutput, values, weights, numActions, KernelTestSize);
+        expectBitwiseEqual(weightedOutput, expectedWeightedOutput);
+
+        std::vector<float> output = initialOutput;
+        accumulateActionValues(output, values, numActions, KernelTestSize);
+        expectBitwiseEqual(output, expectedOutput);
+
+        // Accumulating a chunk of hands only changes that chunk
+        std::vector<float> chunkOutput = initialOutput;
+        std::vector<float> expectedChunkOutput = initialOutput;
+        std::copy_n(expectedWeightedOutput.begin() + ChunkStart, ChunkSize, expectedChunkOutput.begin() + ChunkStart);
+        accumulateActionWeightedValues(
+            std::span<float>(chunkOutput).subspan(ChunkStart, ChunkSize),
+            std::span<const float>(values).subspan(ChunkStart),
+            std::span<const float>(weights).subspan(ChunkStart),
+            numActions,
+            KernelTestSize
+        );
+        expectBitwiseEqual(chunkOutput, expectedChunkOutput);
+    }
+}
+
+TEST(SimdKernelsTest, DiscountedUpdateMatchesScalar) {
+    static constexpr float AlphaT = 0.74f;
+    static constexpr float BetaT = 0.5f;
+    static constexpr float GammaT = 0.83f;
+
+    std::mt19937 rng(4);
+    for (int numActions = 1; numActions <= MaxNumActions; ++numActions) {
+        int rowsSize = numActions * KernelTestSize;
+        std::vector<float> initialRegretSums = getRandomValues(rng, -50.0f, 50.0f, rowsSize);
+        std::vector<float> initialStrategySums = getRandomValues(rng, 0.0f, 50.0f, rowsSize);
+        std::vector<float> actionExpectedValues = getRandomValues(rng, -100.0f, 100.0f, rowsSize);
+        std::vector<float> strategyExpectedValues = getRandomValues(rng, -100.0f, 100.0f);
+        std::vector<float> reachProbs = getRandomValues(rng, 0.0f, 1.0f);
+        std::vector<float> currentStrategy = getRandomValues(rng, 0.0f, 1.0f, rowsSize);
+
+        std::vector<float> expectedRegretSums = initialRegretSums;
+        std::vector<float> expectedStrategySums = initialStrategySums;
+        for (int action = 0; action < numActions; ++action) {
+            for (int i = 0; i < KernelTestSize; ++i) {
+                int index = action * KernelTestSize + i;
+
+                float regret = actionExpectedValues[index] - strategyExpectedValues[i];
+                float regretDiscount = (expectedRegretSums[index] > 0.0f) ? AlphaT : BetaT;
+                expectedRegretSums[index] = expectedRegretSums[index] * regretDiscount + regret;
+
+                float strategy = reachProbs[i] * currentStrategy[index];
+                expectedStrategySums[index] = expectedStrategySums[index] * GammaT + strategy;
+            }
+        }
+
+        // Update the hands in two chunks, like a node split between threads
+        std::vector<float> regretSums = initialRegretSums;
+        std::vector<float> strategySums = initialStrategySums;
+        for (auto [firstHand, numHands] : { std::pair{ 0, ChunkSize }, std::pair{ ChunkSize, KernelTestSize - ChunkSize } }) {
+            updateDiscountedTrainingData(
+                std::span<float>(regretSums).subspan(firstHand),
+                std::span<float>(strategySums).subspan(firstHand),
+                std::span<const float>(actionExpectedValues).subspan(firstHand),
+                std::span<const float>(strategyExpectedValues).subspan(firstHand, numHands),
+                std::span<const float>(reachProbs).subspan(firstHand, numHands),
+                std::span<const float>(currentStrategy).subspan(firstHand),
+                AlphaT,
+                BetaT,
+                GammaT,
+                numActions,
+                KernelTestSize
+            );
+        }
+
+        expectBitwiseEqual(regretSums, expectedRegretSums);
+        expectBitwiseEqual(strategySums, expectedStrategySums);
+    }
+}
@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+
+#include "test_helpers.hpp"
+
+#include "game/game_rules.hpp"
+#include "game/game_types.hpp"
+#include "game/game_utils.hpp"
+#include "game/leduc_poker.hpp"
+#include "solver/cfr.hpp"
+#include "solver/solution_export.hpp"
+#include "solver/tree.hpp"
+#include "util/binary_io.hpp"
+#include "util/fixed_vector.hpp"
+#include "util/mapped_file.hpp"
+#include "util/result.hpp"
+#include "util/stack_allocator.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+static constexpr int LeducIterations = 200;
+static constexpr std::size_t ColumnAlignment = 64;
+static constexpr std::size_t MaxColumnSize = 1 << 24;
+
+class SolutionExportTest : public TemporaryPathTest {};
+
+void solveLeduc(const LeducPoker& rules, Tree& tree) {
+    tree.buildTreeSkeleton(rules);
+    tree.initCfrVectors();
+    trainDiscountedCfrIterations(rules, tree, LeducIterations);
+}
+
+// Columns of one table, concatenated over all of its chunks
+struct ExportedTable {
+    std::map<std::string, std::vector<double>> numbers;
+    std::map<std::string, std::vector<std::string>> strings;
+    std::size_t numRows = 0;
+    std::size_t numChunks = 0;
+};
+
+template <typename T>
+bool readNumberColumn(BinaryReader& reader, std::vector<double>& output) {
+    std::span<const T> values;
+    if (!reader.readAlignedArrayView(values, ColumnAlignment, MaxColumnSize)) return false;
+    output.insert(output.end(), values.begin(), values.end());
+    return true;
+}
+
+bool readTables(const std::filesystem::path& path, std::map<SolutionExportTable, ExportedTable>& tables) {
+    MappedFile file{ path };
+    if (!file.isGood()) return false;
+
+    BinaryReader reader{ file.getBytes() };
+    if (!reader.expect<std::uint32_t>(0x50534558) || !reader.expect<std::uint32_t>(1) || !reader.expect<std::uint32_t>(MaxNumActions)) return false;
+
+    while (true) {
+        SolutionExportTable tableID;
+        if (!reader.read(tableID)) return false;
+        if (tableID == SolutionExportTable::End) break;
+
+        std::uint64_t numRows;
+        std::uint32_t numColumns;
+        if (!reader.read(numRows) || !reader.read(numColumns)) return false;
+
+        ExportedTable& table = tables[tableID];
+        table.numRows += numRows;
+        ++table.numChunks;
+
+        for (std::uint32_t column = 0; column < numColumns; ++column) {
+            std::vector<char> nameCharacters;
+            SolutionExportColumnType type;
+            if (!reader.readArray(nameCharacters, MaxColumnSize) || !reader.read(type)) return false;
+            std::string name{ nameCharacters.begin(), nameCharacters.end() };
+
+            bool success = false;
+            switch (type) {
+                case SolutionExportColumnType::UInt8:
+                    success = readNumberColumn<std::uint8_t>(reader, table.numbers[name]);
+                    break;
+                case SolutionExportColumnType::UInt32:
+                    success = readNumberColumn<std::uint32_t>(reader, table.numbers[name]);
+                    break;
+                case SolutionExportColumnType::Int32:
+                    success = readNumberColumn<std::int32_t>(reader, table.numbers[name]);
+                    break;
+                case SolutionExportColumnType::Float32:
+                    success = readNumberColumn<float>(reader, table.numbers[name]);
+                    break;
+                case SolutionExportColumnType::String: {
+                    std::span<const std::uint32_t> offsets;
+                    std::span<const char> characters;
+                    success = reader.readAlignedArrayView(offsets, ColumnAlignment, MaxColumnSize)
+                        && reader.readAlignedArrayView(characters, ColumnAlignment, MaxColumnSize)
+                        && (offsets.size() == numRows + 1);
+                    for (std::size_t row = 0; success && (row < numRows); ++row) {
+                        table.strings[name].emplace_back(characters.begin() + offsets[row], characters.begin() + offsets[row + 1]);
+                    }
+                    break;
+                }
+            }
+            if (!success) return false;
+        }
+    }
+
+    return reader.isAtEnd();
+}
+} // namespace
+
+TEST_F(SolutionExportTest, ExportedStrategiesMatchFinalStrategies) {
+    LeducPoker leducRules{ true };
+    Tree tree;
+    solveLeduc(leducRules, tree);
+
+    static constexpr std::size_t RowsPerChunk = 16;
+    StackAllocator allocator(1);
+    Result<SolutionExportSummary> exportResult = exportSolution(leducRules, tree, m_path, allocator, RowsPerChunk);
+    ASSERT_TRUE(exportResult.isValue());
+
+    std::map<SolutionExportTable, ExportedTable> tables;
+    ASSERT_TRUE(readTables(m_path, tables));
+
+    const ExportedTable& nodes = tables[SolutionExportTable::Nodes];
+    const ExportedTable& hands = tables[SolutionExportTable::Hands];
+    const SolutionExportSummary& summary = exportResult.getValue();
+    EXPECT_EQ(nodes.numRows, tree.getNumberOfDecisionNodes());
+    EXPECT_EQ(summary.numDecisionNodes, nodes.numRows);
+    EXPECT_EQ(summary.numHandRows, hands.numRows);
+    EXPECT_EQ(summary.numChunks, nodes.numChunks + hands.numChunks);
+    EXPECT_GT(hands.numChunks, 1);
+
+    // Nodes are in tree order
+    const std::vector<double>& nodeIndices = nodes.numbers.at("node_index");
+    for (std::size_t row = 1; row < nodes.numRows; ++row) {
+        EXPECT_LT(nodeIndices[row - 1], nodeIndices[row]);
+    }
+    EXPECT_EQ(nodes.strings.at("history")[0], "");
+
+    // Every hand that is not blocked by the board has one row per decision node, with the tree's average strategy
+    std::map<std::size_t, std::map<std::string, std::size_t>> handRows;
+    for (std::size_t row = 0; row < hands.numRows; ++row) {
+        std::size_t nodeIndex = static_cast<std::size_t>(hands.numbers.at("node_index")[row]);
+        EXPECT_TRUE(handRows[nodeIndex].emplace(hands.strings.at("hand")[row], row).second);
+    }
+    ASSERT_EQ(handRows.size(), nodes.numRows);
+
+    for (double nodeIndexValue : nodeIndices) {
+        std::size_t nodeIndex = static_cast<std::size_t>(nodeIndexValue);
+        const Node& node = tree.allNodes[nodeIndex];
+        ASSERT_EQ(node.nodeType, NodeType::Decision);
+
+        const auto validHands = leducRules.getValidHands(node.playerToAct, node.board);
+        ASSERT_EQ(handRows[nodeIndex].size(), validHands.size());
+
+        for (HandInfo handInfo : validHands) {
+            std::size_t row = handRows[nodeIndex].at(getNameFromCardID(handInfo.card0));
+            FixedVector<float, MaxNumActions> expectedStrategy = getFinalStrategy(leducRules, handInfo.index, node, tree);
+            for (int action = 0; action < MaxNumActions; ++action) {
+                double exportedProbability = hands.numbers.at("strategy_" + std::to_string(action))[row];
+                if (action < expectedStrategy.size()) {
+                    EXPECT_NEAR(exportedProbability, expectedStrategy[action], 1e-6);
+                }
+                else {
+                    EXPECT_TRUE(std::isnan(exportedProbability));
+                }
+            }
+        }
+    }
+}
+
+TEST_F(SolutionExportTest, RootExpectedValuesMatchPlayerExpectedValue) {
+    LeducPoker leducRules{ true };
+    Tree tree;
+    solveLeduc(leducRules, tree);
+
+    StackAllocator allocator(1);
+    ASSERT_TRUE(exportSolution(leducRules, tree, m_path, allocator).isValue());
+
+    std::map<SolutionExportTable, ExportedTable> tables;
+    ASSERT_TRUE(readTables(m_path, tables));
+    const ExportedTable& hands = tables[SolutionExportTable::Hands];
+
+    // Each root expected value is against the villain hands that don't share its card, so weighing it by
+    // that reach and the hand's own weight gives back the player's expected value
+    std::size_t rootIndex = tree.getRootNodeIndex();
+    Player player = tree.allNodes[rootIndex].playerToAct;
+    Player villain = getOpposingPlayer(player);
+    const auto rangeHands = leducRules.getRangeHands(player);
+    const auto rangeWeights = leducRules.getInitialRangeWeights(player);
+    const auto villainRangeHands = leducRules.getRangeHands(villain);
+    const auto villainRangeWeights = leducRules.getInitialRangeWeights(villain);
+
+    double weightedExpectedValue = 0.0;
+    for (std::size_t row = 0; row < hands.numRows; ++row) {
+        if (static_cast<std::size_t>(hands.numbers.at("node_index")[row]) != rootIndex) continue;
+
+        double expectedValue = hands.numbers.at("ev")[row];
+        ASSERT_TRUE(std::isfinite(expectedValue));
+
+        for (std::size_t hand = 0; hand < rangeHands.size(); ++hand) {
+            if (getCardSetNames(rangeHands[hand])[0] != hands.strings.at("hand")[row]) continue;
+
+            double villainReach = 0.0;
+            for (std::size_t villainHand = 0; villainHand < villainRangeHands.size(); ++villainHand) {
+                if (!doSetsOverlap(rangeHands[hand], villainRangeHands[villainHand])) {
+                    villainReach += villainRangeWeights[villainHand];
+                }
+            }
+            weightedExpectedValue += expectedValue * villainReach * rangeWeights[hand];
+        }
+    }
+
+    EXPECT_NEAR(weightedExpectedValue / tree.totalRangeWeight, expectedValue(player, leducRules, tree, allocator), 1e-4);
+}
+
+TEST_F(SolutionExportTest, RejectsUnsolvedTree) {
+    LeducPoker leducRules{ true };
+    Tree tree;
+    tree.buildTreeSkeleton(leducRules);
+
+    StackAllocator allocator(1);
+    EXPECT_TRUE(exportSolution(leducRules, tree, m_path, allocator).isError());
+    EXPECT_FALSE(std::filesystem::exists(m_path));
+}
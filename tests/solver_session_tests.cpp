@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include "test_helpers.hpp"
+
+#include "game/game_types.hpp"
+#include "game/leduc_poker.hpp"
+#include "solver/cfr.hpp"
+#include "solver/solver_session.hpp"
+#include "solver/tree.hpp"
+#include "util/fixed_vector.hpp"
+#include "util/result.hpp"
+
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+static constexpr int NumIterations = 100;
+
+SolveSettings getTestingSolveSettings() {
+    return {
+        .targetPercentExploitability = 0.0f,
+        .maxIterations = NumIterations,
+        .exploitabilityCheckFrequency = 10,
+        .numThreads = 1
+    };
+}
+
+std::unique_ptr<SolverSession> createLeducSession(const SolveSettings& settings) {
+    Result<std::unique_ptr<SolverSession>> sessionResult = SolverSession::create(std::make_unique<LeducPoker>(true), settings);
+    EXPECT_TRUE(sessionResult.isValue());
+    return sessionResult.isValue() ? std::move(sessionResult.getValue()) : nullptr;
+}
+} // namespace
+
+TEST(SolverSessionTest, SolveMatchesDiscountedCfr) {
+    std::unique_ptr<SolverSession> sessionPointer = createLeducSession(getTestingSolveSettings());
+    ASSERT_TRUE(sessionPointer);
+    SolverSession& session = *sessionPointer;
+
+    std::vector<SolveProgress> progress;
+    SolveResult result = session.solve([&progress](const SolveProgress& iterationProgress) {
+        progress.push_back(iterationProgress);
+    });
+    EXPECT_EQ(result.status, SolveStatus::MaxIterationsReached);
+    EXPECT_EQ(result.numIterations, NumIterations);
+    ASSERT_TRUE(result.exploitability.has_value());
+
+    // Every iteration reports its progress, and only the checked iterations calculate the exploitability
+    ASSERT_EQ(progress.size(), static_cast<std::size_t>(NumIterations));
+    for (int i = 0; i < NumIterations; ++i) {
+        EXPECT_EQ(progress[i].iteration, i + 1);
+        EXPECT_EQ(progress[i].exploitability.has_value(), (i + 1) % 10 == 0);
+    }
+    EXPECT_EQ(*progress.back().exploitability, *result.exploitability);
+
+    LeducPoker leducRules{ true };
+    Tree tree;
+    tree.buildTreeSkeleton(leducRules);
+    tree.initCfrVectors();
+    trainDiscountedCfrIterations(leducRules, tree, NumIterations);
+    EXPECT_EQ(session.getTree().allStrategySums, tree.allStrategySums);
+
+    // Strategies are laid out by action, then by hand in the range of the player to act
+    const Node& root = tree.allNodes[tree.getRootNodeIndex()];
+    std::span<const float> strategy = session.getStrategy(tree.getRootNodeIndex());
+    int rangeSize = tree.rangeSize[root.playerToAct];
+    ASSERT_EQ(strategy.size(), static_cast<std::size_t>(root.numChildren * rangeSize));
+    for (int hand = 0; hand < rangeSize; ++hand) {
+        FixedVector<float, MaxNumActions> handStrategy = getFinalStrategy(leducRules, hand, root, tree);
+        for (int action = 0; action < root.numChildren; ++action) {
+            EXPECT_EQ(strategy[action * rangeSize + hand], handStrategy[action]);
+        }
+    }
+
+    // Repeated requests return the same normalized strategy without recalculating it
+    EXPECT_EQ(session.getStrategy(tree.getRootNodeIndex()).data(), strategy.data());
+
+    std::size_t chanceNodeIndex = 0;
+    while (tree.allNodes[chanceNodeIndex].nodeType != NodeType::Chance) {
+        ++chanceNodeIndex;
+    }
+    EXPECT_TRUE(session.getStrategy(chanceNodeIndex).empty());
+}
+
+TEST(SolverSessionTest, CancelledSolveCanBeContinued) {
+    static constexpr int CancelIteration = 5;
+
+    std::unique_ptr<SolverSession> sessionPointer = createLeducSession(getTestingSolveSettings());
+    ASSERT_TRUE(sessionPointer);
+    SolverSession& session = *sessionPointer;
+    EXPECT_TRUE(session.getStrategy(0).empty());
+
+    std::future<SolveResult> cancelledSolve = session.solveAsync([&session](const SolveProgress& progress) {
+        if (progress.iteration == CancelIteration) {
+            session.cancel();
+        }
+    });
+    SolveResult cancelledResult = cancelledSolve.get();
+    EXPECT_EQ(cancelledResult.status, SolveStatus::Cancelled);
+    EXPECT_EQ(cancelledResult.numIterations, CancelIteration);
+    EXPECT_FALSE(cancelledResult.exploitability.has_value());
+    EXPECT_FALSE(session.isSolving());
+
+    // The next solve continues from the last completed iteration, so it ends up with the same tree as an uninterrupted solve
+    SolveResult continuedResult = session.solveAsync().get();
+    EXPECT_EQ(continuedResult.status, SolveStatus::MaxIterationsReached);
+    EXPECT_EQ(continuedResult.numIterations, NumIterations);
+
+    std::unique_ptr<SolverSession> uninterruptedSession = createLeducSession(getTestingSolveSettings());
+    ASSERT_TRUE(uninterruptedSession);
+    SolveResult uninterruptedResult = uninterruptedSession->solve();
+    EXPECT_EQ(session.getTree().allRegretSums, uninterruptedSession->getTree().allRegretSums);
+    EXPECT_EQ(continuedResult.exploitability, uninterruptedResult.exploitability);
+}
+
+TEST(SolverSessionTest, SolveStopsAtTargetExploitability) {
+    static constexpr float TargetPercentExploitability = 5.0f;
+
+    SolveSettings settings = getTestingSolveSettings();
+    settings.targetPercentExploitability = TargetPercentExploitability;
+    settings.maxIterations = 10000;
+
+    std::unique_ptr<SolverSession> session = createLeducSession(settings);
+    ASSERT_TRUE(session);
+    SolveResult result = session->solveAsync().get();
+    EXPECT_EQ(result.status, SolveStatus::TargetReached);
+    EXPECT_LT(result.numIterations, settings.maxIterations);
+    ASSERT_TRUE(result.exploitabilityPercent.has_value());
+    EXPECT_LE(*result.exploitabilityPercent, TargetPercentExploitability);
+}
+
+TEST(SolverSessionTest, RejectsOutOfRangeSettings) {
+    SolveSettings settings = getTestingSolveSettings();
+    settings.exploitabilityCheckFrequency = 0;
+    EXPECT_TRUE(SolverSession::create(std::make_unique<LeducPoker>(true), settings).isError());
+
+    settings = getTestingSolveSettings();
+    settings.pruningRevisitFrequency = 0;
+    EXPECT_TRUE(SolverSession::create(std::make_unique<LeducPoker>(true), settings).isError());
+
+    settings = getTestingSolveSettings();
+    settings.numThreads = 0;
+    EXPECT_TRUE(SolverSession::create(std::make_unique<LeducPoker>(true), settings).isError());
+}
+
+TEST(SolverSessionTest, AsyncSolvePassesExceptionsToTheFuture) {
+    std::unique_ptr<SolverSession> session = createLeducSession(getTestingSolveSettings());
+    ASSERT_TRUE(session);
+
+    std::future<SolveResult> result = session->solveAsync([](const SolveProgress&) {
+        throw std::runtime_error{ "progress callback failed" };
+    });
+    EXPECT_THROW(result.get(), std::runtime_error);
+    EXPECT_FALSE(session->isSolving());
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include "util/stack_allocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace {
+bool isAligned(const void* pointer) {
+    return reinterpret_cast<std::uintptr_t>(pointer) % StackAllocator::Alignment == 0;
+}
+} // namespace
+
+TEST(StackAllocatorTest, BlocksAreAligned) {
+    StackAllocator allocator(1);
+
+    ScopedVector<float> first(allocator, 0, 3);
+    ScopedVector<std::int16_t> second(allocator, 0, 5);
+    ScopedVector<double> third(allocator, 0, 7);
+
+    EXPECT_TRUE(isAligned(first.getData().data()));
+    EXPECT_TRUE(isAligned(second.getData().data()));
+    EXPECT_TRUE(isAligned(third.getData().data()));
+}
+
+TEST(StackAllocatorTest, GrowsPastInitialSize) {
+    static constexpr std::size_t InitialBytes = 1024;
+    static constexpr std::size_t NumBlocks = 40;
+    static constexpr std::size_t FloatsPerBlock = 100;
+    StackAllocator allocator(1, InitialBytes);
+
+    {
+        // Fill every block with its index, blocks in earlier chunks must keep their values
+        std::vector<std::optional<ScopedVector<float>>> blocks(NumBlocks);
+        for (std::size_t i = 0; i < NumBlocks; ++i) {
+            blocks[i].emplace(allocator, 0, FloatsPerBlock);
+            for (float& value : *blocks[i]) {
+                value = static_cast<float>(i);
+            }
+        }
+
+        for (std::size_t i = 0; i < NumBlocks; ++i) {
+            for (float value : *blocks[i]) {
+                ASSERT_EQ(value, static_cast<float>(i));
+            }
+        }
+
+        {
+            // A block larger than a whole chunk gets its own chunk
+            ScopedVector<float> largeBlock(allocator, 0, InitialBytes);
+            EXPECT_EQ(largeBlock.size(), InitialBytes);
+        }
+
+        // Deallocate in reverse order
+        while (!blocks.empty()) {
+            blocks.pop_back();
+        }
+    }
+
+    EXPECT_TRUE(allocator.isEmpty());
+    EXPECT_GT(allocator.getReservedBytes()[0], InitialBytes);
+    EXPECT_EQ(allocator.getMaximumNumBlocks()[0], NumBlocks + 1);
+    EXPECT_GE(allocator.getMaximumStackUsage()[0], (NumBlocks * FloatsPerBlock + InitialBytes) * sizeof(float));
+}
+
+TEST(StackAllocatorTest, ReusesChunksAfterDeallocation) {
+    static constexpr std::size_t InitialBytes = 1024;
+    StackAllocator allocator(1, InitialBytes);
+
+    for (int repeat = 0; repeat < 3; ++repeat) {
+        ScopedVector<float> first(allocator, 0, 200);
+        ScopedVector<float> second(allocator, 0, 200);
+    }
+
+    EXPECT_TRUE(allocator.isEmpty());
+    EXPECT_EQ(allocator.getReservedBytes()[0], 2 * InitialBytes);
+    EXPECT_EQ(allocator.getMaximumNumBlocks()[0], 2);
+}
+
+TEST(StackAllocatorTest, TracksThreadsSeparately) {
+    static constexpr int NumThreads = 96;
+    StackAllocator allocator(NumThreads);
+    EXPECT_EQ(allocator.getNumThreads(), NumThreads);
+
+    {
+        ScopedVector<float> block(allocator, NumThreads - 1, 16);
+        EXPECT_FALSE(allocator.isEmpty());
+    }
+
+    EXPECT_TRUE(allocator.isEmpty());
+    EXPECT_EQ(allocator.getMaximumStackUsage()[0], 0);
+    EXPECT_EQ(allocator.getMaximumStackUsage()[NumThreads - 1], 16 * sizeof(float));
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include "holdem_test_settings.hpp"
+#include "test_helpers.hpp"
+
+#include "game/game_types.hpp"
+#include "game/leduc_poker.hpp"
+#include "game/holdem/holdem_parser.hpp"
+#include "game/holdem/holdem.hpp"
+#include "solver/cfr.hpp"
+#include "solver/tree.hpp"
+#include "util/fixed_vector.hpp"
+#include "util/stack_allocator.hpp"
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+TEST(SubtreeResolveTest, RootSubtreeMatchesFullTraversal) {
+    LeducPoker leducRules{ true };
+    StackAllocator allocator(1);
+
+    Tree fullTree;
+    fullTree.buildTreeSkeleton(leducRules);
+    fullTree.initCfrVectors();
+    trainDiscountedCfrIterations(leducRules, fullTree, 50, allocator);
+
+    Tree subtreeTree;
+    subtreeTree.buildTreeSkeleton(leducRules);
+    subtreeTree.initCfrVectors();
+
+    PlayerArray<std::span<const float>> reachProbs = { leducRules.getInitialRangeWeights(Player::P0), leducRules.getInitialRangeWeights(Player::P1) };
+    for (int i = 0; i < 50; ++i) {
+        for (Player hero : { Player::P0, Player::P1 }) {
+            discountedCfrSubtree(hero, leducRules, getDiscountParams(1.5f, 0.0f, 2.0f, i + 1), subtreeTree.getRootNodeIndex(), reachProbs, subtreeTree, allocator);
+        }
+    }
+
+    EXPECT_EQ(subtreeTree.allRegretSums, fullTree.allRegretSums);
+    EXPECT_EQ(subtreeTree.allStrategySums, fullTree.allStrategySums);
+
+    float exploitability = calculateExploitabilityFast(leducRules, fullTree, allocator);
+    float subtreeExploitability = calculateSubtreeExploitability(leducRules, fullTree.getRootNodeIndex(), reachProbs, fullTree, allocator);
+    EXPECT_NEAR(subtreeExploitability, exploitability, 1e-4f);
+}
+
+TEST(SubtreeResolveTest, ResolveImprovesSubtreeOnly) {
+    Holdem holdemRules{ getHoldemTestSettings(TurnTestSpot) };
+    StackAllocator allocator(1);
+
+    Tree tree;
+    tree.buildTreeSkeleton(holdemRules);
+    tree.initCfrVectors();
+    trainDiscountedCfrIterations(holdemRules, tree, 20, allocator);
+
+    // Re-solve the subtree after the first player checks
+    const Node& root = tree.allNodes[tree.getRootNodeIndex()];
+    ASSERT_EQ(root.nodeType, NodeType::Decision);
+    ASSERT_EQ(root.playerToAct, Player::P0);
+    static constexpr int CheckAction = 0;
+    std::size_t subtreeRootIndex = root.childrenOffset + CheckAction;
+    ASSERT_EQ(tree.allNodes[subtreeRootIndex].nodeType, NodeType::Decision);
+
+    std::vector<float> player0ReachProbs(tree.rangeSize[Player::P0]);
+    const auto player0RangeWeights = holdemRules.getInitialRangeWeights(Player::P0);
+    for (int hand = 0; hand < tree.rangeSize[Player::P0]; ++hand) {
+        player0ReachProbs[hand] = player0RangeWeights[hand] * getFinalStrategy(holdemRules, hand, root, tree)[CheckAction];
+    }
+    PlayerArray<std::span<const float>> reachProbs = { player0ReachProbs, holdemRules.getInitialRangeWeights(Player::P1) };
+
+    std::size_t numRootTrainingValues = root.numChildren * holdemRules.getValidHands(Player::P0, root.board).size();
+    std::vector<float> rootRegretSums(tree.allRegretSums.begin() + root.trainingDataOffset, tree.allRegretSums.begin() + root.trainingDataOffset + numRootTrainingValues);
+
+    float exploitabilityBefore = calculateSubtreeExploitability(holdemRules, subtreeRootIndex, reachProbs, tree, allocator);
+    for (int i = 0; i < 200; ++i) {
+        for (Player hero : { Player::P0, Player::P1 }) {
+            discountedCfrSubtree(hero, holdemRules, getDiscountParams(1.5f, 0.0f, 2.0f, i + 1), subtreeRootIndex, reachProbs, tree, allocator);
+        }
+    }
+    float exploitabilityAfter = calculateSubtreeExploitability(holdemRules, subtreeRootIndex, reachProbs, tree, allocator);
+
+    EXPECT_LT(exploitabilityAfter, exploitabilityBefore);
+
+    std::vector<float> newRootRegretSums(tree.allRegretSums.begin() + root.trainingDataOffset, tree.allRegretSums.begin() + root.trainingDataOffset + numRootTrainingValues);
+    EXPECT_EQ(newRootRegretSums, rootRegretSums);
+}
@@ -0,0 +1,58 @@
+#ifndef TEST_HELPERS_HPP
+#define TEST_HELPERS_HPP
+
+#include <gtest/gtest.h>
+
+#include "game/game_rules.hpp"
+#include "game/game_types.hpp"
+#include "solver/cfr.hpp"
+#include "solver/tree.hpp"
+#include "util/stack_allocator.hpp"
+
+#include <filesystem>
+#include <random>
+#include <string>
+
+// Fixture with a path in the temporary directory that no other test uses
+// Nothing is created at the path, and whatever the test puts there is removed after it
+class TemporaryPathTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_path = std::filesystem::temp_directory_path() / ("postflop_solver_test_" + std::to_string(std::random_device{}()));
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(m_path);
+    }
+
+    std::filesystem::path m_path;
+};
+
+// Trains the tree with the Discounted CFR parameters the solver uses, until numIterations iterations have been completed
+inline void trainDiscountedCfrIterations(
+    const IGameRules& rules,
+    Tree& tree,
+    int numIterations,
+    StackAllocator& allocator,
+    bool useSimultaneousUpdates = false
+) {
+    for (int i = tree.numCompletedIterations; i < numIterations; ++i) {
+        DiscountParams params = getDiscountParams(1.5f, 0.0f, 2.0f, i + 1);
+        if (useSimultaneousUpdates) {
+            simultaneousDiscountedCfr(rules, params, { .numSampledCards = 0, .seed = 0 }, tree, allocator);
+        }
+        else {
+            for (Player hero : { Player::P0, Player::P1 }) {
+                discountedCfr(hero, rules, params, tree, allocator);
+            }
+        }
+        tree.numCompletedIterations = i + 1;
+    }
+}
+
+inline void trainDiscountedCfrIterations(const IGameRules& rules, Tree& tree, int numIterations) {
+    StackAllocator allocator(1);
+    trainDiscountedCfrIterations(rules, tree, numIterations, allocator);
+}
+
+#endif // TEST_HELPERS_HPP
@@ -0,0 +1,266 @@
+#include <gtest/gtest.h>
+
+#include "holdem_test_settings.hpp"
+
+#include "game/game_rules.hpp"
+#include "game/game_types.hpp"
+#include "game/game_utils.hpp"
+#include "game/kuhn_poker.hpp"
+#include "game/leduc_poker.hpp"
+#include "game/holdem/holdem_parser.hpp"
+#include "game/holdem/holdem.hpp"
+#include "solver/tree.hpp"
+#include "util/fixed_vector.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace {
+static constexpr int NumParallelThreads = 4;
+
+const HoldemTestSpot FlopTestSpot = {
+    .communityCards = "Kd, 7c, 2h",
+    .ranges = { "AA, KK, AK, KQs, 76s", "QQ, JJ, AQ, KJs, 87s, 22" },
+};
+
+std::size_t sumOverStreets(const StreetArray<std::size_t>& values) {
+    return values[Street::Flop] + values[Street::Turn] + values[Street::River];
+}
+
+void expectCountsMatchBuiltTree(const IGameRules& rules) {
+    TreeSizeCounts counts = Tree::countTreeSize(rules, NumParallelThreads);
+
+    Tree tree;
+    tree.buildTreeSkeleton(rules);
+    tree.initCfrVectors();
+
+    EXPECT_EQ(sumOverStreets(counts.numNodes), tree.allNodes.size());
+    EXPECT_EQ(sumOverStreets(counts.numDecisionNodes), tree.getNumberOfDecisionNodes());
+    EXPECT_EQ(sumOverStreets(counts.numChanceNodes), tree.allChanceNodeDetails.size());
+    EXPECT_EQ(sumOverStreets(counts.trainingDataSize), tree.allStrategySums.size());
+    EXPECT_EQ(tree.estimateTreeSkeletonSize(rules, counts), tree.getTreeSkeletonSize());
+
+    for (Street street : { Street::Flop, Street::Turn, Street::River }) {
+        std::size_t numNodes = 0;
+        for (const NodeDetails& details : tree.allNodeDetails) {
+            if (details.currentStreet == street) ++numNodes;
+        }
+        EXPECT_EQ(counts.numNodes[street], numNodes);
+    }
+}
+
+// Every node other than the root must be the child of exactly one node that comes before it,
+// and the training data of the decision nodes must not overlap
+void expectValidLayout(const IGameRules& rules, const Tree& tree) {
+    std::vector<int> numParents(tree.allNodes.size(), 0);
+    std::vector<bool> isDecisionNodeIndexUsed(tree.getNumberOfDecisionNodes(), false);
+    std::size_t totalTrainingDataSize = 0;
+
+    for (std::size_t nodeIndex = 0; nodeIndex < tree.allNodes.size(); ++nodeIndex) {
+        const Node& node = tree.allNodes[nodeIndex];
+        if (node.nodeType != NodeType::Chance && node.nodeType != NodeType::Decision) continue;
+
+        ASSERT_GT(node.childrenOffset, nodeIndex);
+        ASSERT_LE(node.childrenOffset + node.numChildren, tree.allNodes.size());
+        for (int child = 0; child < node.numChildren; ++child) {
+            ++numParents[node.childrenOffset + child];
+        }
+
+        if (node.nodeType == NodeType::Decision) {
+            ASSERT_LT(node.decisionNodeIndex, isDecisionNodeIndexUsed.size());
+            EXPECT_FALSE(isDecisionNodeIndexUsed[node.decisionNodeIndex]);
+            isDecisionNodeIndexUsed[node.decisionNodeIndex] = true;
+            totalTrainingDataSize += rules.getValidHands(node.playerToAct, node.board).size() * node.numChildren;
+        }
+    }
+
+    EXPECT_EQ(numParents[0], 0);
+    for (std::size_t nodeIndex = 1; nodeIndex < tree.allNodes.size(); ++nodeIndex) {
+        EXPECT_EQ(numParents[nodeIndex], 1);
+    }
+    EXPECT_EQ(totalTrainingDataSize, tree.allStrategySums.size());
+}
+} // namespace
+
+TEST(TreeBuildTest, KuhnCountsMatchBuiltTree) {
+    KuhnPoker kuhnRules;
+    expectCountsMatchBuiltTree(kuhnRules);
+}
+
+TEST(TreeBuildTest, LeducCountsMatchBuiltTree) {
+    LeducPoker leducRules{ true };
+    expectCountsMatchBuiltTree(leducRules);
+}
+
+TEST(TreeBuildTest, HoldemCountsMatchBuiltTree) {
+    Holdem holdemRules(getHoldemTestSettings(FlopTestSpot));
+    expectCountsMatchBuiltTree(holdemRules);
+}
+
+TEST(TreeBuildTest, HoldemLayoutIsValid) {
+    Holdem holdemRules(getHoldemTestSettings(FlopTestSpot));
+    Tree tree;
+    tree.buildTreeSkeleton(holdemRules, NumParallelThreads);
+    tree.initCfrVectors();
+
+    expectValidLayout(holdemRules, tree);
+}
+
+TEST(TreeBuildTest, ParallelBuildMatchesSerialBuild) {
+    #ifdef _OPENMP
+    Holdem holdemRules(getHoldemTestSettings(FlopTestSpot));
+
+    Tree serialTree;
+    serialTree.buildTreeSkeleton(holdemRules, 1);
+
+    Tree parallelTree;
+    parallelTree.buildTreeSkeleton(holdemRules, NumParallelThreads);
+
+    ASSERT_EQ(serialTree.allNodes.size(), parallelTree.allNodes.size());
+    ASSERT_EQ(serialTree.allChanceNodeDetails.size(), parallelTree.allChanceNodeDetails.size());
+    for (std::size_t nodeIndex = 0; nodeIndex < serialTree.allNodes.size(); ++nodeIndex) {
+        const Node& serialNode = serialTree.allNodes[nodeIndex];
+        const Node& parallelNode = parallelTree.allNodes[nodeIndex];
+        ASSERT_EQ(serialNode.nodeType, parallelNode.nodeType);
+        ASSERT_EQ(serialNode.board, parallelNode.board);
+        ASSERT_EQ(serialNode.numChildren, parallelNode.numChildren);
+        ASSERT_EQ(serialNode.subtreeWork, parallelNode.subtreeWork);
+
+        if (serialNode.nodeType == NodeType::Chance || serialNode.nodeType == NodeType::Decision) {
+            ASSERT_EQ(serialNode.childrenOffset, parallelNode.childrenOffset);
+        }
+        if (serialNode.nodeType == NodeType::Decision) {
+            ASSERT_EQ(serialNode.decisionNodeIndex, parallelNode.decisionNodeIndex);
+            ASSERT_EQ(serialNode.trainingDataOffset, parallelNode.trainingDataOffset);
+        }
+    }
+    #else
+    GTEST_SKIP() << "OMP not found, skipping parallel test.";
+    #endif
+}
+
+TEST(TreeBuildTest, ParallelInitZeroesAllTrainingData) {
+    Holdem holdemRules(getHoldemTestSettings(FlopTestSpot));
+
+    for (bool useHugePages : { false, true }) {
+        Tree tree;
+        tree.buildTreeSkeleton(holdemRules, NumParallelThreads);
+        tree.setTrainingDataHugePages(useHugePages);
+        tree.initCfrVectors(NumParallelThreads);
+
+        // Initializing again reuses the memory, so every value must be zeroed by one of the threads
+        std::fill(tree.allRegretSums.begin(), tree.allRegretSums.end(), 1.0f);
+        std::fill(tree.allStrategySums.begin(), tree.allStrategySums.end(), 1.0f);
+        tree.initCfrVectors(NumParallelThreads);
+
+        EXPECT_TRUE(std::all_of(tree.allRegretSums.begin(), tree.allRegretSums.end(), [](float regretSum) { return regretSum == 0.0f; }));
+        EXPECT_TRUE(std::all_of(tree.allStrategySums.begin(), tree.allStrategySums.end(), [](float strategySum) { return strategySum == 0.0f; }));
+    }
+}
+
+TEST(TreeBuildTest, HandIndexTablesMatchPairwiseSearch) {
+    // Ranges that share some hands at different indices, with a monotone flop so that three suits are isomorphic
+    CardSet communityCards = buildCommunityCardsFromString("Kh, 7h, 2h").getValue();
+    Holdem::Settings settings = getHoldemTestSettings(FlopTestSpot);
+    settings.startingCommunityCards = communityCards;
+    settings.ranges = {
+        buildRangeFromString("AA, KQ:0.5, T9s, 76s", communityCards).getValue(),
+        buildRangeFromString("QQ:0.25, AJs, 76s, 98", communityCards).getValue(),
+    };
+    Holdem holdemRules(settings);
+
+    Tree tree;
+    tree.buildTreeSkeleton(holdemRules, NumParallelThreads);
+
+    PlayerArray<std::span<const CardSet>> rangeHands = { holdemRules.getRangeHands(Player::P0), holdemRules.getRangeHands(Player::P1) };
+    PlayerArray<std::span<const float>> rangeWeights = { holdemRules.getInitialRangeWeights(Player::P0), holdemRules.getInitialRangeWeights(Player::P1) };
+
+    int numSameHands = 0;
+    double expectedTotalRangeWeight = 0.0;
+    for (std::size_t i = 0; i < rangeHands[Player::P0].size(); ++i) {
+        int expectedSameHand = -1;
+        for (std::size_t j = 0; j < rangeHands[Player::P1].size(); ++j) {
+            if (rangeHands[Player::P0][i] == rangeHands[Player::P1][j]) {
+                expectedSameHand = static_cast<int>(j);
+                EXPECT_EQ(tree.sameHandIndexTable[Player::P1][j], static_cast<int>(i));
+            }
+            if (!doSetsOverlap(rangeHands[Player::P0][i] | communityCards, rangeHands[Player::P1][j])) {
+                expectedTotalRangeWeight += static_cast<double>(rangeWeights[Player::P0][i]) * static_cast<double>(rangeWeights[Player::P1][j]);
+            }
+        }
+        EXPECT_EQ(tree.sameHandIndexTable[Player::P0][i], expectedSameHand);
+        numSameHands += (expectedSameHand != -1);
+    }
+    EXPECT_GT(numSameHands, 0);
+    EXPECT_NEAR(tree.totalRangeWeight, expectedTotalRangeWeight, expectedTotalRangeWeight * 1e-12);
+
+    int numSuitSwaps = 0;
+    for (const SuitEquivalenceClass& isomorphism : holdemRules.getChanceNodeIsomorphisms(communityCards)) {
+        for (int i = 0; i < isomorphism.size(); ++i) {
+            for (int j = i + 1; j < isomorphism.size(); ++j) {
+                int twoSuitIndex = mapTwoSuitsToIndex(isomorphism[i], isomorphism[j]);
+                for (Player player : { Player::P0, Player::P1 }) {
+                    const auto& isomorphicHands = tree.isomorphicHandIndices[player][twoSuitIndex];
+                    ASSERT_EQ(isomorphicHands.size(), rangeHands[player].size());
+                    for (std::size_t hand = 0; hand < rangeHands[player].size(); ++hand) {
+                        EXPECT_EQ(isomorphicHands[hand], holdemRules.getHandIndexAfterSuitSwap(player, static_cast<int>(hand), isomorphism[i], isomorphism[j]));
+                    }
+                }
+                ++numSuitSwaps;
+            }
+        }
+    }
+    EXPECT_EQ(numSuitSwaps, 3);
+}
+
+TEST(TreeBuildTest, NonOverlappingPairWeightMatchesPairwiseSum) {
+    Holdem holdemRules(getHoldemTestSettings(FlopTestSpot));
+    CardSet turnBoard = holdemRules.getInitialGameState().currentBoard | cardIDToSet(getCardIDFromName("As").getValue());
+
+    // Uneven weights with some zeros, like the reach probabilities at the root of a subtree
+    PlayerArray<std::vector<float>> weights;
+    for (Player player : { Player::P0, Player::P1 }) {
+        for (std::size_t hand = 0; hand < holdemRules.getRangeHands(player).size(); ++hand) {
+            weights[player].push_back(static_cast<float>(hand % 5) * 0.25f);
+        }
+    }
+
+    PlayerArray<std::span<const CardSet>> rangeHands = { holdemRules.getRangeHands(Player::P0), holdemRules.getRangeHands(Player::P1) };
+    double expectedWeight = 0.0;
+    for (std::size_t i = 0; i < rangeHands[Player::P0].size(); ++i) {
+        for (std::size_t j = 0; j < rangeHands[Player::P1].size(); ++j) {
+            if (!doSetsOverlap(rangeHands[Player::P0][i] | turnBoard, rangeHands[Player::P1][j]) && !doSetsOverlap(rangeHands[Player::P0][i], turnBoard)) {
+                expectedWeight += static_cast<double>(weights[Player::P0][i]) * static_cast<double>(weights[Player::P1][j]);
+            }
+        }
+    }
+
+    double weight = getNonOverlappingPairWeight(holdemRules, turnBoard, { weights[Player::P0], weights[Player::P1] });
+    EXPECT_GT(expectedWeight, 0.0);
+    EXPECT_NEAR(weight, expectedWeight, expectedWeight * 1e-12);
+}
+
+TEST(TreeBuildTest, ParallelHandTablesMatchSerialHandTables) {
+    Holdem::Settings serialSettings = getHoldemTestSettings(FlopTestSpot);
+    Holdem::Settings parallelSettings = serialSettings;
+    parallelSettings.numThreads = NumParallelThreads;
+
+    Holdem serialRules(serialSettings);
+    Holdem parallelRules(parallelSettings);
+
+    CardSet startingBoard = serialSettings.startingCommunityCards;
+    for (CardID turnCard = 0; turnCard < holdem::DeckSize; ++turnCard) {
+        for (CardID riverCard = turnCard; riverCard < holdem::DeckSize; ++riverCard) {
+            CardSet board = startingBoard | cardIDToSet(turnCard) | cardIDToSet(riverCard);
+            if (doSetsOverlap(startingBoard, cardIDToSet(turnCard) | cardIDToSet(riverCard))) continue;
+
+            for (Player player : { Player::P0, Player::P1 }) {
+                auto serialHands = serialRules.getValidHands(player, board);
+                auto parallelHands = parallelRules.getValidHands(player, board);
+                ASSERT_TRUE(std::equal(serialHands.begin(), serialHands.end(), parallelHands.begin(), parallelHands.end()));
+            }
+        }
+    }
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+
+#include "test_helpers.hpp"
+
+#include "game/game_rules.hpp"
+#include "game/game_types.hpp"
+#include "game/kuhn_poker.hpp"
+#include "game/leduc_poker.hpp"
+#include "solver/cfr.hpp"
+#include "solver/checkpoint_writer.hpp"
+#include "solver/tree.hpp"
+#include "util/fixed_vector.hpp"
+#include "util/result.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+namespace {
+static constexpr int LeducIterations = 200;
+
+class TreeFileTest : public TemporaryPathTest {};
+
+void solveLeduc(const LeducPoker& rules, Tree& tree) {
+    tree.buildTreeSkeleton(rules);
+    tree.initCfrVectors();
+    trainDiscountedCfrIterations(rules, tree, LeducIterations);
+}
+
+void expectSameFinalStrategies(const IGameRules& rules, const Tree& actual, const Tree& expected) {
+    ASSERT_EQ(actual.allNodes.size(), expected.allNodes.size());
+    for (std::size_t nodeIndex = 0; nodeIndex < expected.allNodes.size(); ++nodeIndex) {
+        const Node& node = expected.allNodes[nodeIndex];
+        if (node.nodeType != NodeType::Decision) continue;
+
+        for (int hand = 0; hand < expected.rangeSize[node.playerToAct]; ++hand) {
+            FixedVector<float, MaxNumActions> actualStrategy = getFinalStrategy(rules, hand, actual.allNodes[nodeIndex], actual);
+            FixedVector<float, MaxNumActions> expectedStrategy = getFinalStrategy(rules, hand, node, expected);
+            ASSERT_EQ(actualStrategy.size(), expectedStrategy.size());
+            for (int action = 0; action < expectedStrategy.size(); ++action) {
+                ASSERT_EQ(actualStrategy[action], expectedStrategy[action]);
+            }
+        }
+    }
+}
+} // namespace
+
+TEST_F(TreeFileTest, MemoryMappedLoadMatchesSavedTree) {
+    LeducPoker leducRules{ true };
+    Tree tree;
+    solveLeduc(leducRules, tree);
+    ASSERT_TRUE(tree.saveToFile(leducRules, m_path));
+
+    Result<std::unique_ptr<Tree>> loadResult = Tree::loadFromFile(leducRules, m_path, true);
+    ASSERT_TRUE(loadResult.isValue());
+
+    const Tree& loadedTree = *loadResult.getValue();
+    EXPECT_TRUE(loadedTree.areCfrVectorsInitialized());
+    EXPECT_EQ(loadedTree.getNumberOfDecisionNodes(), tree.getNumberOfDecisionNodes());
+    EXPECT_EQ(loadedTree.totalRangeWeight, tree.totalRangeWeight);
+    expectSameFinalStrategies(leducRules, loadedTree, tree);
+}
+
+TEST_F(TreeFileTest, CopiedLoadMatchesSavedTree) {
+    LeducPoker leducRules{ true };
+    Tree tree{ true };
+    solveLeduc(leducRules, tree);
+    ASSERT_TRUE(tree.saveToFile(leducRules, m_path));
+
+    Result<std::unique_ptr<Tree>> loadResult = Tree::loadFromFile(leducRules, m_path, false);
+    ASSERT_TRUE(loadResult.isValue());
+
+    const Tree& loadedTree = *loadResult.getValue();
+    EXPECT_FALSE(loadedTree.isTrainingDataMemoryMapped());
+    EXPECT_TRUE(loadedTree.isTrainingDataCompressed());
+    EXPECT_EQ(loadedTree.allCompressedRegretSums, tree.allCompressedRegretSums);
+    EXPECT_EQ(loadedTree.allRegretSumScales, tree.allRegretSumScales);
+    EXPECT_EQ(loadedTree.allLastDiscountedIterations, tree.allLastDiscountedIterations);
+    expectSameFinalStrategies(leducRules, loadedTree, tree);
+}
+
+TEST_F(TreeFileTest, RejectsDifferentGame) {
+    LeducPoker leducRules{ true };
+    Tree tree;
+    solveLeduc(leducRules, tree);
+    ASSERT_TRUE(tree.saveToFile(leducRules, m_path));
+
+    KuhnPoker kuhnRules;
+    EXPECT_TRUE(Tree::loadFromFile(kuhnRules, m_path, true).isError());
+}
+
+TEST_F(TreeFileTest, RejectsTruncatedFile) {
+    LeducPoker leducRules{ true };
+    Tree tree;
+    solveLeduc(leducRules, tree);
+    ASSERT_TRUE(tree.saveToFile(leducRules, m_path));
+
+    std::uintmax_t fileSize = std::filesystem::file_size(m_path);
+    std::filesystem::resize_file(m_path, fileSize - 1);
+    EXPECT_TRUE(Tree::loadFromFile(leducRules, m_path, true).isError());
+
+    std::filesystem::resize_file(m_path, 0);
+    EXPECT_TRUE(Tree::loadFromFile(leducRules, m_path, true).isError());
+}
+
+TEST_F(TreeFileTest, RejectsMissingFile) {
+    LeducPoker leducRules{ true };
+    EXPECT_TRUE(Tree::loadFromFile(leducRules, m_path, true).isError());
+}
+
+TEST_F(TreeFileTest, ResumedSolveMatchesUninterruptedSolve) {
+    LeducPoker leducRules{ true };
+    Tree uninterruptedTree;
+    uninterruptedTree.buildTreeSkeleton(leducRules);
+    uninterruptedTree.initCfrVectors();
+    trainDiscountedCfrIterations(leducRules, uninterruptedTree, LeducIterations * 2);
+
+    Tree interruptedTree;
+    solveLeduc(leducRules, interruptedTree);
+    ASSERT_TRUE(interruptedTree.saveToFile(leducRules, m_path));
+
+    Result<std::unique_ptr<Tree>> loadResult = Tree::loadFromFile(leducRules, m_path, false);
+    ASSERT_TRUE(loadResult.isValue());
+
+    Tree& resumedTree = *loadResult.getValue();
+    EXPECT_EQ(resumedTree.numCompletedIterations, LeducIterations);
+    trainDiscountedCfrIterations(leducRules, resumedTree, LeducIterations * 2);
+
+    EXPECT_EQ(resumedTree.allRegretSums, uninterruptedTree.allRegretSums);
+    EXPECT_EQ(resumedTree.allStrategySums, uninterruptedTree.allStrategySums);
+}
+
+TEST_F(TreeFileTest, TrainingContinuesWhileCheckpointIsWritten) {
+    LeducPoker leducRules{ true };
+    Tree tree;
+    solveLeduc(leducRules, tree);
+    TrainingDataVector<float> checkpointedRegretSums = tree.allRegretSums;
+    TrainingDataVector<float> checkpointedStrategySums = tree.allStrategySums;
+
+    CheckpointWriter checkpointWriter{ leducRules, m_path };
+    ASSERT_TRUE(checkpointWriter.writeAsync(tree));
+    EXPECT_TRUE(checkpointWriter.isWriting());
+
+    // The checkpoint must contain the state it was started with, not the updates made by training during the write
+    trainDiscountedCfrIterations(leducRules, tree, LeducIterations * 2);
+    ASSERT_TRUE(checkpointWriter.wait());
+    EXPECT_FALSE(checkpointWriter.isWriting());
+
+    Result<std::unique_ptr<Tree>> loadResult = Tree::loadFromFile(leducRules, m_path, false);
+    ASSERT_TRUE(loadResult.isValue());
+
+    const Tree& loadedTree = *loadResult.getValue();
+    EXPECT_EQ(loadedTree.numCompletedIterations, LeducIterations);
+    EXPECT_EQ(loadedTree.allRegretSums, checkpointedRegretSums);
+    EXPECT_EQ(loadedTree.allStrategySums, checkpointedStrategySums);
+    EXPECT_NE(loadedTree.allRegretSums, tree.allRegretSums);
+}
+
+TEST_F(TreeFileTest, FileBackedTrainingDataMatchesInMemoryTrainingData) {
+    LeducPoker leducRules{ true };
+    Tree inMemoryTree;
+    solveLeduc(leducRules, inMemoryTree);
+
+    Tree fileBackedTree;
+    fileBackedTree.buildTreeSkeleton(leducRules);
+    EXPECT_FALSE(fileBackedTree.setTrainingDataDirectory(m_path / "missing"));
+    ASSERT_TRUE(fileBackedTree.setTrainingDataDirectory(std::filesystem::temp_directory_path()));
+    EXPECT_TRUE(fileBackedTree.isTrainingDataFileBacked());
+
+    // Subtrees after the first chance card can be released during training, which must not lose any updates
+    fileBackedTree.initCfrVectors();
+    trainDiscountedCfrIterations(leducRules, fileBackedTree, LeducIterations);
+
+    EXPECT_EQ(fileBackedTree.allRegretSums, inMemoryTree.allRegretSums);
+    EXPECT_EQ(fileBackedTree.allStrategySums, inMemoryTree.allStrategySums);
+
+    // Scratch files would be shared with a forked writer, so the checkpoint is written before training continues
+    CheckpointWriter checkpointWriter{ leducRules, m_path };
+    EXPECT_TRUE(checkpointWriter.writeAsync(fileBackedTree));
+    EXPECT_FALSE(checkpointWriter.isWriting());
+    EXPECT_TRUE(checkpointWriter.wait());
+}
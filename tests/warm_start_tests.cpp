@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include "holdem_test_settings.hpp"
+#include "test_helpers.hpp"
+
+#include "game/game_types.hpp"
+#include "game/leduc_poker.hpp"
+#include "game/holdem/holdem_parser.hpp"
+#include "game/holdem/holdem.hpp"
+#include "solver/cfr.hpp"
+#include "solver/tree.hpp"
+#include "solver/warm_start.hpp"
+#include "util/fixed_vector.hpp"
+#include "util/stack_allocator.hpp"
+
+#include <utility>
+
+namespace {
+static constexpr int SourceIterations = 100;
+static constexpr int NewIterations = 10;
+
+Holdem::Settings getTurnTestSettings(const FixedVector<int, holdem::MaxNumBetSizes>& betSizes) {
+    HoldemTestSpot spot = TurnTestSpot;
+    spot.betSizes = betSizes;
+    return getHoldemTestSettings(spot);
+}
+
+} // namespace
+
+TEST(WarmStartTest, SameTreeCopiesTrainingData) {
+    LeducPoker leducRules{ true };
+    Tree sourceTree;
+    sourceTree.buildTreeSkeleton(leducRules);
+    sourceTree.initCfrVectors();
+    trainDiscountedCfrIterations(leducRules, sourceTree, SourceIterations);
+
+    Tree targetTree;
+    targetTree.buildTreeSkeleton(leducRules);
+    targetTree.initCfrVectors();
+
+    EXPECT_EQ(warmStartTree(leducRules, sourceTree, targetTree), targetTree.getNumberOfDecisionNodes());
+    EXPECT_EQ(targetTree.numCompletedIterations, SourceIterations);
+    EXPECT_EQ(targetTree.allRegretSums, sourceTree.allRegretSums);
+    EXPECT_EQ(targetTree.allStrategySums, sourceTree.allStrategySums);
+    EXPECT_EQ(targetTree.allLastDiscountedIterations, sourceTree.allLastDiscountedIterations);
+}
+
+TEST(WarmStartTest, DifferentBetSizesSeedEveryNode) {
+    Holdem sourceRules{ getTurnTestSettings({ 50 }) };
+    Tree sourceTree;
+    sourceTree.buildTreeSkeleton(sourceRules);
+    sourceTree.initCfrVectors();
+    trainDiscountedCfrIterations(sourceRules, sourceTree, SourceIterations);
+
+    // The compressed target also checks that the seed is converted between the two training data formats
+    Holdem targetRules{ getTurnTestSettings({ 75 }) };
+    Tree seededTree{ true };
+    seededTree.buildTreeSkeleton(targetRules);
+    seededTree.initCfrVectors();
+    EXPECT_EQ(warmStartTree(targetRules, sourceTree, seededTree), seededTree.getNumberOfDecisionNodes());
+
+    Tree coldTree{ true };
+    coldTree.buildTreeSkeleton(targetRules);
+    coldTree.initCfrVectors();
+
+    // The seeded training data starts close to the source solution, so a few iterations get much closer to equilibrium than from scratch
+    trainDiscountedCfrIterations(targetRules, seededTree, SourceIterations + NewIterations);
+    trainDiscountedCfrIterations(targetRules, coldTree, NewIterations);
+
+    StackAllocator allocator(1);
+    float seededExploitability = calculateExploitability(targetRules, seededTree, allocator);
+    float coldExploitability = calculateExploitability(targetRules, coldTree, allocator);
+    EXPECT_LT(seededExploitability, coldExploitability);
+}
+
+TEST(WarmStartTest, ActionsMatchingOneSourceActionSplitItsTrainingData) {
+    Holdem sourceRules{ getTurnTestSettings({ 50 }) };
+    Tree sourceTree;
+    sourceTree.buildTreeSkeleton(sourceRules);
+    sourceTree.initCfrVectors();
+    trainDiscountedCfrIterations(sourceRules, sourceTree, NewIterations);
+
+    Holdem targetRules{ getTurnTestSettings({ 50, 75 }) };
+    Tree targetTree;
+    targetTree.buildTreeSkeleton(targetRules);
+    targetTree.initCfrVectors();
+    warmStartTree(targetRules, sourceTree, targetTree);
+
+    // The root is check, bet and all in for the source tree, and both bets of the target tree take the source bet
+    const Node& sourceRoot = sourceTree.allNodes[sourceTree.getRootNodeIndex()];
+    const Node& targetRoot = targetTree.allNodes[targetTree.getRootNodeIndex()];
+    ASSERT_EQ(sourceRoot.numChildren, 3);
+    ASSERT_EQ(targetRoot.numChildren, 4);
+
+    std::size_t numTrainingHands = targetRules.getValidHands(targetRoot.playerToAct, targetRoot.board).size();
+    auto getSourceValue = [&](const auto& values, int action, std::size_t hand) {
+        return values[sourceRoot.trainingDataOffset + action * numTrainingHands + hand];
+    };
+    auto getTargetValue = [&](const auto& values, int action, std::size_t hand) {
+        return values[targetRoot.trainingDataOffset + action * numTrainingHands + hand];
+    };
+
+    for (std::size_t hand = 0; hand < numTrainingHands; ++hand) {
+        for (auto [targetAction, sourceAction] : { std::pair{ 0, 0 }, std::pair{ 3, 2 } }) {
+            EXPECT_EQ(getTargetValue(targetTree.allRegretSums, targetAction, hand), getSourceValue(sourceTree.allRegretSums, sourceAction, hand));
+            EXPECT_EQ(getTargetValue(targetTree.allStrategySums, targetAction, hand), getSourceValue(sourceTree.allStrategySums, sourceAction, hand));
+        }
+        for (int targetBet : { 1, 2 }) {
+            EXPECT_EQ(getTargetValue(targetTree.allRegretSums, targetBet, hand), 0.5f * getSourceValue(sourceTree.allRegretSums, 1, hand));
+            EXPECT_EQ(getTargetValue(targetTree.allStrategySums, targetBet, hand), 0.5f * getSourceValue(sourceTree.allStrategySums, 1, hand));
+        }
+    }
+}